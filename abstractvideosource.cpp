@@ -0,0 +1,57 @@
+#include <memory>
+#include <utility>
+#include "abstractvideosource.h"
+#include "videosourceinstrumentation.h"
+
+namespace vfg {
+namespace core {
+
+void AbstractVideoSource::setInstrumentation(
+        std::shared_ptr<vfg::core::SourceInstrumentation> newInstrumentation)
+{
+    timings = std::move(newInstrumentation);
+}
+
+std::pair<qint64, qint64> AbstractVideoSource::frameByteRange(const int frameNumber) const
+{
+    Q_UNUSED(frameNumber);
+
+    return {-1, -1};
+}
+
+QVector<int> AbstractVideoSource::keyframes() const
+{
+    return {};
+}
+
+bool AbstractVideoSource::waitForFrame(const int frameNumber)
+{
+    Q_UNUSED(frameNumber);
+
+    return true;
+}
+
+std::shared_ptr<vfg::core::SourceInstrumentation> AbstractVideoSource::instrumentation() const
+{
+    return timings;
+}
+
+void AbstractVideoSource::recordFrameTiming(const int frameNumber, const qint64 decodeTime,
+                                            const qint64 conversionTime)
+{
+    if(!timings) {
+        return;
+    }
+
+    FrameTiming timing;
+    timing.frameNumber = frameNumber;
+    timing.seekDistance = frameNumber - previousFrame;
+    timing.decodeTime = decodeTime;
+    timing.conversionTime = conversionTime;
+    timings->recordFrame(timing);
+
+    previousFrame = frameNumber;
+}
+
+} // namespace core
+} // namespace vfg
@@ -1,8 +1,12 @@
 #ifndef ABSTRACTVIDEOSOURCE_H
 #define ABSTRACTVIDEOSOURCE_H
 
+#include <memory>
 #include <stdexcept>
+#include <utility>
 #include <QObject>
+#include <QVector>
+#include "videosourceinstrumentation.h"
 
 namespace vfg {
     class ScriptParser;
@@ -112,6 +116,75 @@ public:
      */
     virtual QString fileName() const = 0;
 
+    /**
+     * @brief Get location of a frame in the opened file
+     *
+     * Sources that read frames from known offsets report them so that
+     * frames can be read from a file that is still being downloaded
+     *
+     * @param frameNumber Frame number
+     * @return First and last byte (inclusive) of the frame, {-1, -1} if unknown
+     */
+    virtual std::pair<qint64, qint64> frameByteRange(int frameNumber) const;
+
+    /**
+     * @brief Get keyframe positions
+     *
+     * Sources that decode long GOPs report where decoding can start,
+     * so that seeks can be snapped to frames that decode quickly
+     *
+     * @return Sorted keyframe numbers, empty if unknown or if every
+     *         frame is a keyframe
+     */
+    virtual QVector<int> keyframes() const;
+
+    /**
+     * @brief Wait until a frame can be read
+     *
+     * Sources that read a file that is still being downloaded block
+     * until the frame's data is on disk. Called without holding any
+     * frame grabber lock, so that waiting doesn't block other requests.
+     *
+     * @param frameNumber Frame number
+     * @return True if the frame can be read, false if it isn't available in time
+     */
+    virtual bool waitForFrame(int frameNumber);
+
+    /**
+     * @brief Set instrumentation that receives per-call frame timings
+     *
+     * Set the instrumentation before frames are requested from other threads
+     *
+     * @param newInstrumentation Instrumentation, or nullptr to disable
+     */
+    void setInstrumentation(std::shared_ptr<vfg::core::SourceInstrumentation> newInstrumentation);
+
+    /**
+     * @brief Get instrumentation
+     * @return Instrumentation, may be nullptr
+     */
+    std::shared_ptr<vfg::core::SourceInstrumentation> instrumentation() const;
+
+protected:
+    /**
+     * @brief Record timings of a decoded frame
+     *
+     * Derived classes call this from getFrame(). The seek distance
+     * is computed from the previously recorded frame
+     *
+     * @param frameNumber Decoded frame number
+     * @param decodeTime Time spent decoding in microseconds
+     * @param conversionTime Time spent converting to QImage in microseconds
+     */
+    void recordFrameTiming(int frameNumber, qint64 decodeTime, qint64 conversionTime);
+
+private:
+    //! Receives frame timings if set
+    std::shared_ptr<vfg::core::SourceInstrumentation> timings {};
+
+    //! Previously recorded frame number for computing seek distance
+    int previousFrame {0};
+
 signals:    
     /**
      * @brief Signals when the video has been loaded
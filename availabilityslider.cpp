@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <QColor>
+#include <QEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPoint>
+#include <QRect>
+#include <QStyle>
+#include <QStyleOptionSlider>
+#include "availabilityslider.hpp"
+
+namespace {
+
+//! Height of the availability bar in pixels
+constexpr int BarHeight = 3;
+
+} // namespace
+
+namespace vfg {
+namespace ui {
+
+AvailabilitySlider::AvailabilitySlider(QWidget *parent) :
+    QSlider(parent)
+{
+    setMouseTracking(true);
+}
+
+void AvailabilitySlider::setAvailableRanges(const QVector<QPair<int, int>>& ranges)
+{
+    available = ranges;
+    partial = true;
+    update();
+}
+
+void AvailabilitySlider::clearAvailableRanges()
+{
+    available.clear();
+    partial = false;
+    update();
+}
+
+int AvailabilitySlider::valueAt(const int x) const
+{
+    QStyleOptionSlider opt;
+    initStyleOption(&opt);
+    const QRect groove = style()->subControlRect(QStyle::CC_Slider, &opt,
+                                                 QStyle::SC_SliderGroove, this);
+    const QRect handle = style()->subControlRect(QStyle::CC_Slider, &opt,
+                                                 QStyle::SC_SliderHandle, this);
+
+    // The handle's center can't go past the groove by half its width
+    const int span = groove.width() - handle.width();
+    const int pos = x - groove.left() - handle.width() / 2;
+    return QStyle::sliderValueFromPosition(minimum(), maximum(), pos, span, opt.upsideDown);
+}
+
+void AvailabilitySlider::mouseMoveEvent(QMouseEvent *ev)
+{
+    QSlider::mouseMoveEvent(ev);
+
+    if(isEnabled() && orientation() == Qt::Horizontal && maximum() > minimum()) {
+        emit hovered(valueAt(ev->x()), ev->globalPos());
+    }
+}
+
+void AvailabilitySlider::leaveEvent(QEvent *ev)
+{
+    QSlider::leaveEvent(ev);
+
+    emit hoverLeft();
+}
+
+void AvailabilitySlider::paintEvent(QPaintEvent *ev)
+{
+    QSlider::paintEvent(ev);
+
+    if(!partial || orientation() != Qt::Horizontal || maximum() <= minimum()) {
+        return;
+    }
+
+    QStyleOptionSlider opt;
+    initStyleOption(&opt);
+    const QRect groove = style()->subControlRect(QStyle::CC_Slider, &opt,
+                                                 QStyle::SC_SliderGroove, this);
+    const QRect bar(groove.left(), height() - BarHeight, groove.width(), BarHeight);
+    const double scale = static_cast<double>(bar.width()) / (maximum() - minimum() + 1);
+
+    QPainter painter(this);
+
+    // #C8C8C8 (light gray) for missing, #3C9B3C (green) for available
+    painter.fillRect(bar, QColor::fromRgb(200, 200, 200));
+    for(const auto& range : available) {
+        const int left = bar.left() + static_cast<int>((range.first - minimum()) * scale);
+        const int right = bar.left() + static_cast<int>((range.second - minimum() + 1) * scale);
+        painter.fillRect(QRect(left, bar.top(), std::max(1, right - left), BarHeight),
+                         QColor::fromRgb(60, 155, 60));
+    }
+}
+
+} // namespace ui
+} // namespace vfg
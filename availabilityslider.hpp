@@ -0,0 +1,82 @@
+#ifndef VFG_UI_AVAILABILITYSLIDER_HPP
+#define VFG_UI_AVAILABILITYSLIDER_HPP
+
+#include <QPair>
+#include <QSlider>
+#include <QVector>
+
+class QEvent;
+class QMouseEvent;
+class QPaintEvent;
+class QPoint;
+class QWidget;
+
+namespace vfg {
+namespace ui {
+
+/**
+ * @brief The AvailabilitySlider class
+ *
+ * Seek slider that marks which values are available under the groove,
+ * e.g. the frames of a video that have been downloaded. Reports the
+ * value under the mouse cursor while hovering.
+ */
+class AvailabilitySlider : public QSlider
+{
+    Q_OBJECT
+
+private:
+    //! Available value ranges, empty if everything is available
+    QVector<QPair<int, int>> available {};
+
+    //! Set if only the available ranges are shown as available
+    bool partial {false};
+
+public:
+    /**
+     * @brief Constructor
+     * @param parent Owner of the widget
+     */
+    explicit AvailabilitySlider(QWidget *parent = 0);
+
+    /**
+     * @brief Set available value ranges
+     * @param ranges First and last value (inclusive) of every available range
+     */
+    void setAvailableRanges(const QVector<QPair<int, int>>& ranges);
+
+    /**
+     * @brief Mark every value as available
+     */
+    void clearAvailableRanges();
+
+    /**
+     * @brief Get value at a position on the groove
+     * @param x Horizontal position in widget coordinates
+     * @return Value
+     */
+    int valueAt(int x) const;
+
+protected:
+    void paintEvent(QPaintEvent *ev) override;
+    void mouseMoveEvent(QMouseEvent *ev) override;
+    void leaveEvent(QEvent *ev) override;
+
+signals:
+    /**
+     * @brief Emitted when the mouse cursor moves over the slider
+     * @param value Value under the cursor
+     * @param globalPos Cursor position in global coordinates
+     */
+    void hovered(int value, const QPoint& globalPos);
+
+    /**
+     * @brief Emitted when the mouse cursor leaves the slider
+     */
+    void hoverLeft();
+};
+
+} // namespace ui
+} // namespace vfg
+
+#endif // VFG_UI_AVAILABILITYSLIDER_HPP
@@ -3,11 +3,16 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QFileInfo>
 #include <QImage>
+#include <QIODevice>
+#include <QRegularExpression>
 #include <QSize>
 #include <QString>
 #include "avisynthvideosource.h"
+#include "keyframeindex.h"
 #include "ptrutil.hpp"
 #include "scriptparser.h"
 
@@ -39,6 +44,22 @@ QImage videoFrameToQImage(const vfg::avisynth::VideoFrame& frame,
     return image;
 }
 
+/**
+ * @brief Get source file of a script created from the templates
+ * @param scriptPath Path to script
+ * @return Value of PathToVideo, empty if not found
+ */
+QString sourcePath(const QString& scriptPath) {
+    QFile script(scriptPath);
+    if(!script.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return {};
+    }
+
+    static const QRegularExpression pathToVideo("^\\s*PathToVideo\\s*=\\s*\"([^\"]*)\"",
+                                                QRegularExpression::MultilineOption);
+    return pathToVideo.match(QString::fromUtf8(script.readAll())).captured(1);
+}
+
 } // namespace
 
 vfg::core::AvisynthVideoSource::AvisynthVideoSource() :
@@ -49,12 +70,17 @@ vfg::core::AvisynthVideoSource::AvisynthVideoSource() :
 
 void vfg::core::AvisynthVideoSource::load(const QString& fileName) try
 {
-    avs.load(fileName.toStdString());
+    // Settings changes rewrite the same script with a new filter chain,
+    // so the loaded plugins and sources are reused when possible
+    avs.reload(fileName.toStdString());
 
     if(avs.pixelFormat() != vfg::avisynth::PixelFormat::BGR32) {
         throw VideoSourceError("Video is not RGB32. Add ConvertToRGB32() to your script.");
     }
 
+    const auto index = KeyframeIndex::forSource(sourcePath(fileName), keyframeIndexer);
+    keyframeNumbers = index.matches(avs.numFrames()) ? index.frames() : QVector<int>();
+
     emit videoLoaded();
 }
 catch(const vfg::avisynth::AvisynthError& ex)
@@ -74,7 +100,14 @@ int vfg::core::AvisynthVideoSource::getNumFrames() const
 
 QImage vfg::core::AvisynthVideoSource::getFrame(const int frameNumber) try
 {
-    return videoFrameToQImage(avs.getFrame(frameNumber), avs.width(), avs.height());
+    QElapsedTimer timer;
+    timer.start();
+    const vfg::avisynth::VideoFrame frame = avs.getFrame(frameNumber);
+    const qint64 decodeTime = timer.nsecsElapsed() / 1000;
+    QImage image = videoFrameToQImage(frame, avs.width(), avs.height());
+    recordFrameTiming(frameNumber, decodeTime, timer.nsecsElapsed() / 1000 - decodeTime);
+
+    return image;
 }
 catch(const std::exception& exc) {
     return {};
@@ -120,3 +153,13 @@ QString vfg::core::AvisynthVideoSource::fileName() const
     const QFileInfo info(QString::fromStdString(avs.fileName()));
     return info.absoluteFilePath();
 }
+
+QVector<int> vfg::core::AvisynthVideoSource::keyframes() const
+{
+    return keyframeNumbers;
+}
+
+void vfg::core::AvisynthVideoSource::setKeyframeIndexer(const QString& indexerPath)
+{
+    keyframeIndexer = indexerPath;
+}
@@ -1,6 +1,7 @@
 #ifndef AVISYNTHVIDEOSOURCE_H
 #define AVISYNTHVIDEOSOURCE_H
 
+#include <QVector>
 #include "abstractvideosource.h"
 #include "avisynthwrapper.hpp"
 
@@ -12,6 +13,12 @@ class AvisynthVideoSource : public vfg::core::AbstractVideoSource
 private:
     vfg::avisynth::AvisynthWrapper avs {};
 
+    //! Keyframes of the loaded script, empty if unknown
+    QVector<int> keyframeNumbers {};
+
+    //! Path to ffmsindex, empty to not generate keyframe lists
+    QString keyframeIndexer {};
+
 public:
     AvisynthVideoSource();
     ~AvisynthVideoSource() override = default;
@@ -38,6 +45,27 @@ public:
     vfg::ScriptParser getParser(const QFileInfo &info) const override;
     QSize resolution() const override;
     QString fileName() const override;
+
+    /**
+     * @brief Get keyframes of the source file in the loaded script
+     *
+     * The source file is read from the PathToVideo variable used by
+     * the script templates. Keyframes are only reported if the script
+     * doesn't change the number of frames in the source.
+     *
+     * @return Sorted keyframe numbers, empty if unknown
+     */
+    QVector<int> keyframes() const override;
+
+    /**
+     * @brief Set ffmsindex used to generate missing keyframe lists
+     *
+     * FFVideoSource doesn't write keyframe lists, so without ffmsindex
+     * FFMS2 sources have no keyframes. Takes effect on the next load.
+     *
+     * @param indexerPath Path to ffmsindex, empty to not generate lists
+     */
+    void setKeyframeIndexer(const QString& indexerPath);
 };
 
 } // namespace core
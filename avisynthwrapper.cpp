@@ -1,12 +1,197 @@
 #include <cstddef>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <regex>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 #include "avisynthwrapper.hpp"
 #include "ptrutil.hpp"
 #include "raiideleter.hpp"
 
+namespace {
+
+/**
+ * @brief Script split into sources and filters
+ */
+struct ScriptParts
+{
+    //! Lines up to the last line that loads a plugin or opens a source
+    std::string header {};
+
+    //! Remaining lines
+    std::string chain {};
+};
+
+// Appended to the header to remember its clip, as the chain may use it implicitly
+const char *const headerSuffix =
+        "\ntry {\n"
+        "    __vfg_last = last\n"
+        "} catch(err_msg) {\n"
+        "    __vfg_last = 0\n"
+        "}\n";
+
+// Restores the clip of the header before each chain
+const char *const chainPrefix =
+        "try {\n"
+        "    last = IsClip(__vfg_last) ? __vfg_last : last\n"
+        "} catch(err_msg) {\n"
+        "    __vfg_last = 0\n"
+        "}\n";
+
+/**
+ * @brief Restores the working directory on scope exit
+ */
+class WorkingDirectory
+{
+private:
+    std::string previous {};
+    bool changed {false};
+
+public:
+    explicit WorkingDirectory(const std::string& dir) {
+        char buf[MAX_PATH];
+        const DWORD len = GetCurrentDirectoryA(MAX_PATH, buf);
+        if(len > 0 && len < MAX_PATH) {
+            previous.assign(buf, len);
+            changed = SetCurrentDirectoryA(dir.c_str()) != 0;
+        }
+    }
+
+    WorkingDirectory(const WorkingDirectory&) = delete;
+    WorkingDirectory& operator=(const WorkingDirectory&) = delete;
+
+    ~WorkingDirectory() {
+        if(changed) {
+            SetCurrentDirectoryA(previous.c_str());
+        }
+    }
+};
+
+std::string readScript(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        throw vfg::avisynth::AvisynthError("Unable to open " + path);
+    }
+
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::string directoryOf(const std::string& path) {
+    const auto sep = path.find_last_of("/\\");
+    return sep == std::string::npos ? std::string(".") : path.substr(0, sep + 1);
+}
+
+bool isBlank(const std::string& str) {
+    return str.find_first_not_of(" \t\r\n") == std::string::npos;
+}
+
+bool startsWithContinuation(const std::string& line) {
+    const auto first = line.find_first_not_of(" \t");
+    return first != std::string::npos && line[first] == '\\';
+}
+
+bool endsWithContinuation(const std::string& code) {
+    const auto last = code.find_last_not_of(" \t\r");
+    return last != std::string::npos && code[last] == '\\';
+}
+
+/**
+ * @brief Split script after the last line that loads a plugin or opens a source
+ *
+ * The split is moved forward until it's outside of blocks, multi-line
+ * strings and continued lines, so that both parts can be evaluated alone
+ *
+ * @param script Script text
+ * @return Split script, header is empty if there are no such lines
+ */
+ScriptParts splitScript(const std::string& script) {
+    static const std::regex sourceCall(
+                R"((^|[^\w.])(LoadPlugin|LoadCPlugin|Load_Stdcall_Plugin|LoadVirtualdubPlugin|LoadVFAPIPlugin|Import|\w*Source\w*)\s*\()",
+                std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+
+    std::vector<std::string> lines;
+    for(std::size_t begin = 0; begin <= script.size(); ) {
+        const auto end = script.find('\n', begin);
+        if(end == std::string::npos) {
+            lines.push_back(script.substr(begin));
+            break;
+        }
+
+        lines.push_back(script.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    int depth = 0;
+    bool inTripleQuote = false;
+    bool pending = false;
+    std::size_t split = 0;
+    for(std::size_t i = 0; i < lines.size(); ++i) {
+        // Strip strings and comments before matching and counting braces
+        const std::string& line = lines.at(i);
+        std::string code;
+        for(std::size_t c = 0; c < line.size(); ++c) {
+            if(inTripleQuote) {
+                if(line.compare(c, 3, "\"\"\"") == 0) {
+                    inTripleQuote = false;
+                    c += 2;
+                }
+                continue;
+            }
+
+            const char ch = line[c];
+            if(line.compare(c, 3, "\"\"\"") == 0) {
+                inTripleQuote = true;
+                c += 2;
+                code += ' ';
+            }
+            else if(ch == '"') {
+                const auto end = line.find('"', c + 1);
+                if(end == std::string::npos) {
+                    break;
+                }
+                c = end;
+                code += ' ';
+            }
+            else if(ch == '#') {
+                break;
+            }
+            else {
+                if(ch == '{') {
+                    ++depth;
+                }
+                else if(ch == '}') {
+                    --depth;
+                }
+                code += ch;
+            }
+        }
+
+        if(std::regex_search(code, sourceCall)) {
+            pending = true;
+        }
+
+        const bool continued = endsWithContinuation(code)
+                || (i + 1 < lines.size() && startsWithContinuation(lines.at(i + 1)));
+        if(pending && depth == 0 && !inTripleQuote && !continued) {
+            split = i + 1;
+            pending = false;
+        }
+    }
+
+    ScriptParts parts;
+    for(std::size_t i = 0; i < lines.size(); ++i) {
+        std::string& part = i < split ? parts.header : parts.chain;
+        part.append(lines.at(i)).append("\n");
+    }
+
+    return parts;
+}
+
+} // namespace
+
 vfg::avisynth::VideoFrame::VideoFrame(std::unique_ptr<AVS_VideoFrame, Deleter> frame) :
     videoFrame(std::move(frame)) {
 }
@@ -60,25 +245,86 @@ void vfg::avisynth::AvisynthWrapper::load(const std::string& path) {
         res = avsHandle.func.avs_invoke(avsHandle.env, "Import", arg.get(), nullptr);
     }
 
-    if(avs_is_error(res.get())) {
-        throw AvisynthError(avs_as_string(res.get()));
+    // The script may have replaced the variables of the reloaded sources
+    loadedHeader.clear();
+    loadedScript.clear();
+
+    setClip(res.get());
+    openFilePath = path;
+}
+
+void vfg::avisynth::AvisynthWrapper::reload(const std::string& path) {
+    const std::string script = readScript(path);
+    if(hasVideo() && path == openFilePath && script == loadedScript) {
+        return;
     }
 
-    if(!avs_is_clip(res.get())) {
-        throw AvisynthError("Imported script did not return a video clip");
+    const ScriptParts parts = splitScript(script);
+    if(parts.header.empty()) {
+        load(path);
+        return;
     }
 
-    avsHandle.clip = avsHandle.func.avs_take_clip(res.get(), avsHandle.env);
-    info = avsHandle.func.avs_get_video_info(avsHandle.clip);
-    if(!avs_has_video(info.get())) {
-        avsHandle.func.avs_release_clip(avsHandle.clip);
-        info.reset();
-        throw AvisynthError("Imported script does not have video data");
+    // Relative paths are resolved like Import does
+    const WorkingDirectory workingDir(directoryOf(path));
+
+    if(parts.header != loadedHeader) {
+        loadedHeader.clear();
+        loadedScript.clear();
+
+        RaiiDeleter<AVS_Value, decltype(avsHandle.func.avs_release_value)> res(
+                    evaluate(parts.header + headerSuffix), avsHandle.func.avs_release_value);
+        loadedHeader = parts.header;
     }
 
+    RaiiDeleter<AVS_Value, decltype(avsHandle.func.avs_release_value)> res(
+                evaluate(chainPrefix + (isBlank(parts.chain) ? std::string("last\n") : parts.chain)),
+                avsHandle.func.avs_release_value);
+    setClip(res.get());
+
+    loadedScript = script;
     openFilePath = path;
 }
 
+AVS_Value vfg::avisynth::AvisynthWrapper::evaluate(const std::string& script) {
+    RaiiDeleter<AVS_Value, decltype(avsHandle.func.avs_release_value)> arg(
+                avs_void, avsHandle.func.avs_release_value);
+    arg = avs_new_value_string(script.c_str());
+
+    const AVS_Value res = avsHandle.func.avs_invoke(avsHandle.env, "Eval", arg.get(), nullptr);
+    if(avs_is_error(res)) {
+        const std::string error = avs_as_string(res);
+        avsHandle.func.avs_release_value(res);
+        throw AvisynthError(error);
+    }
+
+    return res;
+}
+
+void vfg::avisynth::AvisynthWrapper::setClip(const AVS_Value& result) {
+    if(avs_is_error(result)) {
+        throw AvisynthError(avs_as_string(result));
+    }
+
+    if(!avs_is_clip(result)) {
+        throw AvisynthError("Script did not return a video clip");
+    }
+
+    AVS_Clip *const clip = avsHandle.func.avs_take_clip(result, avsHandle.env);
+    const AVS_VideoInfo *const clipInfo = avsHandle.func.avs_get_video_info(clip);
+    if(!avs_has_video(clipInfo)) {
+        avsHandle.func.avs_release_clip(clip);
+        throw AvisynthError("Script does not have video data");
+    }
+
+    if(hasVideo()) {
+        avsHandle.func.avs_release_clip(avsHandle.clip);
+    }
+
+    avsHandle.clip = clip;
+    info = clipInfo;
+}
+
 vfg::avisynth::VideoFrame
 vfg::avisynth::AvisynthWrapper::getFrame(const int frameNum) const {
     if(!hasVideo()) {
@@ -85,6 +85,30 @@ private:
     vfg::observer_ptr<const AVS_VideoInfo> info {};
     std::string openFilePath {};
 
+    //! Source section of the script last evaluated by reload
+    std::string loadedHeader {};
+
+    //! Contents of the script last loaded by reload
+    std::string loadedScript {};
+
+    /**
+     * @brief Evaluate script text in the script environment
+     * @param script Script text
+     * @throws AvisynthError If evaluation fails
+     * @return Result, must be released
+     */
+    AVS_Value evaluate(const std::string& script);
+
+    /**
+     * @brief Replace the current clip with the clip of a script result
+     *
+     * The current clip is kept if the result is not a valid clip
+     *
+     * @param result Script result
+     * @throws AvisynthError If result is an error or not a clip with video
+     */
+    void setClip(const AVS_Value& result);
+
 public:
     /**
      * @brief Constructor
@@ -103,6 +127,24 @@ public:
      */
     void load(const std::string& path);
 
+    /**
+     * @brief Reload script from path, reusing the loaded sources
+     *
+     * The script is split after the last line that loads a plugin or
+     * opens a source. If that section is unchanged since the previous
+     * reload, only the rest of the script (the filter chain) is
+     * evaluated, so plugins are not reloaded and sources are not reopened.
+     * If the script is unchanged the current clip is kept as is.
+     *
+     * Scripts without such a section are imported with \link load \endlink
+     *
+     * @param path Path to file to load
+     * @throws AvisynthError If the file can't be read
+     * @throws AvisynthError If error occurs during evaluation
+     * @throws AvisynthError If the script doesn't return clip with video data
+     */
+    void reload(const std::string& path);
+
     /**
      * @brief Get frame from video
      * @pre 0 <= frameNum < numFrames()
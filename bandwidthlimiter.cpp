@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include "bandwidthlimiter.hpp"
+
+namespace {
+
+//! Interval between refills while readers are waiting, in milliseconds
+constexpr int RefillInterval = 20;
+
+//! Smallest number of tokens worth waking readers for
+constexpr qint64 MinGrant = 16 * 1024;
+
+//! Fraction of a second that may be read at once
+constexpr qint64 BurstDivisor = 5;
+
+} // namespace
+
+namespace vfg {
+namespace net {
+
+BandwidthLimiter::BandwidthLimiter(QObject *parent) :
+    QObject(parent)
+{
+    refillTimer.setInterval(RefillInterval);
+
+    connect(&refillTimer,   &QTimer::timeout,
+            this,           &BandwidthLimiter::tick);
+
+    clock.start();
+}
+
+void BandwidthLimiter::setRate(const qint64 rate)
+{
+    bytesPerSecond = std::max<qint64>(0, rate);
+    burst = std::max(MinGrant, bytesPerSecond / BurstDivisor);
+    tokens = std::min<double>(tokens, burst);
+    clock.restart();
+
+    // Readers waiting for a lower limit can continue right away
+    if(bytesPerSecond == 0 && refillTimer.isActive()) {
+        refillTimer.stop();
+        emit available();
+    }
+}
+
+qint64 BandwidthLimiter::rate() const
+{
+    return bytesPerSecond;
+}
+
+bool BandwidthLimiter::isLimited() const
+{
+    return bytesPerSecond > 0;
+}
+
+void BandwidthLimiter::refill()
+{
+    const qint64 elapsed = clock.restart();
+    tokens = std::min<double>(burst, tokens + bytesPerSecond * elapsed / 1000.0);
+}
+
+qint64 BandwidthLimiter::acquire(const qint64 wanted)
+{
+    if(bytesPerSecond == 0 || wanted <= 0) {
+        return std::max<qint64>(0, wanted);
+    }
+
+    refill();
+
+    // A quarter of the burst at a time so that other readers get a share
+    const qint64 quantum = std::max(MinGrant, burst / 4);
+    const qint64 granted = std::min({wanted, quantum, static_cast<qint64>(std::max(0.0, std::floor(tokens)))});
+    tokens -= granted;
+
+    if(granted < wanted && !refillTimer.isActive()) {
+        refillTimer.start();
+    }
+
+    return granted;
+}
+
+void BandwidthLimiter::consume(const qint64 bytes)
+{
+    if(bytesPerSecond == 0) {
+        return;
+    }
+
+    refill();
+    tokens -= bytes;
+}
+
+void BandwidthLimiter::tick()
+{
+    refill();
+
+    if(tokens >= std::min(MinGrant, burst)) {
+        refillTimer.stop();
+        emit available();
+    }
+}
+
+} // namespace net
+} // namespace vfg
@@ -0,0 +1,110 @@
+#ifndef VFG_NET_BANDWIDTHLIMITER_HPP
+#define VFG_NET_BANDWIDTHLIMITER_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+namespace vfg {
+namespace net {
+
+/**
+ * @brief The BandwidthLimiter class
+ *
+ * Token bucket shared by downloads to cap their combined rate. Tokens
+ * (bytes) are added at the configured rate up to a small burst, and
+ * readers take tokens before reading data from their replies.
+ *
+ * A reader that gets fewer bytes than it asked for leaves the rest in
+ * the reply and reads again when \link available \endlink is emitted.
+ * A limited reply read buffer then stops the connection from receiving
+ * more data than the reader is allowed to consume.
+ */
+class BandwidthLimiter : public QObject
+{
+    Q_OBJECT
+
+private:
+    //! Bytes added per second, 0 for unlimited
+    qint64 bytesPerSecond {0};
+
+    //! Maximum number of tokens
+    qint64 burst {0};
+
+    //! Available tokens, negative when readers were allowed to overdraw
+    double tokens {0.0};
+
+    //! Time of the last refill
+    QElapsedTimer clock {};
+
+    //! Refills tokens while readers are waiting
+    QTimer refillTimer {};
+
+    /**
+     * @brief Add tokens for the time passed since the last refill
+     */
+    void refill();
+
+private slots:
+    /**
+     * @brief Refill tokens and wake waiting readers once enough are available
+     */
+    void tick();
+
+public:
+    /**
+     * @brief Constructor
+     * @param parent Owner of the object
+     */
+    explicit BandwidthLimiter(QObject *parent = 0);
+
+    /**
+     * @brief Set rate limit
+     * @param rate Bytes per second, 0 for unlimited
+     */
+    void setRate(qint64 rate);
+
+    /**
+     * @brief Get rate limit
+     * @return Bytes per second, 0 if unlimited
+     */
+    qint64 rate() const;
+
+    /**
+     * @brief Check if the rate is limited
+     * @return True if limited, otherwise false
+     */
+    bool isLimited() const;
+
+    /**
+     * @brief Take tokens for reading data
+     *
+     * \link available \endlink is emitted later if fewer bytes
+     * than requested were granted
+     *
+     * @param wanted Bytes the reader wants to read
+     * @return Bytes the reader may read now
+     */
+    qint64 acquire(qint64 wanted);
+
+    /**
+     * @brief Take tokens for data that must be read regardless of the limit
+     *
+     * Used for data of finished replies. The bucket may go negative,
+     * which delays other readers until the debt has been paid off.
+     *
+     * @param bytes Bytes read
+     */
+    void consume(qint64 bytes);
+
+signals:
+    /**
+     * @brief Emitted when tokens are available for readers that had to wait
+     */
+    void available();
+};
+
+} // namespace net
+} // namespace vfg
+
+#endif // VFG_NET_BANDWIDTHLIMITER_HPP
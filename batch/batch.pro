@@ -0,0 +1,61 @@
+#-------------------------------------------------
+#
+# Headless batch mode for unattended screenshot generation
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+QT       -= widgets
+
+TARGET = screenpicker-batch
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp \
+    batchjob.cpp \
+    ..\abstractvideosource.cpp \
+    ..\syntheticvideosource.cpp \
+    ..\y4mvideosource.cpp \
+    ..\videosourceinstrumentation.cpp \
+    ..\videoframegrabber.cpp \
+    ..\videoframegenerator.cpp \
+    ..\framefilter.cpp \
+    ..\framequalityfilter.cpp \
+    ..\gridcomposer.cpp \
+    ..\framespillstore.cpp \
+    ..\scriptparser.cpp \
+    ..\libs\templet\templet.cpp ..\libs\templet\nodes.cpp ..\libs\templet\types.cpp
+
+HEADERS  += batchjob.hpp \
+    ..\abstractvideosource.h \
+    ..\syntheticvideosource.h \
+    ..\y4mvideosource.h \
+    ..\videosourceinstrumentation.h \
+    ..\videoframegrabber.h \
+    ..\videoframegenerator.h \
+    ..\framefilter.h \
+    ..\framequalityfilter.h \
+    ..\gridcomposer.h \
+    ..\framespillstore.h \
+    ..\scriptparser.h
+
+INCLUDEPATH += .. \
+    ..\libs\templet
+
+win32 {
+    SOURCES += ..\avisynthvideosource.cpp \
+        ..\avisynthwrapper.cpp \
+        ..\keyframeindex.cpp
+
+    HEADERS += ..\avisynthvideosource.h \
+        ..\avisynthwrapper.hpp \
+        ..\keyframeindex.h
+
+    INCLUDEPATH += ..\libs\avs2yuv\src
+
+    # Required for avisynth to compile without using wide characters
+    DEFINES -= UNICODE
+}
+
+QMAKE_CXXFLAGS += -std=c++1y -Wall -Wextra -O2
@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <exception>
+#include <random>
+#include <stdexcept>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+#include "abstractvideosource.h"
+#include "framequalityfilter.h"
+#include "framespillstore.h"
+#include "gridcomposer.h"
+#include "scriptparser.h"
+#include "syntheticvideosource.h"
+#include "videoframegenerator.h"
+#include "videoframegrabber.h"
+#include "y4mvideosource.h"
+#include "batchjob.hpp"
+
+#ifdef Q_OS_WIN
+#include "avisynthvideosource.h"
+#endif
+
+Q_LOGGING_CATEGORY(BATCH, "batch")
+
+namespace vfg {
+namespace batch {
+
+double JobResult::framesPerSecond() const
+{
+    if(generateTime == 0) {
+        return 0.0;
+    }
+
+    return generated * 1000.0 / generateTime;
+}
+
+QJsonObject JobResult::toJson() const
+{
+    QJsonObject timings;
+    timings.insert("load_ms", loadTime);
+    timings.insert("generate_ms", generateTime);
+    timings.insert("grid_ms", gridTime);
+    timings.insert("gif_ms", gifTime);
+    timings.insert("total_ms", totalTime);
+
+    QJsonObject obj;
+    obj.insert("source", source);
+    obj.insert("ok", error.isEmpty());
+    if(!error.isEmpty()) {
+        obj.insert("error", error);
+    }
+    obj.insert("resolution", QString("%1x%2").arg(resolution.width()).arg(resolution.height()));
+    obj.insert("frames", numFrames);
+    obj.insert("sampled", sampled);
+    obj.insert("generated", generated);
+    obj.insert("skipped", skipped);
+    obj.insert("fps", framesPerSecond());
+    obj.insert("timings", timings);
+    obj.insert("outputs", QJsonArray::fromStringList(outputs));
+    return obj;
+}
+
+BatchJob::BatchJob(const Options& options) :
+    opts(options)
+{
+}
+
+std::shared_ptr<vfg::core::AbstractVideoSource> BatchJob::load(const QString& source,
+                                                               const QString& baseName)
+{
+    if(source == "synthetic") {
+        auto videoSource = std::make_shared<vfg::core::SyntheticVideoSource>(
+                    opts.resolution, opts.syntheticFrames);
+        videoSource->load(source);
+        return videoSource;
+    }
+    else if(source.endsWith(".y4m", Qt::CaseInsensitive)
+            || source.endsWith(".yuv", Qt::CaseInsensitive)) {
+        auto videoSource = std::make_shared<vfg::core::Y4mVideoSource>();
+        videoSource->setRawFormat(opts.resolution, vfg::core::Y4mVideoSource::Chroma::C420);
+        videoSource->load(source);
+        return videoSource;
+    }
+
+#ifdef Q_OS_WIN
+    auto videoSource = std::make_shared<vfg::core::AvisynthVideoSource>();
+
+    // Render the script next to the outputs, as the script editor does
+    vfg::ScriptParser parser = videoSource->getParser(QFileInfo(source));
+    if(!opts.scriptTemplate.isEmpty()) {
+        parser.setTemplate(opts.scriptTemplate);
+    }
+
+    const QString scriptPath = outputPath(baseName, ".avs");
+    QFile script(scriptPath);
+    if(!script.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        throw std::runtime_error("Unable to write script " + scriptPath.toStdString());
+    }
+
+    QTextStream(&script) << parser.parse(opts.videoSettings);
+    script.close();
+
+    videoSource->load(scriptPath);
+    return videoSource;
+#else
+    Q_UNUSED(baseName);
+
+    throw std::runtime_error("Avisynth scripts are only supported on Windows");
+#endif
+}
+
+QList<int> BatchJob::sample(const int numFrames) const
+{
+    const int first = std::max(0, opts.startFrame);
+    const int last = opts.endFrame < 0 ? numFrames - 1 : std::min(opts.endFrame, numFrames - 1);
+    if(first > last) {
+        return {};
+    }
+
+    const int range = last - first + 1;
+    QList<int> frames;
+    if(opts.sampling == Sampling::Interval) {
+        for(int frameNum = first; frameNum <= last; frameNum += std::max(1, opts.interval)) {
+            frames.append(frameNum);
+        }
+    }
+    else if(opts.sampling == Sampling::Count) {
+        // Centered in equally long parts of the range
+        const int count = std::min(opts.count, range);
+        for(int idx = 0; idx < count; ++idx) {
+            frames.append(first + static_cast<int>((2 * idx + 1) * static_cast<qint64>(range)
+                                                   / (2 * count)));
+        }
+    }
+    else {
+        std::mt19937 engine(opts.seed);
+        std::uniform_int_distribution<int> dist(first, last);
+        const int count = std::min(opts.count, range);
+        while(frames.size() < count) {
+            const int frameNum = dist(engine);
+            if(!frames.contains(frameNum)) {
+                frames.append(frameNum);
+            }
+        }
+
+        std::sort(frames.begin(), frames.end());
+    }
+
+    return frames;
+}
+
+QString BatchJob::uniqueBaseName(const QString& source)
+{
+    const QString baseName = QFileInfo(source).completeBaseName();
+
+    // Compared in lower case, as file names are case-insensitive on Windows
+    QString name = baseName;
+    for(int num = 2; usedBaseNames.contains(name.toLower()); ++num) {
+        name = QString("%1-%2").arg(baseName).arg(num);
+    }
+
+    usedBaseNames.insert(name.toLower());
+    return name;
+}
+
+QString BatchJob::outputPath(const QString& baseName, const QString& suffix) const
+{
+    return QDir(opts.outputDirectory).absoluteFilePath(baseName + suffix);
+}
+
+JobResult BatchJob::run(const QString& source)
+{
+    JobResult result;
+    result.source = source;
+
+    QElapsedTimer total;
+    total.start();
+
+    const QString baseName = uniqueBaseName(source);
+
+    try {
+        qCDebug(BATCH) << "Processing" << source;
+
+        if(!QDir().mkpath(opts.outputDirectory)) {
+            throw std::runtime_error("Unable to create output directory");
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        auto videoSource = load(source, baseName);
+        auto frameGrabber = std::make_shared<vfg::core::VideoFrameGrabber>(videoSource);
+        result.loadTime = timer.elapsed();
+        result.resolution = frameGrabber->resolution();
+        result.numFrames = frameGrabber->totalFrames();
+
+        const QList<int> frames = sample(result.numFrames);
+        result.sampled = frames.size();
+
+        vfg::core::VideoFrameGenerator frameGenerator(frameGrabber);
+        if(opts.qualityFilter) {
+            vfg::core::FrameQualityFilter::Settings settings;
+            settings.searchWindow = opts.searchWindow;
+            frameGenerator.setQualityFilter(
+                        std::make_shared<vfg::core::FrameQualityFilter>(settings));
+        }
+
+        // The grid is composed from the spill store, so it needs no decoding
+        std::shared_ptr<vfg::core::FrameSpillStore> spillStore;
+        if(opts.gridColumns > 0) {
+            spillStore = std::make_shared<vfg::core::FrameSpillStore>(
+                        outputPath(baseName, ".spill"));
+            frameGenerator.setSpillStore(spillStore);
+        }
+
+        // ImageMagick reads the frames from disk, so they're saved
+        // to a temporary directory if they're not exported
+        const bool createGif = !opts.imageMagickPath.isEmpty();
+        QTemporaryDir gifDir;
+        QStringList gifFrames;
+        QList<int> generatedFrames;
+        QObject::connect(&frameGenerator, &vfg::core::VideoFrameGenerator::frameReady,
+                         [&](const int frameNum, const QImage& frame) {
+            generatedFrames.append(frameNum);
+
+            const QString suffix = QString("-%1").arg(frameNum, 6, 10, QChar('0'));
+            if(!opts.frameFormat.isEmpty()) {
+                const QString path = outputPath(baseName, suffix + "." + opts.frameFormat);
+                if(frame.save(path)) {
+                    result.outputs.append(path);
+                    gifFrames.append(path);
+                }
+                else {
+                    qCWarning(BATCH) << "Unable to save frame" << path;
+                }
+            }
+            else if(createGif) {
+                const QString path = QDir(gifDir.path()).absoluteFilePath(suffix + ".png");
+                if(frame.save(path, "PNG", 100)) {
+                    gifFrames.append(path);
+                }
+            }
+        });
+        QObject::connect(&frameGenerator, &vfg::core::VideoFrameGenerator::frameSkipped,
+                         [&result](int) {
+            ++result.skipped;
+        });
+
+        // The generator runs to completion in this thread
+        timer.restart();
+        frameGenerator.enqueue(frames);
+        frameGenerator.start();
+        result.generateTime = timer.elapsed();
+        result.generated = generatedFrames.size();
+
+        if(spillStore && !generatedFrames.empty()) {
+            timer.restart();
+
+            QVector<QVector<int>> rows;
+            for(int idx = 0; idx < generatedFrames.size(); idx += opts.gridColumns) {
+                rows.append(generatedFrames.mid(idx, opts.gridColumns).toVector());
+            }
+
+            vfg::core::GridComposer composer([&spillStore](const int frameNum) {
+                return spillStore->frame(frameNum);
+            }, result.resolution);
+            composer.setRows(rows);
+            composer.setWidth(opts.gridWidth > 0
+                              ? opts.gridWidth
+                              : opts.gridColumns * result.resolution.width());
+            composer.setSpacing(opts.gridSpacing);
+            composer.setSpacingColor(Qt::black);
+
+            const QString path = outputPath(baseName, "-grid.png");
+            if(!composer.compose().save(path, "PNG")) {
+                throw std::runtime_error("Unable to save grid " + path.toStdString());
+            }
+
+            result.outputs.append(path);
+            result.gridTime = timer.elapsed();
+        }
+
+        if(createGif && !gifFrames.empty()) {
+            timer.restart();
+
+            const QString path = outputPath(baseName, ".gif");
+            QStringList args;
+            args << opts.gifArgs.split(' ', QString::SkipEmptyParts) << gifFrames << path;
+
+            QProcess imageMagick;
+            imageMagick.start(opts.imageMagickPath, args);
+            if(!imageMagick.waitForFinished(1000 * opts.imageMagickTimeout)
+                    || imageMagick.exitStatus() != QProcess::NormalExit
+                    || imageMagick.exitCode() != 0) {
+                throw std::runtime_error("ImageMagick failed: "
+                                         + imageMagick.errorString().toStdString());
+            }
+
+            result.outputs.append(path);
+            result.gifTime = timer.elapsed();
+        }
+    }
+    catch(const std::exception& ex) {
+        qCCritical(BATCH) << "Processing" << source << "failed:" << ex.what();
+        result.error = QString(ex.what());
+    }
+
+    result.totalTime = total.elapsed();
+
+    return result;
+}
+
+} // namespace batch
+} // namespace vfg
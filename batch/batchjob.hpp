@@ -0,0 +1,236 @@
+#ifndef VFG_BATCH_BATCHJOB_HPP
+#define VFG_BATCH_BATCHJOB_HPP
+
+#include <memory>
+#include <QList>
+#include <QMap>
+#include <QRect>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include "framequalityfilter.h"
+
+class QJsonObject;
+
+namespace vfg {
+namespace core {
+    class AbstractVideoSource;
+    class VideoFrameGrabber;
+}
+}
+
+namespace vfg {
+namespace batch {
+
+/**
+ * @brief Outcome of processing a single source
+ */
+struct JobResult
+{
+    //! Source name
+    QString source {};
+
+    //! Error message, empty on success
+    QString error {};
+
+    //! Resolution of the loaded video
+    QSize resolution {};
+
+    //! Number of frames in the loaded video
+    int numFrames {0};
+
+    //! Number of frames sampled
+    int sampled {0};
+
+    //! Number of frames generated
+    int generated {0};
+
+    //! Number of frames rejected by the quality filter
+    int skipped {0};
+
+    //! Time spent loading the source in milliseconds
+    qint64 loadTime {0};
+
+    //! Time spent generating and saving frames in milliseconds
+    qint64 generateTime {0};
+
+    //! Time spent composing and saving the grid in milliseconds
+    qint64 gridTime {0};
+
+    //! Time spent creating the GIF in milliseconds
+    qint64 gifTime {0};
+
+    //! Total time in milliseconds
+    qint64 totalTime {0};
+
+    //! Written files
+    QStringList outputs {};
+
+    /**
+     * @brief Get generated frames per second
+     * @return Frames per second, 0 if nothing was generated
+     */
+    double framesPerSecond() const;
+
+    /**
+     * @brief Convert to a JSON object
+     * @return JSON object
+     */
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief The BatchJob class
+ *
+ * Loads a source, samples frames from it with the frame generator and
+ * exports the frames, a grid of the frames and a GIF without creating
+ * any widgets. Runs to completion in the calling thread.
+ */
+class BatchJob
+{
+public:
+    /**
+     * @brief How frames are picked from the video
+     */
+    enum class Sampling {
+        Interval,   //!< Every interval frames
+        Count,      //!< count frames spread evenly
+        Random      //!< count random frames in ascending order
+    };
+
+    /**
+     * @brief Job options
+     */
+    struct Options
+    {
+        //! Directory the outputs are written to
+        QString outputDirectory {"."};
+
+        //! Script template, empty to pick one by file type
+        QString scriptTemplate {};
+
+        //! Video settings passed to the script template
+        QMap<QString, QVariant> videoSettings {};
+
+        //! Resolution of the synthetic video and headerless YUV files
+        QSize resolution {1920, 1080};
+
+        //! Number of frames in the synthetic video
+        int syntheticFrames {100000};
+
+        //! How frames are picked
+        Sampling sampling {Sampling::Count};
+
+        //! Frame step for interval sampling
+        int interval {1000};
+
+        //! Number of frames for count and random sampling
+        int count {20};
+
+        //! Seed for random sampling
+        unsigned seed {1};
+
+        //! First frame to sample
+        int startFrame {0};
+
+        //! Last frame to sample, -1 for the last frame of the video
+        int endFrame {-1};
+
+        //! Reject blurry and blank frames
+        bool qualityFilter {false};
+
+        //! Frames searched on each side of a rejected frame for a replacement
+        int searchWindow {vfg::core::FrameQualityFilter::Settings().searchWindow};
+
+        //! Image format of the frames, empty to not save frames
+        QString frameFormat {"png"};
+
+        //! Number of columns in the grid, 0 to not create a grid
+        int gridColumns {0};
+
+        //! Width of the grid, 0 for the width of the columns
+        int gridWidth {0};
+
+        //! Spacing around the frames in the grid
+        int gridSpacing {10};
+
+        //! Path to ImageMagick, empty to not create a GIF
+        QString imageMagickPath {};
+
+        //! ImageMagick arguments for creating the GIF
+        QString gifArgs {"-delay 50 -loop 0"};
+
+        //! Maximum time ImageMagick may take in seconds
+        int imageMagickTimeout {90};
+    };
+
+    /**
+     * @brief Constructor
+     * @param options Job options
+     */
+    explicit BatchJob(const Options& options);
+
+    /**
+     * @brief Process a source
+     *
+     * Errors are reported in the result instead of thrown, so that
+     * one broken source doesn't stop the batch. Outputs are named after
+     * the source, with a number added if an earlier source of this job
+     * had the same name.
+     *
+     * @param source Source name ("synthetic" or path to a video or script)
+     * @return Outcome
+     */
+    JobResult run(const QString& source);
+
+private:
+    Options opts;
+
+    //! Base names of the outputs of processed sources in lower case
+    QSet<QString> usedBaseNames {};
+
+    /**
+     * @brief Get base name of the outputs of a source
+     *
+     * Sources with the same file name in different directories would
+     * otherwise overwrite each other's outputs
+     *
+     * @param source Source name
+     * @return Base name not used by an earlier source
+     */
+    QString uniqueBaseName(const QString& source);
+
+    /**
+     * @brief Create and load video source
+     * @param source Source name
+     * @param baseName Base name of the outputs
+     * @exception std::runtime_error If the source is not supported on this platform
+     * @exception vfg::core::VideoSourceError If the source can't be loaded
+     * @exception vfg::ScriptParserError If the script template is invalid
+     * @return Loaded video source
+     */
+    std::shared_ptr<vfg::core::AbstractVideoSource> load(const QString& source,
+                                                         const QString& baseName);
+
+    /**
+     * @brief Pick frames from the video
+     * @param numFrames Number of frames in the video
+     * @return Frame numbers in ascending order
+     */
+    QList<int> sample(int numFrames) const;
+
+    /**
+     * @brief Get path of an output file
+     * @param baseName Base name of the outputs
+     * @param suffix Suffix added to the base name
+     * @return Path in the output directory
+     */
+    QString outputPath(const QString& baseName, const QString& suffix) const;
+};
+
+} // namespace batch
+} // namespace vfg
+
+#endif // VFG_BATCH_BATCHJOB_HPP
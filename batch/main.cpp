@@ -0,0 +1,224 @@
+#include <exception>
+#include <stdexcept>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include "batchjob.hpp"
+
+namespace {
+
+/**
+ * @brief Parse resolution from a string such as 1920x1080
+ * @param str String to parse
+ * @return Parsed resolution, invalid size on error
+ */
+QSize parseResolution(const QString& str)
+{
+    const QStringList parts = str.split('x');
+    if(parts.size() != 2) {
+        return {};
+    }
+
+    return QSize(parts.at(0).toInt(), parts.at(1).toInt());
+}
+
+/**
+ * @brief Parse crop from a string such as 8,0,8,0
+ *
+ * The crop is stored like the video settings store it: left and top
+ * as position, right and bottom as size
+ *
+ * @param str Left, top, right and bottom separated by commas
+ * @return Parsed crop, null rect on error
+ */
+QRect parseCrop(const QString& str)
+{
+    const QStringList parts = str.split(',');
+    if(parts.size() != 4) {
+        return {};
+    }
+
+    return QRect(parts.at(0).toInt(), parts.at(1).toInt(),
+                 parts.at(2).toInt(), parts.at(3).toInt());
+}
+
+/**
+ * @brief Read sources from a file, one per line
+ * @param path Path to the file
+ * @exception std::runtime_error If the file can't be read
+ * @return Sources
+ */
+QStringList readSourceList(const QString& path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        throw std::runtime_error("Unable to open source list " + path.toStdString());
+    }
+
+    QStringList sources;
+    QTextStream in(&file);
+    while(!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if(!line.isEmpty() && !line.startsWith('#')) {
+            sources.append(line);
+        }
+    }
+
+    return sources;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) try
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("screenpicker-batch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates screenshots, grids and GIFs from videos "
+                                     "without a user interface");
+    parser.addHelpOption();
+    parser.addPositionalArgument("sources", "Sources: \"synthetic\", paths to .y4m or "
+                                 "4:2:0 .yuv files, or paths to videos or Avisynth scripts "
+                                 "(Windows only).", "[sources...]");
+    parser.addOptions({
+        {"list", "Read sources from a file, one per line.", "path"},
+        {"output-dir", "Directory the outputs are written to.", "path", "."},
+        {"template", "Script template, picked by file type by default.", "path"},
+        {"resize", "Resize the video in the script.", "WxH"},
+        {"resize-kernel", "Resize kernel in the script.", "kernel", "Spline36"},
+        {"crop", "Crop the video in the script.", "left,top,right,bottom"},
+        {"deinterlace", "Deinterlace the video in the script."},
+        {"ivtc", "Inverse telecine the video in the script."},
+        {"plugins", "Avisynth plugins directory.", "path"},
+        {"resolution", "Resolution of the synthetic video and .yuv files.", "WxH", "1920x1080"},
+        {"frames", "Number of frames in the synthetic video.", "count", "100000"},
+        {"sampling", "How frames are picked: interval, count or random.", "strategy", "count"},
+        {"interval", "Frame step for interval sampling.", "frames", "1000"},
+        {"count", "Number of frames for count and random sampling.", "count", "20"},
+        {"seed", "Seed for random sampling.", "seed", "1"},
+        {"start", "First frame to sample.", "frame", "0"},
+        {"end", "Last frame to sample (-1 = last frame).", "frame", "-1"},
+        {"quality-filter", "Reject blurry and blank frames."},
+        {"search-window", "Frames searched on each side of a rejected frame for a replacement.",
+            "frames", QString::number(vfg::batch::BatchJob::Options().searchWindow)},
+        {"frame-format", "Image format of the frames (none = don't save frames).",
+            "format", "png"},
+        {"grid", "Create a grid with this many columns (0 = no grid).", "columns", "0"},
+        {"grid-width", "Width of the grid (0 = width of the columns).", "pixels", "0"},
+        {"grid-spacing", "Spacing around the frames in the grid.", "pixels", "10"},
+        {"imagemagick", "Create a GIF with ImageMagick.", "path"},
+        {"gif-args", "ImageMagick arguments for the GIF.", "args", "-delay 50 -loop 0"},
+        {"imagemagick-timeout", "Maximum time ImageMagick may take.", "seconds", "90"},
+        {"output", "Write the summary to file instead of standard output.", "path"}
+    });
+    parser.process(a);
+
+    QStringList sources = parser.positionalArguments();
+    if(parser.isSet("list")) {
+        sources.append(readSourceList(parser.value("list")));
+    }
+
+    if(sources.empty()) {
+        throw std::runtime_error("No sources given");
+    }
+
+    vfg::batch::BatchJob::Options options;
+    options.outputDirectory = parser.value("output-dir");
+    options.scriptTemplate = parser.value("template");
+    options.videoSettings.insert("resize", parseResolution(parser.value("resize")));
+    options.videoSettings.insert("resizekernel", parser.value("resize-kernel"));
+    options.videoSettings.insert("crop", parseCrop(parser.value("crop")));
+    options.videoSettings.insert("deinterlace", parser.isSet("deinterlace"));
+    options.videoSettings.insert("ivtc", parser.isSet("ivtc"));
+    options.videoSettings.insert("avisynthpluginspath", parser.value("plugins"));
+    options.resolution = parseResolution(parser.value("resolution"));
+    options.syntheticFrames = parser.value("frames").toInt();
+
+    const QString sampling = parser.value("sampling");
+    if(sampling == "interval") {
+        options.sampling = vfg::batch::BatchJob::Sampling::Interval;
+    }
+    else if(sampling == "count") {
+        options.sampling = vfg::batch::BatchJob::Sampling::Count;
+    }
+    else if(sampling == "random") {
+        options.sampling = vfg::batch::BatchJob::Sampling::Random;
+    }
+    else {
+        throw std::invalid_argument("Unknown sampling strategy: " + sampling.toStdString());
+    }
+
+    options.interval = parser.value("interval").toInt();
+    options.count = parser.value("count").toInt();
+    options.seed = parser.value("seed").toUInt();
+    options.startFrame = parser.value("start").toInt();
+    options.endFrame = parser.value("end").toInt();
+    options.qualityFilter = parser.isSet("quality-filter");
+    options.searchWindow = parser.value("search-window").toInt();
+    const QString frameFormat = parser.value("frame-format");
+    options.frameFormat = frameFormat == "none" ? QString() : frameFormat;
+    options.gridColumns = parser.value("grid").toInt();
+    options.gridWidth = parser.value("grid-width").toInt();
+    options.gridSpacing = parser.value("grid-spacing").toInt();
+    options.imageMagickPath = parser.value("imagemagick");
+    options.gifArgs = parser.value("gif-args");
+    options.imageMagickTimeout = parser.value("imagemagick-timeout").toInt();
+
+    vfg::batch::BatchJob job(options);
+
+    QElapsedTimer total;
+    total.start();
+
+    QJsonArray results;
+    int failed = 0;
+    int generated = 0;
+    for(const QString& source : sources) {
+        const vfg::batch::JobResult result = job.run(source);
+        if(!result.error.isEmpty()) {
+            ++failed;
+        }
+
+        generated += result.generated;
+        results.append(result.toJson());
+    }
+
+    const qint64 elapsed = total.elapsed();
+
+    QJsonObject root;
+    root.insert("sources", sources.size());
+    root.insert("failed", failed);
+    root.insert("generated", generated);
+    root.insert("total_ms", elapsed);
+    root.insert("fps", elapsed > 0 ? generated * 1000.0 / elapsed : 0.0);
+    root.insert("results", results);
+    const QByteArray summary = QJsonDocument(root).toJson();
+
+    if(parser.isSet("output")) {
+        QFile outFile(parser.value("output"));
+        if(!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            throw std::runtime_error("Unable to open output file");
+        }
+
+        outFile.write(summary);
+    }
+    else {
+        QTextStream(stdout) << summary;
+    }
+
+    return failed == 0 ? 0 : 1;
+}
+catch(const std::exception& ex) {
+    QTextStream(stderr) << "Error: " << ex.what() << endl;
+
+    return 1;
+}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <utility>
+#include <QHash>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QSet>
+#include "batchresolver.hpp"
+#include "extractorfactory.hpp"
+#include "extractors/baseextractor.hpp"
+#include "ptrutil.hpp"
+
+namespace vfg {
+namespace extractor {
+
+BatchResolver::BatchResolver(const vfg::extractor::ExtractorFactory& extractorFactory, QObject *parent) :
+    QObject(parent),
+    factory(extractorFactory)
+{
+}
+
+BatchResolver::~BatchResolver()
+{
+    cancel();
+}
+
+QList<QUrl> BatchResolver::parseUrls(const QString& text)
+{
+    static const QRegularExpression separator("\\s+");
+
+    QList<QUrl> urls;
+    QSet<QString> seen;
+    for(const QString& item : text.split(separator, QString::SkipEmptyParts)) {
+        const QUrl url(item, QUrl::StrictMode);
+        const QString scheme = url.scheme();
+        if(!url.isValid() || url.host().isEmpty()
+                || !(scheme == "http" || scheme == "https" || scheme == "ftp")) {
+            continue;
+        }
+
+        const QString key = url.toString();
+        if(!seen.contains(key)) {
+            seen.insert(key);
+            urls.append(url);
+        }
+    }
+
+    return urls;
+}
+
+int BatchResolver::streamHeight(const QString& streamName)
+{
+    static const QRegularExpression heightRx("(\\d{3,4})p\\b");
+    const QRegularExpressionMatch match = heightRx.match(streamName);
+    if(match.hasMatch()) {
+        return match.captured(1).toInt();
+    }
+
+    // Dailymotion names its streams by quality
+    static const QHash<QString, int> named {
+        {"HD1080", 1080}, {"HD", 720}, {"HQ", 480}, {"Standard", 360}, {"LD", 240}
+    };
+    return named.value(streamName);
+}
+
+BatchResolver::Selection BatchResolver::selectStream(const QStringList& streams, const Policy& selection)
+{
+    if(streams.isEmpty()) {
+        return {};
+    }
+
+    QString best;
+    int bestHeight = 0;
+    QString closest;
+    int closestHeight = 0;
+    for(const QString& stream : streams) {
+        const int height = streamHeight(stream);
+        if(height == 0) {
+            continue;
+        }
+
+        if(selection.maxHeight > 0 && height > selection.maxHeight) {
+            // Closest to the limit in case nothing fits
+            if(closest.isEmpty() || height < closestHeight) {
+                closest = stream;
+                closestHeight = height;
+            }
+            continue;
+        }
+
+        const bool better = selection.quality == Quality::Highest ? height > bestHeight
+                                                                  : height < bestHeight;
+        if(best.isEmpty() || better) {
+            best = stream;
+            bestHeight = height;
+        }
+    }
+
+    if(!best.isEmpty()) {
+        return {best, {}};
+    }
+    else if(!closest.isEmpty()) {
+        return {closest, tr("no stream within %1p").arg(selection.maxHeight)};
+    }
+
+    return {streams.first(), tr("stream quality is unknown")};
+}
+
+void BatchResolver::setPolicy(const Policy& selection)
+{
+    policy = selection;
+}
+
+void BatchResolver::setMaxWorkers(const int count)
+{
+    maxWorkers = std::max(1, count);
+    startNext();
+}
+
+void BatchResolver::setTimeout(const int msecs)
+{
+    timeoutMsecs = msecs;
+}
+
+void BatchResolver::resolve(const QList<QUrl>& urls)
+{
+    if(!isRunning()) {
+        total = completed = 0;
+    }
+
+    total += urls.size();
+    waiting.insert(waiting.end(), urls.cbegin(), urls.cend());
+
+    emit progress(completed, total);
+
+    startNext();
+}
+
+void BatchResolver::cancel()
+{
+    waiting.clear();
+
+    for(const auto& job : running) {
+        job->timeout->stop();
+        job->extractor->disconnect(this);
+        job->extractor.release()->deleteLater();
+    }
+    running.clear();
+
+    total = completed = 0;
+}
+
+bool BatchResolver::isRunning() const
+{
+    return !running.empty() || !waiting.empty();
+}
+
+void BatchResolver::startNext()
+{
+    // Extractors may finish while they are started
+    if(starting) {
+        return;
+    }
+
+    starting = true;
+    while(static_cast<int>(running.size()) < maxWorkers && !waiting.empty()) {
+        const QUrl url = waiting.front();
+        waiting.pop_front();
+        startJob(url);
+    }
+    starting = false;
+
+    if(total > 0 && !isRunning()) {
+        total = completed = 0;
+        emit finished();
+    }
+}
+
+void BatchResolver::startJob(const QUrl& url)
+{
+    auto job = vfg::make_unique<Job>();
+    job->url = url;
+    job->extractor = factory.getExtractor(url);
+
+    Job *const j = job.get();
+    vfg::extractor::BaseExtractor *const extractor = j->extractor.get();
+
+    connect(extractor, &vfg::extractor::BaseExtractor::streamsReady, this, [this, j]() {
+        const Selection selected = selectStream(j->extractor->getStreams(), policy);
+        if(selected.stream.isEmpty()) {
+            finishJob(j, tr("No streams found"));
+            return;
+        }
+
+        if(selected.fallback.isEmpty()) {
+            emit logReady(tr("%1: selected %2").arg(j->url.toString()).arg(selected.stream));
+        }
+        else {
+            emit logReady(tr("%1: selected %2, %3").arg(j->url.toString())
+                                                   .arg(selected.stream)
+                                                   .arg(selected.fallback));
+        }
+        j->extractor->download(selected.stream);
+    });
+
+    connect(extractor, &vfg::extractor::BaseExtractor::requestReady,
+            this, [this, j](const QNetworkRequest& request) {
+        emit requestReady(request);
+        finishJob(j, {});
+    });
+
+    connect(extractor, &vfg::extractor::BaseExtractor::logReady,
+            this, &BatchResolver::logReady);
+
+    connect(extractor, &vfg::extractor::BaseExtractor::failed,
+            this, [this, j](const QString& msg) {
+        finishJob(j, msg);
+    });
+
+    j->timeout = vfg::make_unique<QTimer>();
+    j->timeout->setSingleShot(true);
+    connect(j->timeout.get(), &QTimer::timeout, this, [this, j]() {
+        finishJob(j, tr("Timed out"));
+    });
+    j->timeout->start(timeoutMsecs);
+
+    running.push_back(std::move(job));
+
+    extractor->fetchStreams(url);
+}
+
+void BatchResolver::finishJob(Job *job, const QString& error)
+{
+    const auto it = std::find_if(running.begin(), running.end(), [job](const std::unique_ptr<Job>& j) {
+        return j.get() == job;
+    });
+
+    if(it == running.end()) {
+        return;
+    }
+
+    // Called from the signals of the extractor or the timer, so they are deleted later
+    job->timeout->stop();
+    job->timeout->disconnect(this);
+    job->timeout.release()->deleteLater();
+    job->extractor->disconnect(this);
+    job->extractor.release()->deleteLater();
+
+    if(!error.isEmpty()) {
+        emit urlFailed(job->url, error);
+    }
+
+    running.erase(it);
+    ++completed;
+
+    emit progress(completed, total);
+
+    startNext();
+}
+
+} // namespace extractor
+} // namespace vfg
@@ -0,0 +1,250 @@
+#ifndef VFG_EXTRACTOR_BATCHRESOLVER_HPP
+#define VFG_EXTRACTOR_BATCHRESOLVER_HPP
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QUrl>
+
+class QNetworkRequest;
+
+namespace vfg {
+namespace extractor {
+    class BaseExtractor;
+    class ExtractorFactory;
+}
+}
+
+namespace vfg {
+namespace extractor {
+
+/**
+ * @brief The BatchResolver class
+ *
+ * Resolves a list of URLs to download requests with extractors from an
+ * \link ExtractorFactory \endlink. A fixed number of extractors run at
+ * the same time and the rest of the URLs wait. The stream of each URL
+ * is picked by a quality policy.
+ *
+ * A URL fails when its extractor reports a failure or when it isn't
+ * resolved in time, and its worker moves on. Streams chosen although
+ * they don't match the policy are reported in the log.
+ */
+class BatchResolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Quality {
+        Highest,
+        Lowest
+    };
+
+    /**
+     * @brief Stream selection policy
+     */
+    struct Policy
+    {
+        //! Preferred end of the quality range
+        Quality quality {Quality::Highest};
+
+        //! Highest acceptable video height, 0 for no limit
+        int maxHeight {0};
+    };
+
+    /**
+     * @brief Stream chosen by \link selectStream \endlink
+     */
+    struct Selection
+    {
+        //! Stream name, empty if there are no streams
+        QString stream {};
+
+        //! Why the stream doesn't match the policy, empty if it does
+        QString fallback {};
+    };
+
+private:
+    /**
+     * @brief URL being resolved
+     */
+    struct Job
+    {
+        //! URL to resolve
+        QUrl url {};
+
+        //! Extractor for the URL
+        std::unique_ptr<vfg::extractor::BaseExtractor> extractor {};
+
+        //! Fails the job if it takes too long
+        std::unique_ptr<QTimer> timeout {};
+    };
+
+    //! Creates the extractors, must outlive the resolver
+    const vfg::extractor::ExtractorFactory& factory;
+
+    //! URLs waiting for a worker
+    std::deque<QUrl> waiting {};
+
+    //! URLs being resolved
+    std::vector<std::unique_ptr<Job>> running {};
+
+    //! Stream selection policy
+    Policy policy {};
+
+    //! Maximum number of URLs resolved at the same time
+    int maxWorkers {4};
+
+    //! Time limit per URL in milliseconds
+    int timeoutMsecs {30000};
+
+    //! URLs in the current batch
+    int total {0};
+
+    //! Finished URLs in the current batch
+    int completed {0};
+
+    //! Set while jobs are being started
+    bool starting {false};
+
+    /**
+     * @brief Start waiting URLs while workers are available
+     *
+     * Emits \link finished \endlink when the batch is done
+     */
+    void startNext();
+
+    /**
+     * @brief Start resolving a URL
+     * @param url URL to resolve
+     */
+    void startJob(const QUrl& url);
+
+    /**
+     * @brief Remove a job and start the next one
+     * @param job Finished job
+     * @param error Error message, empty on success
+     */
+    void finishJob(Job *job, const QString& error);
+
+public:
+    /**
+     * @brief Constructor
+     * @param extractorFactory Creates the extractors, must outlive the resolver
+     * @param parent Owner of the object
+     */
+    explicit BatchResolver(const vfg::extractor::ExtractorFactory& extractorFactory, QObject *parent = 0);
+
+    /**
+     * Destructor
+     */
+    ~BatchResolver();
+
+    /**
+     * @brief Parse URLs from text, e.g. pasted text or a file
+     *
+     * URLs are separated by whitespace. Duplicates and strings
+     * that are not http, https or ftp URLs are skipped.
+     *
+     * @param text Text to parse
+     * @return URLs in order of appearance
+     */
+    static QList<QUrl> parseUrls(const QString& text);
+
+    /**
+     * @brief Get video height of a stream from its name
+     * @param streamName Stream name, e.g. "MP4 720p (2-3Mbps) / AAC (192Kbps)" or "HD"
+     * @return Height in pixels, 0 if unknown
+     */
+    static int streamHeight(const QString& streamName);
+
+    /**
+     * @brief Select a stream by policy
+     *
+     * Streams above the height limit are only chosen if nothing else is
+     * available. Streams of unknown height rank below all others. Both
+     * cases are reported in \link Selection::fallback \endlink.
+     *
+     * @param streams Stream names
+     * @param selection Selection policy
+     * @return Selected stream
+     */
+    static Selection selectStream(const QStringList& streams, const Policy& selection);
+
+    /**
+     * @brief Set stream selection policy
+     * @param selection Selection policy
+     */
+    void setPolicy(const Policy& selection);
+
+    /**
+     * @brief Set maximum number of URLs resolved at the same time
+     * @param count Number of workers, at least 1
+     */
+    void setMaxWorkers(int count);
+
+    /**
+     * @brief Set time limit per URL
+     * @param msecs Time limit in milliseconds
+     */
+    void setTimeout(int msecs);
+
+    /**
+     * @brief Add URLs to the batch
+     * @param urls URLs to resolve
+     */
+    void resolve(const QList<QUrl>& urls);
+
+    /**
+     * @brief Stop resolving and drop waiting URLs
+     */
+    void cancel();
+
+    /**
+     * @brief Check if URLs are being resolved
+     * @return True if busy, otherwise false
+     */
+    bool isRunning() const;
+
+signals:
+    /**
+     * @brief Emitted when a URL has been resolved
+     * @param request Download request for the selected stream
+     */
+    void requestReady(const QNetworkRequest& request);
+
+    /**
+     * @brief Emitted when a URL could not be resolved
+     * @param url URL
+     * @param error Error message
+     */
+    void urlFailed(const QUrl& url, const QString& error);
+
+    /**
+     * @brief Emitted when a URL has finished
+     * @param finished Finished URLs
+     * @param count URLs in the batch
+     */
+    void progress(int finished, int count);
+
+    /**
+     * @brief Emitted when every URL of the batch has finished
+     */
+    void finished();
+
+    /**
+     * @brief Emitted when an extractor logs a message
+     * @param msg Message
+     */
+    void logReady(const QString& msg);
+};
+
+} // namespace extractor
+} // namespace vfg
+
+#endif // VFG_EXTRACTOR_BATCHRESOLVER_HPP
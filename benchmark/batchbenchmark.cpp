@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <stdexcept>
+#include <QByteArray>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QSet>
+#include <QSize>
+#include <QTemporaryDir>
+#include "batchjob.hpp"
+#include "batchbenchmark.hpp"
+
+Q_DECLARE_LOGGING_CATEGORY(BENCHMARK)
+
+namespace {
+
+//! Resolution of the generated sources
+const QSize SourceSize {64, 36};
+
+} // namespace
+
+namespace vfg {
+namespace benchmark {
+
+BatchBenchmark::BatchBenchmark(const Options& options) :
+    opts(options)
+{
+    opts.sources = std::max(2, opts.sources);
+    opts.frames = std::max(1, opts.frames);
+}
+
+QStringList BatchBenchmark::scenarios()
+{
+    static const QStringList names {
+        "batch-same-name"
+    };
+    return names;
+}
+
+ScenarioResult BatchBenchmark::run(const QString& scenario)
+{
+    if(!scenarios().contains(scenario)) {
+        throw std::invalid_argument("Unknown scenario: " + scenario.toStdString());
+    }
+
+    qCDebug(BENCHMARK) << "Running scenario" << scenario;
+
+    QTemporaryDir dir;
+    if(!dir.isValid()) {
+        throw std::runtime_error("Unable to create temporary directory");
+    }
+
+    // 4:2:0 frames, every source has its own gray level
+    const int frameBytes = SourceSize.width() * SourceSize.height() * 3 / 2;
+    QStringList sources;
+    for(int idx = 0; idx < opts.sources; ++idx) {
+        const QString sourceDir = QDir(dir.path()).absoluteFilePath(QString::number(idx));
+        QFile file(QDir(sourceDir).absoluteFilePath("video.yuv"));
+        if(!QDir().mkpath(sourceDir) || !file.open(QIODevice::WriteOnly)) {
+            throw std::runtime_error("Unable to write source " + file.fileName().toStdString());
+        }
+
+        const QByteArray frame(frameBytes, static_cast<char>(16 + idx * 32));
+        for(int frameNum = 0; frameNum < opts.frames; ++frameNum) {
+            file.write(frame);
+        }
+
+        sources.append(file.fileName());
+    }
+
+    vfg::batch::BatchJob::Options options;
+    options.outputDirectory = QDir(dir.path()).absoluteFilePath("out");
+    options.resolution = SourceSize;
+    options.count = 3;
+    options.gridColumns = 3;
+
+    vfg::batch::BatchJob job(options);
+
+    ScenarioResult result;
+    result.name = scenario;
+
+    QSet<QString> outputs;
+    QElapsedTimer total;
+    total.start();
+    for(const QString& source : sources) {
+        QElapsedTimer timer;
+        timer.start();
+
+        const vfg::batch::JobResult jobResult = job.run(source);
+
+        result.samples.append(timer.nsecsElapsed() / 1000);
+
+        if(!jobResult.error.isEmpty()) {
+            throw std::runtime_error("Processing failed: " + jobResult.error.toStdString());
+        }
+
+        for(const QString& output : jobResult.outputs) {
+            if(outputs.contains(output) || !QFileInfo(output).exists()) {
+                throw std::runtime_error("Sources with the same name wrote to the same output "
+                                         + output.toStdString());
+            }
+
+            outputs.insert(output);
+            result.bytes += QFileInfo(output).size();
+        }
+    }
+    result.wallTime = total.nsecsElapsed() / 1000;
+
+    return result;
+}
+
+} // namespace benchmark
+} // namespace vfg
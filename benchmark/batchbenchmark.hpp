@@ -0,0 +1,63 @@
+#ifndef VFG_BENCHMARK_BATCHBENCHMARK_HPP
+#define VFG_BENCHMARK_BATCHBENCHMARK_HPP
+
+#include <QString>
+#include <QStringList>
+#include "benchmarkrunner.hpp"
+
+namespace vfg {
+namespace benchmark {
+
+/**
+ * @brief The BatchBenchmark class
+ *
+ * Runs a \link vfg::batch::BatchJob \endlink on small raw YUV files
+ * generated in a temporary directory. The same-name scenario processes
+ * files with the same name from different directories and checks that
+ * none of them overwrites the outputs of another.
+ */
+class BatchBenchmark
+{
+public:
+    /**
+     * @brief Scenario options
+     */
+    struct Options
+    {
+        //! Number of sources with the same name
+        int sources {3};
+
+        //! Number of frames in each source
+        int frames {20};
+    };
+
+    /**
+     * @brief Constructor
+     * @param options Scenario options
+     */
+    explicit BatchBenchmark(const Options& options);
+
+    /**
+     * @brief Get names of all scenarios
+     * @return Scenario names
+     */
+    static QStringList scenarios();
+
+    /**
+     * @brief Run a scenario
+     * @param scenario Scenario name
+     * @exception std::invalid_argument If scenario is unknown
+     * @exception std::runtime_error If the sources can't be written, a source
+     *            fails or two sources write to the same output
+     * @return Scenario timings, one sample per source
+     */
+    ScenarioResult run(const QString& scenario);
+
+private:
+    Options opts;
+};
+
+} // namespace benchmark
+} // namespace vfg
+
+#endif // VFG_BENCHMARK_BATCHBENCHMARK_HPP
@@ -0,0 +1,98 @@
+#-------------------------------------------------
+#
+# Headless benchmark for the frame pipeline
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent network script
+
+TARGET = screenpicker-benchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp \
+    benchmarkrunner.cpp \
+    discbenchmark.cpp \
+    downloadbenchmark.cpp \
+    extractorbenchmark.cpp \
+    scriptbenchmark.cpp \
+    batchbenchmark.cpp \
+    localhttpserver.cpp \
+    ..\discjobmanager.cpp \
+    ..\dvdprocessor.cpp \
+    ..\indexeroutputparser.cpp \
+    ..\httpdownload.cpp \
+    ..\downloadwriter.cpp \
+    ..\bandwidthlimiter.cpp \
+    ..\extractors\baseextractor.cpp \
+    ..\extractors\youtubeextractor.cpp \
+    ..\extractors\youtubeplayercache.cpp \
+    ..\extractors\jsonscanner.cpp \
+    ..\abstractvideosource.cpp \
+    ..\syntheticvideosource.cpp \
+    ..\y4mvideosource.cpp \
+    ..\videosourceinstrumentation.cpp \
+    ..\videoframegrabber.cpp \
+    ..\videoframegenerator.cpp \
+    ..\filmstrip.cpp \
+    ..\framefilter.cpp \
+    ..\framequalityfilter.cpp \
+    ..\gridcomposer.cpp \
+    ..\framespillstore.cpp \
+    ..\scriptparser.cpp \
+    ..\batch\batchjob.cpp \
+    ..\libs\templet\templet.cpp ..\libs\templet\nodes.cpp ..\libs\templet\types.cpp
+
+HEADERS  += benchmarkrunner.hpp \
+    discbenchmark.hpp \
+    downloadbenchmark.hpp \
+    extractorbenchmark.hpp \
+    scriptbenchmark.hpp \
+    batchbenchmark.hpp \
+    localhttpserver.hpp \
+    ..\discjobmanager.h \
+    ..\dvdprocessor.h \
+    ..\indexeroutputparser.h \
+    ..\httpdownload.hpp \
+    ..\downloadwriter.hpp \
+    ..\bandwidthlimiter.hpp \
+    ..\extractors\baseextractor.hpp \
+    ..\extractors\youtubeextractor.hpp \
+    ..\extractors\youtubeplayercache.hpp \
+    ..\extractors\jsonscanner.hpp \
+    ..\extractors\regexutil.hpp \
+    ..\abstractvideosource.h \
+    ..\syntheticvideosource.h \
+    ..\y4mvideosource.h \
+    ..\videosourceinstrumentation.h \
+    ..\videoframegrabber.h \
+    ..\videoframegenerator.h \
+    ..\filmstrip.h \
+    ..\framefilter.h \
+    ..\framequalityfilter.h \
+    ..\gridcomposer.h \
+    ..\framespillstore.h \
+    ..\scriptparser.h \
+    ..\batch\batchjob.hpp
+
+INCLUDEPATH += .. \
+    ..\batch \
+    ..\libs\templet
+
+win32 {
+    SOURCES += ..\avisynthvideosource.cpp \
+        ..\avisynthwrapper.cpp \
+        ..\keyframeindex.cpp
+
+    HEADERS += ..\avisynthvideosource.h \
+        ..\avisynthwrapper.hpp \
+        ..\keyframeindex.h
+
+    INCLUDEPATH += ..\libs\avs2yuv\src
+
+    # Required for avisynth to compile without using wide characters
+    DEFINES -= UNICODE
+}
+
+QMAKE_CXXFLAGS += -std=c++1y -Wall -Wextra -O3 -fpermissive
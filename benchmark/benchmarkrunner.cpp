@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QIcon>
+#include <QImage>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMimeData>
+#include <QPixmap>
+#include <QRect>
+#include <QSize>
+#include <QStandardItemModel>
+#include <QTextStream>
+#include "filmstrip.h"
+#include "framefilter.h"
+#include "gridcomposer.h"
+#include "videoframegenerator.h"
+#include "videoframegrabber.h"
+#include "benchmarkrunner.hpp"
+
+Q_LOGGING_CATEGORY(BENCHMARK, "benchmark")
+
+namespace {
+
+//! Largest grid composed by the grid scenario, well below the QImage limit of 2 GB
+constexpr qint64 MaxGridBytes = 1024LL * 1024 * 1024;
+
+} // namespace
+
+namespace vfg {
+namespace benchmark {
+
+qint64 ScenarioResult::percentile(const double percent) const
+{
+    if(samples.empty()) {
+        return 0;
+    }
+
+    QVector<qint64> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    // Nearest-rank percentile
+    const int rank = static_cast<int>(std::ceil(percent / 100.0 * sorted.size()));
+    return sorted.at(std::min(std::max(rank, 1), sorted.size()) - 1);
+}
+
+double ScenarioResult::mean() const
+{
+    if(samples.empty()) {
+        return 0.0;
+    }
+
+    qint64 sum = 0;
+    for(const qint64 sample : samples) {
+        sum += sample;
+    }
+
+    return static_cast<double>(sum) / samples.size();
+}
+
+double ScenarioResult::throughput() const
+{
+    return wallTime == 0 ? 0.0 : samples.size() * 1000000.0 / wallTime;
+}
+
+double ScenarioResult::megabytesPerSecond() const
+{
+    return wallTime == 0 ? 0.0 : bytes / 1000000.0 / (wallTime / 1000000.0);
+}
+
+double ScenarioResult::mainThreadUsPerMegabyte() const
+{
+    return bytes == 0 ? 0.0 : mainThreadTime / (bytes / 1000000.0);
+}
+
+QJsonObject ScenarioResult::toJson() const
+{
+    QJsonObject obj;
+    obj.insert("name", name);
+    obj.insert("operations", samples.size());
+    obj.insert("wallTimeMs", wallTime / 1000.0);
+    obj.insert("opsPerSecond", throughput());
+    obj.insert("meanUs", mean());
+    obj.insert("minUs", samples.empty() ? 0.0 : static_cast<double>(*std::min_element(samples.begin(), samples.end())));
+    obj.insert("p50Us", static_cast<double>(percentile(50)));
+    obj.insert("p90Us", static_cast<double>(percentile(90)));
+    obj.insert("p99Us", static_cast<double>(percentile(99)));
+    obj.insert("maxUs", static_cast<double>(percentile(100)));
+    if(bytes > 0) {
+        obj.insert("bytes", static_cast<double>(bytes));
+        obj.insert("mbPerSecond", megabytesPerSecond());
+    }
+    if(mainThreadTime > 0) {
+        obj.insert("mainThreadMs", mainThreadTime / 1000.0);
+        obj.insert("mainThreadUsPerMb", mainThreadUsPerMegabyte());
+    }
+    return obj;
+}
+
+QString ScenarioResult::csvHeader()
+{
+    return "name,operations,wall_time_ms,ops_per_second,mean_us,min_us,p50_us,p90_us,p99_us,max_us,"
+           "bytes,mb_per_second,main_thread_us_per_mb";
+}
+
+QString ScenarioResult::toCsv() const
+{
+    QString out;
+    QTextStream ts(&out);
+    ts << name << "," << samples.size() << ","
+       << QString::number(wallTime / 1000.0, 'f', 3) << ","
+       << QString::number(throughput(), 'f', 2) << ","
+       << QString::number(mean(), 'f', 1) << ","
+       << (samples.empty() ? 0 : *std::min_element(samples.begin(), samples.end())) << ","
+       << percentile(50) << "," << percentile(90) << ","
+       << percentile(99) << "," << percentile(100) << ","
+       << bytes << "," << QString::number(megabytesPerSecond(), 'f', 2) << ","
+       << QString::number(mainThreadUsPerMegabyte(), 'f', 1);
+    return out;
+}
+
+BenchmarkRunner::BenchmarkRunner(std::shared_ptr<vfg::core::VideoFrameGrabber> newFrameGrabber,
+                                 const Options& options) :
+    frameGrabber(std::move(newFrameGrabber)),
+    opts(options)
+{
+    if(!frameGrabber || !frameGrabber->hasVideo()) {
+        throw std::runtime_error("Benchmark requires a frame grabber with a loaded video");
+    }
+
+    opts.count = std::max(1, opts.count);
+    opts.stride = std::max(1, opts.stride);
+}
+
+QStringList BenchmarkRunner::scenarios()
+{
+    static const QStringList names {
+        "sequential", "strided", "random", "backforth",
+        "thumbnails", "png", "preview-filter", "generator",
+        "filmstrip-build", "filmstrip-hover", "grid"
+    };
+    return names;
+}
+
+QStringList BenchmarkRunner::guiScenarios()
+{
+    static const QStringList names {
+        "grid-thumbnails"
+    };
+    return names;
+}
+
+ScenarioResult BenchmarkRunner::run(const QString& scenario)
+{
+    qCDebug(BENCHMARK) << "Running scenario" << scenario;
+
+    if(scenario == "sequential") {
+        return measure(scenario, sequentialFrames(), [this](const int frameNum) {
+            frameGrabber->getFrame(frameNum);
+        });
+    }
+    else if(scenario == "strided") {
+        return measure(scenario, stridedFrames(), [this](const int frameNum) {
+            frameGrabber->getFrame(frameNum);
+        });
+    }
+    else if(scenario == "random") {
+        return measure(scenario, randomFrames(), [this](const int frameNum) {
+            frameGrabber->getFrame(frameNum);
+        });
+    }
+    else if(scenario == "backforth") {
+        return backAndForth();
+    }
+    else if(scenario == "thumbnails") {
+        const int width = opts.thumbnailWidth;
+        return measure(scenario, stridedFrames(), [this, width](const int frameNum) {
+            const QImage frame = frameGrabber->getFrame(frameNum);
+            frame.scaledToWidth(width, Qt::SmoothTransformation);
+        });
+    }
+    else if(scenario == "png") {
+        return measure(scenario, stridedFrames(), [this](const int frameNum) {
+            const QImage frame = frameGrabber->getFrame(frameNum);
+            QBuffer buffer;
+            buffer.open(QIODevice::WriteOnly);
+            frame.save(&buffer, "PNG");
+        });
+    }
+    else if(scenario == "preview-filter") {
+        // Typical DVD preview: deinterlace, resize to 16:9 and crop the borders
+        vfg::core::FrameFilter::Settings settings;
+        settings.deinterlace = true;
+        settings.resize = QSize(854, 480);
+        settings.crop = QRect(8, 4, 8, 4);
+        const vfg::core::FrameFilter filter(settings);
+        return measure(scenario, stridedFrames(), [this, &filter](const int frameNum) {
+            filter.apply(frameGrabber->getFrame(frameNum));
+        });
+    }
+    else if(scenario == "generator") {
+        return generator();
+    }
+    else if(scenario == "filmstrip-build" || scenario == "filmstrip-hover") {
+        return filmstrip(scenario);
+    }
+    else if(scenario == "grid") {
+        return grid();
+    }
+    else if(scenario == "grid-thumbnails") {
+        return gridThumbnails();
+    }
+
+    throw std::invalid_argument("Unknown scenario: " + scenario.toStdString());
+}
+
+ScenarioResult BenchmarkRunner::measure(const QString& name, const QList<int>& frames,
+                                        const std::function<void(int)>& op) const
+{
+    ScenarioResult result;
+    result.name = name;
+    result.samples.reserve(frames.size());
+
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer timer;
+    for(const int frameNum : frames) {
+        timer.start();
+        op(frameNum);
+        result.samples.append(timer.nsecsElapsed() / 1000);
+    }
+    result.wallTime = total.nsecsElapsed() / 1000;
+
+    return result;
+}
+
+QList<int> BenchmarkRunner::sequentialFrames() const
+{
+    const int numFrames = std::min(opts.count, frameGrabber->totalFrames());
+    QList<int> frames;
+    frames.reserve(numFrames);
+    for(int frameNum = 0; frameNum < numFrames; ++frameNum) {
+        frames.append(frameNum);
+    }
+
+    return frames;
+}
+
+QList<int> BenchmarkRunner::stridedFrames() const
+{
+    const int totalFrames = frameGrabber->totalFrames();
+    QList<int> frames;
+    for(int frameNum = 0; frameNum < totalFrames && frames.size() < opts.count;
+            frameNum += opts.stride) {
+        frames.append(frameNum);
+    }
+
+    return frames;
+}
+
+QList<int> BenchmarkRunner::randomFrames() const
+{
+    std::mt19937 engine(opts.seed);
+    std::uniform_int_distribution<int> dist(0, frameGrabber->totalFrames() - 1);
+
+    QList<int> frames;
+    frames.reserve(opts.count);
+    for(int i = 0; i < opts.count; ++i) {
+        frames.append(dist(engine));
+    }
+
+    return frames;
+}
+
+ScenarioResult BenchmarkRunner::backAndForth()
+{
+    // Step forward five frames, then back four, which mimics
+    // a user looking for the right frame with the arrow keys
+    const int start = frameGrabber->totalFrames() / 2;
+    frameGrabber->requestFrame(start);
+
+    QList<int> steps;
+    steps.reserve(opts.count);
+    for(int i = 0; i < opts.count; ++i) {
+        steps.append(i % 9 < 5 ? 1 : -1);
+    }
+
+    return measure("backforth", steps, [this](const int step) {
+        if(step > 0) {
+            frameGrabber->requestNextFrame();
+        }
+        else {
+            frameGrabber->requestPreviousFrame();
+        }
+    });
+}
+
+ScenarioResult BenchmarkRunner::generator()
+{
+    vfg::core::VideoFrameGenerator frameGenerator(frameGrabber);
+
+    ScenarioResult result;
+    result.name = "generator";
+
+    QElapsedTimer timer;
+    QObject::connect(&frameGenerator, &vfg::core::VideoFrameGenerator::frameReady,
+                     [&result, &timer](int, const QImage&) {
+        result.samples.append(timer.nsecsElapsed() / 1000);
+        timer.start();
+    });
+
+    frameGenerator.enqueue(stridedFrames());
+
+    // The generator runs to completion in this thread
+    QElapsedTimer total;
+    total.start();
+    timer.start();
+    frameGenerator.start();
+    result.wallTime = total.nsecsElapsed() / 1000;
+
+    return result;
+}
+
+ScenarioResult BenchmarkRunner::filmstrip(const QString& name)
+{
+    const int numFrames = frameGrabber->totalFrames();
+    vfg::core::Filmstrip strip(numFrames, opts.count, frameGrabber->resolution());
+
+    QList<int> tiles;
+    for(int tile = 0; tile < strip.count(); ++tile) {
+        tiles.append(tile);
+    }
+
+    // Decoding a tile per operation, as the filmstrip builder does
+    const ScenarioResult build = measure("filmstrip-build", tiles, [this, &strip](const int tile) {
+        strip.setTile(tile, frameGrabber->getFrame(strip.frameAt(tile)));
+    });
+    if(name == "filmstrip-build") {
+        return build;
+    }
+
+    // Hovering the seek slider only looks up and copies a tile
+    const QImage atlas = strip.atlas();
+    return measure(name, randomFrames(), [&strip, &atlas](const int frameNum) {
+        atlas.copy(strip.tileRect(strip.nearestTile(frameNum)));
+    });
+}
+
+ScenarioResult BenchmarkRunner::grid()
+{
+    // Rows of ten full size frames, like a contact sheet
+    const int columns = 10;
+    const QList<int> frames = stridedFrames();
+    QVector<QVector<int>> rows;
+    for(int idx = 0; idx < frames.size(); idx += columns) {
+        rows.append(frames.mid(idx, columns).toVector());
+    }
+
+    const QSize frameSize = frameGrabber->resolution();
+    vfg::core::GridComposer composer([this](const int frameNum) {
+        return frameGrabber->getFrame(frameNum);
+    }, frameSize);
+    composer.setRows(rows);
+    composer.setSpacing(10);
+    composer.setSpacingColor(Qt::black);
+
+    // Full size frames unless the grid wouldn't fit in a QImage,
+    // every frame is still decoded and scaled into the grid
+    int width = frameSize.width() * columns;
+    composer.setWidth(width);
+    while(width > columns && static_cast<qint64>(composer.size().width())
+                                 * composer.size().height() * 4 > MaxGridBytes) {
+        width = width * 3 / 4;
+        composer.setWidth(width);
+    }
+
+    qint64 bytes = 0;
+    ScenarioResult result = measure("grid", {0}, [&composer, &bytes](int) {
+        bytes = composer.compose().byteCount();
+    });
+
+    if(bytes == 0) {
+        throw std::runtime_error("Unable to compose grid of size "
+                                 + QString("%1x%2").arg(composer.size().width())
+                                       .arg(composer.size().height()).toStdString());
+    }
+
+    result.bytes = bytes;
+
+    return result;
+}
+
+ScenarioResult BenchmarkRunner::gridThumbnails()
+{
+    if(!qobject_cast<QGuiApplication*>(QCoreApplication::instance())) {
+        throw std::runtime_error("The grid-thumbnails scenario requires a QGuiApplication");
+    }
+
+    const int width = opts.thumbnailWidth;
+    return measure("grid-thumbnails", stridedFrames(), [this, width](const int frameNum) {
+        const QImage thumbnail = frameGrabber->getFrame(frameNum)
+                                    .scaledToWidth(width, Qt::SmoothTransformation);
+        const QImage tagged = vfg::core::GridComposer::tagThumbnail(thumbnail, frameNum);
+
+        // Drag the icon from one item model and drop it into another,
+        // like the save grid dialog's list and grid
+        QStandardItemModel source;
+        source.appendRow(new QStandardItem(QIcon(QPixmap::fromImage(tagged)), QString()));
+        std::unique_ptr<QMimeData> mimeData(source.mimeData({source.index(0, 0)}));
+
+        QStandardItemModel target;
+        target.dropMimeData(mimeData.get(), Qt::CopyAction, 0, 0, {});
+        const QIcon icon = target.item(0) ? target.item(0)->icon() : QIcon();
+        const QImage dropped = icon.isNull()
+                ? QImage()
+                : icon.pixmap(icon.availableSizes().first()).toImage();
+
+        if(vfg::core::GridComposer::taggedFrame(dropped) != frameNum) {
+            throw std::runtime_error("Frame number of thumbnail " + std::to_string(frameNum)
+                                     + " was lost in drag and drop");
+        }
+    });
+}
+
+} // namespace benchmark
+} // namespace vfg
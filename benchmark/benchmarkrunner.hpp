@@ -0,0 +1,201 @@
+#ifndef VFG_BENCHMARK_BENCHMARKRUNNER_HPP
+#define VFG_BENCHMARK_BENCHMARKRUNNER_HPP
+
+#include <functional>
+#include <memory>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QJsonObject;
+
+namespace vfg {
+namespace core {
+    class VideoFrameGrabber;
+}
+}
+
+namespace vfg {
+namespace benchmark {
+
+/**
+ * @brief Timings collected from a single scenario
+ */
+struct ScenarioResult
+{
+    //! Scenario name
+    QString name {};
+
+    //! Duration of each operation in microseconds
+    QVector<qint64> samples {};
+
+    //! Duration of the whole scenario in microseconds
+    qint64 wallTime {0};
+
+    //! Bytes processed by the scenario, 0 if not applicable
+    qint64 bytes {0};
+
+    //! CPU time of the main thread in microseconds, 0 if not measured
+    qint64 mainThreadTime {0};
+
+    /**
+     * @brief Get exact percentile of the samples
+     * @param percent Percentile in range [0, 100]
+     * @return Percentile in microseconds, 0 if there are no samples
+     */
+    qint64 percentile(double percent) const;
+
+    /**
+     * @brief Get mean of the samples
+     * @return Mean in microseconds, 0 if there are no samples
+     */
+    double mean() const;
+
+    /**
+     * @brief Get operations per second over the wall time
+     * @return Operations per second
+     */
+    double throughput() const;
+
+    /**
+     * @brief Get processed megabytes per second over the wall time
+     * @return Megabytes per second, 0 if no bytes were processed
+     */
+    double megabytesPerSecond() const;
+
+    /**
+     * @brief Get main thread CPU time per processed megabyte
+     * @return Microseconds per megabyte, 0 if not measured
+     */
+    double mainThreadUsPerMegabyte() const;
+
+    /**
+     * @brief Convert to a JSON object
+     * @return JSON object
+     */
+    QJsonObject toJson() const;
+
+    /**
+     * @brief Get CSV header matching \link toCsv \endlink
+     * @return CSV header line
+     */
+    static QString csvHeader();
+
+    /**
+     * @brief Convert to a CSV line
+     * @return CSV line
+     */
+    QString toCsv() const;
+};
+
+/**
+ * @brief The BenchmarkRunner class
+ *
+ * Runs frame access scenarios against a frame grabber and
+ * measures the duration of every operation
+ */
+class BenchmarkRunner
+{
+public:
+    /**
+     * @brief Scenario options
+     */
+    struct Options
+    {
+        //! Number of operations per scenario
+        int count {500};
+
+        //! Frame step for strided access and generation
+        int stride {100};
+
+        //! Seed for random access
+        unsigned seed {1};
+
+        //! Thumbnail width for the thumbnail scenario
+        int thumbnailWidth {200};
+    };
+
+    /**
+     * @brief Constructor
+     * @param frameGrabber Frame grabber with a loaded video
+     * @param options Scenario options
+     * @exception std::runtime_error If frameGrabber is nullptr or has no video
+     */
+    BenchmarkRunner(std::shared_ptr<vfg::core::VideoFrameGrabber> frameGrabber,
+                    const Options& options);
+
+    /**
+     * @brief Get names of all scenarios
+     * @return Scenario names in default run order
+     */
+    static QStringList scenarios();
+
+    /**
+     * @brief Get names of the scenarios that require a QGuiApplication
+     *
+     * Not run by default, as they need a display or the offscreen platform
+     *
+     * @return Scenario names
+     */
+    static QStringList guiScenarios();
+
+    /**
+     * @brief Run a scenario
+     * @param scenario Scenario name
+     * @exception std::invalid_argument If scenario is unknown
+     * @return Scenario timings
+     */
+    ScenarioResult run(const QString& scenario);
+
+private:
+    std::shared_ptr<vfg::core::VideoFrameGrabber> frameGrabber;
+    Options opts;
+
+    /**
+     * @brief Time an operation over a list of frames
+     * @param name Scenario name
+     * @param frames Frames to pass to op
+     * @param op Operation to time
+     * @return Scenario timings
+     */
+    ScenarioResult measure(const QString& name, const QList<int>& frames,
+                           const std::function<void(int)>& op) const;
+
+    QList<int> sequentialFrames() const;
+    QList<int> stridedFrames() const;
+    QList<int> randomFrames() const;
+
+    ScenarioResult backAndForth();
+    ScenarioResult generator();
+
+    /**
+     * @brief Build a filmstrip of count tiles
+     * @param name filmstrip-build to time decoding the tiles,
+     *        filmstrip-hover to time looking up tiles of random frames
+     * @return Scenario timings
+     */
+    ScenarioResult filmstrip(const QString& name);
+
+    /**
+     * @brief Compose the strided frames into a grid of full size frames
+     *
+     * The grid is made narrower until it fits in 1 GB
+     *
+     * @exception std::runtime_error If the grid can't be allocated
+     * @return Scenario timings, a single sample for the whole grid
+     */
+    ScenarioResult grid();
+
+    /**
+     * @brief Drag and drop tagged thumbnails of the strided frames between item models
+     * @exception std::runtime_error If a thumbnail loses its frame number
+     * @return Scenario timings, one sample per thumbnail
+     */
+    ScenarioResult gridThumbnails();
+};
+
+} // namespace benchmark
+} // namespace vfg
+
+#endif // VFG_BENCHMARK_BENCHMARKRUNNER_HPP
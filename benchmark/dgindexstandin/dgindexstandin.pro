@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Stand-in for DGIndex used by the disc benchmark
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = dgindex-standin
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += main.cpp
+
+QMAKE_CXXFLAGS += -std=c++1y -Wall -Wextra -O2
@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringList>
+#include <QThread>
+
+/**
+ * Stand-in for DGIndex used by the disc benchmark
+ *
+ * Accepts the command line DvdProcessor passes to DGIndex, reads the
+ * input files and prints progress the way DGIndex does with -hide,
+ * one percentage per line. Writes a D2V file listing the inputs.
+ *
+ * DGINDEX_STANDIN_DELAY adds time per percent in milliseconds
+ * to simulate decoding.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const QStringList args = a.arguments();
+    const int outputArg = args.indexOf("-o");
+    const int inputArg = args.indexOf("-i");
+    if(outputArg == -1 || outputArg + 1 >= args.size() || inputArg == -1) {
+        std::fprintf(stderr, "Usage: dgindex-standin [options] -o output -i files...\n");
+        return 2;
+    }
+
+    QStringList inputs;
+    for(int i = inputArg + 1; i < args.size() && !args.at(i).startsWith('-'); ++i) {
+        inputs.append(args.at(i));
+    }
+
+    const int delay = qgetenv("DGINDEX_STANDIN_DELAY").toInt();
+
+    qint64 total = 0;
+    for(const QString& input : inputs) {
+        total += QFileInfo(input).size();
+    }
+
+    // Raw bytes so that every line ends with a single \n as the parser expects
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+
+    qint64 done = 0;
+    int lastPercent = -1;
+    for(const QString& input : inputs) {
+        QFile file(input);
+        if(!file.open(QIODevice::ReadOnly)) {
+            std::fprintf(stderr, "Unable to open %s\n", qPrintable(input));
+            return 1;
+        }
+
+        while(!file.atEnd()) {
+            done += file.read(1024 * 1024).size();
+
+            const int percent = total > 0 ? static_cast<int>(done * 100 / total) : 100;
+            for(int p = lastPercent + 1; p <= percent; ++p) {
+                if(delay > 0) {
+                    QThread::msleep(delay);
+                }
+
+                out.write(QByteArray::number(p).append('\n'));
+                out.flush();
+            }
+            lastPercent = percent;
+        }
+    }
+
+    QByteArray d2v("DGIndexProjectFile16\n");
+    d2v.append(QByteArray::number(inputs.size())).append('\n');
+    for(const QString& input : inputs) {
+        d2v.append(QDir::toNativeSeparators(QFileInfo(input).absoluteFilePath()).toLocal8Bit()).append('\n');
+    }
+    d2v.append("\nStream_Type=1\nMPEG_Type=2\n\nFINISHED  100.00% VIDEO\n");
+
+    QSaveFile output(args.at(outputArg + 1) + ".d2v");
+    if(!output.open(QIODevice::WriteOnly) || output.write(d2v) != d2v.size() || !output.commit()) {
+        std::fprintf(stderr, "Unable to write %s\n", qPrintable(output.fileName()));
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <stdexcept>
+#include <QByteArray>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QVector>
+#include "discjobmanager.h"
+#include "discbenchmark.hpp"
+
+Q_DECLARE_LOGGING_CATEGORY(BENCHMARK)
+
+namespace {
+
+/**
+ * @brief Write the VOBs of a generated disc
+ * @param dir Disc directory
+ * @param titles Number of titles
+ * @param size Size of each title in bytes
+ * @exception std::runtime_error If a file can't be written
+ * @return Paths to the VOBs
+ */
+QStringList createDisc(const QDir& dir, const int titles, const qint64 size) {
+    QStringList files;
+    for(int title = 1; title <= titles; ++title) {
+        const QString path = dir.absoluteFilePath(QString("VTS_%1_1.VOB").arg(title, 2, 10, QChar('0')));
+        QFile file(path);
+        if(!file.open(QIODevice::WriteOnly)) {
+            throw std::runtime_error(QString("Unable to create %1").arg(path).toStdString());
+        }
+
+        // Every title has different content so that each has its own cache key
+        QByteArray block(1024 * 1024, 0);
+        for(int i = 0; i < block.size(); ++i) {
+            block[i] = static_cast<char>((i * title) ^ (i >> 8));
+        }
+
+        for(qint64 written = 0; written < size; ) {
+            const qint64 count = std::min<qint64>(block.size(), size - written);
+            if(file.write(block.constData(), count) != count) {
+                throw std::runtime_error(QString("Unable to write %1").arg(path).toStdString());
+            }
+            written += count;
+        }
+
+        files.append(path);
+    }
+
+    return files;
+}
+
+/**
+ * @brief Index a disc and wait until it's finished
+ * @param jobs Job manager
+ * @param files Files of the disc
+ * @param timeout Maximum duration in milliseconds
+ * @exception std::runtime_error If indexing fails or times out
+ * @return Time from the start until each title finished, in microseconds
+ */
+QVector<qint64> indexDisc(vfg::DiscJobManager& jobs, const QStringList& files, const int timeout) {
+    QEventLoop loop;
+    QElapsedTimer timer;
+    QVector<qint64> samples;
+    QStringList outputs;
+    QString errorMsg;
+    bool done = false;
+
+    QObject::connect(&jobs, &vfg::DiscJobManager::jobFinished, &loop, [&](int, const QString&) {
+        samples.append(timer.nsecsElapsed() / 1000);
+    });
+    QObject::connect(&jobs, &vfg::DiscJobManager::finished, &loop, [&](const QStringList& filenames) {
+        outputs = filenames;
+        done = true;
+        loop.quit();
+    });
+    QObject::connect(&jobs, &vfg::DiscJobManager::error, &loop, [&](const QString& msg) {
+        errorMsg = msg;
+        done = true;
+        loop.quit();
+    });
+    QTimer::singleShot(timeout, &loop, &QEventLoop::quit);
+
+    timer.start();
+    jobs.process(files);
+    if(!done) {
+        loop.exec();
+    }
+
+    if(!errorMsg.isEmpty()) {
+        throw std::runtime_error(errorMsg.toStdString());
+    }
+    else if(!done) {
+        jobs.abort();
+        throw std::runtime_error("Indexing did not finish in time");
+    }
+
+    for(const QString& output : outputs) {
+        QFile d2v(output);
+        if(!d2v.open(QIODevice::ReadOnly) || !d2v.readLine().startsWith("DGIndexProjectFile")) {
+            throw std::runtime_error(QString("Invalid D2V file %1").arg(output).toStdString());
+        }
+    }
+
+    return samples;
+}
+
+} // namespace
+
+namespace vfg {
+namespace benchmark {
+
+DiscBenchmark::DiscBenchmark(const Options& options) :
+    opts(options)
+{
+}
+
+QStringList DiscBenchmark::scenarios()
+{
+    static const QStringList names {
+        "disc-index", "disc-index-serial", "disc-index-cached"
+    };
+    return names;
+}
+
+ScenarioResult DiscBenchmark::run(const QString& scenario)
+{
+    if(!scenarios().contains(scenario)) {
+        throw std::invalid_argument("Unknown scenario: " + scenario.toStdString());
+    }
+
+    qCDebug(BENCHMARK) << "Running scenario" << scenario;
+
+    const QTemporaryDir discDir;
+    const QTemporaryDir cacheDir;
+    if(!discDir.isValid() || !cacheDir.isValid()) {
+        throw std::runtime_error("Unable to create temporary directory");
+    }
+
+    const QStringList files = createDisc(QDir(discDir.path()), opts.titles, opts.titleSize);
+
+    // Inherited by the stand-in processes
+    qputenv("DGINDEX_STANDIN_DELAY", QByteArray::number(opts.indexerDelay));
+
+    vfg::DiscJobManager jobs(opts.indexer, cacheDir.path());
+    if(scenario == "disc-index-serial") {
+        jobs.setMaxJobs(1);
+    }
+    else if(opts.maxJobs > 0) {
+        jobs.setMaxJobs(opts.maxJobs);
+    }
+
+    // Index the disc in a previous "session"
+    if(scenario == "disc-index-cached") {
+        indexDisc(jobs, files, opts.timeout);
+    }
+
+    const int startedBefore = jobs.startedCount();
+
+    ScenarioResult result;
+    result.name = scenario;
+
+    QElapsedTimer total;
+    total.start();
+    result.samples = indexDisc(jobs, files, opts.timeout);
+    result.wallTime = total.nsecsElapsed() / 1000;
+    result.bytes = opts.titleSize * opts.titles;
+
+    const int started = jobs.startedCount() - startedBefore;
+    const int expected = scenario == "disc-index-cached" ? 0 : opts.titles;
+    if(started != expected) {
+        throw std::runtime_error(QString("Indexer was started %1 times, expected %2")
+                                 .arg(started).arg(expected).toStdString());
+    }
+
+    return result;
+}
+
+} // namespace benchmark
+} // namespace vfg
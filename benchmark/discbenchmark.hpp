@@ -0,0 +1,74 @@
+#ifndef VFG_BENCHMARK_DISCBENCHMARK_HPP
+#define VFG_BENCHMARK_DISCBENCHMARK_HPP
+
+#include <QString>
+#include <QStringList>
+#include "benchmarkrunner.hpp"
+
+namespace vfg {
+namespace benchmark {
+
+/**
+ * @brief The DiscBenchmark class
+ *
+ * Indexes a generated multi-title DVD with \link vfg::DiscJobManager \endlink
+ * using a stand-in indexer that reads the VOBs and prints progress
+ * like DGIndex, so the scenarios run without DGIndex or a real disc.
+ */
+class DiscBenchmark
+{
+public:
+    /**
+     * @brief Scenario options
+     */
+    struct Options
+    {
+        //! Path to the indexer executable
+        QString indexer {"dgindex-standin"};
+
+        //! Number of titles on the disc
+        int titles {4};
+
+        //! Size of each title in bytes
+        qint64 titleSize {64 * 1000 * 1000};
+
+        //! Time the stand-in spends per percent in milliseconds
+        int indexerDelay {5};
+
+        //! Maximum number of indexer processes at once (0 = number of cores)
+        int maxJobs {0};
+
+        //! Maximum duration of a scenario in milliseconds
+        int timeout {300000};
+    };
+
+    /**
+     * @brief Constructor
+     * @param options Scenario options
+     */
+    explicit DiscBenchmark(const Options& options);
+
+    /**
+     * @brief Get names of all scenarios
+     * @return Scenario names
+     */
+    static QStringList scenarios();
+
+    /**
+     * @brief Run a scenario
+     * @param scenario Scenario name
+     * @exception std::invalid_argument If scenario is unknown
+     * @exception std::runtime_error If indexing fails, or a cached disc
+     *            starts the indexer
+     * @return Scenario timings, one sample per title from the start of indexing
+     */
+    ScenarioResult run(const QString& scenario);
+
+private:
+    Options opts;
+};
+
+} // namespace benchmark
+} // namespace vfg
+
+#endif // VFG_BENCHMARK_DISCBENCHMARK_HPP
@@ -0,0 +1,162 @@
+#include <stdexcept>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QTemporaryDir>
+#include "httpdownload.hpp"
+#include "localhttpserver.hpp"
+#include "downloadbenchmark.hpp"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <time.h>
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(BENCHMARK)
+
+namespace {
+
+//! Number of times a failed download is retried
+constexpr int MaxRetries = 5;
+
+/**
+ * @brief Get CPU time used by the calling thread
+ *
+ * Time spent waiting in the event loop is not counted, so the
+ * difference is the time spent handling network and disk events
+ *
+ * @return CPU time in microseconds, 0 if not supported
+ */
+qint64 threadCpuTime() {
+#if defined(Q_OS_WIN)
+    FILETIME creation, exit, kernel, user;
+    if(!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+
+    const auto toUs = [](const FILETIME& time) {
+        return ((static_cast<qint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10;
+    };
+    return toUs(kernel) + toUs(user);
+#elif defined(Q_OS_UNIX)
+    timespec ts;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+    return 0;
+#endif
+}
+
+} // namespace
+
+namespace vfg {
+namespace benchmark {
+
+DownloadBenchmark::DownloadBenchmark(const Options& options) :
+    opts(options)
+{
+    // Deterministic, poorly compressible content
+    payload.resize(static_cast<int>(opts.size));
+    quint32 state = 2463534242u;
+    for(int i = 0; i < payload.size(); ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        payload[i] = static_cast<char>(state);
+    }
+}
+
+QStringList DownloadBenchmark::scenarios()
+{
+    static const QStringList names {
+        "download-single", "download-segmented"
+    };
+    return names;
+}
+
+ScenarioResult DownloadBenchmark::run(const QString& scenario)
+{
+    if(!scenarios().contains(scenario)) {
+        throw std::invalid_argument("Unknown scenario: " + scenario.toStdString());
+    }
+
+    qCDebug(BENCHMARK) << "Running scenario" << scenario;
+
+    LocalHttpServer::Options serverOptions;
+    serverOptions.bytesPerSecond = opts.bytesPerSecond;
+    serverOptions.failEveryNth = opts.failEveryNth;
+    // The server runs in its own thread so that the main thread's
+    // CPU time only includes handling the download
+    LocalHttpServer server(payload, serverOptions);
+    const ServerThread serverThread(server);
+
+    const QTemporaryDir cacheDir;
+    if(!cacheDir.isValid()) {
+        throw std::runtime_error("Unable to create temporary directory");
+    }
+
+    QNetworkAccessManager netMan;
+    const int segments = scenario == "download-segmented" ? opts.segments : 1;
+
+    ScenarioResult result;
+    result.name = scenario;
+
+    QElapsedTimer total;
+    total.start();
+    for(int i = 0; i < opts.repeat; ++i) {
+        vfg::net::HttpDownload download(QNetworkRequest(server.url("payload.bin")),
+                                        QDir(cacheDir.path()));
+        download.setMaxSegments(segments);
+        download.setReadBufferSize(opts.readBufferSize);
+        download.setWriteBufferSize(opts.writeBufferSize);
+
+        QEventLoop loop;
+        QObject::connect(&download, &vfg::net::HttpDownload::updated, &loop, [&download, &loop]() {
+            if(download.isFinished()) {
+                loop.quit();
+            }
+        });
+
+        QElapsedTimer timer;
+        timer.start();
+        const qint64 cpuStart = threadCpuTime();
+        download.start(&netMan);
+        loop.exec();
+
+        for(int retries = 0; download.hasError() && retries < MaxRetries; ++retries) {
+            qCDebug(BENCHMARK) << "Retrying download:" << download.errorString();
+
+            download.retry();
+            loop.exec();
+        }
+        result.samples.append(timer.nsecsElapsed() / 1000);
+        result.mainThreadTime += threadCpuTime() - cpuStart;
+
+        if(download.getStatus() != vfg::net::HttpDownload::Status::Finished || download.hasError()) {
+            throw std::runtime_error("Download failed: " + download.errorString().toStdString());
+        }
+
+        QFile file(download.path());
+        if(!file.open(QIODevice::ReadOnly) || file.readAll() != payload) {
+            throw std::runtime_error("Downloaded file does not match the payload");
+        }
+
+        result.bytes += payload.size();
+    }
+    result.wallTime = total.nsecsElapsed() / 1000;
+
+    qCDebug(BENCHMARK) << "Server handled" << server.requestCount() << "requests";
+
+    return result;
+}
+
+} // namespace benchmark
+} // namespace vfg
@@ -0,0 +1,78 @@
+#ifndef VFG_BENCHMARK_DOWNLOADBENCHMARK_HPP
+#define VFG_BENCHMARK_DOWNLOADBENCHMARK_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include "benchmarkrunner.hpp"
+
+namespace vfg {
+namespace benchmark {
+
+/**
+ * @brief The DownloadBenchmark class
+ *
+ * Downloads a generated payload from a \link LocalHttpServer \endlink
+ * with \link vfg::net::HttpDownload \endlink and verifies the result
+ */
+class DownloadBenchmark
+{
+public:
+    /**
+     * @brief Scenario options
+     */
+    struct Options
+    {
+        //! Size of the downloaded file in bytes
+        qint64 size {64 * 1000 * 1000};
+
+        //! Maximum number of segments for segmented scenarios
+        int segments {4};
+
+        //! Bandwidth limit per connection in bytes per second (0 = unlimited)
+        qint64 bytesPerSecond {0};
+
+        //! Drop every Nth response halfway through (0 = never)
+        int failEveryNth {0};
+
+        //! Number of downloads per scenario
+        int repeat {3};
+
+        //! Read buffer per connection in bytes (0 = unlimited)
+        qint64 readBufferSize {1024 * 1024};
+
+        //! Size of the blocks written to disk in bytes
+        int writeBufferSize {1024 * 1024};
+    };
+
+    /**
+     * @brief Constructor
+     * @param options Scenario options
+     */
+    explicit DownloadBenchmark(const Options& options);
+
+    /**
+     * @brief Get names of all scenarios
+     * @return Scenario names
+     */
+    static QStringList scenarios();
+
+    /**
+     * @brief Run a scenario
+     * @param scenario Scenario name
+     * @exception std::invalid_argument If scenario is unknown
+     * @exception std::runtime_error If a download fails or is corrupted
+     * @return Scenario timings, one sample per download, and the CPU
+     *         time the main thread spent handling the downloads
+     */
+    ScenarioResult run(const QString& scenario);
+
+private:
+    Options opts;
+    QByteArray payload;
+};
+
+} // namespace benchmark
+} // namespace vfg
+
+#endif // VFG_BENCHMARK_DOWNLOADBENCHMARK_HPP
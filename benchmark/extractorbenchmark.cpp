@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+#include "extractors/youtubeextractor.hpp"
+#include "extractors/youtubeplayercache.hpp"
+#include "localhttpserver.hpp"
+#include "ptrutil.hpp"
+#include "extractorbenchmark.hpp"
+
+Q_DECLARE_LOGGING_CATEGORY(BENCHMARK)
+
+namespace {
+
+/**
+ * @brief Network manager that sends every request to a local server
+ *
+ * The path and query of the request are kept
+ */
+class StandInNetworkAccessManager : public QNetworkAccessManager
+{
+public:
+    explicit StandInNetworkAccessManager(const QUrl& serverUrl) :
+        server(serverUrl)
+    {
+    }
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest& request,
+                                 QIODevice *outgoingData) override {
+        QUrl url = request.url();
+        url.setScheme(server.scheme());
+        url.setHost(server.host());
+        url.setPort(server.port());
+
+        QNetworkRequest local(request);
+        local.setUrl(url);
+
+        return QNetworkAccessManager::createRequest(op, local, outgoingData);
+    }
+
+private:
+    QUrl server;
+};
+
+/**
+ * @brief Resolve URLs at the same time
+ * @param cache Player cache shared by the extractors
+ * @param serverUrl URL of the local server
+ * @param count Number of URLs
+ * @param timeout Maximum duration in milliseconds
+ * @exception std::runtime_error If a URL is not resolved
+ * @return Time from the start of the batch until each URL was resolved, in microseconds
+ */
+QVector<qint64> resolveBatch(const std::shared_ptr<vfg::extractor::YoutubePlayerCache>& cache,
+                             const QUrl& serverUrl, const int count, const int timeout) {
+    QEventLoop loop;
+    QElapsedTimer timer;
+    QVector<qint64> samples;
+    int failures = 0;
+
+    std::vector<std::unique_ptr<vfg::extractor::YoutubeExtractor>> extractors;
+    timer.start();
+    for(int i = 0; i < count; ++i) {
+        auto extractor = vfg::make_unique<vfg::extractor::YoutubeExtractor>(cache);
+        extractor->setNetworkManager(vfg::make_unique<StandInNetworkAccessManager>(serverUrl));
+
+        vfg::extractor::YoutubeExtractor *const ex = extractor.get();
+        QObject::connect(ex, &vfg::extractor::BaseExtractor::streamsReady, &loop, [&, ex]() {
+            samples.append(timer.nsecsElapsed() / 1000);
+
+            // The first stream must have a decrypted signature
+            const QStringList streams = ex->getStreams();
+            if(!streams.isEmpty()) {
+                ex->download(streams.first());
+            }
+            else {
+                ++failures;
+            }
+
+            if(samples.size() == count) {
+                loop.quit();
+            }
+        });
+        QObject::connect(ex, &vfg::extractor::BaseExtractor::requestReady, &loop,
+                         [&failures](const QNetworkRequest& request) {
+            if(QUrlQuery(request.url()).queryItemValue("signature").isEmpty()) {
+                ++failures;
+            }
+        });
+        QObject::connect(ex, &vfg::extractor::BaseExtractor::logReady, [](const QString& msg) {
+            qCDebug(BENCHMARK) << msg;
+        });
+
+        // Video IDs are 11 characters
+        ex->fetchStreams(QUrl(QString("https://www.youtube.com/watch?v=fixture%1").arg(i, 4, 10, QChar('0'))));
+        extractors.push_back(std::move(extractor));
+    }
+
+    QTimer::singleShot(timeout, &loop, &QEventLoop::quit);
+    if(samples.size() < count) {
+        loop.exec();
+    }
+
+    if(samples.size() < count) {
+        throw std::runtime_error(QString("%1 of %2 URLs were not resolved in time")
+                                 .arg(count - samples.size()).arg(count).toStdString());
+    }
+    else if(failures > 0) {
+        throw std::runtime_error(QString("%1 of %2 URLs resolved without a decrypted stream")
+                                 .arg(failures).arg(count).toStdString());
+    }
+
+    return samples;
+}
+
+/**
+ * @brief Pad a page with filler markup to a typical watch page size
+ *
+ * Real watch pages have most of their markup around the player
+ * config, so half of the filler goes before it and half after.
+ *
+ * @param page Recorded page
+ * @param size Size of the padded page in bytes
+ * @return Padded page
+ */
+QByteArray padPage(const QByteArray& page, const int size) {
+    static const QByteArray filler(
+                "<li class=\"video-list-item\"><a href=\"/watch?v=related0000\" "
+                "class=\"content-link\" title=\"Related video\"><span class=\"title\">"
+                "Related video</span><span class=\"stat view-count\">1,234 views</span></a></li>\n");
+
+    const int scriptPos = std::max(0, page.indexOf("<script>"));
+    QByteArray padding;
+    while(padding.size() + page.size() < size) {
+        padding.append(filler);
+    }
+
+    const int half = padding.size() / 2;
+    QByteArray padded;
+    padded.reserve(page.size() + padding.size() + 64);
+    padded.append(page.left(scriptPos));
+    padded.append(padding.left(half));
+    padded.append(page.mid(scriptPos));
+    padded.append("<script>var ytInitialData = {\"contents\":[]};</script>\n");
+    padded.append(padding.mid(half));
+
+    return padded;
+}
+
+} // namespace
+
+namespace vfg {
+namespace benchmark {
+
+ExtractorBenchmark::ExtractorBenchmark(const Options& options) :
+    opts(options)
+{
+}
+
+QStringList ExtractorBenchmark::scenarios()
+{
+    static const QStringList names {
+        "extract-batch", "extract-batch-cached", "extract-parse"
+    };
+    return names;
+}
+
+ScenarioResult ExtractorBenchmark::parsePages()
+{
+    QFile file(QString("%1/watch").arg(opts.fixtures));
+    if(!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error(QString("Unable to open %1").arg(file.fileName()).toStdString());
+    }
+
+    const QByteArray page = padPage(file.readAll(), opts.pageSize);
+
+    ScenarioResult result;
+    result.name = "extract-parse";
+
+    QElapsedTimer total;
+    total.start();
+    for(int i = 0; i < opts.batch; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+
+        const QString player = vfg::extractor::YoutubeExtractor::findPlayer(page);
+        const QByteArray config = vfg::extractor::YoutubeExtractor::findPlayerConfig(page);
+        const auto parsed = vfg::extractor::YoutubeExtractor::parsePlayerConfig(config);
+
+        result.samples.append(timer.nsecsElapsed() / 1000);
+
+        if(!parsed.available || parsed.streamMap.split(',').size() != 2
+                || parsed.player.isEmpty() || parsed.player != player) {
+            throw std::runtime_error("Recorded watch page was not parsed correctly");
+        }
+    }
+    result.wallTime = total.nsecsElapsed() / 1000;
+    result.bytes = static_cast<qint64>(page.size()) * opts.batch;
+
+    return result;
+}
+
+ScenarioResult ExtractorBenchmark::run(const QString& scenario)
+{
+    if(!scenarios().contains(scenario)) {
+        throw std::invalid_argument("Unknown scenario: " + scenario.toStdString());
+    }
+
+    qCDebug(BENCHMARK) << "Running scenario" << scenario;
+
+    if(scenario == "extract-parse") {
+        return parsePages();
+    }
+
+    LocalHttpServer server(QByteArray(), LocalHttpServer::Options());
+    server.setDocumentRoot(opts.fixtures);
+    const ServerThread serverThread(server);
+    const QUrl serverUrl = server.url(QString());
+
+    const QTemporaryDir cacheDir;
+    if(!cacheDir.isValid()) {
+        throw std::runtime_error("Unable to create temporary directory");
+    }
+
+    // Fill the disk cache in a previous "session"
+    if(scenario == "extract-batch-cached") {
+        auto primer = std::make_shared<vfg::extractor::YoutubePlayerCache>(cacheDir.path());
+        primer->setNetworkManager(vfg::make_unique<StandInNetworkAccessManager>(serverUrl));
+        resolveBatch(primer, serverUrl, 1, opts.timeout);
+    }
+
+    auto cache = std::make_shared<vfg::extractor::YoutubePlayerCache>(cacheDir.path());
+    cache->setNetworkManager(vfg::make_unique<StandInNetworkAccessManager>(serverUrl));
+
+    ScenarioResult result;
+    result.name = scenario;
+
+    QElapsedTimer total;
+    total.start();
+    result.samples = resolveBatch(cache, serverUrl, opts.batch, opts.timeout);
+    result.wallTime = total.nsecsElapsed() / 1000;
+
+    const int expectedFetches = scenario == "extract-batch-cached" ? 0 : 1;
+    if(cache->fetchCount() != expectedFetches) {
+        throw std::runtime_error(QString("Player script was fetched %1 times, expected %2")
+                                 .arg(cache->fetchCount()).arg(expectedFetches).toStdString());
+    }
+
+    qCDebug(BENCHMARK) << "Server handled" << server.requestCount() << "requests";
+
+    return result;
+}
+
+} // namespace benchmark
+} // namespace vfg
@@ -0,0 +1,80 @@
+#ifndef VFG_BENCHMARK_EXTRACTORBENCHMARK_HPP
+#define VFG_BENCHMARK_EXTRACTORBENCHMARK_HPP
+
+#include <QString>
+#include <QStringList>
+#include "benchmarkrunner.hpp"
+
+namespace vfg {
+namespace benchmark {
+
+/**
+ * @brief The ExtractorBenchmark class
+ *
+ * Resolves a batch of YouTube URLs at the same time against recorded
+ * responses served by a \link LocalHttpServer \endlink. Every request
+ * of the extractors is redirected to the local server, which serves
+ * the file at the request's path in the fixture directory.
+ *
+ * The parse scenario measures only the page parsing of the extractor
+ * on the recorded watch page, without the network.
+ */
+class ExtractorBenchmark
+{
+public:
+    /**
+     * @brief Scenario options
+     */
+    struct Options
+    {
+        //! Directory of the recorded responses
+        QString fixtures {"fixtures/youtube"};
+
+        //! Number of URLs resolved at the same time
+        int batch {100};
+
+        //! Maximum duration of the batch in milliseconds
+        int timeout {60000};
+
+        //! Size the watch page is padded to in the parse scenario, in bytes
+        int pageSize {512 * 1024};
+    };
+
+    /**
+     * @brief Constructor
+     * @param options Scenario options
+     */
+    explicit ExtractorBenchmark(const Options& options);
+
+    /**
+     * @brief Get names of all scenarios
+     * @return Scenario names
+     */
+    static QStringList scenarios();
+
+    /**
+     * @brief Run a scenario
+     * @param scenario Scenario name
+     * @exception std::invalid_argument If scenario is unknown
+     * @exception std::runtime_error If a URL is not resolved, the player
+     *            script is fetched more than once or the page is not parsed
+     * @return Scenario timings, one sample per URL from the start of the batch
+     *         or per parsed page
+     */
+    ScenarioResult run(const QString& scenario);
+
+private:
+    Options opts;
+
+    /**
+     * @brief Parse the recorded watch page repeatedly
+     * @exception std::runtime_error If the page is missing or not parsed correctly
+     * @return Scenario timings, one sample per parsed page
+     */
+    ScenarioResult parsePages();
+};
+
+} // namespace benchmark
+} // namespace vfg
+
+#endif // VFG_BENCHMARK_EXTRACTORBENCHMARK_HPP
@@ -0,0 +1,5 @@
+(function(g){
+function Zz(a){a=a.split("");Xy.cd(a,0);Xy.ab(a,2);Xy.ef(a,3);return a.join("")}
+var Xy={cd:function(a){a.reverse()},ab:function(a,b){a.splice(0,b)},ef:function(a,b){var c=a[0];a[0]=a[b%a.length];a[b]=c}};
+g.signature=function(c){return c.sig||Zz(c.s)};
+})(this);
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <QDir>
+#include <QFile>
+#include <QHostAddress>
+#include <QList>
+#include <QMetaObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include "localhttpserver.hpp"
+
+namespace {
+
+//! Interval between writes of a bandwidth limited response
+constexpr int ThrottleInterval = 50;
+
+} // namespace
+
+namespace vfg {
+namespace benchmark {
+
+LocalHttpServer::LocalHttpServer(const QByteArray& payload, const Options& options,
+                                 QObject *parent) :
+    QTcpServer(parent),
+    content(payload),
+    opts(options)
+{
+}
+
+QUrl LocalHttpServer::url(const QString& fileName) const
+{
+    return QUrl(QString("http://127.0.0.1:%1/%2").arg(serverPort()).arg(fileName));
+}
+
+int LocalHttpServer::requestCount() const
+{
+    return requests;
+}
+
+int LocalHttpServer::requestCount(const QString& path) const
+{
+    return pathRequests.value(path);
+}
+
+void LocalHttpServer::setDocumentRoot(const QString& path)
+{
+    documentRoot = QDir::cleanPath(QDir(path).absolutePath());
+}
+
+bool LocalHttpServer::listenLocal()
+{
+    return listen(QHostAddress::LocalHost);
+}
+
+void LocalHttpServer::incomingConnection(const qintptr socketDescriptor)
+{
+    auto socket = new QTcpSocket(this);
+    if(!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        return;
+    }
+
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+    auto buffer = std::make_shared<QByteArray>();
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket, buffer]() {
+        buffer->append(socket->readAll());
+        const int headerEnd = buffer->indexOf("\r\n\r\n");
+        if(headerEnd < 0) {
+            return;
+        }
+
+        const QByteArray header = buffer->left(headerEnd);
+        buffer->clear();
+        respond(socket, header);
+    });
+}
+
+void LocalHttpServer::respond(QTcpSocket *socket, const QByteArray& header)
+{
+    ++requests;
+
+    const QList<QByteArray> lines = header.split('\n');
+    const QList<QByteArray> requestLine = lines.first().split(' ');
+    const QByteArray method = requestLine.first().trimmed();
+    const QString path = QString::fromLatin1(requestLine.value(1).split('?').first());
+    ++pathRequests[path];
+
+    QByteArray file;
+    if(!documentRoot.isEmpty()) {
+        // Keep requests inside the document root
+        const QString filePath = QDir::cleanPath(documentRoot + path);
+        QFile recorded(filePath);
+        if(!filePath.startsWith(documentRoot + "/") || !recorded.open(QIODevice::ReadOnly)) {
+            socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n"
+                          "Connection: close\r\n\r\n");
+            socket->disconnectFromHost();
+            return;
+        }
+
+        file = recorded.readAll();
+    }
+    const QByteArray& served = documentRoot.isEmpty() ? content : file;
+
+    qint64 first = 0;
+    qint64 last = served.size() - 1;
+    bool partial = false;
+    for(const QByteArray& line : lines) {
+        const QByteArray trimmed = line.trimmed();
+        if(!opts.acceptRanges || !trimmed.toLower().startsWith("range: bytes=")) {
+            continue;
+        }
+
+        const QList<QByteArray> range = trimmed.mid(13).split('-');
+        first = range.value(0).toLongLong();
+        if(!range.value(1).isEmpty()) {
+            last = std::min(last, range.value(1).toLongLong());
+        }
+        partial = true;
+    }
+
+    if(first > last) {
+        socket->write("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Length: 0\r\n"
+                      "Connection: close\r\n\r\n");
+        socket->disconnectFromHost();
+        return;
+    }
+
+    const qint64 length = last - first + 1;
+    QByteArray response = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+    response += "Content-Type: application/octet-stream\r\n";
+    response += "Content-Length: " + QByteArray::number(length) + "\r\n";
+    if(opts.acceptRanges) {
+        response += "Accept-Ranges: bytes\r\n";
+    }
+    if(partial) {
+        response += "Content-Range: bytes " + QByteArray::number(first) + "-"
+                + QByteArray::number(last) + "/" + QByteArray::number(served.size()) + "\r\n";
+    }
+    response += "Connection: close\r\n\r\n";
+    socket->write(response);
+
+    if(method == "HEAD") {
+        socket->disconnectFromHost();
+        return;
+    }
+
+    QByteArray body = served.mid(static_cast<int>(first), static_cast<int>(length));
+    if(opts.failEveryNth > 0 && requests % opts.failEveryNth == 0) {
+        body.truncate(body.size() / 2);
+    }
+
+    if(opts.bytesPerSecond <= 0) {
+        socket->write(body);
+        socket->disconnectFromHost();
+        return;
+    }
+
+    const int chunkSize = static_cast<int>(std::max<qint64>(1, opts.bytesPerSecond * ThrottleInterval / 1000));
+    auto offset = std::make_shared<int>(0);
+    auto timer = new QTimer(socket);
+    connect(timer, &QTimer::timeout, socket, [socket, timer, body, offset, chunkSize]() {
+        socket->write(body.mid(*offset, chunkSize));
+        *offset += chunkSize;
+        if(*offset >= body.size()) {
+            timer->stop();
+            socket->disconnectFromHost();
+        }
+    });
+    timer->start(ThrottleInterval);
+}
+
+ServerThread::ServerThread(LocalHttpServer& server)
+{
+    server.moveToThread(&thread);
+    thread.start();
+
+    bool listening = false;
+    QMetaObject::invokeMethod(&server, "listenLocal", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, listening));
+    if(!listening) {
+        thread.quit();
+        thread.wait();
+        throw std::runtime_error("Unable to start local HTTP server");
+    }
+}
+
+ServerThread::~ServerThread()
+{
+    thread.quit();
+    thread.wait();
+}
+
+} // namespace benchmark
+} // namespace vfg
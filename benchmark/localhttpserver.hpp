@@ -0,0 +1,144 @@
+#ifndef VFG_BENCHMARK_LOCALHTTPSERVER_HPP
+#define VFG_BENCHMARK_LOCALHTTPSERVER_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QTcpServer>
+#include <QThread>
+
+class QTcpSocket;
+class QUrl;
+
+namespace vfg {
+namespace benchmark {
+
+/**
+ * @brief The LocalHttpServer class
+ *
+ * Minimal HTTP/1.1 server that serves a single in-memory payload.
+ * Supports HEAD and GET requests with single byte ranges, a per
+ * connection bandwidth limit and dropped connections so that
+ * downloads can be measured without an external server.
+ *
+ * With a document root the server serves recorded responses from
+ * files instead, so that it can stand in for a remote site.
+ */
+class LocalHttpServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Server behaviour
+     */
+    struct Options
+    {
+        //! Advertise and honor byte ranges
+        bool acceptRanges {true};
+
+        //! Close every Nth GET response halfway through the body (0 = never)
+        int failEveryNth {0};
+
+        //! Bandwidth limit per connection in bytes per second (0 = unlimited)
+        qint64 bytesPerSecond {0};
+    };
+
+    /**
+     * @brief Constructor
+     * @param payload Content served for every path
+     * @param options Server behaviour
+     * @param parent Owner of the object
+     */
+    LocalHttpServer(const QByteArray& payload, const Options& options, QObject *parent = 0);
+
+    /**
+     * @brief Get URL to the payload
+     * @pre Server must be listening
+     * @param fileName File name used in the URL path
+     * @return URL
+     */
+    QUrl url(const QString& fileName) const;
+
+    /**
+     * @brief Get number of requests served
+     * @return Number of requests
+     */
+    int requestCount() const;
+
+    /**
+     * @brief Get number of requests for a path
+     * @param path URL path without the query
+     * @return Number of requests
+     */
+    int requestCount(const QString& path) const;
+
+    /**
+     * @brief Serve files from a directory instead of the payload
+     *
+     * The URL path, without the query, is the path to the file
+     * relative to the directory. Missing files return 404.
+     * Must be set before the server is moved to another thread.
+     *
+     * @param path Directory
+     */
+    void setDocumentRoot(const QString& path);
+
+    /**
+     * @brief Listen on the loopback interface
+     *
+     * Invokable so that the server can listen in its own thread
+     *
+     * @return True on success, otherwise false
+     */
+    Q_INVOKABLE bool listenLocal();
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+    QByteArray content;
+    Options opts;
+    int requests {0};
+    QHash<QString, int> pathRequests;
+    QString documentRoot;
+
+    /**
+     * @brief Write response to a request
+     * @param socket Client connection
+     * @param header Request line and headers
+     */
+    void respond(QTcpSocket *socket, const QByteArray& header);
+};
+
+/**
+ * @brief Runs a \link LocalHttpServer \endlink in its own thread
+ *
+ * Keeps the server's work out of the CPU time measured in the main
+ * thread. The thread is stopped when the object is destroyed.
+ */
+class ServerThread
+{
+public:
+    /**
+     * @brief Move server to a new thread and start listening
+     * @param server Server, must outlive this object
+     * @exception std::runtime_error If the server can't listen
+     */
+    explicit ServerThread(LocalHttpServer& server);
+
+    /**
+     * Destructor
+     *
+     * Stops the thread
+     */
+    ~ServerThread();
+
+private:
+    QThread thread;
+};
+
+} // namespace benchmark
+} // namespace vfg
+
+#endif // VFG_BENCHMARK_LOCALHTTPSERVER_HPP
@@ -0,0 +1,282 @@
+#include <exception>
+#include <memory>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include "abstractvideosource.h"
+#include "syntheticvideosource.h"
+#include "videoframegrabber.h"
+#include "videosourceinstrumentation.h"
+#include "y4mvideosource.h"
+#include "benchmarkrunner.hpp"
+#include "batchbenchmark.hpp"
+#include "discbenchmark.hpp"
+#include "downloadbenchmark.hpp"
+#include "extractorbenchmark.hpp"
+#include "scriptbenchmark.hpp"
+
+#ifdef Q_OS_WIN
+#include "avisynthvideosource.h"
+#endif
+
+namespace {
+
+/**
+ * @brief Parse resolution from a string such as 1920x1080
+ * @param str String to parse
+ * @return Parsed resolution, invalid size on error
+ */
+QSize parseResolution(const QString& str)
+{
+    const QStringList parts = str.split('x');
+    if(parts.size() != 2) {
+        return {};
+    }
+
+    return QSize(parts.at(0).toInt(), parts.at(1).toInt());
+}
+
+/**
+ * @brief Create video source for the benchmark
+ * @param source Source name ("synthetic" or path to a video or script)
+ * @param resolution Resolution of the synthetic video and headerless YUV files
+ * @param numFrames Number of frames in the synthetic video
+ * @param latency Decode latency of the synthetic video in microseconds
+ * @exception std::runtime_error If the source is not supported on this platform
+ * @return Video source
+ */
+std::shared_ptr<vfg::core::AbstractVideoSource> createSource(const QString& source,
+                                                             const QSize& resolution,
+                                                             const int numFrames,
+                                                             const int latency)
+{
+    if(source == "synthetic") {
+        return std::make_shared<vfg::core::SyntheticVideoSource>(resolution, numFrames, latency);
+    }
+    else if(source.endsWith(".y4m", Qt::CaseInsensitive)
+            || source.endsWith(".yuv", Qt::CaseInsensitive)) {
+        auto y4mSource = std::make_shared<vfg::core::Y4mVideoSource>();
+        y4mSource->setRawFormat(resolution, vfg::core::Y4mVideoSource::Chroma::C420);
+        return y4mSource;
+    }
+
+#ifdef Q_OS_WIN
+    return std::make_shared<vfg::core::AvisynthVideoSource>();
+#else
+    throw std::runtime_error("Avisynth scripts are only supported on Windows");
+#endif
+}
+
+/**
+ * @brief Create the application
+ *
+ * Scenarios that use icons need a QGuiApplication, the others
+ * run without a display
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @return Application
+ */
+QCoreApplication* createApplication(int& argc, char *argv[])
+{
+    for(int idx = 1; idx < argc; ++idx) {
+        for(const QString& scenario : vfg::benchmark::BenchmarkRunner::guiScenarios()) {
+            if(QString::fromLocal8Bit(argv[idx]).contains(scenario)) {
+                return new QGuiApplication(argc, argv);
+            }
+        }
+    }
+
+    return new QCoreApplication(argc, argv);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) try
+{
+    QScopedPointer<QCoreApplication> a(createApplication(argc, argv));
+    a->setApplicationName("screenpicker-benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures frame throughput of the ScreenPicker frame pipeline");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"source", "Video source: \"synthetic\", path to a .y4m or 4:2:0 .yuv file, "
+            "or path to an Avisynth script (Windows only).", "source", "synthetic"},
+        {"resolution", "Resolution of the synthetic video and .yuv files.", "WxH", "1920x1080"},
+        {"frames", "Number of frames in the synthetic video.", "count", "100000"},
+        {"latency", "Decode latency of the synthetic video.", "microseconds", "0"},
+        {"count", "Number of operations per scenario.", "count", "500"},
+        {"stride", "Frame step for strided scenarios.", "frames", "100"},
+        {"seed", "Seed for random access.", "seed", "1"},
+        {"scenarios", "Comma separated list of scenarios to run: "
+            + (vfg::benchmark::BenchmarkRunner::scenarios()
+               + vfg::benchmark::BenchmarkRunner::guiScenarios()
+               + vfg::benchmark::DownloadBenchmark::scenarios()
+               + vfg::benchmark::ExtractorBenchmark::scenarios()
+               + vfg::benchmark::DiscBenchmark::scenarios()
+               + vfg::benchmark::ScriptBenchmark::scenarios()
+               + vfg::benchmark::BatchBenchmark::scenarios()).join(", ") + ".",
+            "list", vfg::benchmark::BenchmarkRunner::scenarios().join(",")},
+        {"download-size", "Size of the file in download scenarios.", "MB", "64"},
+        {"download-repeat", "Number of downloads per download scenario.", "count", "3"},
+        {"segments", "Maximum number of segments in segmented downloads.", "count", "4"},
+        {"throttle", "Bandwidth limit per connection in download scenarios (0 = unlimited).",
+            "KB/s", "0"},
+        {"fail-every", "Drop every Nth response of the local HTTP server (0 = never).", "count", "0"},
+        {"read-buffer", "Read buffer per connection in download scenarios (0 = unlimited).",
+            "KB", "1024"},
+        {"write-buffer", "Size of the blocks written to disk in download scenarios.", "KB", "1024"},
+        {"fixtures", "Directory of recorded responses for extractor scenarios.", "path",
+            "fixtures/youtube"},
+        {"batch", "Number of URLs resolved at the same time in extractor scenarios.", "count", "100"},
+        {"page-size", "Size the watch page is padded to in the extract-parse scenario.", "KB", "512"},
+        {"indexer", "Indexer executable for disc scenarios.", "path",
+            QDir(a->applicationDirPath()).absoluteFilePath("dgindex-standin")},
+        {"titles", "Number of titles on the generated disc in disc scenarios.", "count", "4"},
+        {"title-size", "Size of each title in disc scenarios.", "MB", "64"},
+        {"indexer-delay", "Time the stand-in indexer spends per percent.", "milliseconds", "5"},
+        {"index-jobs", "Maximum number of indexer processes at once (0 = number of cores).",
+            "count", "0"},
+        {"template", "Script template for script scenarios.", "path", "../default_template.avs"},
+        {"format", "Output format: json or csv.", "format", "json"},
+        {"output", "Write results to file instead of standard output.", "path"},
+        {"timings", "Write decode time histograms to file.", "path"}
+    });
+    parser.process(*a);
+
+    const QString source = parser.value("source");
+    const QSize resolution = parseResolution(parser.value("resolution"));
+    auto videoSource = createSource(source, resolution, parser.value("frames").toInt(),
+                                    parser.value("latency").toInt());
+
+    std::shared_ptr<vfg::core::HistogramInstrumentation> timings;
+    if(parser.isSet("timings")) {
+        timings = std::make_shared<vfg::core::HistogramInstrumentation>();
+        videoSource->setInstrumentation(timings);
+    }
+
+    videoSource->load(source);
+
+    auto frameGrabber = std::make_shared<vfg::core::VideoFrameGrabber>(videoSource);
+
+    vfg::benchmark::BenchmarkRunner::Options options;
+    options.count = parser.value("count").toInt();
+    options.stride = parser.value("stride").toInt();
+    options.seed = parser.value("seed").toUInt();
+
+    vfg::benchmark::BenchmarkRunner runner(frameGrabber, options);
+
+    vfg::benchmark::DownloadBenchmark::Options downloadOptions;
+    downloadOptions.size = parser.value("download-size").toLongLong() * 1000 * 1000;
+    downloadOptions.repeat = parser.value("download-repeat").toInt();
+    downloadOptions.segments = parser.value("segments").toInt();
+    downloadOptions.bytesPerSecond = parser.value("throttle").toLongLong() * 1000;
+    downloadOptions.failEveryNth = parser.value("fail-every").toInt();
+    downloadOptions.readBufferSize = parser.value("read-buffer").toLongLong() * 1024;
+    downloadOptions.writeBufferSize = parser.value("write-buffer").toInt() * 1024;
+
+    vfg::benchmark::ExtractorBenchmark::Options extractorOptions;
+    extractorOptions.fixtures = parser.value("fixtures");
+    extractorOptions.batch = parser.value("batch").toInt();
+    extractorOptions.pageSize = parser.value("page-size").toInt() * 1024;
+
+    vfg::benchmark::DiscBenchmark::Options discOptions;
+    discOptions.indexer = parser.value("indexer");
+    discOptions.titles = parser.value("titles").toInt();
+    discOptions.titleSize = parser.value("title-size").toLongLong() * 1000 * 1000;
+    discOptions.indexerDelay = parser.value("indexer-delay").toInt();
+    discOptions.maxJobs = parser.value("index-jobs").toInt();
+
+    vfg::benchmark::ScriptBenchmark::Options scriptOptions;
+    scriptOptions.templatePath = parser.value("template");
+    scriptOptions.count = parser.value("count").toInt();
+
+    vfg::benchmark::BatchBenchmark::Options batchOptions;
+
+    QList<vfg::benchmark::ScenarioResult> results;
+    for(const QString& name : parser.value("scenarios").split(',', QString::SkipEmptyParts)) {
+        const QString scenario = name.trimmed();
+        if(vfg::benchmark::DownloadBenchmark::scenarios().contains(scenario)) {
+            vfg::benchmark::DownloadBenchmark downloads(downloadOptions);
+            results.append(downloads.run(scenario));
+        }
+        else if(vfg::benchmark::ExtractorBenchmark::scenarios().contains(scenario)) {
+            vfg::benchmark::ExtractorBenchmark extractors(extractorOptions);
+            results.append(extractors.run(scenario));
+        }
+        else if(vfg::benchmark::DiscBenchmark::scenarios().contains(scenario)) {
+            vfg::benchmark::DiscBenchmark discs(discOptions);
+            results.append(discs.run(scenario));
+        }
+        else if(vfg::benchmark::ScriptBenchmark::scenarios().contains(scenario)) {
+            vfg::benchmark::ScriptBenchmark scripts(scriptOptions);
+            results.append(scripts.run(scenario));
+        }
+        else if(vfg::benchmark::BatchBenchmark::scenarios().contains(scenario)) {
+            vfg::benchmark::BatchBenchmark batches(batchOptions);
+            results.append(batches.run(scenario));
+        }
+        else {
+            results.append(runner.run(scenario));
+        }
+    }
+
+    QString out;
+    QTextStream ts(&out);
+    if(parser.value("format") == "csv") {
+        ts << vfg::benchmark::ScenarioResult::csvHeader() << "\n";
+        for(const auto& result : results) {
+            ts << result.toCsv() << "\n";
+        }
+    }
+    else {
+        const QSize videoSize = videoSource->resolution();
+
+        QJsonArray scenarios;
+        for(const auto& result : results) {
+            scenarios.append(result.toJson());
+        }
+
+        QJsonObject root;
+        root.insert("source", source);
+        root.insert("resolution", QString("%1x%2").arg(videoSize.width()).arg(videoSize.height()));
+        root.insert("frames", videoSource->getNumFrames());
+        root.insert("scenarios", scenarios);
+        ts << QJsonDocument(root).toJson();
+    }
+    ts.flush();
+
+    if(parser.isSet("output")) {
+        QFile outFile(parser.value("output"));
+        if(!outFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+            throw std::runtime_error("Unable to open output file");
+        }
+
+        QTextStream(&outFile) << out;
+    }
+    else {
+        QTextStream(stdout) << out;
+    }
+
+    if(timings && !timings->dump(parser.value("timings"))) {
+        throw std::runtime_error("Unable to write timings file");
+    }
+
+    return 0;
+}
+catch(const std::exception& ex) {
+    QTextStream(stderr) << "Error: " << ex.what() << endl;
+
+    return 1;
+}
@@ -0,0 +1,78 @@
+#include <stdexcept>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QRect>
+#include <QSize>
+#include <QVariant>
+#include "scriptparser.h"
+#include "scriptbenchmark.hpp"
+
+Q_DECLARE_LOGGING_CATEGORY(BENCHMARK)
+
+namespace vfg {
+namespace benchmark {
+
+ScriptBenchmark::ScriptBenchmark(const Options& options) :
+    opts(options)
+{
+}
+
+QStringList ScriptBenchmark::scenarios()
+{
+    static const QStringList names {
+        "script-render-cold", "script-render-changed", "script-render-cached"
+    };
+    return names;
+}
+
+ScenarioResult ScriptBenchmark::run(const QString& scenario)
+{
+    if(!scenarios().contains(scenario)) {
+        throw std::invalid_argument("Unknown scenario: " + scenario.toStdString());
+    }
+
+    qCDebug(BENCHMARK) << "Running scenario" << scenario;
+
+    vfg::ScriptParser parser("C:/video/source.mkv");
+    parser.setTemplate(opts.templatePath);
+    vfg::ScriptParser::clearCache();
+
+    QMap<QString, QVariant> settings;
+    settings.insert("avisynthpluginspath", "C:/avisynth/plugins");
+    settings.insert("deinterlace", true);
+    settings.insert("crop", QRect(8, 4, 8, 4));
+
+    ScenarioResult result;
+    result.name = scenario;
+
+    QElapsedTimer total;
+    total.start();
+    for(int i = 0; i < opts.count; ++i) {
+        if(scenario == "script-render-cold") {
+            vfg::ScriptParser::clearCache();
+        }
+
+        // Every render of the changed scenario has settings not seen before
+        const int width = scenario == "script-render-cached" ? 1280 : 640 + i;
+        settings.insert("resize", QSize(width, 720));
+
+        QElapsedTimer timer;
+        timer.start();
+
+        const QString script = parser.parse(settings);
+
+        result.samples.append(timer.nsecsElapsed() / 1000);
+        result.bytes += script.size();
+
+        if(!script.contains(QString("%1,720").arg(width))) {
+            throw std::runtime_error("Rendered script doesn't contain the settings");
+        }
+    }
+    result.wallTime = total.nsecsElapsed() / 1000;
+
+    return result;
+}
+
+} // namespace benchmark
+} // namespace vfg
@@ -0,0 +1,64 @@
+#ifndef VFG_BENCHMARK_SCRIPTBENCHMARK_HPP
+#define VFG_BENCHMARK_SCRIPTBENCHMARK_HPP
+
+#include <QString>
+#include <QStringList>
+#include "benchmarkrunner.hpp"
+
+namespace vfg {
+namespace benchmark {
+
+/**
+ * @brief The ScriptBenchmark class
+ *
+ * Measures the latency of rendering an Avisynth script from a template
+ * with \link vfg::ScriptParser \endlink, as done on every video settings
+ * change. The cold scenario reads and parses the template every time,
+ * the changed scenario renders new settings from a cached template and
+ * the cached scenario renders the same settings again.
+ */
+class ScriptBenchmark
+{
+public:
+    /**
+     * @brief Scenario options
+     */
+    struct Options
+    {
+        //! Path to the script template
+        QString templatePath {"../default_template.avs"};
+
+        //! Number of renders per scenario
+        int count {500};
+    };
+
+    /**
+     * @brief Constructor
+     * @param options Scenario options
+     */
+    explicit ScriptBenchmark(const Options& options);
+
+    /**
+     * @brief Get names of all scenarios
+     * @return Scenario names
+     */
+    static QStringList scenarios();
+
+    /**
+     * @brief Run a scenario
+     * @param scenario Scenario name
+     * @exception std::invalid_argument If scenario is unknown
+     * @exception std::runtime_error If the template can't be read or
+     *            the script doesn't contain the settings
+     * @return Scenario timings, one sample per render
+     */
+    ScenarioResult run(const QString& scenario);
+
+private:
+    Options opts;
+};
+
+} // namespace benchmark
+} // namespace vfg
+
+#endif // VFG_BENCHMARK_SCRIPTBENCHMARK_HPP
@@ -37,6 +37,12 @@ vfg::ConfigDialog::ConfigDialog(QWidget *parent) :
     ui.cbSaveDgindexFiles->setChecked(saveDgIndexFiles);
     ui.cbShowVideoSettings->setChecked(cfg.value("showvideosettings").toBool());
     ui.cbResumeGeneratorAfterClear->setChecked(cfg.value("resumegeneratorafterclear").toBool());
+    ui.cbLiveScrubbing->setChecked(cfg.value("livescrubbing").toBool());
+    ui.cbKeyframeSeeking->setChecked(cfg.value("keyframeseeking").toBool());
+    ui.cbQualityFilter->setChecked(cfg.value("qualityfilter").toBool());
+    ui.spinQualitySearchWindow->setValue(cfg.value("qualitysearchwindow").toInt());
+    ui.cbSpillStore->setChecked(cfg.value("spillstore").toBool());
+    ui.cbSpillCompression->setChecked(cfg.value("spillcompression").toBool());
     ui.editImageMagickPath->setText(cfg.value("imagemagickpath").toString());
     ui.editGifsiclePath->setText(cfg.value("gifsiclepath").toString());
 
@@ -45,6 +51,11 @@ vfg::ConfigDialog::ConfigDialog(QWidget *parent) :
 
     ui.editX264Path->setText(cfg.value("x264path").toString());
     ui.cacheFolder->setText(cfg.value("cachedirectory").toString());
+    ui.spinDownloadSegments->setValue(cfg.value("downloadsegments").toInt());
+    ui.spinDownloadReadBuffer->setValue(cfg.value("downloadreadbuffer").toInt());
+    ui.spinDownloadMaxActive->setValue(cfg.value("downloadmaxactive").toInt());
+    ui.spinDownloadMaxPerHost->setValue(cfg.value("downloadmaxperhost").toInt());
+    ui.spinDownloadBandwidth->setValue(cfg.value("downloadbandwidth").toInt());
 }
 
 void vfg::ConfigDialog::on_buttonBox_rejected()
@@ -69,10 +80,21 @@ void vfg::ConfigDialog::on_buttonBox_accepted()
     cfg.setValue("savedgindexfiles", ui.cbSaveDgindexFiles->isChecked());
     cfg.setValue("showvideosettings", ui.cbShowVideoSettings->isChecked());
     cfg.setValue("resumegeneratorafterclear", ui.cbResumeGeneratorAfterClear->isChecked());
+    cfg.setValue("livescrubbing", ui.cbLiveScrubbing->isChecked());
+    cfg.setValue("keyframeseeking", ui.cbKeyframeSeeking->isChecked());
+    cfg.setValue("qualityfilter", ui.cbQualityFilter->isChecked());
+    cfg.setValue("qualitysearchwindow", ui.spinQualitySearchWindow->value());
+    cfg.setValue("spillstore", ui.cbSpillStore->isChecked());
+    cfg.setValue("spillcompression", ui.cbSpillCompression->isChecked());
     cfg.setValue("imagemagickpath", ui.editImageMagickPath->text());
     cfg.setValue("gifsiclepath", ui.editGifsiclePath->text());
     cfg.setValue("x264path", ui.editX264Path->text());
     cfg.setValue("cachedirectory", ui.cacheFolder->text());
+    cfg.setValue("downloadsegments", ui.spinDownloadSegments->value());
+    cfg.setValue("downloadreadbuffer", ui.spinDownloadReadBuffer->value());
+    cfg.setValue("downloadmaxactive", ui.spinDownloadMaxActive->value());
+    cfg.setValue("downloadmaxperhost", ui.spinDownloadMaxPerHost->value());
+    cfg.setValue("downloadbandwidth", ui.spinDownloadBandwidth->value());
 }
 
 void vfg::ConfigDialog::on_btnDgindexPath_clicked()
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <utility>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QThread>
+#include "discjobmanager.h"
+#include "dvdprocessor.h"
+#include "ptrutil.hpp"
+
+Q_LOGGING_CATEGORY(DISCJOBS, "discjobmanager")
+
+namespace {
+
+//! Bytes hashed from the start, middle and end of each file
+constexpr qint64 SampleSize = 64 * 1024;
+
+QRegularExpression titleSetRx() {
+    static const QRegularExpression rx("^VTS_(\\d\\d)_(\\d+)\\.VOB$", QRegularExpression::CaseInsensitiveOption);
+    return rx;
+}
+
+/**
+ * @brief Get user visible name of a title
+ * @param files Files of the title
+ * @return Title name
+ */
+QString titleName(const QStringList& files) {
+    const QFileInfo first(files.first());
+    const QRegularExpressionMatch titleSet = titleSetRx().match(first.fileName());
+    if(titleSet.hasMatch()) {
+        return QString("VTS_%1").arg(titleSet.captured(1));
+    }
+
+    return first.completeBaseName();
+}
+
+} // namespace
+
+namespace vfg {
+
+DiscJobManager::DiscJobManager(const QString& processor, const QString& cacheDir, QObject *parent) :
+    QObject(parent),
+    processorPath(processor),
+    cacheDirectory(cacheDir),
+    maxJobs(std::max(1, QThread::idealThreadCount()))
+{
+    if(!QDir().mkpath(cacheDirectory)) {
+        qCWarning(DISCJOBS) << "Unable to create" << cacheDirectory;
+    }
+}
+
+DiscJobManager::~DiscJobManager()
+{
+    for(const auto& job : jobs) {
+        if(job->processor) {
+            job->processor->disconnect(this);
+            job->processor->handleAbortProcess();
+        }
+    }
+}
+
+QList<QStringList> DiscJobManager::splitTitles(const QStringList& files)
+{
+    QMap<int, QMap<int, QString>> titleSets;
+    QStringList others;
+    for(const QString& file : files) {
+        const QRegularExpressionMatch titleSet = titleSetRx().match(QFileInfo(file).fileName());
+        if(titleSet.hasMatch()) {
+            titleSets[titleSet.captured(1).toInt()].insert(titleSet.captured(2).toInt(), file);
+        }
+        else {
+            others.append(file);
+        }
+    }
+
+    QList<QStringList> titles;
+    for(QMap<int, QString> parts : titleSets) {
+        // VTS_NN_0 holds the menus of the title set, not its video
+        if(parts.size() > 1) {
+            parts.remove(0);
+        }
+
+        titles.append(parts.values());
+    }
+
+    if(!others.isEmpty()) {
+        titles.append(others);
+    }
+
+    return titles;
+}
+
+QString DiscJobManager::cacheKey(const QStringList& files)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for(const QString& path : files) {
+        QFile file(path);
+        if(!file.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+
+        const qint64 size = file.size();
+        hash.addData(QFileInfo(path).fileName().toUpper().toUtf8());
+        hash.addData(QByteArray::number(size));
+
+        const qint64 offsets[] = {0, (size - SampleSize) / 2, size - SampleSize};
+        for(const qint64 offset : offsets) {
+            if(!file.seek(std::max<qint64>(0, offset))) {
+                return {};
+            }
+
+            hash.addData(file.read(SampleSize));
+        }
+    }
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool DiscJobManager::restore(const QString& cachedPath, const QStringList& files)
+{
+    QFile file(cachedPath);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // Line 1 is the format, line 2 the number of files, followed by the files
+    const QByteArray data = file.readAll();
+    file.close();
+
+    const int headerEnd = data.indexOf('\n');
+    if(headerEnd < 1 || !data.startsWith("DGIndexProjectFile")) {
+        return false;
+    }
+
+    const int countEnd = data.indexOf('\n', headerEnd + 1);
+    bool ok = false;
+    const int count = data.mid(headerEnd + 1, countEnd - headerEnd - 1).trimmed().toInt(&ok);
+    if(countEnd == -1 || !ok || count != files.size()) {
+        return false;
+    }
+
+    int listEnd = countEnd;
+    for(int i = 0; i < count; ++i) {
+        listEnd = data.indexOf('\n', listEnd + 1);
+        if(listEnd == -1) {
+            return false;
+        }
+    }
+
+    const QByteArray eol = data.at(headerEnd - 1) == '\r' ? "\r\n" : "\n";
+    QByteArray rewritten = data.left(countEnd + 1);
+    for(const QString& path : files) {
+        rewritten.append(QDir::toNativeSeparators(QFileInfo(path).absoluteFilePath()).toLocal8Bit());
+        rewritten.append(eol);
+    }
+    rewritten.append(data.mid(listEnd + 1));
+
+    if(rewritten == data) {
+        return true;
+    }
+
+    QSaveFile out(cachedPath);
+    return out.open(QIODevice::WriteOnly) && out.write(rewritten) == rewritten.size() && out.commit();
+}
+
+void DiscJobManager::setProcessor(const QString& processor)
+{
+    processorPath = processor;
+}
+
+void DiscJobManager::setSavePath(const QString& path)
+{
+    savePath = path;
+}
+
+void DiscJobManager::setMaxJobs(const int count)
+{
+    maxJobs = std::max(1, count);
+    startJobs();
+}
+
+void DiscJobManager::process(const QStringList& files)
+{
+    abort();
+
+    if(files.empty()) {
+        emit error(tr("Nothing to process."));
+        return;
+    }
+
+    const QDir cache(cacheDirectory);
+    for(const QStringList& title : splitTitles(files)) {
+        auto job = vfg::make_unique<Job>();
+        job->name = titleName(title);
+        job->files = title;
+        job->key = cacheKey(title);
+        jobs.push_back(std::move(job));
+    }
+
+    qCDebug(DISCJOBS) << "Indexing" << jobs.size() << "titles";
+
+    // Cached titles finish at once, the rest are indexed
+    for(const auto& job : jobs) {
+        const QString cached = cache.absoluteFilePath(QString("%1.d2v").arg(job->key));
+        if(!job->key.isEmpty() && restore(cached, job->files)) {
+            qCDebug(DISCJOBS) << job->name << "found in cache";
+
+            finishJob(job.get(), cached);
+        }
+    }
+
+    startJobs();
+    checkFinished();
+}
+
+void DiscJobManager::startJobs()
+{
+    int running = std::count_if(jobs.cbegin(), jobs.cend(), [](const std::unique_ptr<Job>& job) {
+        return job->processor != nullptr;
+    });
+
+    const QDir cache(cacheDirectory);
+    for(std::size_t i = 0; i < jobs.size() && running < maxJobs; ++i) {
+        Job *const job = jobs.at(i).get();
+        if(job->done || job->processor) {
+            continue;
+        }
+
+        // Indexed under a temporary name so an aborted title is never taken from the cache
+        const QString partial = cache.absoluteFilePath(job->key.isEmpty()
+                                                       ? QString("uncached-%1.partial").arg(i)
+                                                       : QString("%1.partial").arg(job->key));
+        job->processor = vfg::make_unique<vfg::DvdProcessor>(processorPath);
+        job->processor->setOutputPath(partial);
+
+        connect(job->processor.get(), &vfg::DvdProcessor::statsUpdate, this, [this, i](const vfg::IndexerProgress& stats) {
+            jobs.at(i)->progress = stats.percent;
+            jobs.at(i)->stats = stats;
+            emit jobProgress(static_cast<int>(i), stats.percent);
+            updateProgress();
+        });
+
+        connect(job->processor.get(), &vfg::DvdProcessor::finished, this, [this, job](const QString& filename) {
+            QString output = filename;
+            if(!job->key.isEmpty()) {
+                output = QDir(cacheDirectory).absoluteFilePath(QString("%1.d2v").arg(job->key));
+                QFile::remove(output);
+                if(!QFile::rename(filename, output)) {
+                    qCWarning(DISCJOBS) << "Unable to cache" << filename;
+                    output = filename;
+                }
+            }
+
+            finishJob(job, output);
+            checkFinished();
+        });
+
+        connect(job->processor.get(), &vfg::DvdProcessor::error, this, [this, job](const QString& msg) {
+            failJobs(tr("%1: %2").arg(job->name).arg(msg));
+        });
+
+        qCDebug(DISCJOBS) << "Starting" << job->name;
+
+        ++started;
+        ++running;
+        job->processor->process(job->files);
+    }
+}
+
+void DiscJobManager::finishJob(Job *job, const QString& filename)
+{
+    const auto it = std::find_if(jobs.cbegin(), jobs.cend(), [job](const std::unique_ptr<Job>& j) {
+        return j.get() == job;
+    });
+    const int index = static_cast<int>(std::distance(jobs.cbegin(), it));
+
+    // Called from the processor's signal
+    if(job->processor) {
+        job->processor->disconnect(this);
+        job->processor.release()->deleteLater();
+    }
+
+    job->done = true;
+    job->progress = 100;
+    job->output = filename;
+
+    if(!savePath.isEmpty()) {
+        const QString target = jobs.size() > 1 ? QString("%1_%2.d2v").arg(savePath).arg(job->name)
+                                               : QString("%1.d2v").arg(savePath);
+        QFile::remove(target);
+        if(QFile::copy(filename, target)) {
+            job->output = target;
+        }
+        else {
+            qCWarning(DISCJOBS) << "Unable to save" << target;
+        }
+    }
+
+    emit jobProgress(index, 100);
+    emit jobFinished(index, job->output);
+    updateProgress();
+}
+
+void DiscJobManager::checkFinished()
+{
+    const bool allDone = std::all_of(jobs.cbegin(), jobs.cend(), [](const std::unique_ptr<Job>& j) {
+        return j->done;
+    });
+    if(jobs.empty() || !allDone) {
+        startJobs();
+        return;
+    }
+
+    QStringList outputs;
+    for(const auto& j : jobs) {
+        outputs.append(j->output);
+    }
+
+    emit finished(outputs);
+}
+
+void DiscJobManager::failJobs(const QString& msg)
+{
+    abort();
+    emit error(msg);
+}
+
+void DiscJobManager::abort()
+{
+    for(const auto& job : jobs) {
+        if(!job->processor) {
+            continue;
+        }
+
+        // May be called from the processor's signal
+        job->processor->disconnect(this);
+        job->processor->handleAbortProcess();
+        QFile::remove(job->processor->savedPath());
+        job->processor.release()->deleteLater();
+    }
+
+    jobs.clear();
+}
+
+void DiscJobManager::updateProgress()
+{
+    if(jobs.empty()) {
+        return;
+    }
+
+    int total = 0;
+    for(const auto& job : jobs) {
+        total += job->progress;
+    }
+
+    emit progressUpdate(total / static_cast<int>(jobs.size()));
+}
+
+int DiscJobManager::jobCount() const
+{
+    return static_cast<int>(jobs.size());
+}
+
+QString DiscJobManager::jobName(const int job) const
+{
+    if(job < 0 || job >= static_cast<int>(jobs.size())) {
+        return {};
+    }
+
+    return jobs.at(job)->name;
+}
+
+int DiscJobManager::jobPercent(const int job) const
+{
+    if(job < 0 || job >= static_cast<int>(jobs.size())) {
+        return 0;
+    }
+
+    return jobs.at(job)->progress;
+}
+
+QString DiscJobManager::jobFile(const int job) const
+{
+    if(job < 0 || job >= static_cast<int>(jobs.size()) || !jobs.at(job)->processor) {
+        return QString();
+    }
+
+    return jobs.at(job)->stats.currentFile;
+}
+
+qint64 DiscJobManager::bytesPerSecond() const
+{
+    qint64 total = 0;
+    for(const auto& job : jobs) {
+        if(job->processor) {
+            total += job->stats.bytesPerSecond;
+        }
+    }
+
+    return total;
+}
+
+qint64 DiscJobManager::remainingMsecs() const
+{
+    // Running titles finish in parallel, so the slowest one decides
+    qint64 remaining = -1;
+    for(const auto& job : jobs) {
+        if(job->processor) {
+            remaining = std::max(remaining, job->stats.remainingMsecs);
+        }
+    }
+
+    return remaining;
+}
+
+int DiscJobManager::startedCount() const
+{
+    return started;
+}
+
+} // namespace vfg
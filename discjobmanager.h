@@ -0,0 +1,277 @@
+#ifndef VFG_DISCJOBMANAGER_H
+#define VFG_DISCJOBMANAGER_H
+
+#include <memory>
+#include <vector>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include "indexeroutputparser.h"
+
+namespace vfg {
+    class DvdProcessor;
+}
+
+namespace vfg {
+
+/**
+ * @brief The DiscJobManager class indexes the titles of a disc in parallel
+ *
+ * Selected files are split into titles (DVD title sets VTS_NN_*.VOB),
+ * and each title is indexed by its own \link DvdProcessor \endlink.
+ * At most \link setMaxJobs \endlink indexer processes run at once.
+ *
+ * Finished D2V files are cached by the content of their VOBs, so
+ * opening the same disc again skips indexing, even from another path.
+ */
+class DiscJobManager : public QObject
+{
+    Q_OBJECT
+
+private:
+    /**
+     * @brief A title being indexed
+     */
+    struct Job
+    {
+        //! Name shown to the user, e.g. VTS_01
+        QString name {};
+
+        //! Files of the title in playback order
+        QStringList files {};
+
+        //! Cache key of the files
+        QString key {};
+
+        //! Path to the finished D2V file
+        QString output {};
+
+        //! Progress in range 0-100
+        int progress {0};
+
+        //! Throughput, time left and current file of a running title
+        vfg::IndexerProgress stats {};
+
+        //! Set when the job has finished
+        bool done {false};
+
+        //! Indexer process, set while running
+        std::unique_ptr<vfg::DvdProcessor> processor {};
+    };
+
+    //! Path to the indexer executable
+    QString processorPath;
+
+    //! Directory of the cached D2V files
+    QString cacheDirectory;
+
+    //! Path to save copies of the D2V files to, without suffix
+    QString savePath {};
+
+    //! Jobs of the current disc in title order
+    std::vector<std::unique_ptr<Job>> jobs {};
+
+    //! Maximum number of indexer processes at once
+    int maxJobs;
+
+    //! Number of indexer processes started, for diagnostics
+    int started {0};
+
+    /**
+     * @brief Start waiting jobs while the limit allows
+     */
+    void startJobs();
+
+    /**
+     * @brief Mark a job finished
+     * @param job Finished job
+     * @param filename Path to the D2V file
+     */
+    void finishJob(Job *job, const QString& filename);
+
+    /**
+     * @brief Start more jobs, or emit \link finished \endlink when all are done
+     */
+    void checkFinished();
+
+    /**
+     * @brief Stop all jobs and report an error
+     * @param msg Error message
+     */
+    void failJobs(const QString& msg);
+
+    /**
+     * @brief Emit overall progress of the jobs
+     */
+    void updateProgress();
+
+public:
+    /**
+     * @brief Constructor
+     * @param processor Path to the indexer executable
+     * @param cacheDir Directory of the cached D2V files
+     * @param parent Owner of the object
+     */
+    DiscJobManager(const QString& processor, const QString& cacheDir, QObject *parent = 0);
+
+    /**
+     * Destructor
+     */
+    ~DiscJobManager();
+
+    /**
+     * @brief Split disc files into independently indexed titles
+     *
+     * VOBs of each DVD title set form one title. Other files are
+     * kept together as a single title in the given order.
+     *
+     * @param files Selected files
+     * @return Titles in title set order
+     */
+    static QList<QStringList> splitTitles(const QStringList& files);
+
+    /**
+     * @brief Get cache key of a title
+     *
+     * The key is derived from the names, sizes and sampled content
+     * of the files, so reading a whole disc is not required.
+     *
+     * @param files Files of the title
+     * @return Key, empty if a file can't be read
+     */
+    static QString cacheKey(const QStringList& files);
+
+    /**
+     * @brief Restore a cached D2V file for the given files
+     *
+     * D2V files list the absolute paths of their VOBs, so the
+     * paths are rewritten to the current location of the files.
+     *
+     * @param cachedPath Path to the cached D2V file
+     * @param files Files of the title
+     * @return True if the D2V file is usable, otherwise false
+     */
+    static bool restore(const QString& cachedPath, const QStringList& files);
+
+    /**
+     * @brief Set indexer executable path
+     * @param processor Path to the executable
+     */
+    void setProcessor(const QString& processor);
+
+    /**
+     * @brief Set path to save copies of the D2V files to
+     *
+     * With several titles the title name is appended to the path
+     *
+     * @param path Path without a suffix, empty to use only the cache
+     */
+    void setSavePath(const QString& path);
+
+    /**
+     * @brief Set maximum number of indexer processes at once
+     * @param count Number of processes, at least 1
+     */
+    void setMaxJobs(int count);
+
+    /**
+     * @brief Index disc files, aborting any previous disc
+     * @param files Files to index
+     */
+    void process(const QStringList& files);
+
+    /**
+     * @brief Get number of titles of the current disc
+     *
+     * Titles are kept after \link finished \endlink until the next disc
+     *
+     * @return Number of titles
+     */
+    int jobCount() const;
+
+    /**
+     * @brief Get name of a title
+     * @param job Title index
+     * @return Title name
+     */
+    QString jobName(int job) const;
+
+    /**
+     * @brief Get progress of a title
+     * @param job Title index
+     * @return Progress in range 0-100
+     */
+    int jobPercent(int job) const;
+
+    /**
+     * @brief Get input file a title is currently indexing
+     * @param job Title index
+     * @return Path to the file, empty if the title isn't running
+     */
+    QString jobFile(int job) const;
+
+    /**
+     * @brief Get combined throughput of the running titles
+     * @return Bytes per second, 0 until known
+     */
+    qint64 bytesPerSecond() const;
+
+    /**
+     * @brief Get estimated time until the running titles are finished
+     *
+     * Titles still waiting for a free process are not included
+     *
+     * @return Milliseconds, -1 until known
+     */
+    qint64 remainingMsecs() const;
+
+    /**
+     * @brief Get number of indexer processes started since construction
+     * @return Number of processes
+     */
+    int startedCount() const;
+
+public slots:
+    /**
+     * @brief Stop all indexer processes
+     */
+    void abort();
+
+signals:
+    /**
+     * @brief Emitted when the progress of a title changes
+     * @param job Title index
+     * @param progress Progress in range 0-100
+     */
+    void jobProgress(int job, int progress);
+
+    /**
+     * @brief Emitted when the overall progress changes
+     * @param progress Progress in range 0-100
+     */
+    void progressUpdate(int progress);
+
+    /**
+     * @brief Emitted when a title has been indexed or found in the cache
+     * @param job Title index
+     * @param filename Path to the D2V file
+     */
+    void jobFinished(int job, const QString& filename);
+
+    /**
+     * @brief Emitted when every title has been indexed
+     * @param filenames Paths to the D2V files in title order
+     */
+    void finished(const QStringList& filenames);
+
+    /**
+     * @brief Emitted when a title fails, the other titles are stopped
+     * @param errorMsg Error message
+     */
+    void error(const QString& errorMsg);
+};
+
+} // namespace vfg
+
+#endif // VFG_DISCJOBMANAGER_H
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <utility>
+#include <QLoggingCategory>
+#include <QNetworkAccessManager>
+#include <QUrl>
+#include "downloadscheduler.hpp"
+#include "httpdownload.hpp"
+
+Q_LOGGING_CATEGORY(DOWNLOADSCHEDULER, "downloadscheduler")
+
+namespace vfg {
+namespace net {
+
+DownloadScheduler::DownloadScheduler(QNetworkAccessManager *netMan, QObject *parent) :
+    QObject(parent),
+    manager(netMan)
+{
+}
+
+void DownloadScheduler::enqueue(std::shared_ptr<HttpDownload> download, const Priority priority)
+{
+    HttpDownload *const dl = download.get();
+    if(download->getStatus() == HttpDownload::Status::Running) {
+        return;
+    }
+
+    const auto isSame = [dl](const Entry& entry) { return entry.download.get() == dl; };
+    if(std::any_of(queued.cbegin(), queued.cend(), isSame)) {
+        return;
+    }
+
+    Entry entry;
+    entry.download = std::move(download);
+    entry.priority = priority;
+    entry.sequence = nextSequence++;
+    entry.requestedConnections = dl->getMaxSegments();
+    queued.push_back(std::move(entry));
+
+    dl->disconnect(this);
+    connect(dl, &HttpDownload::updated, this, [this, dl]() {
+        downloadUpdated(dl);
+    });
+
+    dl->setBandwidthLimiter(&limiter);
+    dl->markPending();
+
+    schedule();
+}
+
+void DownloadScheduler::prioritize(const HttpDownload *download)
+{
+    const auto it = std::find_if(queued.begin(), queued.end(), [download](const Entry& entry) {
+        return entry.download.get() == download;
+    });
+
+    if(it == queued.end()) {
+        return;
+    }
+
+    it->priority = Priority::High;
+    it->sequence = frontSequence--;
+
+    schedule();
+}
+
+void DownloadScheduler::setMaxActive(const int count)
+{
+    maxActive = std::max(1, count);
+    schedule();
+}
+
+void DownloadScheduler::setMaxConnectionsPerHost(const int count)
+{
+    maxPerHost = std::max(1, count);
+    schedule();
+}
+
+void DownloadScheduler::setBandwidthLimit(const qint64 rate)
+{
+    limiter.setRate(rate);
+}
+
+int DownloadScheduler::queuedCount() const
+{
+    return static_cast<int>(queued.size());
+}
+
+int DownloadScheduler::activeCount() const
+{
+    return static_cast<int>(active.size());
+}
+
+int DownloadScheduler::hostConnections(const QString& host) const
+{
+    int connections = 0;
+    for(const Entry& entry : active) {
+        if(entry.download->url().host() == host) {
+            connections += entry.connections;
+        }
+    }
+
+    return connections;
+}
+
+void DownloadScheduler::schedule()
+{
+    std::stable_sort(queued.begin(), queued.end(), [](const Entry& a, const Entry& b) {
+        return a.priority != b.priority ? a.priority > b.priority : a.sequence < b.sequence;
+    });
+
+    // Start the downloads after choosing them, starting may emit updates
+    std::vector<std::shared_ptr<HttpDownload>> starting;
+    for(auto it = queued.begin(); it != queued.end() && static_cast<int>(active.size()) < maxActive;) {
+        // A busy host doesn't block downloads from other hosts
+        const int available = maxPerHost - hostConnections(it->download->url().host());
+        if(available <= 0) {
+            ++it;
+            continue;
+        }
+
+        it->connections = std::min(it->requestedConnections, available);
+        it->download->setMaxSegments(it->connections);
+        starting.push_back(it->download);
+        active.push_back(std::move(*it));
+        it = queued.erase(it);
+    }
+
+    for(const auto& download : starting) {
+        qCDebug(DOWNLOADSCHEDULER) << "Starting" << download->url()
+                                   << "with" << download->getMaxSegments() << "connections";
+
+        download->start(manager);
+    }
+}
+
+void DownloadScheduler::downloadUpdated(HttpDownload *download)
+{
+    if(!download->isFinished()) {
+        return;
+    }
+
+    const auto isSame = [download](const Entry& entry) { return entry.download.get() == download; };
+
+    // Canceled before it started
+    queued.erase(std::remove_if(queued.begin(), queued.end(), isSame), queued.end());
+
+    const auto it = std::find_if(active.begin(), active.end(), isSame);
+    if(it == active.end()) {
+        return;
+    }
+
+    // Restore the connections the download asked for so that a restart isn't limited
+    it->download->setMaxSegments(it->requestedConnections);
+    active.erase(it);
+
+    schedule();
+}
+
+} // namespace net
+} // namespace vfg
@@ -0,0 +1,166 @@
+#ifndef VFG_NET_DOWNLOADSCHEDULER_HPP
+#define VFG_NET_DOWNLOADSCHEDULER_HPP
+
+#include <memory>
+#include <vector>
+#include <QObject>
+#include <QString>
+#include "bandwidthlimiter.hpp"
+
+class QNetworkAccessManager;
+
+namespace vfg {
+namespace net {
+
+class HttpDownload;
+
+/**
+ * @brief The DownloadScheduler class
+ *
+ * Decides when queued downloads start. Limits the number of downloads
+ * running at once and the number of connections to each host, and
+ * shares a \link BandwidthLimiter \endlink between all downloads.
+ *
+ * Queued downloads start in priority order, oldest first within a
+ * priority. A download can be moved to the front of the queue, e.g.
+ * when the user is about to open it.
+ */
+class DownloadScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Priority {
+        Low,
+        Normal,
+        High
+    };
+
+private:
+    /**
+     * @brief Download managed by the scheduler
+     */
+    struct Entry
+    {
+        //! Download
+        std::shared_ptr<HttpDownload> download {};
+
+        //! Queue priority
+        Priority priority {Priority::Normal};
+
+        //! Queue position within the priority, lower starts first
+        qint64 sequence {0};
+
+        //! Connections the download asked for
+        int requestedConnections {1};
+
+        //! Connections reserved for the running download
+        int connections {0};
+    };
+
+    //! Network manager used for the requests
+    QNetworkAccessManager *manager;
+
+    //! Downloads waiting to start
+    std::vector<Entry> queued {};
+
+    //! Running downloads
+    std::vector<Entry> active {};
+
+    //! Maximum number of running downloads
+    int maxActive {3};
+
+    //! Maximum number of connections to a host
+    int maxPerHost {8};
+
+    //! Sequence of the next queued download
+    qint64 nextSequence {0};
+
+    //! Sequence of the next download moved to the front of the queue
+    qint64 frontSequence {-1};
+
+    //! Shared rate limit
+    BandwidthLimiter limiter {};
+
+    /**
+     * @brief Start queued downloads while limits allow
+     */
+    void schedule();
+
+    /**
+     * @brief Get connections reserved by running downloads of a host
+     * @param host Host name
+     * @return Number of connections
+     */
+    int hostConnections(const QString& host) const;
+
+    /**
+     * @brief Release the slot of a stopped download or drop a canceled queued one
+     * @param download Updated download
+     */
+    void downloadUpdated(HttpDownload *download);
+
+public:
+    /**
+     * @brief Constructor
+     * @param netMan Network manager to start the downloads with
+     * @param parent Owner of the object
+     */
+    explicit DownloadScheduler(QNetworkAccessManager *netMan, QObject *parent = 0);
+
+    /**
+     * @brief Queue a download
+     *
+     * Also used to restart a stopped download, which then resumes
+     * from its partial file
+     *
+     * @param download Download to queue
+     * @param priority Queue priority
+     */
+    void enqueue(std::shared_ptr<HttpDownload> download, Priority priority = Priority::Normal);
+
+    /**
+     * @brief Move a queued download to the front of the queue
+     * @param download Queued download
+     */
+    void prioritize(const HttpDownload *download);
+
+    /**
+     * @brief Set maximum number of downloads running at once
+     * @param count Number of downloads, at least 1
+     */
+    void setMaxActive(int count);
+
+    /**
+     * @brief Set maximum number of connections to a host
+     *
+     * Segmented downloads get fewer segments if the host has
+     * too few connections left
+     *
+     * @param count Number of connections, at least 1
+     */
+    void setMaxConnectionsPerHost(int count);
+
+    /**
+     * @brief Set combined rate limit of all downloads
+     * @param rate Bytes per second, 0 for unlimited
+     */
+    void setBandwidthLimit(qint64 rate);
+
+    /**
+     * @brief Get number of downloads waiting to start
+     * @return Number of queued downloads
+     */
+    int queuedCount() const;
+
+    /**
+     * @brief Get number of running downloads
+     * @return Number of running downloads
+     */
+    int activeCount() const;
+};
+
+} // namespace net
+} // namespace vfg
+
+#endif // VFG_NET_DOWNLOADSCHEDULER_HPP
@@ -2,6 +2,8 @@
 #include <utility>
 #include <QAction>
 #include <QDir>
+#include <QFileInfo>
+#include <QHeaderView>
 #include <QMenu>
 #include <QMessageBox>
 #include <QModelIndex>
@@ -25,16 +27,35 @@ DownloadsDialog::DownloadsDialog(QWidget *parent) :
 {
     ui.setupUi(this);
 
-    ui.downloadList->setItemDelegate(new vfg::ui::ProgressBarDelegate(ui.downloadList));
+    ui.downloadList->setItemDelegateForColumn(vfg::core::DownloadsListModel::ProgressColumn,
+                                              new vfg::ui::ProgressBarDelegate(ui.downloadList));
     ui.downloadList->setModel(model.get());
     ui.downloadList->setContextMenuPolicy(Qt::CustomContextMenu);
-    ui.downloadList->setUniformItemSizes(true);
+    ui.downloadList->horizontalHeader()->setSectionResizeMode(
+                vfg::core::DownloadsListModel::NameColumn, QHeaderView::Stretch);
 
-    connect(ui.downloadList, &QListView::customContextMenuRequested,
+    connect(ui.downloadList, &QTableView::customContextMenuRequested,
             this, &DownloadsDialog::contextMenuRequested);
+
+    loadSchedulerSettings();
+
+    // Resume downloads left unfinished by the previous session
+    QSettings config("config.ini", QSettings::IniFormat);
+    const QDir cacheDir(config.value("cachedirectory").toString());
+    model->restoreQueue(cacheDir.absoluteFilePath("downloads.json"));
 }
 
-void DownloadsDialog::addDownload(const QNetworkRequest &request)
+void DownloadsDialog::loadSchedulerSettings()
+{
+    QSettings config("config.ini", QSettings::IniFormat);
+    vfg::net::DownloadScheduler *scheduler = model->scheduler();
+    scheduler->setMaxActive(config.value("downloadmaxactive").toInt());
+    scheduler->setMaxConnectionsPerHost(config.value("downloadmaxperhost").toInt());
+    scheduler->setBandwidthLimit(config.value("downloadbandwidth").toLongLong() * 1024);
+}
+
+void DownloadsDialog::addDownload(const QNetworkRequest &request,
+                                  const vfg::net::DownloadScheduler::Priority priority)
 {
     const QUrl url = request.url();
     if(!(url.scheme() == "http" || url.scheme() == "https" ||
@@ -44,10 +65,15 @@ void DownloadsDialog::addDownload(const QNetworkRequest &request)
         return;
     }
 
+    // Limits may have changed since the last download
+    loadSchedulerSettings();
+
     QSettings config("config.ini", QSettings::IniFormat);
     auto httpReq = std::make_shared<vfg::net::HttpDownload>(request,
                                                         QDir(config.value("cachedirectory").toString()));
-    model->addItem(std::move(httpReq));
+    httpReq->setMaxSegments(config.value("downloadsegments").toInt());
+    httpReq->setReadBufferSize(config.value("downloadreadbuffer").toLongLong() * 1024);
+    model->addItem(std::move(httpReq), priority);
 }
 
 void DownloadsDialog::on_pushButton_clicked()
@@ -62,16 +88,38 @@ void DownloadsDialog::contextMenuRequested(const QPoint& pos)
         return;
     }
 
-    const QVariant data = model->data(index);
+    const QVariant data = model->data(index, vfg::core::DownloadsListModel::DownloadRole);
     const auto download = data.value<std::shared_ptr<vfg::net::HttpDownload>>();
     const auto status = download->getStatus();
     QMenu menu;
+    menu.setToolTipsVisible(true);
     auto action = vfg::make_unique<QAction>(&menu);
     if(status == vfg::net::HttpDownload::Status::Running) {        
         action->setText(tr("Stop"));
         connect(action.get(), &QAction::triggered, [&download]() {
-            download->abort();
+            download->discard();
         });
+
+        auto playAction = vfg::make_unique<QAction>(tr("Play while downloading"), &menu);
+        playAction->setToolTip(tr("Only YUV4MPEG2 (*.y4m) videos can be played while downloading"));
+        playAction->setEnabled(download->isPreallocated() &&
+                               QFileInfo(download->path()).suffix().toLower() == "y4m");
+        connect(playAction.get(), &QAction::triggered, [&download, this]() {
+            emit playPartial(download);
+        });
+        menu.addAction(playAction.release());
+    }
+    else if(status == vfg::net::HttpDownload::Status::Pending) {
+        action->setText(tr("Cancel"));
+        connect(action.get(), &QAction::triggered, [&download]() {
+            download->discard();
+        });
+
+        auto firstAction = vfg::make_unique<QAction>(tr("Download next"), &menu);
+        connect(firstAction.get(), &QAction::triggered, [&download, this]() {
+            model->prioritize(download.get());
+        });
+        menu.addAction(firstAction.release());
     }
     else if(status == vfg::net::HttpDownload::Status::Finished) {
         action->setText(tr("Play"));
@@ -81,8 +129,8 @@ void DownloadsDialog::contextMenuRequested(const QPoint& pos)
     }
     else if(status == vfg::net::HttpDownload::Status::Aborted) {
         action->setText(tr("Retry"));
-        connect(action.get(), &QAction::triggered, [&download]() {
-            download->retry();
+        connect(action.get(), &QAction::triggered, [&download, this]() {
+            model->retry(download);
         });
     }
     menu.addAction(action.release());
@@ -40,10 +40,17 @@ public:
     /**
      * @brief Add new download request
      * @param request Request to add
+     * @param priority Queue priority, e.g. high for a file the user is about to open
      */
-    void addDownload(const QNetworkRequest &request);
+    void addDownload(const QNetworkRequest &request,
+                     vfg::net::DownloadScheduler::Priority priority = vfg::net::DownloadScheduler::Priority::Normal);
 
 private:
+    /**
+     * @brief Apply download limits from the configuration
+     */
+    void loadSchedulerSettings();
+
     //! UI
     Ui::DownloadsDialog ui {};
 
@@ -65,6 +72,12 @@ private slots:
 
 signals:
     void play(QString path);
+
+    /**
+     * @brief Emitted when user wants to open a download before it has finished
+     * @param download Running download
+     */
+    void playPartial(std::shared_ptr<vfg::net::HttpDownload> download);
 };
 
 
@@ -1,77 +1,357 @@
 #include <algorithm>
 #include <memory>
 #include <utility>
-#include <QAbstractListModel>
+#include <QAbstractTableModel>
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
 #include <QList>
+#include <QLoggingCategory>
 #include <QModelIndex>
+#include <QNetworkRequest>
 #include <QObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QSettings>
+#include <QString>
+#include <QTime>
+#include <QUrl>
 #include <QVariant>
+#include "common.hpp"
 #include "downloadslistmodel.hpp"
 #include "httpdownload.hpp"
 #include "ptrutil.hpp"
 
+Q_LOGGING_CATEGORY(DOWNLOADSLISTMODEL, "downloadslistmodel")
+
+namespace {
+
+//! Default interval between view updates in milliseconds (10 Hz)
+constexpr int UpdateInterval = 100;
+
+QString statusText(const vfg::net::HttpDownload& download) {
+    switch(download.getStatus()) {
+    case vfg::net::HttpDownload::Status::Pending:
+        return QObject::tr("Queued");
+    case vfg::net::HttpDownload::Status::Running:
+        // Speed is the aggregate of all connections of a segmented download
+        return download.activeConnections() > 1
+                ? QObject::tr("Downloading (%1 connections)").arg(download.activeConnections())
+                : QObject::tr("Downloading");
+    case vfg::net::HttpDownload::Status::Finished:
+        return QObject::tr("Finished");
+    case vfg::net::HttpDownload::Status::Aborted:
+        return download.hasError() ? QObject::tr("Failed: %1").arg(download.errorString())
+                                   : QObject::tr("Canceled");
+    }
+
+    return {};
+}
+
+QString timeLeftText(const vfg::net::HttpDownload& download) {
+    const double speed = download.downloadSpeed();
+    if(download.getStatus() != vfg::net::HttpDownload::Status::Running
+            || !download.sizeKnown() || speed <= 0.0) {
+        return {};
+    }
+
+    const qint64 remaining = static_cast<qint64>(
+                (download.bytesTotal() - download.bytesDownloaded()) * 1000.0 / speed);
+    if(remaining < 0 || remaining >= 24 * 3600000) {
+        return {};
+    }
+
+    const QTime left = QTime(0, 0).addMSecs(static_cast<int>(remaining));
+    return left.toString(remaining >= 3600000 ? "h:mm:ss" : "m:ss");
+}
+
+} // namespace
+
 namespace vfg {
 namespace core {
 
 DownloadsListModel::DownloadsListModel(QObject *parent) :
-    QAbstractListModel(parent),
-    netMan(vfg::make_unique<QNetworkAccessManager>())
+    QAbstractTableModel(parent),
+    netMan(vfg::make_unique<QNetworkAccessManager>()),
+    downloadScheduler(netMan.get())
 {
+    updateTimer.setInterval(UpdateInterval);
+
+    connect(&updateTimer,   &QTimer::timeout,
+            this,           &DownloadsListModel::flushUpdates);
 }
 
-int DownloadsListModel::rowCount(const QModelIndex &parent) const
+DownloadsListModel::~DownloadsListModel()
 {
-    Q_UNUSED(parent);
+    saveQueue();
+}
 
-    return downloads.size();
+int DownloadsListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : downloads.size();
 }
 
 int DownloadsListModel::columnCount(const QModelIndex &parent) const
 {
-    Q_UNUSED(parent);
-
-    return 1;
+    return parent.isValid() ? 0 : ColumnCount;
 }
 
 QVariant DownloadsListModel::data(const QModelIndex &index, const int role) const
 {
-    Q_UNUSED(role);
+    if(!index.isValid() || index.row() >= downloads.size()) {
+        return {};
+    }
+
+    const auto& download = downloads[index.row()];
+    switch(role) {
+    case DownloadRole:
+        return QVariant::fromValue(download);
+    case StatusRole:
+        return static_cast<int>(download->getStatus());
+    case ProgressRole:
+        return download->sizeKnown() && download->bytesTotal() > 0 ? download->percentCompleted() : -1.0;
+    case BytesReceivedRole:
+        return download->bytesDownloaded();
+    case BytesTotalRole:
+        return download->sizeKnown() ? download->bytesTotal() : -1;
+    case SpeedRole:
+        return download->downloadSpeed();
+    case ConnectionsRole:
+        return download->activeConnections();
+    case Qt::DisplayRole:
+        break;
+    default:
+        return {};
+    }
 
-    if(!index.isValid()) {
+    switch(index.column()) {
+    case NameColumn:
+        return download->fileName();
+    case StatusColumn:
+        return statusText(*download);
+    case ProgressColumn:
+        return download->sizeKnown() && download->bytesTotal() > 0
+                ? QString("%1 %").arg(QString::number(download->percentCompleted(), 'f', 1))
+                : QString();
+    case SizeColumn:
+        return download->sizeKnown() ? vfg::format::formatNumber(download->bytesTotal()) : QString();
+    case SpeedColumn:
+        return download->getStatus() == vfg::net::HttpDownload::Status::Running
+                ? QString("%1/sec").arg(vfg::format::formatNumber(download->downloadSpeed()))
+                : QString();
+    case TimeLeftColumn:
+        return timeLeftText(*download);
+    case HostColumn:
+        return download->url().host();
+    }
+
+    return {};
+}
+
+QVariant DownloadsListModel::headerData(const int section, const Qt::Orientation orientation,
+                                        const int role) const
+{
+    if(orientation != Qt::Horizontal || role != Qt::DisplayRole) {
         return {};
     }
 
-    if(role == Qt::DisplayRole) {
-        return QVariant::fromValue(downloads[index.row()]);
+    switch(section) {
+    case NameColumn:
+        return tr("Name");
+    case StatusColumn:
+        return tr("Status");
+    case ProgressColumn:
+        return tr("Progress");
+    case SizeColumn:
+        return tr("Size");
+    case SpeedColumn:
+        return tr("Speed");
+    case TimeLeftColumn:
+        return tr("Time left");
+    case HostColumn:
+        return tr("Host");
     }
 
     return {};
 }
 
-void DownloadsListModel::addItem(std::shared_ptr<vfg::net::HttpDownload> download)
+void DownloadsListModel::setUpdateInterval(const int msecs)
 {
-    beginInsertRows(QModelIndex(), downloads.size(), downloads.size());
-    connect(download.get(), &vfg::net::HttpDownload::updated,
-            this,           &DownloadsListModel::updateData);
-    download->start(netMan.get());
-    downloads.prepend(std::move(download));
+    updateTimer.setInterval(msecs);
+}
+
+void DownloadsListModel::addItem(std::shared_ptr<vfg::net::HttpDownload> download,
+                                 const vfg::net::DownloadScheduler::Priority priority)
+{
+    // Newest downloads are shown first
+    beginInsertRows(QModelIndex(), 0, 0);
+    vfg::net::HttpDownload *const dl = download.get();
+    connect(dl, &vfg::net::HttpDownload::updated, this, [this, dl]() {
+        markDirty(dl);
+    });
+    downloads.prepend(download);
     endInsertRows();
+
+    downloadScheduler.enqueue(std::move(download), priority);
+
+    saveQueue();
 }
 
-void DownloadsListModel::updateData()
+void DownloadsListModel::retry(std::shared_ptr<vfg::net::HttpDownload> download)
 {
-    beginResetModel();
-    endResetModel();
+    downloadScheduler.enqueue(std::move(download));
+}
+
+void DownloadsListModel::prioritize(const vfg::net::HttpDownload *download)
+{
+    downloadScheduler.prioritize(download);
+}
+
+vfg::net::DownloadScheduler *DownloadsListModel::scheduler()
+{
+    return &downloadScheduler;
+}
+
+int DownloadsListModel::rowOf(const vfg::net::HttpDownload *download) const
+{
+    for(int row = 0; row < downloads.size(); ++row) {
+        if(downloads[row].get() == download) {
+            return row;
+        }
+    }
+
+    return -1;
+}
+
+void DownloadsListModel::markDirty(vfg::net::HttpDownload *download)
+{
+    dirty.insert(download);
+
+    if(!updateTimer.isActive()) {
+        updateTimer.start();
+    }
+}
+
+void DownloadsListModel::flushUpdates()
+{
+    // Stop ticking once downloads go quiet
+    if(dirty.isEmpty()) {
+        updateTimer.stop();
+        return;
+    }
+
+    for(const vfg::net::HttpDownload *download : dirty) {
+        const int row = rowOf(download);
+        if(row >= 0) {
+            emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+        }
+    }
+    dirty.clear();
 }
 
 void DownloadsListModel::clearFinished()
 {
+    dirty.clear();
+
     beginResetModel();
     downloads.erase(std::remove_if(downloads.begin(), downloads.end(),
                                    [](const std::shared_ptr<vfg::net::HttpDownload> &dl) {
-                        return dl->isFinished();
+                        if(!dl->isFinished()) {
+                            return false;
+                        }
+
+                        // Cleared downloads are not resumed later
+                        dl->discard();
+                        return true;
                     }), downloads.end());
     endResetModel();
+
+    saveQueue();
+}
+
+void DownloadsListModel::restoreQueue(const QString& path)
+{
+    queuePath = path;
+
+    QFile queueFile(queuePath);
+    if(!queueFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const QJsonArray queue = QJsonDocument::fromJson(queueFile.readAll()).array();
+    queueFile.close();
+
+    QSettings config("config.ini", QSettings::IniFormat);
+    for(const QJsonValue& value : queue) {
+        const QJsonObject item = value.toObject();
+        const QUrl url(item.value("url").toString());
+        if(!url.isValid()) {
+            continue;
+        }
+
+        QNetworkRequest request(url);
+        const QJsonObject headers = item.value("headers").toObject();
+        for(auto it = headers.constBegin(); it != headers.constEnd(); ++it) {
+            request.setRawHeader(it.key().toLatin1(), it.value().toString().toLatin1());
+        }
+
+        qCDebug(DOWNLOADSLISTMODEL) << "Restoring download" << url;
+
+        auto download = std::make_shared<vfg::net::HttpDownload>(request,
+                                                                 QFileInfo(item.value("path").toString()));
+        download->setMaxSegments(config.value("downloadsegments").toInt());
+        download->setReadBufferSize(config.value("downloadreadbuffer").toLongLong() * 1024);
+        addItem(std::move(download));
+    }
+}
+
+void DownloadsListModel::saveQueue() const
+{
+    if(queuePath.isEmpty()) {
+        return;
+    }
+
+    // Oldest first so that restored downloads keep their order
+    QJsonArray queue;
+    for(auto it = downloads.crbegin(); it != downloads.crend(); ++it) {
+        const auto& download = *it;
+        const auto status = download->getStatus();
+        if(status == vfg::net::HttpDownload::Status::Finished) {
+            continue;
+        }
+
+        // Canceled by the user, so it must not restart on the next launch.
+        // Its files are discarded when it's destroyed
+        if(status == vfg::net::HttpDownload::Status::Aborted && !download->hasError()) {
+            continue;
+        }
+
+        const QNetworkRequest request = download->getRequest();
+        QJsonObject headers;
+        for(const QByteArray& header : request.rawHeaderList()) {
+            headers.insert(QString::fromLatin1(header), QString::fromLatin1(request.rawHeader(header)));
+        }
+
+        QJsonObject item;
+        item.insert("url", download->url().toString());
+        item.insert("path", download->path());
+        item.insert("headers", headers);
+        queue.append(item);
+    }
+
+    QSaveFile queueFile(queuePath);
+    if(!queueFile.open(QIODevice::WriteOnly)) {
+        qCWarning(DOWNLOADSLISTMODEL) << "Unable to write" << queuePath << queueFile.errorString();
+
+        return;
+    }
+
+    queueFile.write(QJsonDocument(queue).toJson());
+    queueFile.commit();
 }
 
 } // namespace core
@@ -2,10 +2,14 @@
 #define VFG_CORE_DOWNLOADSLISTMODEL_HPP
 
 #include <memory>
-#include <QAbstractListModel>
+#include <QAbstractTableModel>
 #include <QList>
 #include <QNetworkAccessManager>
+#include <QSet>
+#include <QString>
+#include <QTimer>
 #include <QVariant>
+#include "downloadscheduler.hpp"
 
 class QModelIndex;
 class QObject;
@@ -19,10 +23,48 @@ namespace net {
 namespace vfg {
 namespace core {
 
-class DownloadsListModel : public QAbstractListModel
+/**
+ * @brief The DownloadsListModel class
+ *
+ * One row per download, newest first. Progress updates are coalesced
+ * and reported as per-row dataChanged notifications at a fixed rate,
+ * so the cost of repainting does not depend on how often data arrives.
+ *
+ * Downloads are started by a \link vfg::net::DownloadScheduler \endlink.
+ */
+class DownloadsListModel : public QAbstractTableModel
 {
     Q_OBJECT
 
+public:
+    enum Column {
+        NameColumn,
+        StatusColumn,
+        ProgressColumn,
+        SizeColumn,
+        SpeedColumn,
+        TimeLeftColumn,
+        HostColumn,
+        ColumnCount
+    };
+
+    enum Role {
+        //! std::shared_ptr<vfg::net::HttpDownload>
+        DownloadRole = Qt::UserRole,
+        //! vfg::net::HttpDownload::Status as int
+        StatusRole,
+        //! Percent completed as double, -1 if the size is unknown
+        ProgressRole,
+        //! Bytes downloaded as qint64
+        BytesReceivedRole,
+        //! Bytes total as qint64, -1 if unknown
+        BytesTotalRole,
+        //! Download speed in bytes per second as double
+        SpeedRole,
+        //! Number of active connections as int
+        ConnectionsRole
+    };
+
 private:
     //! Active download requests
     QList<std::shared_ptr<vfg::net::HttpDownload>> downloads {};
@@ -30,6 +72,31 @@ private:
     //! Network access manager
     std::unique_ptr<QNetworkAccessManager> netMan;
 
+    //! Starts downloads within the concurrency and bandwidth limits
+    vfg::net::DownloadScheduler downloadScheduler;
+
+    //! Path to the file where unfinished downloads are saved, empty to disable
+    QString queuePath {};
+
+    //! Downloads updated since the last notification
+    QSet<vfg::net::HttpDownload*> dirty {};
+
+    //! Sends the coalesced notifications
+    QTimer updateTimer {};
+
+    /**
+     * @brief Get row of a download
+     * @param download Download to find
+     * @return Row, -1 if not found
+     */
+    int rowOf(const vfg::net::HttpDownload *download) const;
+
+    /**
+     * @brief Mark download as updated
+     * @param download Updated download
+     */
+    void markDirty(vfg::net::HttpDownload *download);
+
 public:
     /**
      * @brief Constructor
@@ -37,28 +104,79 @@ public:
      */
     explicit DownloadsListModel(QObject *parent = 0);
 
+    /**
+     * Destructor
+     *
+     * Saves unfinished downloads to the queue file
+     */
+    ~DownloadsListModel();
+
     int rowCount(const QModelIndex &parent) const override;
 
     int columnCount(const QModelIndex &parent) const override;
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Set how often updated rows are reported
+     * @param msecs Interval in milliseconds
+     */
+    void setUpdateInterval(int msecs);
+
     /**
-     * @brief Add new request
+     * @brief Add new request and queue it for download
      * @param download New request
+     * @param priority Queue priority
+     */
+    void addItem(std::shared_ptr<vfg::net::HttpDownload> download,
+                 vfg::net::DownloadScheduler::Priority priority = vfg::net::DownloadScheduler::Priority::Normal);
+
+    /**
+     * @brief Queue a stopped download again
+     * @param download Stopped download
      */
-    void addItem(std::shared_ptr<vfg::net::HttpDownload> download);
+    void retry(std::shared_ptr<vfg::net::HttpDownload> download);
+
+    /**
+     * @brief Move a queued download to the front of the queue
+     * @param download Queued download
+     */
+    void prioritize(const vfg::net::HttpDownload *download);
+
+    /**
+     * @brief Get scheduler that starts the downloads
+     * @return Scheduler
+     */
+    vfg::net::DownloadScheduler *scheduler();
 
     /**
      * @brief Clear finished requests
      */
     void clearFinished();
 
+    /**
+     * @brief Restore unfinished downloads of a previous session
+     *
+     * Restored downloads are started and resume from their partial files.
+     * The queue is saved to the same file afterwards.
+     *
+     * @param path Path to the queue file
+     */
+    void restoreQueue(const QString& path);
+
+    /**
+     * @brief Save unfinished downloads to the queue file
+     */
+    void saveQueue() const;
+
 private slots:
     /**
-     * @brief Update model data
+     * @brief Notify views of the rows updated since the last notification
      */
-    void updateData();
+    void flushUpdates();
 };
 
 } // namespace core
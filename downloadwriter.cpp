@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include <QThread>
+#include "downloadwriter.hpp"
+#include "ptrutil.hpp"
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/uio.h>
+#endif
+
+Q_LOGGING_CATEGORY(DOWNLOADWRITER, "downloadwriter")
+
+namespace {
+
+//! Number of queued commands searched for data to coalesce
+constexpr int CoalesceWindow = 256;
+
+/**
+ * @brief Thread that runs a function
+ */
+class WriterThread : public QThread
+{
+public:
+    explicit WriterThread(std::function<void()> function) :
+        fn(std::move(function))
+    {
+    }
+
+protected:
+    void run() override {
+        fn();
+    }
+
+private:
+    std::function<void()> fn;
+};
+
+} // namespace
+
+namespace vfg {
+namespace net {
+
+DownloadWriter::DownloadWriter(QObject *parent) :
+    QObject(parent),
+    thread(vfg::make_unique<WriterThread>([this]() { process(); }))
+{
+    thread->start();
+}
+
+DownloadWriter::~DownloadWriter()
+{
+    {
+        QMutexLocker lock(&mutex);
+        stopping = true;
+        workAvailable.wakeAll();
+    }
+
+    thread->wait();
+    file.close();
+}
+
+void DownloadWriter::open(const QString& path, const bool truncate)
+{
+    Command command;
+    command.type = Command::Type::Open;
+    command.path = path;
+    command.truncate = truncate;
+
+    QMutexLocker lock(&mutex);
+    enqueue(std::move(command));
+}
+
+void DownloadWriter::close()
+{
+    Command command;
+    command.type = Command::Type::Close;
+
+    QMutexLocker lock(&mutex);
+    enqueue(std::move(command));
+}
+
+void DownloadWriter::write(const int stream, const qint64 offset, const QByteArray& data)
+{
+    if(data.isEmpty()) {
+        return;
+    }
+
+    Command command;
+    command.type = Command::Type::Write;
+    command.stream = stream;
+    command.offset = offset;
+    command.data.append(data);
+    command.size = data.size();
+
+    QMutexLocker lock(&mutex);
+    pending[stream] += data.size();
+    totalPending += data.size();
+    if(totalPending > maxPending) {
+        backlogged = true;
+    }
+
+    enqueue(std::move(command));
+}
+
+void DownloadWriter::resize(const qint64 size)
+{
+    Command command;
+    command.type = Command::Type::Resize;
+    command.offset = size;
+
+    QMutexLocker lock(&mutex);
+    enqueue(std::move(command));
+}
+
+void DownloadWriter::preallocate(const qint64 size)
+{
+    Command command;
+    command.type = Command::Type::Preallocate;
+    command.offset = size;
+
+    QMutexLocker lock(&mutex);
+    enqueue(std::move(command));
+}
+
+void DownloadWriter::enqueue(Command command)
+{
+    queue.push_back(std::move(command));
+    workAvailable.wakeOne();
+}
+
+void DownloadWriter::process()
+{
+    QMutexLocker lock(&mutex);
+    for(;;) {
+        while(queue.empty() && !stopping) {
+            workAvailable.wait(&mutex);
+        }
+
+        // Queued data is dropped when stopping, see the destructor
+        if(stopping) {
+            return;
+        }
+
+        Command command = std::move(queue.front());
+        queue.pop_front();
+
+        // Gather following writes of the stream into one block that ends
+        // on a buffer size boundary. Streams never overlap, so writes of
+        // other streams can be skipped, but not other operations.
+        if(command.type == Command::Type::Write && command.size < bufferSize) {
+            const qint64 limit = bufferSize - command.offset % bufferSize;
+            int searched = 0;
+            for(auto it = queue.begin(); it != queue.end() && searched < CoalesceWindow; ++searched) {
+                if(it->type != Command::Type::Write) {
+                    break;
+                }
+                else if(it->stream != command.stream || it->offset != command.offset + command.size) {
+                    ++it;
+                    continue;
+                }
+                else if(command.size + it->size > limit) {
+                    break;
+                }
+
+                command.data += it->data;
+                command.size += it->size;
+                it = queue.erase(it);
+            }
+        }
+
+        // Operations on a file that has failed are only accounted,
+        // but the file is still closed and the next one opened
+        const bool opensOrCloses = command.type == Command::Type::Open
+                                   || command.type == Command::Type::Close;
+        const bool failedBefore = !error.isEmpty() && !opensOrCloses;
+        lock.unlock();
+
+        const QString failure = failedBefore ? QString() : execute(command);
+
+        lock.relock();
+        if(command.type == Command::Type::Write) {
+            pending[command.stream] -= command.size;
+            totalPending -= command.size;
+            if(failure.isEmpty() && !failedBefore) {
+                written += command.size;
+            }
+        }
+
+        if(!failure.isEmpty()) {
+            error = failure;
+        }
+
+        bool drainedBacklog = false;
+        if(backlogged && totalPending <= maxPending / 2) {
+            backlogged = false;
+            drainedBacklog = true;
+        }
+
+        lock.unlock();
+        if(!failure.isEmpty()) {
+            qCCritical(DOWNLOADWRITER) << "Operation failed:" << failure;
+            emit failed(failure);
+        }
+        if(drainedBacklog) {
+            emit ready();
+        }
+        if(command.type == Command::Type::Close) {
+            emit closed();
+        }
+        lock.relock();
+    }
+}
+
+QString DownloadWriter::execute(const Command& command)
+{
+    bool success = false;
+    switch(command.type) {
+    case Command::Type::Open: {
+        file.close();
+        file.setFileName(command.path);
+
+        {
+            // Errors of the previous file don't apply to this one
+            QMutexLocker lock(&mutex);
+            error.clear();
+        }
+
+        // Data is gathered here, so QFile's own buffer would only add a copy
+        QIODevice::OpenMode mode = QIODevice::ReadWrite | QIODevice::Unbuffered;
+        if(command.truncate) {
+            mode |= QIODevice::Truncate;
+        }
+
+        if(!file.open(mode)) {
+            qCWarning(DOWNLOADWRITER) << "Unable to open" << command.path << file.errorString();
+            return tr("Unable to open %1: %2").arg(command.path, file.errorString());
+        }
+
+        return {};
+    }
+
+    case Command::Type::Close:
+        file.close();
+        return {};
+
+    case Command::Type::Write:
+        return writeData(command.offset, command.data);
+
+    case Command::Type::Resize:
+        success = file.resize(command.offset);
+        break;
+
+    case Command::Type::Preallocate:
+#ifdef Q_OS_LINUX
+        // Reserves the blocks without writing them, unlike resize which creates a sparse file
+        if(posix_fallocate(file.handle(), 0, command.offset) == 0) {
+            return {};
+        }
+#endif
+        success = file.size() >= command.offset || file.resize(command.offset);
+        break;
+    }
+
+    return success ? QString() : file.errorString();
+}
+
+QString DownloadWriter::writeData(qint64 offset, const QVector<QByteArray>& data)
+{
+#ifdef Q_OS_LINUX
+    // One system call for the whole block, straight from the received buffers
+    const int fd = file.handle();
+    if(fd != -1) {
+        std::vector<iovec> vectors;
+        vectors.reserve(static_cast<std::size_t>(data.size()));
+        for(const QByteArray& buffer : data) {
+            vectors.push_back({const_cast<char*>(buffer.constData()),
+                               static_cast<std::size_t>(buffer.size())});
+        }
+
+        std::size_t first = 0;
+        while(first < vectors.size()) {
+            const int count = static_cast<int>(std::min<std::size_t>(vectors.size() - first, IOV_MAX));
+            const ssize_t result = pwritev(fd, &vectors[first], count, offset);
+            if(result < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+
+                return QString::fromLocal8Bit(std::strerror(errno));
+            }
+
+            // Skip what was written, a short write continues mid-buffer
+            offset += result;
+            std::size_t left = static_cast<std::size_t>(result);
+            while(first < vectors.size() && left >= vectors[first].iov_len) {
+                left -= vectors[first].iov_len;
+                ++first;
+            }
+            if(left > 0) {
+                vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + left;
+                vectors[first].iov_len -= left;
+            }
+        }
+
+        return {};
+    }
+#endif
+
+    if(!file.seek(offset)) {
+        return file.errorString();
+    }
+
+    for(const QByteArray& buffer : data) {
+        if(file.write(buffer.constData(), buffer.size()) != buffer.size()) {
+            return file.errorString();
+        }
+    }
+
+    return {};
+}
+
+qint64 DownloadWriter::pendingBytes(const int stream) const
+{
+    QMutexLocker lock(&mutex);
+    return pending.value(stream);
+}
+
+qint64 DownloadWriter::pendingBytes() const
+{
+    QMutexLocker lock(&mutex);
+    return totalPending;
+}
+
+qint64 DownloadWriter::bytesWritten() const
+{
+    QMutexLocker lock(&mutex);
+    return written;
+}
+
+bool DownloadWriter::isBusy() const
+{
+    QMutexLocker lock(&mutex);
+    return backlogged;
+}
+
+void DownloadWriter::setBufferSize(const int size)
+{
+    QMutexLocker lock(&mutex);
+    bufferSize = std::max(4096, size);
+}
+
+void DownloadWriter::setMaxPending(const qint64 size)
+{
+    QMutexLocker lock(&mutex);
+    maxPending = std::max<qint64>(bufferSize, size);
+}
+
+bool DownloadWriter::hasError() const
+{
+    QMutexLocker lock(&mutex);
+    return !error.isEmpty();
+}
+
+QString DownloadWriter::errorString() const
+{
+    QMutexLocker lock(&mutex);
+    return error;
+}
+
+} // namespace net
+} // namespace vfg
@@ -0,0 +1,293 @@
+#ifndef VFG_NET_DOWNLOADWRITER_HPP
+#define VFG_NET_DOWNLOADWRITER_HPP
+
+#include <deque>
+#include <memory>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+
+class QThread;
+
+namespace vfg {
+namespace net {
+
+/**
+ * @brief The DownloadWriter class
+ *
+ * Writes downloaded data to a file in a dedicated thread so that disk
+ * I/O never blocks the thread receiving the data.
+ *
+ * Data is queued by reference (QByteArray is implicitly shared). Writes
+ * to consecutive offsets are gathered into blocks that end on buffer
+ * size boundaries and are written with a single vectored write where
+ * the platform has one, so the data is never copied.
+ *
+ * Opening and closing files are queued like writes, so no call waits
+ * for the disk. \link closed \endlink tells when queued data is on disk.
+ *
+ * Queued bytes are tracked per stream, e.g. per download segment, so
+ * that the caller knows how much of each stream is actually on disk.
+ */
+class DownloadWriter : public QObject
+{
+    Q_OBJECT
+
+private:
+    /**
+     * @brief Queued file operation
+     */
+    struct Command
+    {
+        enum class Type {
+            Open,
+            Close,
+            Write,
+            Resize,
+            Preallocate
+        };
+
+        //! Operation
+        Type type {Type::Write};
+
+        //! Stream the data belongs to
+        int stream {0};
+
+        //! Write offset, or file size for resize and preallocate
+        qint64 offset {0};
+
+        //! Data to write at consecutive offsets
+        QVector<QByteArray> data {};
+
+        //! Bytes in data
+        qint64 size {0};
+
+        //! File to open
+        QString path {};
+
+        //! Remove existing content of the opened file
+        bool truncate {false};
+    };
+
+    //! Output file, only accessed from the writer thread
+    QFile file {};
+
+    //! Writer thread
+    std::unique_ptr<QThread> thread;
+
+    //! Guards everything below
+    mutable QMutex mutex {};
+
+    //! Signaled when commands are queued or the thread should stop
+    QWaitCondition workAvailable {};
+
+    //! Queued commands
+    std::deque<Command> queue {};
+
+    //! Queued bytes per stream
+    QHash<int, qint64> pending {};
+
+    //! Queued bytes of all streams
+    qint64 totalPending {0};
+
+    //! Bytes written to the file
+    qint64 written {0};
+
+    //! Size of the gathered blocks
+    int bufferSize {1024 * 1024};
+
+    //! Queued bytes at which the writer becomes busy
+    qint64 maxPending {64 * 1024 * 1024};
+
+    //! Set when the backlog exceeds maxPending, cleared when it has
+    //! drained to half of it. Both \link isBusy \endlink and
+    //! \link ready \endlink follow this flag.
+    bool backlogged {false};
+
+    //! Set to stop the writer thread
+    bool stopping {false};
+
+    //! Error of the first failed operation
+    QString error {};
+
+    /**
+     * @brief Execute queued commands until stopped
+     */
+    void process();
+
+    /**
+     * @brief Execute a command
+     *
+     * Called in the writer thread without holding the mutex
+     *
+     * @param command Command to execute
+     * @return Error message, empty on success
+     */
+    QString execute(const Command& command);
+
+    /**
+     * @brief Write data at consecutive offsets
+     *
+     * Called in the writer thread without holding the mutex
+     *
+     * @param offset Offset of the first buffer
+     * @param data Buffers to write
+     * @return Error message, empty on success
+     */
+    QString writeData(qint64 offset, const QVector<QByteArray>& data);
+
+    /**
+     * @brief Queue a command and wake the writer thread
+     * @pre mutex must be locked
+     * @param command Command to queue
+     */
+    void enqueue(Command command);
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * Starts the writer thread
+     *
+     * @param parent Owner of the object
+     */
+    explicit DownloadWriter(QObject *parent = 0);
+
+    /**
+     * Destructor
+     *
+     * Stops the writer thread after the operation in progress.
+     * Queued data that isn't written yet is dropped, so callers
+     * that need it on disk close the file and wait for
+     * \link closed \endlink first.
+     */
+    ~DownloadWriter();
+
+    /**
+     * @brief Queue opening a file for writing
+     *
+     * The previous file is closed after its queued data is written.
+     * Failure is reported by \link failed \endlink.
+     *
+     * @param path Path to the file
+     * @param truncate Remove existing content
+     */
+    void open(const QString& path, bool truncate);
+
+    /**
+     * @brief Queue closing the file after its queued data is written
+     *
+     * Returns immediately, \link closed \endlink is emitted once the
+     * file is closed
+     */
+    void close();
+
+    /**
+     * @brief Queue data to be written
+     * @param stream Stream the data belongs to
+     * @param offset Offset in the file
+     * @param data Data to write
+     */
+    void write(int stream, qint64 offset, const QByteArray& data);
+
+    /**
+     * @brief Queue a file size change
+     * @param size New file size
+     */
+    void resize(qint64 size);
+
+    /**
+     * @brief Queue allocation of disk space for the whole file
+     *
+     * Reserves the blocks up front when the platform supports it,
+     * which avoids fragmentation, otherwise the file is extended
+     *
+     * @param size File size
+     */
+    void preallocate(qint64 size);
+
+    /**
+     * @brief Get queued bytes of a stream
+     * @param stream Stream
+     * @return Bytes not yet written
+     */
+    qint64 pendingBytes(int stream) const;
+
+    /**
+     * @brief Get queued bytes of all streams
+     * @return Bytes not yet written
+     */
+    qint64 pendingBytes() const;
+
+    /**
+     * @brief Get number of bytes written to files
+     * @return Bytes written
+     */
+    qint64 bytesWritten() const;
+
+    /**
+     * @brief Check if the backlog is too large to queue more data
+     *
+     * Stop reading from the network until \link ready \endlink is emitted
+     *
+     * @return True if busy, otherwise false
+     */
+    bool isBusy() const;
+
+    /**
+     * @brief Set size of the gathered blocks
+     * @param size Block size in bytes
+     */
+    void setBufferSize(int size);
+
+    /**
+     * @brief Set backlog size at which the writer becomes busy
+     *
+     * The writer is ready again when the backlog has drained to half of it
+     *
+     * @param size Size in bytes
+     */
+    void setMaxPending(qint64 size);
+
+    /**
+     * @brief Check if an operation has failed
+     * @return True if failed, otherwise false
+     */
+    bool hasError() const;
+
+    /**
+     * @brief Get error of the first failed operation
+     * @return Error message
+     */
+    QString errorString() const;
+
+signals:
+    /**
+     * @brief Emitted from the writer thread when a busy writer has drained its backlog
+     */
+    void ready();
+
+    /**
+     * @brief Emitted from the writer thread when a file has been closed
+     *
+     * Everything queued before \link close \endlink is on disk, unless
+     * \link failed \endlink was emitted
+     */
+    void closed();
+
+    /**
+     * @brief Emitted from the writer thread when an operation fails
+     * @param error Error message
+     */
+    void failed(QString error);
+};
+
+} // namespace net
+} // namespace vfg
+
+#endif // VFG_NET_DOWNLOADWRITER_HPP
@@ -1,4 +1,3 @@
-#include <cctype>
 #include <utility>
 #include <QString>
 #include <QStringList>
@@ -8,11 +7,18 @@
 
 namespace vfg {
 
+const int DvdProcessor::emitInterval = 100;
+
 DvdProcessor::DvdProcessor(const QString &processorPath, QObject *parent) :
     QObject(parent),
     processor(processorPath),
-    proc(vfg::make_unique<QProcess>())
+    proc(vfg::make_unique<QProcess>()),
+    readBuffer(4096, Qt::Uninitialized)
 {
+    emitTimer.setSingleShot(true);
+    connect(&emitTimer, &QTimer::timeout,
+            this,       &DvdProcessor::emitProgress);
+
     connect(proc.get(), &QProcess::readyReadStandardOutput,
             this,       &DvdProcessor::updateDialog);
 
@@ -30,7 +36,9 @@ void DvdProcessor::process(const QStringList& files)
         return;
     }
 
-    lastProgress = 0;
+    parser.reset(files);
+    lastEmit.invalidate();
+    emitTimer.stop();
 
     QStringList args;
     args << "-ia" << "5" << "-fo" << "0" << "-yr" << "1" << "-om" << "0"
@@ -51,40 +59,57 @@ void DvdProcessor::setOutputPath(const QString &newOutputPath)
 
 void DvdProcessor::updateDialog()
 {
-    // Read last integer value from process output
-    const QByteArray rawOutput = proc->readAllStandardOutput();
-    QString parsedOutput;
-    for(int last = rawOutput.size() - 2; last >= 0; --last)
-    {
-        const char c = rawOutput.at(last);
-        if(std::isdigit(c)) {
-            parsedOutput.prepend(c);
-        }
-        else {
+    bool advanced = false;
+    while(proc->bytesAvailable() > 0) {
+        const qint64 count = proc->read(readBuffer.data(), readBuffer.size());
+        if(count <= 0) {
             break;
         }
+
+        advanced |= parser.feed(readBuffer.constData(), count);
     }
 
-    const int currentProgress = parsedOutput.toInt();
-    if(currentProgress < lastProgress) {
+    if(!advanced) {
         return;
     }
 
-    lastProgress = currentProgress;
-    emit progressUpdate(currentProgress);
+    // DGIndex prints every percent, so limit how often the UI is updated
+    // but always report completion immediately
+    if(parser.progress().percent == 100 || !lastEmit.isValid() || lastEmit.elapsed() >= emitInterval) {
+        emitProgress();
+    }
+    else if(!emitTimer.isActive()) {
+        emitTimer.start(static_cast<int>(emitInterval - lastEmit.elapsed()));
+    }
+}
+
+void DvdProcessor::emitProgress()
+{
+    emitTimer.stop();
+    lastEmit.start();
+
+    emit progressUpdate(parser.progress().percent);
+    emit statsUpdate(parser.progress());
 }
 
 void DvdProcessor::handleProcessFinish(const int exitCode)
 {
-    // Non-zero exit code implies crash / abort
+    // Non-zero exit code implies crash / abort, crashes are reported as errors
     if(exitCode == 0) {
+        if(emitTimer.isActive()) {
+            emitProgress();
+        }
         emit finished(savedPath());
     }
+    else if(proc->exitStatus() == QProcess::NormalExit && !aborted) {
+        emit error(tr("DGIndex.exe exited with code %1").arg(exitCode));
+    }
 }
 
 void DvdProcessor::handleAbortProcess()
 {
     aborted = true;
+    emitTimer.stop();
     proc->close();
 }
 
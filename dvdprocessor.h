@@ -2,8 +2,12 @@
 #define VFG_DVDPROCESSOR_H
 
 #include <memory>
+#include <QByteArray>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QProcess>
+#include <QTimer>
+#include "indexeroutputparser.h"
 
 class QString;
 class QStringList;
@@ -65,6 +69,14 @@ signals:
      */
     void progressUpdate(int progress);
 
+    /**
+     * @brief Emits estimated throughput, time left and current input file
+     *
+     * Emitted along with progressUpdate
+     * @param progress Current progress
+     */
+    void statsUpdate(const vfg::IndexerProgress& progress);
+
     /**
      * @brief Emits a signal that the processor finished
      * @param filename Path to the processed file
@@ -90,9 +102,22 @@ private:
     //! Flag to indicate whether the process was aborted by user
     bool aborted {false};
 
-    //! Tracks the last processed value from process output
-    //! as dgindex can return values smaller than last value
-    int lastProgress {0};
+    //! Parses process output as it arrives
+    IndexerOutputParser parser {};
+
+    //! Reused buffer for reading process output
+    QByteArray readBuffer;
+
+    //! Time since progress was last emitted
+    QElapsedTimer lastEmit {};
+
+    //! Emits progress held back by the rate limit
+    QTimer emitTimer {};
+
+    //! Minimum time between progress updates in milliseconds
+    static const int emitInterval;
+
+    void emitProgress();
 
 private slots:
     void updateDialog();
@@ -1,15 +1,22 @@
 #include <memory>
+#include <QString>
 #include <QUrl>
 #include "extractors/baseextractor.hpp"
 #include "extractors/dailymotionextractor.hpp"
 #include "extractors/instagramextractor.hpp"
 #include "extractors/tumblrextractor.hpp"
 #include "extractors/youtubeextractor.hpp"
+#include "extractors/youtubeplayercache.hpp"
 #include "extractorfactory.hpp"
 
 namespace vfg {
 namespace extractor {
 
+ExtractorFactory::ExtractorFactory(const QString& cacheDirectory) :
+    youtubePlayers(std::make_shared<vfg::extractor::YoutubePlayerCache>(cacheDirectory))
+{
+}
+
 std::unique_ptr<vfg::extractor::BaseExtractor> ExtractorFactory::getExtractor(const QUrl& url) const
 {
     std::unique_ptr<vfg::extractor::BaseExtractor> out;
@@ -28,7 +35,7 @@ std::unique_ptr<vfg::extractor::BaseExtractor> ExtractorFactory::getExtractor(co
         return out;
     }
 
-    out.reset(new vfg::extractor::YoutubeExtractor);
+    out.reset(new vfg::extractor::YoutubeExtractor(youtubePlayers));
     if(out->isSame(url)) {
         return out;
     }
@@ -3,11 +3,13 @@
 
 #include <memory>
 
+class QString;
 class QUrl;
 
 namespace vfg {
 namespace extractor {
     class BaseExtractor;
+    class YoutubePlayerCache;
 }
 }
 
@@ -16,11 +18,16 @@ namespace extractor {
 
 class ExtractorFactory
 {
+private:
+    //! YouTube player cache shared by the created extractors
+    std::shared_ptr<vfg::extractor::YoutubePlayerCache> youtubePlayers;
+
 public:
     /**
-     * Default constructor
+     * @brief Constructor
+     * @param cacheDirectory Directory for cached extractor data, empty to cache in memory only
      */
-    ExtractorFactory() = default;
+    explicit ExtractorFactory(const QString& cacheDirectory);
 
     /**
      * @brief Get extractor
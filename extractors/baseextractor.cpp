@@ -1,3 +1,5 @@
+#include <memory>
+#include <utility>
 #include <QByteArray>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -42,6 +44,11 @@ void BaseExtractor::download(const QString& streamName)
     emit requestReady(createRequest(url));
 }
 
+void BaseExtractor::setNetworkManager(std::unique_ptr<QNetworkAccessManager> manager)
+{
+    net = std::move(manager);
+}
+
 void BaseExtractor::log(const QString& msg) const
 {
     emit logReady(QString("[%1] %2").arg(name).arg(msg));
@@ -66,6 +66,12 @@ public:
      */
     virtual void download(const QString& streamName);
 
+    /**
+     * @brief Replace the network manager, e.g. with one for a local stand-in server
+     * @param manager Network manager
+     */
+    void setNetworkManager(std::unique_ptr<QNetworkAccessManager> manager);
+
 protected:
     /**
      * @brief Log message
@@ -97,6 +103,12 @@ signals:
      * @brief Emitted when stream URLs have been found
      */
     void streamsReady() const;
+
+    /**
+     * @brief Emitted when the streams can't be extracted
+     * @param msg Reason
+     */
+    void failed(const QString& msg) const;
 };
 
 } // namespace extractor
@@ -1,16 +1,16 @@
-#include <string>
 #include <QByteArray>
 #include <QList>
 #include <QMap>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QObject>
-#include <QRegExp>
+#include <QRegularExpression>
 #include <QString>
 #include <QUrl>
 #include <QVariant>
 #include "dailymotionextractor.hpp"
-#include "libs/picojson/picojson.h"
+#include "jsonscanner.hpp"
+#include "regexutil.hpp"
 
 namespace vfg {
 namespace extractor {
@@ -30,15 +30,17 @@ bool DailyMotionExtractor::isSame(const QUrl& url) const
 
 void DailyMotionExtractor::fetchStreams(const QUrl& url)
 {
+    static const QRegularExpression videoIdRx = compileRegex("\\/video\\/([^\?]+)");
+
     // Get the video id
-    const QRegExp rx("\\/video\\/([^\?]+)");
-    if(rx.indexIn(url.toDisplayString()) == -1) {
+    const QRegularExpressionMatch videoId = videoIdRx.match(url.toDisplayString());
+    if(!videoId.hasMatch()) {
         log("Invalid URL");
         return;
     }
 
     // Request the embed page html
-    const QUrl embedUrl(QString("http://www.dailymotion.com/embed/video/%1").arg(rx.cap(1)));
+    const QUrl embedUrl(QString("http://www.dailymotion.com/embed/video/%1").arg(videoId.captured(1)));
     reply.reset(net->get(createRequest(embedUrl)));
     connect(reply.get(), SIGNAL(finished()), this, SLOT(embedUrlFinished()));
 }
@@ -78,25 +80,25 @@ void DailyMotionExtractor::embedUrlFinished()
         {"stream_h264_hq_url", "HQ"}, {"stream_h264_ld_url", "LD"},
         {"stream_h264_url", "Standard"}
     };
-    const QString html = reply->readAll();
-    // Get the JSON object
-    const QRegExp jsonRx("var\\s*info\\s*=\\s*(\\{.+\\}),\\n");
-    if(jsonRx.indexIn(html) == -1) {
+    static const QRegularExpression jsonRx = compileRegex("var\\s*info\\s*=\\s*\\{");
+
+    const QByteArray html = reply->readAll();
+    // Find the start of the JSON object. Latin-1 keeps the offsets equal to
+    // byte offsets, and the end is found by matching braces instead of a regex
+    const QRegularExpressionMatch info = jsonRx.match(QString::fromLatin1(html));
+    const int jsonStart = info.capturedEnd() - 1;
+    if(!info.hasMatch() || JsonScanner::valueEnd(html, jsonStart) == -1) {
         log("Could not find stream data");
         return;
     }
 
-    // Parse the JSON object and get all streams
-    const std::string parsed = jsonRx.cap(1).toStdString();
-    picojson::value json;
-    picojson::parse(json, parsed);
-    if(json.is<picojson::object>()) {
-        for(const QString& format : formats.keys()) {
-            const picojson::value val = json.get(format.toStdString());
-            if(val.is<std::string>()) {
-                foundStreams.insert(formats.value(format),
-                                    QString::fromStdString(val.get<std::string>()));
-            }
+    // Read only the stream URLs from the JSON object
+    const JsonScanner json(html, jsonStart);
+    for(const QString& format : formats.keys()) {
+        bool found = false;
+        const QString streamUrl = json.string({format.toLatin1().constData()}, &found);
+        if(found) {
+            foundStreams.insert(formats.value(format), streamUrl);
         }
     }
 
@@ -2,10 +2,12 @@
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QObject>
-#include <QRegExp>
+#include <QRegularExpression>
+#include <QString>
 #include <QStringList>
 #include <QUrl>
 #include "instagramextractor.hpp"
+#include "regexutil.hpp"
 
 namespace vfg {
 namespace extractor {
@@ -41,14 +43,16 @@ void InstagramExtractor::download(const QString& streamName)
 
 void InstagramExtractor::pageReply()
 {
-    const QByteArray html = reply->readAll();
-    const QRegExp urlRx("<meta property=\"og:video\" content=\"([^\"]+)\" \\/>");
-    if(urlRx.indexIn(html) == -1) {
+    static const QRegularExpression urlRx =
+            compileRegex("<meta property=\"og:video\" content=\"([^\"]+)\" \\/>");
+
+    const QRegularExpressionMatch videoUrl = urlRx.match(QString::fromUtf8(reply->readAll()));
+    if(!videoUrl.hasMatch()) {
         log("Could not find stream URL");
         return;
     }
 
-    dlUrl.setUrl(urlRx.cap(1));
+    dlUrl.setUrl(videoUrl.captured(1));
 
     emit streamsReady();
 }
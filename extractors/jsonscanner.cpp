@@ -0,0 +1,271 @@
+#include <cstring>
+#include <QChar>
+#include "jsonscanner.hpp"
+
+namespace {
+
+bool isSpace(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+int skipSpace(const QByteArray& text, int pos) {
+    while(pos < text.size() && isSpace(text.at(pos))) {
+        ++pos;
+    }
+
+    return pos;
+}
+
+/**
+ * @brief Skip a string
+ * @param text JSON text
+ * @param pos Position of the opening quote
+ * @return Position after the closing quote, -1 if unterminated
+ */
+int skipString(const QByteArray& text, int pos) {
+    const char *data = text.constData();
+    const int size = text.size();
+    for(++pos; pos < size; ++pos) {
+        if(data[pos] == '\\') {
+            ++pos;
+        }
+        else if(data[pos] == '"') {
+            return pos + 1;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Skip any value
+ * @param text JSON text
+ * @param pos Position of the first character of the value
+ * @return Position after the value, -1 if malformed
+ */
+int skipValue(const QByteArray& text, const int pos) {
+    if(pos >= text.size()) {
+        return -1;
+    }
+
+    const char c = text.at(pos);
+    if(c == '"') {
+        return skipString(text, pos);
+    }
+    else if(c == '{' || c == '[') {
+        return vfg::extractor::JsonScanner::valueEnd(text, pos);
+    }
+
+    // Number, true, false or null
+    int end = pos;
+    while(end < text.size()) {
+        const char e = text.at(end);
+        if(e == ',' || e == '}' || e == ']' || isSpace(e)) {
+            break;
+        }
+        ++end;
+    }
+
+    return end > pos ? end : -1;
+}
+
+/**
+ * @brief Find the value of a key in an object
+ * @param text JSON text
+ * @param pos Position of the object's opening brace
+ * @param key Key to find
+ * @return Position of the value, -1 if not found
+ */
+int findKey(const QByteArray& text, int pos, const char *key) {
+    if(pos < 0 || pos >= text.size() || text.at(pos) != '{') {
+        return -1;
+    }
+
+    const int keyLength = static_cast<int>(std::strlen(key));
+    pos = skipSpace(text, pos + 1);
+    while(pos < text.size() && text.at(pos) == '"') {
+        const int keyEnd = skipString(text, pos);
+        if(keyEnd == -1) {
+            return -1;
+        }
+
+        const bool matches = keyEnd - pos - 2 == keyLength
+                && std::memcmp(text.constData() + pos + 1, key, keyLength) == 0;
+
+        pos = skipSpace(text, keyEnd);
+        if(pos >= text.size() || text.at(pos) != ':') {
+            return -1;
+        }
+
+        pos = skipSpace(text, pos + 1);
+        if(matches) {
+            return pos;
+        }
+
+        pos = skipValue(text, pos);
+        if(pos == -1) {
+            return -1;
+        }
+
+        pos = skipSpace(text, pos);
+        if(pos >= text.size() || text.at(pos) != ',') {
+            return -1;
+        }
+
+        pos = skipSpace(text, pos + 1);
+    }
+
+    return -1;
+}
+
+int hexValue(const char c) {
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    else if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    else if(c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Decode a string
+ * @param text JSON text
+ * @param pos Position of the opening quote
+ * @param ok Set to false if the string is malformed
+ * @return Decoded string
+ */
+QString decodeString(const QByteArray& text, int pos, bool *ok) {
+    QString decoded;
+    const char *data = text.constData();
+    const int size = text.size();
+
+    // Unescaped runs are converted from UTF-8 at once
+    int run = ++pos;
+    for(; pos < size; ++pos) {
+        if(data[pos] == '"') {
+            decoded.append(QString::fromUtf8(data + run, pos - run));
+            *ok = true;
+            return decoded;
+        }
+        else if(data[pos] != '\\') {
+            continue;
+        }
+
+        decoded.append(QString::fromUtf8(data + run, pos - run));
+        if(++pos >= size) {
+            break;
+        }
+
+        switch(data[pos]) {
+        case 'b': decoded.append(QChar('\b')); break;
+        case 'f': decoded.append(QChar('\f')); break;
+        case 'n': decoded.append(QChar('\n')); break;
+        case 'r': decoded.append(QChar('\r')); break;
+        case 't': decoded.append(QChar('\t')); break;
+        case 'u': {
+            if(pos + 4 >= size) {
+                *ok = false;
+                return {};
+            }
+
+            int code = 0;
+            for(int i = 1; i <= 4; ++i) {
+                const int digit = hexValue(data[pos + i]);
+                if(digit == -1) {
+                    *ok = false;
+                    return {};
+                }
+                code = code * 16 + digit;
+            }
+
+            // Surrogate pairs arrive as two escapes and combine in UTF-16
+            decoded.append(QChar(static_cast<ushort>(code)));
+            pos += 4;
+            break;
+        }
+        default:
+            // \" \\ \/
+            decoded.append(QChar::fromLatin1(data[pos]));
+        }
+
+        run = pos + 1;
+    }
+
+    *ok = false;
+    return {};
+}
+
+} // namespace
+
+namespace vfg {
+namespace extractor {
+
+JsonScanner::JsonScanner(const QByteArray& text, const int from) :
+    json(text),
+    root(from)
+{
+}
+
+int JsonScanner::valueEnd(const QByteArray& text, const int from)
+{
+    const char *data = text.constData();
+    const int size = text.size();
+    int depth = 0;
+    for(int pos = from; pos < size; ++pos) {
+        const char c = data[pos];
+        if(c == '"') {
+            pos = skipString(text, pos);
+            if(pos == -1) {
+                return -1;
+            }
+
+            // Compensate for the loop increment
+            --pos;
+        }
+        else if(c == '{' || c == '[') {
+            ++depth;
+        }
+        else if(c == '}' || c == ']') {
+            if(--depth == 0) {
+                return pos + 1;
+            }
+        }
+    }
+
+    return -1;
+}
+
+QString JsonScanner::string(const std::initializer_list<const char*> path, bool *ok) const
+{
+    bool found = false;
+    if(ok) {
+        *ok = false;
+    }
+
+    int pos = root;
+    for(const char *key : path) {
+        pos = findKey(json, pos, key);
+        if(pos == -1) {
+            return {};
+        }
+    }
+
+    if(pos >= json.size() || json.at(pos) != '"') {
+        return {};
+    }
+
+    const QString value = decodeString(json, pos, &found);
+    if(ok) {
+        *ok = found;
+    }
+
+    return value;
+}
+
+} // namespace extractor
+} // namespace vfg
@@ -0,0 +1,63 @@
+#ifndef VFG_EXTRACTOR_JSONSCANNER_HPP
+#define VFG_EXTRACTOR_JSONSCANNER_HPP
+
+#include <initializer_list>
+#include <QByteArray>
+#include <QString>
+
+namespace vfg {
+namespace extractor {
+
+/**
+ * @brief The JsonScanner class
+ *
+ * Reads single string values from a JSON object without parsing the
+ * whole document. Values on the way to the requested key are skipped
+ * by matching brackets and quotes, so nothing is decoded or allocated
+ * except the returned string.
+ *
+ * Extractors only need a few keys of large player configs, which makes
+ * this much cheaper than building a full JSON tree.
+ */
+class JsonScanner
+{
+private:
+    //! JSON text
+    QByteArray json;
+
+    //! Position of the root object in the text
+    int root;
+
+public:
+    /**
+     * @brief Constructor
+     * @param text Text containing a JSON object
+     * @param from Position of the object's opening brace in the text
+     */
+    explicit JsonScanner(const QByteArray& text, int from = 0);
+
+    /**
+     * @brief Find the end of a JSON object or array
+     * @param text Text containing the object
+     * @param from Position of the opening brace or bracket
+     * @return Position after the closing brace or bracket, -1 if unterminated
+     */
+    static int valueEnd(const QByteArray& text, int from);
+
+    /**
+     * @brief Get a string value by its key path
+     *
+     * For example {"args", "title"} reads json.args.title.
+     * Keys containing escape sequences are not matched.
+     *
+     * @param path Keys of the nested objects, ending with the key of the value
+     * @param ok Set to true if the value was found and is a string
+     * @return Decoded string, empty if not found
+     */
+    QString string(std::initializer_list<const char*> path, bool *ok = nullptr) const;
+};
+
+} // namespace extractor
+} // namespace vfg
+
+#endif // VFG_EXTRACTOR_JSONSCANNER_HPP
@@ -0,0 +1,33 @@
+#ifndef VFG_EXTRACTOR_REGEXUTIL_HPP
+#define VFG_EXTRACTOR_REGEXUTIL_HPP
+
+#include <QRegularExpression>
+#include <QString>
+
+namespace vfg {
+namespace extractor {
+
+/**
+ * @brief Compile a regular expression that is reused for every page
+ *
+ * The pattern is compiled and JIT optimized up front instead of on
+ * its first matches. Keep the result in a static so it's compiled once.
+ *
+ * @param pattern Perl compatible pattern
+ * @param options Pattern options
+ * @return Compiled expression
+ */
+inline QRegularExpression compileRegex(const QString& pattern,
+                                       const QRegularExpression::PatternOptions options =
+                                            QRegularExpression::NoPatternOption)
+{
+    QRegularExpression rx(pattern, options);
+    rx.optimize();
+
+    return rx;
+}
+
+} // namespace extractor
+} // namespace vfg
+
+#endif // VFG_EXTRACTOR_REGEXUTIL_HPP
@@ -1,8 +1,10 @@
 #include <QByteArray>
 #include <QObject>
-#include <QRegExp>
+#include <QRegularExpression>
+#include <QString>
 #include <QStringList>
 #include <QUrl>
+#include "regexutil.hpp"
 #include "tumblrextractor.hpp"
 
 // Thanks to:
@@ -11,14 +13,16 @@
 
 namespace {
 
-QUrl getSourceUrl(const QByteArray& html)
+QUrl getSourceUrl(const QString& html)
 {
-    const QRegExp sourceRx("<source src=\"([^\"]*)\"");
-    if(sourceRx.indexIn(html) == -1) {
+    static const QRegularExpression sourceRx =
+            vfg::extractor::compileRegex("<source src=\"([^\"]*)\"");
+    const QRegularExpressionMatch source = sourceRx.match(html);
+    if(!source.hasMatch()) {
         return {};
     }
 
-    return {sourceRx.cap(1)};
+    return {source.captured(1)};
 }
 
 } // namespace
@@ -57,9 +61,17 @@ void TumblrExtractor::download(const QString& streamName)
 
 void TumblrExtractor::postReplyFinished()
 {
-    const QByteArray html = postReply->readAll();
-    const QRegExp feedTypeRx("<meta property=\"og:type\" content=\"tumblr-feed:(\\w+)\" \\/>");
-    if(feedTypeRx.indexIn(html) == -1) {
+    static const QRegularExpression feedTypeRx =
+            compileRegex("<meta property=\"og:type\" content=\"tumblr-feed:(\\w+)\" \\/>");
+    static const QRegularExpression videoMeRx =
+            compileRegex("src=[\'\"](https?://vid\\.me/[^\'\"]+)[\'\"]");
+    static const QRegularExpression videoLinkRx =
+            compileRegex("<iframe src='(https?:\\/\\/www\\.tumblr\\.com\\/video\\/[^\']*)'");
+
+    // Converted once for all the regexes
+    const QString html = QString::fromUtf8(postReply->readAll());
+    const QRegularExpressionMatch feedTypeMatch = feedTypeRx.match(html);
+    if(!feedTypeMatch.hasMatch()) {
         // We might be on the video page already...
         const QUrl sourceUrl = getSourceUrl(html);
         if(sourceUrl.isEmpty()) {
@@ -73,34 +85,32 @@ void TumblrExtractor::postReplyFinished()
         }
     }
 
-    const QString feedType = feedTypeRx.cap(1);
+    const QString feedType = feedTypeMatch.captured(1);
     if(feedType == "audio") {
         log("Page contains only audio");
         return;
     }
 
     // Check for vid.me embedded video
-    const QRegExp videoMeRx("src=[\'\"](https?://vid\\.me/[^\'\"]+)[\'\"]");
-    if(videoMeRx.indexIn(html) > -1) {
+    if(html.contains("vid.me/") && videoMeRx.match(html).hasMatch()) {
         log("Vid.me embedded videos are not currently supported. Sorry!");
         return;
     }
 
-    const QRegExp videoLinkRx("<iframe src='(https?:\\/\\/www\\.tumblr\\.com\\/video\\/[^\']*)'");
-    if(videoLinkRx.indexIn(html) == -1) {
+    const QRegularExpressionMatch videoLinkMatch = videoLinkRx.match(html);
+    if(!videoLinkMatch.hasMatch()) {
         log("Could not find video URL");
         return;
     }
 
-    const QString videoLink = videoLinkRx.cap(1);
+    const QString videoLink = videoLinkMatch.captured(1);
     videoReply.reset(net->get(createRequest(QUrl(videoLink))));
     connect(videoReply.get(), SIGNAL(finished()), this, SLOT(videoReplyFinished()));
 }
 
 void TumblrExtractor::videoReplyFinished()
 {
-    const QByteArray html = videoReply->readAll();
-    const QUrl sourceUrl = getSourceUrl(html);
+    const QUrl sourceUrl = getSourceUrl(QString::fromUtf8(videoReply->readAll()));
     if(sourceUrl.isEmpty()) {
         log("Could not find source URL");
         return;
@@ -1,18 +1,21 @@
 #include <algorithm>
-#include <string>
+#include <memory>
+#include <utility>
 #include <QByteArray>
 #include <QList>
 #include <QMap>
 #include <QNetworkRequest>
 #include <QObject>
-#include <QRegExp>
+#include <QRegularExpression>
 #include <QScriptEngine>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
 #include <QUrlQuery>
-#include "libs/picojson/picojson.h"
+#include "jsonscanner.hpp"
+#include "regexutil.hpp"
 #include "youtubeextractor.hpp"
+#include "youtubeplayercache.hpp"
 
 namespace {
 
@@ -74,31 +77,23 @@ QMap<T, T> parseQueryString(const T& query) {
     return entries;
 }
 
-QStringList match(const QString& regex, const QString& text) {
-    const QRegExp rx(regex);
-    if(rx.indexIn(text) > -1) {
-        return rx.capturedTexts();
-    }
-    else {
-        return {};
-    }
-}
-
 } // namespace
 
 namespace vfg {
 namespace extractor {
 
-YoutubeExtractor::YoutubeExtractor(QObject *parent) :
+YoutubeExtractor::YoutubeExtractor(std::shared_ptr<YoutubePlayerCache> cache, QObject *parent) :
     BaseExtractor("youtube", parent),
     videoInfoReply(),
     videoPageReply(),
-    html5JsReply(),
     embedPageReply(),
     embedVideoInfoReply(),
     videoId(),
-    html5Player()
+    html5Player(),
+    playerCache(cache ? std::move(cache) : std::make_shared<YoutubePlayerCache>(QString()))
 {
+    connect(playerCache.get(),  &YoutubePlayerCache::decipherReady,
+            this,               &YoutubeExtractor::decipherReady);
 }
 
 bool YoutubeExtractor::isSame(const QUrl &url) const
@@ -109,17 +104,28 @@ bool YoutubeExtractor::isSame(const QUrl &url) const
 
 void YoutubeExtractor::fetchStreams(const QUrl &url)
 {
+    static const QRegularExpression watchRx = compileRegex("watch\\?v=([a-zA-Z0-9-_]{11})");
+    static const QRegularExpression shortRx = compileRegex("youtu\\.be\\/([a-zA-Z0-9-_]{11})");
+
     // Get video id
-    QRegExp videoIdRx("watch\\?v=([a-zA-Z0-9-_]{11})");
-    if(videoIdRx.indexIn(url.toDisplayString()) == -1) {
-        videoIdRx.setPattern("youtu\\.be\\/([a-zA-Z0-9-_]{11})");
-        if(videoIdRx.indexIn(url.toDisplayString()) == -1) {
+    const QString displayUrl = url.toDisplayString();
+    QRegularExpressionMatch videoIdMatch = watchRx.match(displayUrl);
+    if(!videoIdMatch.hasMatch()) {
+        videoIdMatch = shortRx.match(displayUrl);
+        if(!videoIdMatch.hasMatch()) {
             log("Invalid URL");
             return;
         }
     }
 
-    videoId = videoIdRx.cap(1);
+    videoId = videoIdMatch.captured(1);
+    videoPageHtml.clear();
+    videoPageDone = false;
+    needsVideoPage = false;
+    decipherRequested = false;
+    waitingForDecipher = false;
+    decipherCode.clear();
+
     QUrl ytUrl("https://www.youtube.com/get_video_info");
     QUrlQuery urlQuery;
     urlQuery.addQueryItem("video_id", videoId);
@@ -127,6 +133,10 @@ void YoutubeExtractor::fetchStreams(const QUrl &url)
 
     videoInfoReply.reset(net->get(createRequest(ytUrl)));
     connect(videoInfoReply.get(), SIGNAL(finished()), this, SLOT(videoInfoFinished()));
+
+    // Most videos need the video page as well, so request it at the same time
+    videoPageReply.reset(net->get(makeYoutubeRequest(videoId)));
+    connect(videoPageReply.get(), SIGNAL(finished()), this, SLOT(videoPageFinished()));
 }
 
 QStringList YoutubeExtractor::getStreams() const
@@ -154,22 +164,25 @@ void YoutubeExtractor::videoInfoFinished()
                 || videoInfo.value("use_cipher_signature") == "False") {
             log("use_cipher_signature: Disabled");
             log(QString("Title: ").append(QUrl::fromPercentEncoding(videoInfo.value("title"))));
+
+            // The video page isn't needed after all
+            if(!videoPageDone) {
+                videoPageReply->disconnect(this);
+                videoPageReply->abort();
+            }
+
             QByteArray decoded;
             decoded.append(QUrl::fromPercentEncoding(videoInfo.value("url_encoded_fmt_stream_map")));
             processStreamList(decoded.split(','));
         }
         else {
             log("use_cipher_signature: Enabled");
-            videoPageReply.reset(net->get(makeYoutubeRequest(videoId)));
-            connect(videoPageReply.get(), SIGNAL(finished()),
-                    this, SLOT(videoPageFinished()));
+            useVideoPage();
         }
     }
     else if(videoInfo.value("status") == "fail") {
         if(videoInfo.value("errorcode") == "150") {
-            videoPageReply.reset(net->get(makeYoutubeRequest(videoId)));
-            connect(videoPageReply.get(), SIGNAL(finished()),
-                    this, SLOT(videoPageFinished()));
+            useVideoPage();
         }
         else if(videoInfo.value("errorcode") == "100") {
             log("This video does not exist");
@@ -186,7 +199,31 @@ void YoutubeExtractor::videoInfoFinished()
 
 void YoutubeExtractor::videoPageFinished()
 {
-    const QByteArray videoPageHtml = videoPageReply->readAll();
+    videoPageHtml = videoPageReply->readAll();
+    videoPageDone = true;
+
+    // Look up the player while waiting for the video info
+    const QString player = findPlayer(videoPageHtml);
+    if(!player.isEmpty()) {
+        html5Player = player;
+        requestDecipher();
+    }
+
+    if(needsVideoPage) {
+        processVideoPage();
+    }
+}
+
+void YoutubeExtractor::useVideoPage()
+{
+    needsVideoPage = true;
+    if(videoPageDone) {
+        processVideoPage();
+    }
+}
+
+void YoutubeExtractor::processVideoPage()
+{
     if(videoPageHtml.contains("player-age-gate-content\">")) {
         log("Found age-restriced video");
         embedPageReply.reset(net->get(createRequest(QUrl(QString("https://www.youtube.com/embed/").append(videoId)))));
@@ -194,81 +231,41 @@ void YoutubeExtractor::videoPageFinished()
     }
     else {
         // Get the ytplayer.config JSON object from the page
-        const QRegExp jsonRx("ytplayer.config = (\\{.+\\});");
-        if(jsonRx.indexIn(videoPageHtml) == -1) {
+        const QByteArray config = findPlayerConfig(videoPageHtml);
+        if(config.isEmpty()) {
             log("Could not find ytplayer.config");
             return;
         }
 
         // Parse the JSON object and get the stream list
-        const QByteArray decoded = parseYtPlayerConfig(jsonRx.cap(1));
+        const QByteArray decoded = parseYtPlayerConfig(config);
         processStreamList(decoded.split(','));
     }
 }
 
-void YoutubeExtractor::html5JsFinished()
-{
-    // The following regexes extract the functions used to decrypt the signature
-    const QByteArray js = html5JsReply->readAll();
-    const QString f1 = match("\\w+\\.sig\\|\\|([$\\w]+)\\(\\w+\\.\\w+\\)", js).at(1);
-    QString f1def = match(QString("(function %1\\(\\w+\\)\\{[^\\{]+\\})").arg(QRegExp::escape(f1)), js).at(1);
-    f1def.replace(QRegExp("([$\\w]+\\.)([$\\w]+\\(\\w+,\\d+\\))"), "\\2");
-    QString code = f1def;
-    const QRegExp a("([$\\w]+)\\(\\w+,\\d+\\)");
-    int pos = 0;
-    while((pos = a.indexIn(f1def, pos)) != -1) {
-        pos += a.matchedLength();
-        const QString f2 = a.cap(1);
-        const QString f2e = QRegExp::escape(f2);
-        QStringList f2def = match(QString("[^$\\w]%1:function\\((\\w+,\\w+)\\)(\\{[^\\{\\}]+\\})").arg(f2e), js);
-        if(!f2def.isEmpty()) {
-            const QString tmp = QString("function %1(%2)%3}").arg(f2e).arg(f2def.at(1)).arg(f2def.at(2));
-            f2def.clear();
-            f2def << tmp;
-        }
-        else {
-            f2def = match(QString("[^$\\w]%1:function\\((\\w+)\\)(\\{[^\\{\\}]+\\})").arg(f2e), js);
-            f2def = QStringList(QString("function %1(%2,b)%3").arg(f2e).arg(f2def.at(1)).arg(f2def.at(2)));
-        }
-
-        code.append(f2def.at(0));
-    }
-
-    code.append(QString("var sig=%1(s)").arg(f1));
-    code.replace("}}", "}");
-
-    // Evaluate the code to compute the decrypted signature values for all streams
-    QScriptEngine engine;
-    for(const QMap<QByteArray, QByteArray>& stream : rawStreams) {
-        if(stream.contains("s")) {
-            engine.globalObject().setProperty("s", QString(stream.value("s")));
-            engine.evaluate(code);
-
-            const QString decryptedSignature = engine.globalObject().property("sig").toString();
-            const QUrl url(QUrl::fromPercentEncoding(stream.value("url")).append("&signature=").append(decryptedSignature));
-
-            foundStreams.insert(stringify(findStream(stream.value("itag").toInt())), url);
-        }
-    }
-
-    emit streamsReady();
-}
-
 void YoutubeExtractor::embedPageFinished()
 {
+    static const QRegularExpression stsRx = compileRegex("\"sts\"\\s*:\\s*(\\d+)");
+
     const QByteArray embedPage = embedPageReply->readAll();
     // Get the ytplayer.config JSON object from the page
-    const QRegExp jsonRx("ytplayer.config = (\\{.+\\});");
-    if(jsonRx.indexIn(embedPage) == -1) {
-        const QStringList m = match("\"assets\":\\{.*\"js\":\"([^\"]+)\".*\\}", embedPage);
-        if(m.size() == 2) {
-            html5Player = QString("https:").append(m.at(1).replace("\\/", "/"));
+    const QByteArray config = findPlayerConfig(embedPage);
+    if(config.isEmpty()) {
+        const QString player = findPlayer(embedPage);
+        if(!player.isEmpty()) {
+            html5Player = player;
+            requestDecipher();
         }
 
+        // Only the text around the key is converted for the regex
+        const int stsPos = embedPage.indexOf("\"sts\"");
+        const QString sts = stsPos == -1 ? QString()
+                : stsRx.match(QString::fromLatin1(embedPage.mid(stsPos, 32))).captured(1);
+
         QUrlQuery query;
         query.addQueryItem("video_id", videoId);
         query.addQueryItem("eurl", QString("https://youtube.googleapis.com/v/").append(videoId));
-        query.addQueryItem("sts", match("\"sts\"\\s*:\\s*(\\d+)", embedPage).at(1));
+        query.addQueryItem("sts", sts);
         QUrl url("https://www.youtube.com/get_video_info");
         url.setQuery(query);
         embedVideoInfoReply.reset(net->get(createRequest(url)));
@@ -276,7 +273,7 @@ void YoutubeExtractor::embedPageFinished()
     }
     else {
         // Parse the JSON object and get the stream list
-        const QByteArray decoded = parseYtPlayerConfig(jsonRx.cap(1));
+        const QByteArray decoded = parseYtPlayerConfig(config);
         processStreamList(decoded.split(','));
     }
 }
@@ -327,49 +324,151 @@ void YoutubeExtractor::handleStreamDownload()
     if(std::any_of(rawStreams.begin(), rawStreams.end(),
                    [](const QMap<QByteArray, QByteArray>& stream){ return stream.contains("s"); })) {
         log("Found encrypted stream(s). Decrypting...");
-        html5JsReply.reset(net->get(createRequest(QUrl(html5Player))));
-        connect(html5JsReply.get(), SIGNAL(finished()), this, SLOT(html5JsFinished()));
+        waitingForDecipher = true;
+        requestDecipher();
+        if(!decipherCode.isEmpty()) {
+            decryptStreams();
+        }
+        else if(!playerCache->isFetching(QUrl(html5Player))) {
+            // The player was already fetched without usable code
+            decipherFailed();
+        }
     }
     else {
         emit streamsReady();
     }
 }
 
-QByteArray YoutubeExtractor::parseYtPlayerConfig(const QString& jsonStr)
+void YoutubeExtractor::requestDecipher()
 {
-    QByteArray decoded;
-    const std::string parsed = jsonStr.toStdString();
-    picojson::value json;
-    picojson::parse(json, parsed);
-    if(json.is<picojson::object>()) {
-        const picojson::value args = json.get("args");
-        if(args.is<picojson::object>()) {
-            const picojson::value title = args.get("title");
-            if(title.is<std::string>()) {
-                QByteArray ba;
-                ba.append(QString::fromStdString(title.get<std::string>()));
-                log(QString("Title: ").append(QUrl::fromPercentEncoding(ba)));
-                const picojson::value streamMap = args.get("url_encoded_fmt_stream_map");
-                if(streamMap.is<std::string>()) {
-                    decoded.append(QString::fromStdString(streamMap.get<std::string>()));
-                }
-            }
-            else {
-                log("The uploader has not made this video available in your country");
-                return decoded;
-            }
+    if(html5Player.isEmpty() || decipherRequested) {
+        return;
+    }
+
+    decipherRequested = true;
+    decipherCode = playerCache->decipher(QUrl(html5Player));
+    if(decipherCode.isEmpty()) {
+        playerCache->fetch(createRequest(QUrl(html5Player)));
+    }
+}
+
+void YoutubeExtractor::decipherReady(const QString& version, const QString& code)
+{
+    if(html5Player.isEmpty() || version != YoutubePlayerCache::playerVersion(QUrl(html5Player))) {
+        return;
+    }
+
+    decipherCode = code;
+    if(!waitingForDecipher) {
+        return;
+    }
+    else if(decipherCode.isEmpty()) {
+        decipherFailed();
+        return;
+    }
+
+    decryptStreams();
+}
+
+void YoutubeExtractor::decipherFailed()
+{
+    waitingForDecipher = false;
+
+    const QString msg("Could not find the signature decryption function");
+    log(msg);
+    emit failed(msg);
+}
+
+void YoutubeExtractor::decryptStreams()
+{
+    waitingForDecipher = false;
+
+    // Evaluate the code to compute the decrypted signature values for all streams
+    QScriptEngine engine;
+    for(const QMap<QByteArray, QByteArray>& stream : rawStreams) {
+        if(stream.contains("s")) {
+            engine.globalObject().setProperty("s", QString(stream.value("s")));
+            engine.evaluate(decipherCode);
+
+            const QString decryptedSignature = engine.globalObject().property("sig").toString();
+            const QUrl url(QUrl::fromPercentEncoding(stream.value("url")).append("&signature=").append(decryptedSignature));
+
+            foundStreams.insert(stringify(findStream(stream.value("itag").toInt())), url);
         }
+    }
 
-        const picojson::value assets = json.get("assets");
-        if(assets.is<picojson::object>()) {
-            const picojson::value js = assets.get("js");
-            if(js.is<std::string>()) {
-                html5Player = QString("https:").append(QString::fromStdString(js.get<std::string>()));
-            }
+    emit streamsReady();
+}
+
+QByteArray YoutubeExtractor::findPlayerConfig(const QByteArray& page)
+{
+    // A plain search finds the object, its end is found by matching braces
+    static const QByteArray marker("ytplayer.config = ");
+    const int pos = page.indexOf(marker);
+    if(pos == -1) {
+        return {};
+    }
+
+    const int start = pos + marker.size();
+    if(start >= page.size() || page.at(start) != '{') {
+        return {};
+    }
+
+    const int end = JsonScanner::valueEnd(page, start);
+    if(end == -1) {
+        return {};
+    }
+
+    return page.mid(start, end - start);
+}
+
+YoutubeExtractor::PlayerConfig YoutubeExtractor::parsePlayerConfig(const QByteArray& json)
+{
+    PlayerConfig config;
+    const JsonScanner scanner(json);
+    config.title = scanner.string({"args", "title"}, &config.available);
+    if(!config.available) {
+        return config;
+    }
+
+    config.streamMap = scanner.string({"args", "url_encoded_fmt_stream_map"}).toUtf8();
+
+    const QString js = scanner.string({"assets", "js"});
+    if(!js.isEmpty()) {
+        config.player = QString("https:").append(js);
+    }
+
+    return config;
+}
+
+QString YoutubeExtractor::findPlayer(const QByteArray& page)
+{
+    static const QByteArray marker("\"assets\":{");
+    for(int pos = page.indexOf(marker); pos != -1; pos = page.indexOf(marker, pos + 1)) {
+        const QString js = JsonScanner(page, pos + marker.size() - 1).string({"js"});
+        if(!js.isEmpty()) {
+            return QString("https:").append(js);
         }
     }
 
-    return decoded;
+    return {};
+}
+
+QByteArray YoutubeExtractor::parseYtPlayerConfig(const QByteArray& json)
+{
+    const PlayerConfig config = parsePlayerConfig(json);
+    if(!config.available) {
+        log("The uploader has not made this video available in your country");
+        return {};
+    }
+
+    log(QString("Title: ").append(QUrl::fromPercentEncoding(config.title.toUtf8())));
+
+    if(!config.player.isEmpty()) {
+        html5Player = config.player;
+    }
+
+    return config.streamMap;
 }
 
 QNetworkRequest YoutubeExtractor::makeYoutubeRequest(const QString& videoId) const
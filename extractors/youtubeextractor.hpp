@@ -5,10 +5,10 @@
 #include <QList>
 #include <QMap>
 #include <QNetworkReply>
+#include <QByteArray>
 #include <QString>
 #include "extractors/baseextractor.hpp"
 
-class QByteArray;
 class QNetworkRequest;
 class QObject;
 class QStringList;
@@ -17,6 +17,8 @@ class QUrl;
 namespace vfg {
 namespace extractor {
 
+class YoutubePlayerCache;
+
 /**
  * @brief The YoutubeExtractor class
  *
@@ -24,11 +26,36 @@ namespace extractor {
  *
  * Currently supports at least non-encrypted streams,
  * encrypted streams and age-restricted streams
+ *
+ * The video info and the video page are requested at the same time,
+ * and the player script is looked up as soon as the page names it.
+ * Signature decryption code is shared through a
+ * \link YoutubePlayerCache \endlink so that each player version is
+ * fetched once.
  */
 class YoutubeExtractor : public vfg::extractor::BaseExtractor
 {
     Q_OBJECT
 
+public:
+    /**
+     * @brief Fields of ytplayer.config used by the extractor
+     */
+    struct PlayerConfig
+    {
+        //! Set if the video is available in the viewer's country
+        bool available {false};
+
+        //! Percent-encoded video title
+        QString title {};
+
+        //! Comma separated list of streams
+        QByteArray streamMap {};
+
+        //! URL to the html5 player JS file, empty if not named
+        QString player {};
+    };
+
 private:
     //! get_video_info reply
     std::unique_ptr<QNetworkReply> videoInfoReply;
@@ -36,9 +63,6 @@ private:
     //! watch?v=xyz page reply
     std::unique_ptr<QNetworkReply> videoPageReply;
 
-    //! HTML5 JS video player file reply
-    std::unique_ptr<QNetworkReply> html5JsReply;
-
     //! Embed page reply
     std::unique_ptr<QNetworkReply> embedPageReply;
 
@@ -51,6 +75,27 @@ private:
     //! URL to html5 video player JS file
     QString html5Player;
 
+    //! Player scripts and decryption code shared by extractors
+    std::shared_ptr<YoutubePlayerCache> playerCache;
+
+    //! Downloaded video page, kept until it's known whether it's needed
+    QByteArray videoPageHtml;
+
+    //! Set when the video page has been downloaded
+    bool videoPageDone {false};
+
+    //! Set when the streams must be read from the video page
+    bool needsVideoPage {false};
+
+    //! Set when the decryption code has been requested
+    bool decipherRequested {false};
+
+    //! Set when encrypted streams wait for the decryption code
+    bool waitingForDecipher {false};
+
+    //! Signature decryption code of the player
+    QString decipherCode;
+
     //! Raw streams
     QList<QMap<QByteArray, QByteArray>> rawStreams;
 
@@ -60,9 +105,10 @@ private:
 public:
     /**
      * @brief Constructor
+     * @param cache Player cache shared with other extractors, nullptr for a private in-memory cache
      * @param parent Owner of the widget
      */
-    explicit YoutubeExtractor(QObject *parent = 0);
+    explicit YoutubeExtractor(std::shared_ptr<YoutubePlayerCache> cache = nullptr, QObject *parent = 0);
 
     bool isSame(const QUrl &url) const override;
 
@@ -72,6 +118,27 @@ public:
 
     void download(const QString &streamName) override;
 
+    /**
+     * @brief Find the ytplayer.config JSON object in a video or embed page
+     * @param page Page HTML
+     * @return JSON object, empty if not found
+     */
+    static QByteArray findPlayerConfig(const QByteArray& page);
+
+    /**
+     * @brief Read the needed fields of ytplayer.config without parsing all of it
+     * @param json ytplayer.config JSON object
+     * @return Player config
+     */
+    static PlayerConfig parsePlayerConfig(const QByteArray& json);
+
+    /**
+     * @brief Find the html5 player named in the assets of a page
+     * @param page Page HTML
+     * @return URL to the html5 player JS file, empty if not found
+     */
+    static QString findPlayer(const QByteArray& page);
+
 private:
     /**
      * @brief Process stream list
@@ -92,10 +159,35 @@ private:
     void handleStreamDownload();
 
     /**
-     * @brief Parses JSON object jsonStr returning url_encoded_fmt_stream_map field
-     * @param jsonStr JSON object to parse
+     * @brief Read streams from the downloaded video page
+     */
+    void processVideoPage();
+
+    /**
+     * @brief Read streams from the video page once it has been downloaded
+     */
+    void useVideoPage();
+
+    /**
+     * @brief Look up the decryption code of the player, fetching the player if needed
+     */
+    void requestDecipher();
+
+    /**
+     * @brief Decrypt the signatures of encrypted streams
+     */
+    void decryptStreams();
+
+    /**
+     * @brief Stop waiting for the decryption code and report the failure
+     */
+    void decipherFailed();
+
+    /**
+     * @brief Parses JSON object json returning url_encoded_fmt_stream_map field
+     * @param json JSON object to parse
      */
-    QByteArray parseYtPlayerConfig(const QString& jsonStr);
+    QByteArray parseYtPlayerConfig(const QByteArray& json);
 
     /**
      * @brief Make request to Youtube video page
@@ -116,9 +208,11 @@ private slots:
     void videoPageFinished();
 
     /**
-     * @brief HTML5 player JS file finished downloading
+     * @brief Player cache has fetched a player script
+     * @param version Player version
+     * @param code Decryption code, empty on failure
      */
-    void html5JsFinished();
+    void decipherReady(const QString& version, const QString& code);
 
     /**
      * @brief Embed page finished downloading
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <utility>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QUrl>
+#include "regexutil.hpp"
+#include "youtubeplayercache.hpp"
+
+Q_LOGGING_CATEGORY(YOUTUBEPLAYERCACHE, "youtubeplayercache")
+
+namespace {
+
+/**
+ * @brief Write a file atomically
+ * @param path Path to the file
+ * @param data File content
+ */
+void writeFile(const QString& path, const QByteArray& data) {
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qCWarning(YOUTUBEPLAYERCACHE) << "Unable to write" << path << file.errorString();
+    }
+}
+
+} // namespace
+
+namespace vfg {
+namespace extractor {
+
+YoutubePlayerCache::YoutubePlayerCache(const QString& cacheDirectory, QObject *parent) :
+    QObject(parent),
+    directory(cacheDirectory),
+    net(new QNetworkAccessManager)
+{
+    if(!directory.isEmpty() && !QDir().mkpath(directory)) {
+        qCWarning(YOUTUBEPLAYERCACHE) << "Unable to create" << directory << "caching in memory only";
+
+        directory.clear();
+    }
+}
+
+QString YoutubePlayerCache::playerVersion(const QUrl& playerUrl)
+{
+    // Every player version has its own path
+    const QByteArray hash = QCryptographicHash::hash(playerUrl.path().toUtf8(), QCryptographicHash::Sha1);
+    return QString::fromLatin1(hash.toHex().left(16));
+}
+
+QString YoutubePlayerCache::deriveDecipher(const QByteArray& js)
+{
+    static const QRegularExpression sigRx = compileRegex("\\w+\\.sig\\|\\|([$\\w]+)\\(\\w+\\.\\w+\\)");
+    static const QRegularExpression memberCallRx = compileRegex("([$\\w]+\\.)([$\\w]+\\(\\w+,\\d+\\))");
+    static const QRegularExpression callRx = compileRegex("([$\\w]+)\\(\\w+,\\d+\\)");
+
+    // Each regex starts from the first occurrence of text its match must contain,
+    // so the multi-megabyte script is converted once and scanned mostly by plain search
+    const QString script = QString::fromUtf8(js);
+
+    // The following regexes extract the functions used to decrypt the signature
+    const int sigPos = script.indexOf(".sig||");
+    if(sigPos == -1) {
+        return {};
+    }
+
+    const QString f1 = sigRx.match(script, std::max(0, sigPos - 64)).captured(1);
+    if(f1.isEmpty()) {
+        return {};
+    }
+
+    const int f1Pos = script.indexOf(QString("function %1(").arg(f1));
+    if(f1Pos == -1) {
+        return {};
+    }
+
+    const QRegularExpression f1Rx(QString("function %1\\(\\w+\\)\\{[^\\{]+\\}").arg(QRegularExpression::escape(f1)));
+    QString f1def = f1Rx.match(script, f1Pos).captured(0);
+    if(f1def.isEmpty()) {
+        return {};
+    }
+
+    f1def.replace(memberCallRx, "\\2");
+    QString code = f1def;
+    QRegularExpressionMatchIterator calls = callRx.globalMatch(f1def);
+    while(calls.hasNext()) {
+        const QString f2 = calls.next().captured(1);
+        const QString f2e = QRegularExpression::escape(f2);
+
+        // The match starts one character before the name
+        const int f2Pos = script.indexOf(QString("%1:function(").arg(f2));
+        if(f2Pos == -1) {
+            return {};
+        }
+
+        const QRegularExpression twoArgsRx(QString("[^$\\w]%1:function\\((\\w+,\\w+)\\)(\\{[^\\{\\}]+\\})").arg(f2e));
+        QRegularExpressionMatch f2def = twoArgsRx.match(script, std::max(0, f2Pos - 1));
+        if(f2def.hasMatch()) {
+            code.append(QString("function %1(%2)%3}").arg(f2e).arg(f2def.captured(1)).arg(f2def.captured(2)));
+            continue;
+        }
+
+        const QRegularExpression oneArgRx(QString("[^$\\w]%1:function\\((\\w+)\\)(\\{[^\\{\\}]+\\})").arg(f2e));
+        f2def = oneArgRx.match(script, std::max(0, f2Pos - 1));
+        if(!f2def.hasMatch()) {
+            return {};
+        }
+
+        code.append(QString("function %1(%2,b)%3").arg(f2e).arg(f2def.captured(1)).arg(f2def.captured(2)));
+    }
+
+    code.append(QString("var sig=%1(s)").arg(f1));
+    code.replace("}}", "}");
+
+    return code;
+}
+
+QString YoutubePlayerCache::cachePath(const QString& version, const QString& suffix) const
+{
+    return QDir(directory).absoluteFilePath(QString("youtube-player-%1%2").arg(version).arg(suffix));
+}
+
+QString YoutubePlayerCache::decipher(const QUrl& playerUrl)
+{
+    const QString version = playerVersion(playerUrl);
+    const auto it = decipherCode.constFind(version);
+    if(it != decipherCode.constEnd()) {
+        return it.value();
+    }
+    else if(directory.isEmpty()) {
+        return {};
+    }
+
+    QFile codeFile(cachePath(version, ".decipher.js"));
+    if(codeFile.open(QIODevice::ReadOnly)) {
+        const QString code = QString::fromUtf8(codeFile.readAll());
+        if(!code.isEmpty()) {
+            decipherCode.insert(version, code);
+            return code;
+        }
+    }
+
+    QFile scriptFile(cachePath(version, ".js"));
+    if(scriptFile.open(QIODevice::ReadOnly)) {
+        qCDebug(YOUTUBEPLAYERCACHE) << "Deriving decryption code from cached player" << version;
+
+        return store(version, scriptFile.readAll());
+    }
+
+    return {};
+}
+
+QString YoutubePlayerCache::store(const QString& version, const QByteArray& js)
+{
+    const QString code = deriveDecipher(js);
+    if(code.isEmpty()) {
+        qCWarning(YOUTUBEPLAYERCACHE) << "Decryption code not found in player" << version;
+
+        return {};
+    }
+
+    decipherCode.insert(version, code);
+
+    if(!directory.isEmpty()) {
+        writeFile(cachePath(version, ".decipher.js"), code.toUtf8());
+    }
+
+    return code;
+}
+
+void YoutubePlayerCache::fetch(const QNetworkRequest& request)
+{
+    const QString version = playerVersion(request.url());
+    if(pending.count(version) > 0) {
+        return;
+    }
+
+    qCDebug(YOUTUBEPLAYERCACHE) << "Fetching player" << request.url();
+
+    ++fetches;
+    std::unique_ptr<QNetworkReply> reply(net->get(request));
+    connect(reply.get(), &QNetworkReply::finished, this, [this, version]() {
+        fetchFinished(version);
+    });
+    pending[version] = std::move(reply);
+}
+
+bool YoutubePlayerCache::isFetching(const QUrl& playerUrl) const
+{
+    return pending.count(playerVersion(playerUrl)) > 0;
+}
+
+void YoutubePlayerCache::fetchFinished(const QString& version)
+{
+    const auto it = pending.find(version);
+    if(it == pending.end()) {
+        return;
+    }
+
+    // Deleted later, this is called from the reply's signal
+    QNetworkReply *reply = it->second.release();
+    pending.erase(it);
+    reply->deleteLater();
+
+    QString code;
+    if(reply->error() == QNetworkReply::NoError) {
+        const QByteArray js = reply->readAll();
+        if(!directory.isEmpty()) {
+            writeFile(cachePath(version, ".js"), js);
+        }
+
+        code = store(version, js);
+    }
+    else {
+        qCWarning(YOUTUBEPLAYERCACHE) << "Unable to fetch player" << version << reply->errorString();
+    }
+
+    emit decipherReady(version, code);
+}
+
+void YoutubePlayerCache::setNetworkManager(std::unique_ptr<QNetworkAccessManager> manager)
+{
+    // Replies are owned by the old manager
+    for(auto& request : pending) {
+        request.second->disconnect(this);
+        request.second->abort();
+    }
+    pending.clear();
+
+    net = std::move(manager);
+}
+
+int YoutubePlayerCache::fetchCount() const
+{
+    return fetches;
+}
+
+} // namespace extractor
+} // namespace vfg
@@ -0,0 +1,148 @@
+#ifndef VFG_EXTRACTOR_YOUTUBEPLAYERCACHE_HPP
+#define VFG_EXTRACTOR_YOUTUBEPLAYERCACHE_HPP
+
+#include <map>
+#include <memory>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QString>
+
+class QByteArray;
+class QNetworkRequest;
+class QUrl;
+
+namespace vfg {
+namespace extractor {
+
+/**
+ * @brief The YoutubePlayerCache class
+ *
+ * Caches YouTube's HTML5 player scripts and the signature decryption
+ * code derived from them, per player version, in memory and on disk.
+ *
+ * Extractors share one cache, so a batch of videos using the same
+ * player fetches the script once. Concurrent requests for a player
+ * that is being fetched wait for the same reply.
+ */
+class YoutubePlayerCache : public QObject
+{
+    Q_OBJECT
+
+private:
+    //! Directory of the cached files, empty to cache in memory only
+    QString directory;
+
+    //! Network manager used to fetch player scripts
+    std::unique_ptr<QNetworkAccessManager> net;
+
+    //! Decryption code per player version
+    QHash<QString, QString> decipherCode {};
+
+    //! Player script requests in flight per player version
+    std::map<QString, std::unique_ptr<QNetworkReply>> pending {};
+
+    //! Number of player scripts fetched
+    int fetches {0};
+
+    /**
+     * @brief Get path to a cached file
+     * @param version Player version
+     * @param suffix File suffix
+     * @return Path to the file
+     */
+    QString cachePath(const QString& version, const QString& suffix) const;
+
+    /**
+     * @brief Derive decryption code from a player script and cache it
+     * @param version Player version
+     * @param js Player script
+     * @return Decryption code, empty if not found
+     */
+    QString store(const QString& version, const QByteArray& js);
+
+    /**
+     * @brief Player script request finished
+     * @param version Player version
+     */
+    void fetchFinished(const QString& version);
+
+public:
+    /**
+     * @brief Constructor
+     * @param cacheDirectory Directory of the cached files, empty to cache in memory only
+     * @param parent Owner of the object
+     */
+    explicit YoutubePlayerCache(const QString& cacheDirectory, QObject *parent = 0);
+
+    /**
+     * @brief Get player version of a player script URL
+     * @param playerUrl URL to the player script
+     * @return Player version
+     */
+    static QString playerVersion(const QUrl& playerUrl);
+
+    /**
+     * @brief Derive signature decryption code from a player script
+     *
+     * The code expects the encrypted signature in variable s
+     * and stores the decrypted signature in variable sig
+     *
+     * @param js Player script
+     * @return Decryption code, empty if not found
+     */
+    static QString deriveDecipher(const QByteArray& js);
+
+    /**
+     * @brief Get cached decryption code
+     *
+     * Looks in memory, then on disk. A cached script without
+     * decryption code is derived again without fetching it.
+     *
+     * @param playerUrl URL to the player script
+     * @return Decryption code, empty if not cached
+     */
+    QString decipher(const QUrl& playerUrl);
+
+    /**
+     * @brief Fetch a player script unless it is already being fetched
+     *
+     * \link decipherReady \endlink is emitted when finished
+     *
+     * @param request Request for the player script
+     */
+    void fetch(const QNetworkRequest& request);
+
+    /**
+     * @brief Check if a player script is being fetched
+     * @param playerUrl URL to the player script
+     * @return True if a fetch is in flight, otherwise false
+     */
+    bool isFetching(const QUrl& playerUrl) const;
+
+    /**
+     * @brief Replace the network manager, e.g. with one for a local stand-in server
+     * @param manager Network manager
+     */
+    void setNetworkManager(std::unique_ptr<QNetworkAccessManager> manager);
+
+    /**
+     * @brief Get number of player scripts fetched
+     * @return Number of fetches
+     */
+    int fetchCount() const;
+
+signals:
+    /**
+     * @brief Emitted when a player script has been fetched
+     * @param version Player version
+     * @param code Decryption code, empty on failure
+     */
+    void decipherReady(const QString& version, const QString& code);
+};
+
+} // namespace extractor
+} // namespace vfg
+
+#endif // VFG_EXTRACTOR_YOUTUBEPLAYERCACHE_HPP
@@ -0,0 +1,176 @@
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QPainter>
+#include "filmstrip.h"
+
+namespace {
+
+//! JPEG quality of the saved atlas
+const int AtlasQuality = 85;
+
+//! Scripts larger than this are identified like other files
+const qint64 MaxScriptSize = 1024 * 1024;
+
+QString atlasPath(const QString& directory, const QString& key,
+                  const int numFrames, const int tileCount)
+{
+    return QDir(directory).absoluteFilePath(
+                QString("filmstrip-%1-%2-%3.jpg").arg(key).arg(numFrames).arg(tileCount));
+}
+
+int rowCount(const int tileCount)
+{
+    return (tileCount + vfg::core::Filmstrip::Columns - 1) / vfg::core::Filmstrip::Columns;
+}
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+Filmstrip::Filmstrip(const int numFrames, const int tileCount, const QSize& frameSize) :
+    frames(numFrames),
+    tiles(qMin(numFrames, tileCount))
+{
+    if(tiles < 1 || frameSize.isEmpty()) {
+        tiles = 0;
+        return;
+    }
+
+    const int tileHeight = qMax(1, TileWidth * frameSize.height() / frameSize.width());
+    tileSize = QSize(TileWidth, tileHeight);
+    image = QImage(TileWidth * Columns, tileHeight * rowCount(tiles), QImage::Format_RGB32);
+    image.fill(Qt::black);
+}
+
+Filmstrip::Filmstrip(const int numFrames, const int tileCount, const QImage& atlas) :
+    frames(numFrames),
+    tiles(tileCount),
+    image(atlas)
+{
+    if(tiles < 1 || tiles > numFrames || image.isNull()
+            || image.width() % Columns != 0 || image.height() % rowCount(tiles) != 0) {
+        tiles = 0;
+        image = QImage();
+        return;
+    }
+
+    tileSize = QSize(image.width() / Columns, image.height() / rowCount(tiles));
+}
+
+Filmstrip Filmstrip::load(const QString& directory, const QString& key,
+                          const int numFrames, const int tileCount)
+{
+    if(key.isEmpty()) {
+        return {};
+    }
+
+    const QImage atlas(atlasPath(directory, key, numFrames, tileCount));
+    if(atlas.isNull()) {
+        return {};
+    }
+
+    return Filmstrip(numFrames, tileCount, atlas.convertToFormat(QImage::Format_RGB32));
+}
+
+bool Filmstrip::save(const QString& directory, const QString& key) const
+{
+    if(isNull() || key.isEmpty()) {
+        return false;
+    }
+
+    const QDir dir(directory);
+    if(!dir.exists() && !dir.mkpath(dir.absolutePath())) {
+        return false;
+    }
+
+    return image.save(atlasPath(directory, key, frames, tiles), "JPG", AtlasQuality);
+}
+
+QString Filmstrip::cacheKey(const QString& fileName)
+{
+    const QFileInfo info(fileName);
+    if(!info.isFile()) {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const QString suffix = info.suffix().toLower();
+    if((suffix == "avs" || suffix == "avsi") && info.size() <= MaxScriptSize) {
+        QFile script(fileName);
+        if(!script.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+
+        hash.addData(script.readAll());
+    }
+    else {
+        hash.addData(info.absoluteFilePath().toUtf8());
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool Filmstrip::isNull() const
+{
+    return tiles == 0;
+}
+
+int Filmstrip::count() const
+{
+    return tiles;
+}
+
+int Filmstrip::numFrames() const
+{
+    return frames;
+}
+
+int Filmstrip::frameAt(const int tile) const
+{
+    return static_cast<int>(static_cast<qint64>(tile) * frames / tiles);
+}
+
+int Filmstrip::nearestTile(const int frameNum) const
+{
+    if(isNull()) {
+        return -1;
+    }
+
+    // Inverse of frameAt() rounded to the nearest tile
+    const qint64 tile = (2 * static_cast<qint64>(frameNum) * tiles + frames) / (2 * frames);
+    return static_cast<int>(qBound<qint64>(0, tile, tiles - 1));
+}
+
+QRect Filmstrip::tileRect(const int tile) const
+{
+    return QRect(QPoint((tile % Columns) * tileSize.width(), (tile / Columns) * tileSize.height()),
+                 tileSize);
+}
+
+const QImage& Filmstrip::atlas() const
+{
+    return image;
+}
+
+void Filmstrip::setTile(const int tile, const QImage& frame)
+{
+    if(tile < 0 || tile >= tiles || frame.isNull()) {
+        return;
+    }
+
+    QPainter painter(&image);
+    painter.drawImage(tileRect(tile).topLeft(), frame.size() == tileSize
+                      ? frame
+                      : frame.scaled(tileSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+}
+
+} // namespace core
+} // namespace vfg
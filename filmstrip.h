@@ -0,0 +1,151 @@
+#ifndef VFG_FILMSTRIP_H
+#define VFG_FILMSTRIP_H
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QString>
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The Filmstrip class
+ *
+ * Tiny frames taken at regular intervals of a video, stored as tiles of
+ * a single atlas image. Tiles are laid out row by row in a fixed number
+ * of columns, so the layout follows from the number of frames, the
+ * number of tiles and the atlas size, and the atlas can be saved as an
+ * ordinary image.
+ */
+class Filmstrip
+{
+public:
+    //! Width of a tile in pixels
+    static const int TileWidth = 96;
+
+    //! Tiles per atlas row
+    static const int Columns = 16;
+
+    /**
+     * @brief Constructor for an empty filmstrip
+     */
+    Filmstrip() = default;
+
+    /**
+     * @brief Constructor for a filmstrip to be filled
+     * @param numFrames Number of frames in the video
+     * @param tileCount Number of tiles, at most numFrames
+     * @param frameSize Size of the video frames, sets the tile aspect ratio
+     */
+    Filmstrip(int numFrames, int tileCount, const QSize& frameSize);
+
+    /**
+     * @brief Constructor for an existing atlas
+     * @param numFrames Number of frames in the video
+     * @param tileCount Number of tiles in the atlas
+     * @param atlas Atlas image
+     */
+    Filmstrip(int numFrames, int tileCount, const QImage& atlas);
+
+    /**
+     * @brief Load atlas from the cache
+     * @param directory Cache directory
+     * @param key Cache key, see \link cacheKey \endlink
+     * @param numFrames Number of frames in the video
+     * @param tileCount Number of tiles
+     * @return Filmstrip, null if not cached
+     */
+    static Filmstrip load(const QString& directory, const QString& key,
+                          int numFrames, int tileCount);
+
+    /**
+     * @brief Save atlas to the cache
+     * @param directory Cache directory, created if needed
+     * @param key Cache key, see \link cacheKey \endlink
+     * @return True on success, otherwise false
+     */
+    bool save(const QString& directory, const QString& key) const;
+
+    /**
+     * @brief Get cache key of an opened file
+     *
+     * Scripts are identified by their content, because they're
+     * rewritten whenever they're loaded. Other files are identified
+     * by path, size and modification time.
+     *
+     * @param fileName Opened file
+     * @return Cache key, empty if the file can't be read
+     */
+    static QString cacheKey(const QString& fileName);
+
+    /**
+     * @brief Check if the filmstrip is empty
+     * @return True if there are no tiles, otherwise false
+     */
+    bool isNull() const;
+
+    /**
+     * @brief Get number of tiles
+     * @return Number of tiles
+     */
+    int count() const;
+
+    /**
+     * @brief Get number of frames in the video
+     * @return Number of frames
+     */
+    int numFrames() const;
+
+    /**
+     * @brief Get frame number of a tile
+     * @param tile Tile index
+     * @return Frame number
+     */
+    int frameAt(int tile) const;
+
+    /**
+     * @brief Get tile nearest to a frame
+     * @param frameNum Frame number
+     * @return Tile index, -1 if the filmstrip is empty
+     */
+    int nearestTile(int frameNum) const;
+
+    /**
+     * @brief Get area of a tile in the atlas
+     * @param tile Tile index
+     * @return Area
+     */
+    QRect tileRect(int tile) const;
+
+    /**
+     * @brief Get atlas image
+     * @return Atlas
+     */
+    const QImage& atlas() const;
+
+    /**
+     * @brief Draw a frame to a tile
+     * @param tile Tile index
+     * @param frame Frame, scaled to the tile size
+     */
+    void setTile(int tile, const QImage& frame);
+
+private:
+    //! Number of frames in the video
+    int frames {0};
+
+    //! Number of tiles
+    int tiles {0};
+
+    //! Size of a tile
+    QSize tileSize {};
+
+    //! Tiles
+    QImage image {};
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_FILMSTRIP_H
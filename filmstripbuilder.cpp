@@ -0,0 +1,114 @@
+#include <stdexcept>
+#include <utility>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include <QSize>
+#include "filmstrip.h"
+#include "filmstripbuilder.h"
+#include "videoframegrabber.h"
+
+Q_LOGGING_CATEGORY(FILMSTRIP, "filmstripbuilder")
+
+namespace vfg {
+namespace core {
+
+FilmstripBuilder::FilmstripBuilder(std::shared_ptr<vfg::core::VideoFrameGrabber> newFrameGrabber,
+                                   QObject *parent) :
+    QObject(parent),
+    frameGrabber(std::move(newFrameGrabber))
+{
+    if(!frameGrabber) {
+        qCCritical(FILMSTRIP) << "Invalid frame grabber passed to filmstrip builder";
+
+        throw std::runtime_error("Frame grabber must be a valid object");
+    }
+}
+
+void FilmstripBuilder::setCacheDirectory(const QString& directory)
+{
+    QMutexLocker lock(&mutex);
+
+    cacheDirectory = directory;
+}
+
+int FilmstripBuilder::cancel()
+{
+    QMutexLocker lock(&mutex);
+
+    return ++generation;
+}
+
+bool FilmstripBuilder::isCancelled(const int started) const
+{
+    QMutexLocker lock(&mutex);
+
+    return generation != started;
+}
+
+void FilmstripBuilder::build(const QString& key, const int tileCount, const int buildGeneration)
+{
+    QMutexLocker lock(&mutex);
+    const QString directory = cacheDirectory;
+    lock.unlock();
+
+    // Another video has been loaded since this build was queued
+    if(isCancelled(buildGeneration) || !frameGrabber->hasVideo()) {
+        return;
+    }
+
+    const int numFrames = frameGrabber->totalFrames();
+    Filmstrip strip = Filmstrip::load(directory, key, numFrames, tileCount);
+    if(!strip.isNull()) {
+        if(isCancelled(buildGeneration)) {
+            return;
+        }
+
+        qCDebug(FILMSTRIP) << "Loaded cached filmstrip" << key;
+        emit tilesReady(numFrames, strip.count(), strip.count(), strip.atlas());
+        return;
+    }
+
+    strip = Filmstrip(numFrames, tileCount, frameGrabber->resolution());
+    if(strip.isNull()) {
+        return;
+    }
+
+    qCDebug(FILMSTRIP) << "Building filmstrip of" << strip.count() << "tiles";
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QElapsedTimer sinceUpdate;
+    sinceUpdate.start();
+
+    for(int tile = 0; tile < strip.count(); ++tile) {
+        if(isCancelled(buildGeneration)) {
+            qCDebug(FILMSTRIP) << "Filmstrip cancelled after" << tile << "tiles";
+            return;
+        }
+
+        strip.setTile(tile, frameGrabber->getFrame(strip.frameAt(tile)));
+
+        if(sinceUpdate.elapsed() >= UpdateInterval) {
+            emit tilesReady(numFrames, strip.count(), tile + 1, strip.atlas());
+            sinceUpdate.restart();
+        }
+    }
+
+    if(isCancelled(buildGeneration)) {
+        qCDebug(FILMSTRIP) << "Filmstrip cancelled after the last tile";
+        return;
+    }
+
+    qCDebug(FILMSTRIP) << "Built filmstrip in" << elapsed.elapsed() << "ms";
+
+    if(!key.isEmpty() && !strip.save(directory, key)) {
+        qCWarning(FILMSTRIP) << "Unable to save filmstrip" << key;
+    }
+
+    emit tilesReady(numFrames, strip.count(), strip.count(), strip.atlas());
+}
+
+} // namespace core
+} // namespace vfg
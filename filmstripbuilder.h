@@ -0,0 +1,112 @@
+#ifndef VFG_FILMSTRIPBUILDER_H
+#define VFG_FILMSTRIPBUILDER_H
+
+#include <memory>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+class QImage;
+
+namespace vfg {
+namespace core {
+    class VideoFrameGrabber;
+}
+}
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The FilmstripBuilder class
+ *
+ * Decodes the tiles of a \link vfg::core::Filmstrip filmstrip \endlink
+ * in the thread it lives in. Finished atlases are saved in the cache
+ * directory and loaded from there when the same file is opened again,
+ * so each file is decoded once.
+ *
+ * Frames are taken from the frame grabber one at a time, so requests
+ * from the GUI wait for at most one decode.
+ */
+class FilmstripBuilder : public QObject
+{
+    Q_OBJECT
+
+private:
+    std::shared_ptr<vfg::core::VideoFrameGrabber> frameGrabber;
+
+    //! Guards generation and cacheDirectory
+    mutable QMutex mutex {};
+
+    //! Incremented to cancel the running and queued builds
+    int generation {0};
+
+    //! Directory of the saved atlases
+    QString cacheDirectory {};
+
+    /**
+     * @brief Check if the build has been cancelled
+     * @param started Generation the build was queued with
+     * @return True if cancelled, otherwise false
+     */
+    bool isCancelled(int started) const;
+
+public:
+    //! Minimum interval between \link tilesReady \endlink in milliseconds
+    static const int UpdateInterval = 250;
+
+    /**
+     * @brief Constructor
+     * @param frameGrabber Shared pointer to frame grabber
+     * @param parent Owner of the object
+     * @exception std::runtime_error If frameGrabber is nullptr
+     */
+    explicit FilmstripBuilder(std::shared_ptr<vfg::core::VideoFrameGrabber> frameGrabber,
+                              QObject *parent = 0);
+
+    /**
+     * @brief Set directory of the saved atlases
+     * @param directory Cache directory
+     */
+    void setCacheDirectory(const QString& directory);
+
+    /**
+     * @brief Cancel the running and queued builds
+     *
+     * Safe to call from any thread. Only builds queued with the
+     * returned generation run.
+     *
+     * @return Generation to pass to \link build \endlink
+     */
+    int cancel();
+
+public slots:
+    /**
+     * @brief Build filmstrip of the video in the frame grabber
+     *
+     * Emits \link tilesReady \endlink as tiles are decoded and once the
+     * atlas is complete, or once if the atlas is cached
+     *
+     * @param key Cache key of the opened file, empty to not cache
+     * @param tileCount Number of tiles
+     * @param buildGeneration Generation returned by \link cancel \endlink when
+     *        the build was queued. The build does nothing if it's stale, so
+     *        it can't decode another video and save it under this key.
+     */
+    void build(const QString& key, int tileCount, int buildGeneration);
+
+signals:
+    /**
+     * @brief Emitted when tiles have been added to the atlas
+     * @param numFrames Number of frames in the video
+     * @param tileCount Number of tiles
+     * @param completed Number of tiles decoded, in order
+     * @param atlas Atlas image
+     */
+    void tilesReady(int numFrames, int tileCount, int completed, const QImage& atlas);
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_FILMSTRIPBUILDER_H
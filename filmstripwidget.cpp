@@ -0,0 +1,136 @@
+#include <QEvent>
+#include <QImage>
+#include <QLabel>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPoint>
+#include <QRect>
+#include "filmstripwidget.hpp"
+
+namespace {
+
+//! Height of the filmstrip in pixels
+constexpr int StripHeight = 40;
+
+//! Distance of the popup from the cursor in pixels
+constexpr int PopupOffset = 16;
+
+} // namespace
+
+namespace vfg {
+namespace ui {
+
+FilmstripWidget::FilmstripWidget(QWidget *parent) :
+    QWidget(parent),
+    popup(new QLabel(this, Qt::ToolTip))
+{
+    setFixedHeight(StripHeight);
+    setMouseTracking(true);
+
+    popup->setFrameShape(QFrame::Box);
+}
+
+void FilmstripWidget::setTiles(const int numFrames, const int tileCount,
+                               const int tilesCompleted, const QImage& atlasImage)
+{
+    strip = vfg::core::Filmstrip(numFrames, tileCount, atlasImage);
+    atlas = QPixmap::fromImage(strip.atlas());
+    completed = strip.isNull() ? 0 : tilesCompleted;
+    update();
+}
+
+void FilmstripWidget::clear()
+{
+    strip = vfg::core::Filmstrip();
+    atlas = QPixmap();
+    completed = 0;
+    hideTile();
+    update();
+}
+
+int FilmstripWidget::frameAt(const int x) const
+{
+    if(width() < 2) {
+        return 0;
+    }
+
+    const qint64 last = strip.numFrames() - 1;
+    return static_cast<int>(qBound<qint64>(0, x * last / (width() - 1), last));
+}
+
+void FilmstripWidget::paintEvent(QPaintEvent *ev)
+{
+    Q_UNUSED(ev);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+
+    if(strip.isNull() || completed == 0) {
+        return;
+    }
+
+    // Tiles keep their aspect ratio, so the width decides how many fit
+    const QRect first = strip.tileRect(0);
+    const int tileWidth = qMax(1, height() * first.width() / first.height());
+    for(int x = 0; x < width(); x += tileWidth) {
+        const int tile = strip.nearestTile(frameAt(x + tileWidth / 2));
+        if(tile < completed) {
+            painter.drawPixmap(QRect(x, 0, tileWidth, height()), atlas, strip.tileRect(tile));
+        }
+    }
+}
+
+void FilmstripWidget::mouseMoveEvent(QMouseEvent *ev)
+{
+    QWidget::mouseMoveEvent(ev);
+
+    if(!strip.isNull()) {
+        showTile(frameAt(ev->x()), ev->globalPos());
+    }
+}
+
+void FilmstripWidget::mousePressEvent(QMouseEvent *ev)
+{
+    if(ev->button() != Qt::LeftButton || strip.isNull()) {
+        QWidget::mousePressEvent(ev);
+        return;
+    }
+
+    emit frameClicked(frameAt(ev->x()));
+}
+
+void FilmstripWidget::leaveEvent(QEvent *ev)
+{
+    QWidget::leaveEvent(ev);
+
+    hideTile();
+}
+
+void FilmstripWidget::showTile(const int frameNum, const QPoint& globalPos)
+{
+    const int tile = strip.nearestTile(frameNum);
+    if(tile < 0 || tile >= completed) {
+        hideTile();
+        return;
+    }
+
+    const QRect source = strip.tileRect(tile);
+    popup->setPixmap(atlas.copy(source).scaled(source.size() * PopupScale,
+                                               Qt::IgnoreAspectRatio,
+                                               Qt::SmoothTransformation));
+    popup->adjustSize();
+
+    // Centered above the cursor
+    popup->move(globalPos.x() - popup->width() / 2,
+                globalPos.y() - popup->height() - PopupOffset);
+    popup->show();
+}
+
+void FilmstripWidget::hideTile()
+{
+    popup->hide();
+}
+
+} // namespace ui
+} // namespace vfg
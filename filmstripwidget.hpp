@@ -0,0 +1,105 @@
+#ifndef VFG_UI_FILMSTRIPWIDGET_HPP
+#define VFG_UI_FILMSTRIPWIDGET_HPP
+
+#include <QPixmap>
+#include <QWidget>
+#include "filmstrip.h"
+#include "ptrutil.hpp"
+
+class QEvent;
+class QImage;
+class QLabel;
+class QMouseEvent;
+class QPaintEvent;
+class QPoint;
+
+namespace vfg {
+namespace ui {
+
+/**
+ * @brief The FilmstripWidget class
+ *
+ * Timeline of tiny frames shown above the seek slider. Tiles come from
+ * a \link vfg::core::FilmstripBuilder filmstrip builder \endlink and are
+ * shown as they arrive. Hovering the filmstrip or the seek slider shows
+ * the nearest tile in a popup, which only copies it from the atlas.
+ */
+class FilmstripWidget : public QWidget
+{
+    Q_OBJECT
+
+private:
+    //! Tiles
+    vfg::core::Filmstrip strip {};
+
+    //! Atlas of the tiles converted for painting
+    QPixmap atlas {};
+
+    //! Number of tiles decoded, in order
+    int completed {0};
+
+    //! Popup that shows a tile
+    vfg::observer_ptr<QLabel> popup;
+
+    /**
+     * @brief Get frame at a position
+     * @param x Horizontal position in widget coordinates
+     * @return Frame number
+     */
+    int frameAt(int x) const;
+
+public:
+    //! Scale of the tile in the popup
+    static const int PopupScale = 2;
+
+    /**
+     * @brief Constructor
+     * @param parent Owner of the widget
+     */
+    explicit FilmstripWidget(QWidget *parent = 0);
+
+protected:
+    void paintEvent(QPaintEvent *ev) override;
+    void mouseMoveEvent(QMouseEvent *ev) override;
+    void mousePressEvent(QMouseEvent *ev) override;
+    void leaveEvent(QEvent *ev) override;
+
+public slots:
+    /**
+     * @brief Set tiles
+     * @param numFrames Number of frames in the video
+     * @param tileCount Number of tiles
+     * @param tilesCompleted Number of tiles decoded, in order
+     * @param atlasImage Atlas image
+     */
+    void setTiles(int numFrames, int tileCount, int tilesCompleted, const QImage& atlasImage);
+
+    /**
+     * @brief Remove tiles
+     */
+    void clear();
+
+    /**
+     * @brief Show tile nearest to a frame in a popup
+     * @param frameNum Frame number
+     * @param globalPos Cursor position in global coordinates
+     */
+    void showTile(int frameNum, const QPoint& globalPos);
+
+    /**
+     * @brief Hide the popup
+     */
+    void hideTile();
+
+signals:
+    /**
+     * @brief Emitted when a frame is clicked
+     * @param frameNum Frame number
+     */
+    void frameClicked(int frameNum);
+};
+
+} // namespace ui
+} // namespace vfg
+
+#endif // VFG_UI_FILMSTRIPWIDGET_HPP
@@ -0,0 +1,462 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#include <QImage>
+#include <QLoggingCategory>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include "framefilter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VFG_FRAMEFILTER_SSE2
+#include <emmintrin.h>
+#endif
+
+Q_LOGGING_CATEGORY(FRAMEFILTER, "framefilter")
+
+namespace {
+
+// Weights are fixed point with 14 fractional bits so that a pixel
+// times a weight summed over all taps fits in 32 bits
+const int weightBits = 14;
+const int weightOne = 1 << weightBits;
+const int weightRound = 1 << (weightBits - 1);
+
+const double pi = 3.14159265358979323846;
+
+using Kernel = vfg::core::FrameFilter::Kernel;
+
+/**
+ * @brief Weights of a resize in one dimension
+ *
+ * Every output pixel has the same number of taps. Taps outside
+ * the source are folded into the edge pixels, so the taps of
+ * output pixel i are source pixels [offsets[i], offsets[i] + taps)
+ */
+struct ResizeTable
+{
+    //! Number of source pixels per output pixel
+    int taps {0};
+
+    //! First source pixel of each output pixel
+    std::vector<int> offsets {};
+
+    //! Weights of each output pixel, taps per pixel
+    std::vector<std::int16_t> weights {};
+};
+
+double sinc(const double x) {
+    if(x == 0.0) {
+        return 1.0;
+    }
+
+    return std::sin(pi * x) / (pi * x);
+}
+
+double kernelSupport(const Kernel kernel) {
+    switch(kernel) {
+    case Kernel::Point:
+        return 0.5;
+    case Kernel::Bilinear:
+        return 1.0;
+    case Kernel::Bicubic:
+        return 2.0;
+    case Kernel::Lanczos3:
+    case Kernel::Spline36:
+        return 3.0;
+    }
+
+    return 1.0;
+}
+
+double kernelValue(const Kernel kernel, double x) {
+    x = std::abs(x);
+    switch(kernel) {
+    case Kernel::Point:
+        return x <= 0.5 ? 1.0 : 0.0;
+    case Kernel::Bilinear:
+        return x < 1.0 ? 1.0 - x : 0.0;
+    case Kernel::Bicubic: {
+        // Mitchell-Netravali with b = c = 1/3, the BicubicResize default
+        const double b = 1.0 / 3.0;
+        const double c = 1.0 / 3.0;
+        if(x < 1.0) {
+            return ((12 - 9 * b - 6 * c) * x * x * x
+                    + (-18 + 12 * b + 6 * c) * x * x + (6 - 2 * b)) / 6;
+        }
+        else if(x < 2.0) {
+            return ((-b - 6 * c) * x * x * x + (6 * b + 30 * c) * x * x
+                    + (-12 * b - 48 * c) * x + (8 * b + 24 * c)) / 6;
+        }
+        return 0.0;
+    }
+    case Kernel::Lanczos3:
+        return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+    case Kernel::Spline36:
+        if(x < 1.0) {
+            return ((13.0 / 11.0 * x - 453.0 / 209.0) * x - 3.0 / 209.0) * x + 1.0;
+        }
+        else if(x < 2.0) {
+            x -= 1.0;
+            return ((-6.0 / 11.0 * x + 270.0 / 209.0) * x - 156.0 / 209.0) * x;
+        }
+        else if(x < 3.0) {
+            x -= 2.0;
+            return ((1.0 / 11.0 * x - 45.0 / 209.0) * x + 26.0 / 209.0) * x;
+        }
+        return 0.0;
+    }
+
+    return 0.0;
+}
+
+/**
+ * @brief Compute resize weights for one dimension
+ *
+ * The kernel is widened when downscaling so that it averages
+ * over all source pixels, except for Point
+ *
+ * @param srcSize Source size in pixels
+ * @param dstSize Destination size in pixels
+ * @param kernel Resize kernel
+ * @return Resize weights
+ */
+ResizeTable resizeTable(const int srcSize, const int dstSize, const Kernel kernel) {
+    const double scale = static_cast<double>(dstSize) / srcSize;
+    const double filterScale = kernel == Kernel::Point ? 1.0 : std::min(scale, 1.0);
+    const double support = kernelSupport(kernel) / filterScale;
+
+    ResizeTable table;
+    table.taps = std::min(srcSize, static_cast<int>(std::ceil(support * 2)) + 1);
+    table.offsets.resize(dstSize);
+    table.weights.assign(static_cast<std::size_t>(dstSize) * table.taps, 0);
+
+    std::vector<double> weights(table.taps);
+    for(int i = 0; i < dstSize; ++i) {
+        const double center = (i + 0.5) / scale - 0.5;
+        const int first = static_cast<int>(std::floor(center - support)) + 1;
+        const int last = static_cast<int>(std::floor(center + support));
+        const int offset = std::max(0, std::min(first, srcSize - table.taps));
+
+        std::fill(weights.begin(), weights.end(), 0.0);
+        double total = 0.0;
+        for(int j = first; j <= last; ++j) {
+            const double value = kernelValue(kernel, (j - center) * filterScale);
+            const int pos = std::min(std::max(j, 0), srcSize - 1) - offset;
+            weights[std::min(std::max(pos, 0), table.taps - 1)] += value;
+            total += value;
+        }
+
+        if(total == 0.0) {
+            const int nearest = std::min(std::max(static_cast<int>(std::lround(center)), 0), srcSize - 1);
+            weights[std::min(nearest - offset, table.taps - 1)] = 1.0;
+            total = 1.0;
+        }
+
+        // Quantize so that the weights sum to exactly one
+        std::int16_t *const out = &table.weights[static_cast<std::size_t>(i) * table.taps];
+        int sum = 0;
+        int largest = 0;
+        for(int k = 0; k < table.taps; ++k) {
+            out[k] = static_cast<std::int16_t>(std::lround(weights[k] / total * weightOne));
+            sum += out[k];
+            if(out[k] > out[largest]) {
+                largest = k;
+            }
+        }
+        out[largest] = static_cast<std::int16_t>(out[largest] + weightOne - sum);
+
+        table.offsets[i] = offset;
+    }
+
+    return table;
+}
+
+// Vertical resizing and deinterlacing combine whole scan lines,
+// so each source line is read once per tap in a single loop
+
+/**
+ * @brief Add a weighted row of bytes to an accumulator
+ * @param src Source bytes
+ * @param weight Fixed point weight
+ * @param acc Accumulator
+ * @param count Number of bytes
+ */
+void accumulateRow(const std::uint8_t* __restrict src, const std::int32_t weight,
+                   std::int32_t* __restrict acc, const int count) {
+    for(int i = 0; i < count; ++i) {
+        acc[i] += weight * src[i];
+    }
+}
+
+/**
+ * @brief Convert an accumulator back to bytes
+ * @param acc Accumulator
+ * @param dst Destination bytes
+ * @param count Number of bytes
+ */
+void storeRow(const std::int32_t* __restrict acc, std::uint8_t* __restrict dst,
+              const int count) {
+    for(int i = 0; i < count; ++i) {
+        dst[i] = static_cast<std::uint8_t>(std::min(std::max(acc[i] >> weightBits, 0), 255));
+    }
+}
+
+/**
+ * @brief Average two rows of bytes
+ * @param above Row above
+ * @param below Row below
+ * @param dst Destination row
+ * @param count Number of bytes
+ */
+void averageRows(const std::uint8_t* __restrict above, const std::uint8_t* __restrict below,
+                 std::uint8_t* __restrict dst, const int count) {
+    for(int i = 0; i < count; ++i) {
+        dst[i] = static_cast<std::uint8_t>((above[i] + below[i] + 1) >> 1);
+    }
+}
+
+#ifdef VFG_FRAMEFILTER_SSE2
+/**
+ * @brief Resize a row of 32-bit pixels with SSE2
+ *
+ * The taps of an output pixel are adjacent, so two taps are loaded
+ * at once, their channels interleaved and multiplied by both weights
+ * and summed per channel with a single multiply-add.
+ *
+ * @param src Source row
+ * @param dst Destination row
+ * @param width Destination width
+ * @param table Resize weights
+ */
+void resizeRow(const std::uint8_t* __restrict src, std::uint8_t* __restrict dst,
+               const int width, const ResizeTable& table) {
+    const int taps = table.taps;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(weightRound);
+    for(int x = 0; x < width; ++x) {
+        const std::uint8_t *const px = src + table.offsets[x] * 4;
+        const std::int16_t *const weights = &table.weights[static_cast<std::size_t>(x) * taps];
+
+        __m128i acc = round;
+        int k = 0;
+        for(; k + 1 < taps; k += 2) {
+            // p0c0 p0c1 p0c2 p0c3 p1c0 p1c1 p1c2 p1c3 -> p0c0 p1c0 p0c1 p1c1 ...
+            const __m128i pixels = _mm_unpacklo_epi8(
+                        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(px + k * 4)), zero);
+            const __m128i pairs = _mm_unpacklo_epi16(pixels, _mm_srli_si128(pixels, 8));
+            const __m128i weight = _mm_set1_epi32(
+                        static_cast<std::int32_t>(static_cast<std::uint32_t>(weights[k + 1]) << 16
+                                                  | static_cast<std::uint16_t>(weights[k])));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(pairs, weight));
+        }
+
+        if(k < taps) {
+            std::int32_t last;
+            std::memcpy(&last, px + k * 4, 4);
+            const __m128i pixel = _mm_unpacklo_epi16(
+                        _mm_unpacklo_epi8(_mm_cvtsi32_si128(last), zero), zero);
+            const __m128i weight = _mm_set1_epi32(static_cast<std::uint16_t>(weights[k]));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(pixel, weight));
+        }
+
+        // Saturating packs clamp to [0, 255]
+        acc = _mm_srai_epi32(acc, weightBits);
+        acc = _mm_packus_epi16(_mm_packs_epi32(acc, acc), zero);
+        const std::int32_t out = _mm_cvtsi128_si32(acc);
+        std::memcpy(dst + x * 4, &out, 4);
+    }
+}
+#else
+/**
+ * @brief Resize a row of 32-bit pixels
+ * @param src Source row
+ * @param dst Destination row
+ * @param width Destination width
+ * @param table Resize weights
+ */
+void resizeRow(const std::uint8_t* __restrict src, std::uint8_t* __restrict dst,
+               const int width, const ResizeTable& table) {
+    const int taps = table.taps;
+    for(int x = 0; x < width; ++x) {
+        const std::uint8_t *const px = src + table.offsets[x] * 4;
+        const std::int16_t *const weights = &table.weights[static_cast<std::size_t>(x) * taps];
+
+        std::int32_t acc[4] = {weightRound, weightRound, weightRound, weightRound};
+        for(int k = 0; k < taps; ++k) {
+            for(int c = 0; c < 4; ++c) {
+                acc[c] += weights[k] * px[k * 4 + c];
+            }
+        }
+
+        storeRow(acc, dst + x * 4, 4);
+    }
+}
+#endif
+
+/**
+ * @brief Resize rows of a 32-bit frame
+ * @param frame Frame to resize
+ * @param width New width
+ * @param kernel Resize kernel
+ * @return Resized frame
+ */
+QImage resizeWidth(const QImage& frame, const int width, const Kernel kernel) {
+    const ResizeTable table = resizeTable(frame.width(), width, kernel);
+
+    QImage resized(width, frame.height(), frame.format());
+    for(int y = 0; y < frame.height(); ++y) {
+        resizeRow(frame.constScanLine(y), resized.scanLine(y), width, table);
+    }
+
+    return resized;
+}
+
+/**
+ * @brief Resize columns of a 32-bit frame
+ * @param frame Frame to resize
+ * @param height New height
+ * @param kernel Resize kernel
+ * @return Resized frame
+ */
+QImage resizeHeight(const QImage& frame, const int height, const Kernel kernel) {
+    const ResizeTable table = resizeTable(frame.height(), height, kernel);
+    const int count = frame.width() * 4;
+
+    QImage resized(frame.width(), height, frame.format());
+    std::vector<std::int32_t> acc(count);
+    for(int y = 0; y < height; ++y) {
+        std::fill(acc.begin(), acc.end(), weightRound);
+        const std::int16_t *const weights = &table.weights[static_cast<std::size_t>(y) * table.taps];
+        for(int k = 0; k < table.taps; ++k) {
+            accumulateRow(frame.constScanLine(table.offsets[y] + k), weights[k], acc.data(), count);
+        }
+
+        storeRow(acc.data(), resized.scanLine(y), count);
+    }
+
+    return resized;
+}
+
+/**
+ * @brief Replace the bottom field with lines interpolated from the top field
+ * @param frame Frame to deinterlace
+ * @return Deinterlaced frame
+ */
+QImage deinterlaced(const QImage& frame) {
+    QImage out = frame.copy();
+    const int count = out.width() * 4;
+    for(int y = 1; y < out.height(); y += 2) {
+        const std::uint8_t *const above = out.constScanLine(y - 1);
+        const std::uint8_t *const below = y + 1 < out.height() ? out.constScanLine(y + 1) : above;
+        averageRows(above, below, out.scanLine(y), count);
+    }
+
+    return out;
+}
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+FrameFilter::FrameFilter(const Settings& settings) :
+    config(settings)
+{
+}
+
+FrameFilter::Settings FrameFilter::settings() const
+{
+    return config;
+}
+
+bool FrameFilter::isIdentity() const
+{
+    const QRect& crop = config.crop;
+    const bool resize = config.resize.width() > 0 && config.resize.height() > 0;
+    return !config.deinterlace && !resize
+            && crop.x() <= 0 && crop.y() <= 0 && crop.width() <= 0 && crop.height() <= 0;
+}
+
+QImage FrameFilter::apply(const QImage& frame) const
+{
+    if(frame.isNull()) {
+        return {};
+    }
+
+    QImage out = frame;
+    if(out.format() != QImage::Format_RGB32 && out.format() != QImage::Format_ARGB32) {
+        out = out.convertToFormat(QImage::Format_ARGB32);
+    }
+
+    if(config.deinterlace) {
+        out = deinterlaced(out);
+    }
+
+    const QSize size = config.resize;
+    if(size.width() > 0 && size.height() > 0) {
+        // Resize the shrinking dimension first so that the other pass has less to do
+        const bool heightFirst = size.height() < out.height();
+        if(heightFirst && size.height() != out.height()) {
+            out = resizeHeight(out, size.height(), config.kernel);
+        }
+        if(size.width() != out.width()) {
+            out = resizeWidth(out, size.width(), config.kernel);
+        }
+        if(size.height() != out.height()) {
+            out = resizeHeight(out, size.height(), config.kernel);
+        }
+    }
+
+    const QRect& crop = config.crop;
+    if(crop.x() > 0 || crop.y() > 0 || crop.width() > 0 || crop.height() > 0) {
+        const QRect area(std::max(crop.x(), 0), std::max(crop.y(), 0),
+                         out.width() - std::max(crop.x(), 0) - std::max(crop.width(), 0),
+                         out.height() - std::max(crop.y(), 0) - std::max(crop.height(), 0));
+        if(area.width() <= 0 || area.height() <= 0) {
+            qCDebug(FRAMEFILTER) << "Crop" << crop << "leaves nothing of" << out.size();
+            return {};
+        }
+
+        out = out.copy(area);
+    }
+
+    return out;
+}
+
+QString FrameFilter::kernelName(const Kernel kernel)
+{
+    switch(kernel) {
+    case Kernel::Point:
+        return "Point";
+    case Kernel::Bilinear:
+        return "Bilinear";
+    case Kernel::Bicubic:
+        return "Bicubic";
+    case Kernel::Lanczos3:
+        return "Lanczos";
+    case Kernel::Spline36:
+        return "Spline36";
+    }
+
+    return "Spline36";
+}
+
+FrameFilter::Kernel FrameFilter::kernelFromName(const QString& name)
+{
+    for(const Kernel kernel : {Kernel::Point, Kernel::Bilinear, Kernel::Bicubic,
+                               Kernel::Lanczos3, Kernel::Spline36}) {
+        if(kernelName(kernel) == name) {
+            return kernel;
+        }
+    }
+
+    return Kernel::Spline36;
+}
+
+} // namespace core
+} // namespace vfg
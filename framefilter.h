@@ -0,0 +1,102 @@
+#ifndef VFG_FRAMEFILTER_H
+#define VFG_FRAMEFILTER_H
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QString>
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The FrameFilter class
+ *
+ * Applies deinterlace, resize and crop to decoded frames in the same
+ * order as the script templates, so that video settings can be
+ * previewed without reloading the script
+ */
+class FrameFilter
+{
+public:
+    /**
+     * @brief Resize kernels, named after the Avisynth resizers
+     */
+    enum class Kernel : int {
+        Point,      //!< Nearest neighbour
+        Bilinear,   //!< Triangle filter
+        Bicubic,    //!< Mitchell-Netravali (b = c = 1/3)
+        Lanczos3,   //!< Lanczos with 3 lobes
+        Spline36    //!< 6-tap spline
+    };
+
+    /**
+     * @brief Filter settings
+     */
+    struct Settings
+    {
+        //! Pixels to crop from each side, x = left, y = top,
+        //! width = right and height = bottom as in the video settings
+        QRect crop {};
+
+        //! Size to resize to, invalid to keep the size
+        QSize resize {};
+
+        //! Resize kernel
+        Kernel kernel {Kernel::Spline36};
+
+        //! Interpolate the bottom field from the top field
+        bool deinterlace {false};
+    };
+
+    /**
+     * @brief Constructor
+     * @param settings Filter settings
+     */
+    explicit FrameFilter(const Settings& settings);
+
+    /**
+     * @brief Get filter settings
+     * @return Filter settings
+     */
+    Settings settings() const;
+
+    /**
+     * @brief Check if the filter leaves frames unchanged
+     * @return True if nothing is applied, otherwise false
+     */
+    bool isIdentity() const;
+
+    /**
+     * @brief Filter a frame
+     * @param frame Frame to filter
+     * @return Filtered frame in Format_ARGB32, null if frame is null
+     *         or the crop leaves nothing
+     */
+    QImage apply(const QImage& frame) const;
+
+    /**
+     * @brief Get Avisynth name of a kernel
+     *
+     * The name is used as the prefix of the resize function in scripts
+     *
+     * @param kernel Kernel
+     * @return Name, e.g. Spline36 for Spline36Resize
+     */
+    static QString kernelName(Kernel kernel);
+
+    /**
+     * @brief Get kernel by its Avisynth name
+     * @param name Name as returned by \link kernelName \endlink
+     * @return Kernel, Spline36 if the name is unknown
+     */
+    static Kernel kernelFromName(const QString& name);
+
+private:
+    Settings config;
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_FRAMEFILTER_H
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+#include <QImage>
+#include <QLoggingCategory>
+#include "framequalityfilter.h"
+
+Q_LOGGING_CATEGORY(QUALITYFILTER, "framequalityfilter")
+
+namespace {
+
+// The kernels below work on plain contiguous arrays without
+// branches in the inner loops so that the compiler can vectorize them
+
+/**
+ * @brief Convert a row of 32-bit (A)RGB pixels to luma (Rec.601) and add it to acc
+ * @param src Source pixels
+ * @param acc Accumulator
+ * @param count Number of pixels
+ */
+void accumulateLumaRow(const std::uint32_t* __restrict src,
+                       std::uint32_t* __restrict acc, const int count) {
+    for(int x = 0; x < count; ++x) {
+        const std::uint32_t px = src[x];
+        const std::uint32_t r = (px >> 16) & 0xff;
+        const std::uint32_t g = (px >> 8) & 0xff;
+        const std::uint32_t b = px & 0xff;
+        acc[x] += (77 * r + 150 * g + 29 * b) >> 8;
+    }
+}
+
+/**
+ * @brief Compute the Laplacian of a row of the luma plane
+ * @param above Row above
+ * @param row Current row
+ * @param below Row below
+ * @param out Laplacian values for columns [1, width - 1)
+ * @param width Row width
+ */
+void laplacianRow(const std::uint8_t* __restrict above,
+                  const std::uint8_t* __restrict row,
+                  const std::uint8_t* __restrict below,
+                  std::int32_t* __restrict out, const int width) {
+    for(int x = 1; x < width - 1; ++x) {
+        out[x - 1] = 4 * static_cast<std::int32_t>(row[x])
+                     - above[x] - below[x] - row[x - 1] - row[x + 1];
+    }
+}
+
+/**
+ * @brief Downscale a 32-bit frame into a luma plane by box averaging
+ * @param frame Frame in Format_RGB32 or Format_ARGB32
+ * @param targetWidth Approximate width of the luma plane
+ * @param width Width of the resulting plane
+ * @param height Height of the resulting plane
+ * @return Luma plane
+ */
+std::vector<std::uint8_t> downscaledLuma(const QImage& frame, const int targetWidth,
+                                         int& width, int& height) {
+    const int step = std::max(1, frame.width() / std::max(1, targetWidth));
+    width = frame.width() / step;
+    height = frame.height() / step;
+
+    std::vector<std::uint8_t> plane(static_cast<std::size_t>(width) * height);
+    std::vector<std::uint32_t> columns(static_cast<std::size_t>(width) * step);
+    const int area = step * step;
+    for(int y = 0; y < height; ++y) {
+        std::fill(columns.begin(), columns.end(), 0);
+        for(int sy = y * step, end = sy + step; sy < end; ++sy) {
+            const auto src = reinterpret_cast<const std::uint32_t*>(frame.constScanLine(sy));
+            accumulateLumaRow(src, columns.data(), static_cast<int>(columns.size()));
+        }
+
+        std::uint8_t* const out = plane.data() + static_cast<std::size_t>(y) * width;
+        for(int x = 0; x < width; ++x) {
+            const std::uint32_t* block = columns.data() + x * step;
+            std::uint32_t sum = 0;
+            for(int i = 0; i < step; ++i) {
+                sum += block[i];
+            }
+            out[x] = static_cast<std::uint8_t>(sum / area);
+        }
+    }
+
+    return plane;
+}
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+FrameQualityFilter::FrameQualityFilter(const Settings& settings) :
+    config(settings)
+{
+}
+
+FrameQualityFilter::Settings FrameQualityFilter::settings() const
+{
+    return config;
+}
+
+FrameQuality FrameQualityFilter::measure(const QImage& frame) const
+{
+    if(frame.isNull()) {
+        return {};
+    }
+
+    const QImage::Format format = frame.format();
+    const QImage rgb = (format == QImage::Format_RGB32 || format == QImage::Format_ARGB32)
+                       ? frame : frame.convertToFormat(QImage::Format_RGB32);
+
+    int width = 0;
+    int height = 0;
+    const std::vector<std::uint8_t> luma = downscaledLuma(rgb, config.analysisWidth,
+                                                          width, height);
+    if(width < 3 || height < 3) {
+        return {};
+    }
+
+    std::uint64_t lumaSum = 0;
+    for(const std::uint8_t value : luma) {
+        lumaSum += value;
+    }
+
+    std::vector<std::int32_t> lap(width - 2);
+    std::int64_t lapSum = 0;
+    std::int64_t lapSumSq = 0;
+    for(int y = 1; y < height - 1; ++y) {
+        const std::uint8_t* row = luma.data() + static_cast<std::size_t>(y) * width;
+        laplacianRow(row - width, row, row + width, lap.data(), width);
+        for(const std::int32_t value : lap) {
+            lapSum += value;
+            lapSumSq += static_cast<std::int64_t>(value) * value;
+        }
+    }
+
+    const double count = static_cast<double>(width - 2) * (height - 2);
+    const double lapMean = lapSum / count;
+
+    FrameQuality quality;
+    quality.sharpness = lapSumSq / count - lapMean * lapMean;
+    quality.meanLuma = static_cast<double>(lumaSum) / luma.size();
+    return quality;
+}
+
+bool FrameQualityFilter::isAcceptable(const FrameQuality& quality) const
+{
+    return quality.sharpness >= config.minSharpness
+            && quality.meanLuma >= config.minLuma
+            && quality.meanLuma <= config.maxLuma;
+}
+
+FrameQualityFilter::Result FrameQualityFilter::apply(const int frameNum, const QImage& frame,
+                                                     const FrameFetcher& fetch,
+                                                     const int lastFrame) const
+{
+    const FrameQuality quality = measure(frame);
+    if(isAcceptable(quality)) {
+        return {true, frameNum, frame};
+    }
+
+    qCDebug(QUALITYFILTER) << "Rejected frame" << frameNum << "sharpness:"
+                           << quality.sharpness << "luma:" << quality.meanLuma;
+
+    Result best;
+    double bestSharpness = -1.0;
+    for(int offset = 1; offset <= config.searchWindow; ++offset) {
+        for(const int candidate : {frameNum - offset, frameNum + offset}) {
+            if(candidate < 0 || candidate > lastFrame) {
+                continue;
+            }
+
+            const QImage image = fetch(candidate);
+            const FrameQuality score = measure(image);
+            if(isAcceptable(score) && score.sharpness > bestSharpness) {
+                bestSharpness = score.sharpness;
+                best = {true, candidate, image};
+            }
+        }
+    }
+
+    if(best.accepted) {
+        qCDebug(QUALITYFILTER) << "Replaced frame" << frameNum << "with" << best.frameNum;
+    }
+
+    return best;
+}
+
+} // namespace core
+} // namespace vfg
@@ -0,0 +1,121 @@
+#ifndef VFG_FRAMEQUALITYFILTER_H
+#define VFG_FRAMEQUALITYFILTER_H
+
+#include <functional>
+#include <QImage>
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief Quality scores computed for a single frame
+ */
+struct FrameQuality
+{
+    //! Variance of the Laplacian of the luma plane (higher is sharper)
+    double sharpness {0.0};
+
+    //! Mean luma value in range [0, 255]
+    double meanLuma {0.0};
+};
+
+/**
+ * @brief The FrameQualityFilter class
+ *
+ * Scores frames for sharpness and brightness on a downscaled
+ * luma plane so that motion-blurred frames and fades to black
+ * or white can be rejected or replaced by a nearby sharper frame
+ */
+class FrameQualityFilter
+{
+public:
+    /**
+     * @brief Filter thresholds
+     */
+    struct Settings
+    {
+        //! Frames below this sharpness are rejected
+        double minSharpness {40.0};
+
+        //! Frames darker than this are rejected (black frames)
+        double minLuma {20.0};
+
+        //! Frames brighter than this are rejected (white frames)
+        double maxLuma {235.0};
+
+        //! Number of frames to search on each side of a rejected frame
+        //! for a replacement. 0 rejects the frame without searching
+        int searchWindow {3};
+
+        //! Width of the luma plane the scores are computed on
+        int analysisWidth {320};
+    };
+
+    /**
+     * @brief Result of \link apply \endlink
+     */
+    struct Result
+    {
+        //! True if a frame passed the filter
+        bool accepted {false};
+
+        //! Frame number of the accepted frame
+        int frameNum {-1};
+
+        //! The accepted frame
+        QImage frame {};
+    };
+
+    //! Fetches a frame by number, returns a null image on error
+    using FrameFetcher = std::function<QImage(int)>;
+
+    /**
+     * @brief Constructor
+     * @param settings Filter thresholds
+     */
+    explicit FrameQualityFilter(const Settings& settings);
+
+    /**
+     * @brief Get filter thresholds
+     * @return Filter thresholds
+     */
+    Settings settings() const;
+
+    /**
+     * @brief Compute quality scores for a frame
+     * @param frame Frame to score
+     * @return Quality scores, zeroed if the frame is null
+     */
+    FrameQuality measure(const QImage& frame) const;
+
+    /**
+     * @brief Check if scores pass the filter thresholds
+     * @param quality Scores to check
+     * @return True if acceptable, otherwise false
+     */
+    bool isAcceptable(const FrameQuality& quality) const;
+
+    /**
+     * @brief Filter a frame
+     *
+     * If the frame is rejected and the search window is non-zero
+     * the frames around it are scored and the sharpest acceptable
+     * frame is returned instead
+     *
+     * @param frameNum Frame number of the frame
+     * @param frame Frame to filter
+     * @param fetch Used to fetch neighbouring frames
+     * @param lastFrame Last valid frame number for fetch
+     * @return Filter result
+     */
+    Result apply(int frameNum, const QImage& frame,
+                 const FrameFetcher& fetch, int lastFrame) const;
+
+private:
+    Settings config;
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_FRAMEQUALITYFILTER_H
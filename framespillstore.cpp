@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cstring>
+#include <QByteArray>
+#include <QDir>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include "framespillstore.h"
+
+Q_LOGGING_CATEGORY(SPILLSTORE, "framespillstore")
+
+namespace {
+
+//! Size of a mapped segment of the backing file
+constexpr qint64 SegmentSize = 64 * 1024 * 1024;
+
+//! Alignment of frame data within a segment
+constexpr qint64 FrameAlignment = 64;
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+FrameSpillStore::FrameSpillStore(const QString& path, const Compression newCompression) :
+    file(path),
+    compression(newCompression)
+{
+}
+
+FrameSpillStore::~FrameSpillStore()
+{
+    QMutexLocker lock(&mutex);
+
+    release();
+    file.remove();
+}
+
+bool FrameSpillStore::append(const int frameNumber, const QImage& frame)
+{
+    if(frame.isNull() || frame.colorCount() > 0) {
+        return false;
+    }
+
+    Entry entry;
+    entry.width = frame.width();
+    entry.height = frame.height();
+    entry.bytesPerLine = frame.bytesPerLine();
+    entry.format = frame.format();
+
+    const qint64 rawSize = static_cast<qint64>(entry.bytesPerLine) * entry.height;
+    const uchar *source = frame.constBits();
+    entry.size = rawSize;
+
+    // Compress before locking so that readers are not blocked
+    QByteArray compressed;
+    if(compression == Compression::Fast) {
+        compressed = qCompress(source, static_cast<int>(rawSize), 1);
+        source = reinterpret_cast<const uchar*>(compressed.constData());
+        entry.size = compressed.size();
+        entry.compressed = true;
+    }
+
+    QMutexLocker lock(&mutex);
+
+    uchar *dest = reserve(entry.size, entry.offset);
+    if(!dest) {
+        return false;
+    }
+
+    std::memcpy(dest, source, static_cast<std::size_t>(entry.size));
+    index.insert(frameNumber, entry);
+
+    return true;
+}
+
+bool FrameSpillStore::contains(const int frameNumber) const
+{
+    QMutexLocker lock(&mutex);
+    return index.contains(frameNumber);
+}
+
+QImage FrameSpillStore::frame(const int frameNumber) const
+{
+    QMutexLocker lock(&mutex);
+
+    const auto it = index.constFind(frameNumber);
+    if(it == index.cend()) {
+        return {};
+    }
+
+    const Entry& entry = it.value();
+
+    // Frames of earlier segments are mapped only while they are copied
+    uchar *mapped = nullptr;
+    const uchar *data = nullptr;
+    if(segment && entry.offset >= segmentStart) {
+        data = segment + (entry.offset - segmentStart);
+    }
+    else {
+        mapped = file.map(entry.offset, entry.size);
+        if(!mapped) {
+            qCWarning(SPILLSTORE) << "Unable to map frame" << frameNumber << file.errorString();
+
+            return {};
+        }
+        data = mapped;
+    }
+
+    QImage copy;
+    if(!entry.compressed) {
+        // Copy so that the returned image stays valid after unmapping
+        copy = QImage(data, entry.width, entry.height,
+                      entry.bytesPerLine, entry.format).copy();
+    }
+    else {
+        const QByteArray raw = qUncompress(data, static_cast<int>(entry.size));
+        if(raw.size() == entry.bytesPerLine * entry.height) {
+            copy = QImage(reinterpret_cast<const uchar*>(raw.constData()), entry.width,
+                          entry.height, entry.bytesPerLine, entry.format).copy();
+        }
+        else {
+            qCWarning(SPILLSTORE) << "Corrupted frame" << frameNumber;
+        }
+    }
+
+    if(mapped) {
+        file.unmap(mapped);
+    }
+
+    return copy;
+}
+
+int FrameSpillStore::count() const
+{
+    QMutexLocker lock(&mutex);
+    return index.size();
+}
+
+qint64 FrameSpillStore::size() const
+{
+    QMutexLocker lock(&mutex);
+    return written;
+}
+
+void FrameSpillStore::clear()
+{
+    QMutexLocker lock(&mutex);
+
+    qCDebug(SPILLSTORE) << "Clearing" << index.size() << "frames," << written << "bytes";
+
+    release();
+    file.remove();
+    index.clear();
+    written = 0;
+}
+
+uchar* FrameSpillStore::reserve(const qint64 bytes, qint64& offset)
+{
+    if(!file.isOpen()) {
+        QDir().mkpath(QFileInfo(file).absolutePath());
+        if(!file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+            qCWarning(SPILLSTORE) << "Unable to open" << file.fileName() << file.errorString();
+
+            return nullptr;
+        }
+    }
+
+    const qint64 alignedUsed = (segmentUsed + FrameAlignment - 1) / FrameAlignment * FrameAlignment;
+    if(!segment || alignedUsed + bytes > segmentSize) {
+        const qint64 start = segment ? segmentStart + segmentSize : 0;
+        const qint64 newSize = std::max(SegmentSize, bytes);
+        if(!file.resize(start + newSize)) {
+            qCWarning(SPILLSTORE) << "Unable to grow" << file.fileName() << file.errorString();
+
+            return nullptr;
+        }
+
+        uchar *mapped = file.map(start, newSize);
+        if(!mapped) {
+            qCWarning(SPILLSTORE) << "Unable to map" << file.fileName() << file.errorString();
+
+            return nullptr;
+        }
+
+        // The full segment is no longer written, its frames are mapped when read
+        if(segment) {
+            file.unmap(segment);
+        }
+
+        segment = mapped;
+        segmentStart = start;
+        segmentSize = newSize;
+        segmentUsed = 0;
+    }
+    else {
+        segmentUsed = alignedUsed;
+    }
+
+    uchar *dest = segment + segmentUsed;
+    offset = segmentStart + segmentUsed;
+    segmentUsed += bytes;
+    written += bytes;
+
+    return dest;
+}
+
+void FrameSpillStore::release()
+{
+    if(segment) {
+        file.unmap(segment);
+        segment = nullptr;
+    }
+    segmentStart = 0;
+    segmentSize = 0;
+    segmentUsed = 0;
+
+    file.close();
+}
+
+} // namespace core
+} // namespace vfg
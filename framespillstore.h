@@ -0,0 +1,168 @@
+#ifndef VFG_FRAMESPILLSTORE_H
+#define VFG_FRAMESPILLSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The FrameSpillStore class
+ *
+ * Append-only store for decoded frames backed by a memory-mapped file.
+ * Frames are written once and read back by frame number, so saving a
+ * generated frame pages it in from disk instead of decoding it again.
+ * Resident memory is bounded by the operating system's page cache
+ * rather than by the number of stored frames.
+ *
+ * The file is written through fixed size mapped segments. Only the
+ * segment being written stays mapped, frames in earlier segments are
+ * mapped on demand when they are read, so the mapped address space
+ * doesn't grow with the number of stored frames. The file is removed
+ * when the store is destroyed.
+ *
+ * All member functions are thread-safe.
+ */
+class FrameSpillStore
+{
+public:
+    /**
+     * @brief Compression of stored frames
+     */
+    enum class Compression {
+        None,   //!< Raw pixel data
+        Fast    //!< zlib level 1
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * The file is created when the first frame is appended
+     *
+     * @param path Path to the backing file
+     * @param compression Compression of stored frames
+     */
+    explicit FrameSpillStore(const QString& path, Compression compression = Compression::None);
+
+    /**
+     * @brief Destructor
+     *
+     * Unmaps and removes the backing file
+     */
+    ~FrameSpillStore();
+
+    FrameSpillStore(const FrameSpillStore&) = delete;
+    FrameSpillStore& operator=(const FrameSpillStore&) = delete;
+
+    /**
+     * @brief Append frame to the store
+     *
+     * If the frame number is already stored, the new frame replaces
+     * the old one in the index
+     *
+     * @param frameNumber Frame number
+     * @param frame Frame to append
+     * @return True on success, otherwise false
+     */
+    bool append(int frameNumber, const QImage& frame);
+
+    /**
+     * @brief Check if frame is stored
+     * @param frameNumber Frame number
+     * @return True if stored, otherwise false
+     */
+    bool contains(int frameNumber) const;
+
+    /**
+     * @brief Get stored frame
+     * @param frameNumber Frame number
+     * @return Copy of the stored frame, null QImage if not stored
+     */
+    QImage frame(int frameNumber) const;
+
+    /**
+     * @brief Get number of stored frames
+     * @return Number of stored frames
+     */
+    int count() const;
+
+    /**
+     * @brief Get number of bytes written to the backing file
+     * @return Bytes written
+     */
+    qint64 size() const;
+
+    /**
+     * @brief Remove all frames and truncate the backing file
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Location and format of a stored frame
+     */
+    struct Entry
+    {
+        //! Offset of the frame data in the file
+        qint64 offset {0};
+
+        //! Size of the frame data
+        qint64 size {0};
+
+        int width {0};
+        int height {0};
+        int bytesPerLine {0};
+        QImage::Format format {QImage::Format_Invalid};
+        bool compressed {false};
+    };
+
+    /**
+     * @brief Reserve space for data in the current segment
+     *
+     * Unmaps the current segment and maps a new one if it can't hold the data
+     *
+     * @pre mutex must be locked
+     * @param bytes Size of the data
+     * @param offset Set to the offset of the reserved space in the file
+     * @return Pointer to the reserved space, nullptr on error
+     */
+    uchar* reserve(qint64 bytes, qint64& offset);
+
+    /**
+     * @brief Unmap the current segment and close the file
+     * @pre mutex must be locked
+     */
+    void release();
+
+    mutable QMutex mutex {};
+
+    //! Backing file, mapped while reading frames of earlier segments
+    mutable QFile file {};
+    const Compression compression;
+
+    //! Mapped segment being written, nullptr if none
+    uchar *segment {nullptr};
+
+    //! Offset where the current segment starts
+    qint64 segmentStart {0};
+
+    //! Size of the current segment
+    qint64 segmentSize {0};
+
+    //! Bytes used in the current segment
+    qint64 segmentUsed {0};
+
+    //! Bytes written in total
+    qint64 written {0};
+
+    QHash<int, Entry> index {};
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_FRAMESPILLSTORE_H
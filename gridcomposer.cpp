@@ -0,0 +1,202 @@
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QtConcurrent>
+#include "gridcomposer.h"
+
+Q_LOGGING_CATEGORY(GRIDCOMPOSER, "gridcomposer")
+
+namespace {
+
+//! Image text key of the frame number in the thumbnails
+const QString FrameNumberKey {"vfg-frame"};
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+QImage GridComposer::tagThumbnail(const QImage& thumbnail, const int frameNum)
+{
+    QImage tagged = thumbnail;
+    tagged.setText(FrameNumberKey, QString::number(frameNum));
+    return tagged;
+}
+
+int GridComposer::taggedFrame(const QImage& thumbnail)
+{
+    bool ok = false;
+    const int frameNum = thumbnail.text(FrameNumberKey).toInt(&ok);
+    return ok ? frameNum : -1;
+}
+
+GridComposer::GridComposer(FrameSource source, const QSize& newFrameSize) :
+    frameSource(std::move(source)),
+    frameSize(newFrameSize),
+    width(newFrameSize.width())
+{
+    if(!frameSource) {
+        throw std::invalid_argument("Frame source must be a valid function");
+    }
+
+    if(frameSize.isEmpty()) {
+        throw std::invalid_argument("Frame size must not be empty");
+    }
+}
+
+void GridComposer::setRows(const QVector<QVector<int>>& frameRows)
+{
+    rows.clear();
+    for(const auto& frameRow : frameRows) {
+        if(!frameRow.empty()) {
+            rows.append(frameRow);
+        }
+    }
+}
+
+void GridComposer::setWidth(const int value)
+{
+    width = value;
+}
+
+void GridComposer::setSpacing(const int value)
+{
+    spacing = qMax(0, value);
+}
+
+void GridComposer::setSpacingColor(const QColor& color)
+{
+    spacingColor = color;
+}
+
+int GridComposer::gridWidth() const
+{
+    // Widened so that every frame of the widest row is at least a pixel wide
+    int minWidth = 1;
+    for(const auto& frameRow : rows) {
+        minWidth = qMax(minWidth, spacing * (frameRow.size() + 1) + frameRow.size());
+    }
+
+    return qMax(width, minWidth);
+}
+
+QVector<QVector<QRect>> GridComposer::layout() const
+{
+    QVector<QVector<QRect>> areas;
+    areas.reserve(rows.size());
+
+    const int totalWidth = gridWidth();
+    int y = spacing;
+    for(const auto& frameRow : rows) {
+        const int columns = frameRow.size();
+        const int frameWidth = (totalWidth - spacing * (columns + 1)) / columns;
+        const int frameHeight = qMax(1, qRound(static_cast<double>(frameWidth) *
+                                               frameSize.height() / frameSize.width()));
+
+        QVector<QRect> rowAreas;
+        rowAreas.reserve(columns);
+        for(int column = 0; column < columns; ++column) {
+            rowAreas.append(QRect(spacing + column * (frameWidth + spacing), y,
+                                  frameWidth, frameHeight));
+        }
+
+        areas.append(rowAreas);
+        y += frameHeight + spacing;
+    }
+
+    return areas;
+}
+
+QSize GridComposer::size() const
+{
+    const auto areas = layout();
+    if(areas.empty()) {
+        return {};
+    }
+
+    return {gridWidth(), areas.last().first().bottom() + 1 + spacing};
+}
+
+QImage GridComposer::compose() const
+{
+    const auto areas = layout();
+    const QSize gridSize = size();
+    if(gridSize.isEmpty()) {
+        return {};
+    }
+
+    const QImage::Format format = spacingColor.alpha() < 255 ? QImage::Format_ARGB32
+                                                             : QImage::Format_RGB32;
+    QImage grid(gridSize, format);
+    if(grid.isNull()) {
+        qCCritical(GRIDCOMPOSER) << "Unable to allocate grid of size" << gridSize;
+        return {};
+    }
+
+    grid.fill(spacingColor);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Take the pixel data once, workers must not touch the image itself
+    uchar *gridBits = grid.bits();
+    const int bytesPerLine = grid.bytesPerLine();
+
+    QVector<int> rowIndexes;
+    rowIndexes.reserve(rows.size());
+    for(int row = 0; row < rows.size(); ++row) {
+        rowIndexes.append(row);
+    }
+
+    QtConcurrent::blockingMap(rowIndexes, [&](const int row) {
+        composeRow(gridBits, bytesPerLine, gridSize, format, rows.at(row), areas.at(row));
+    });
+
+    qCDebug(GRIDCOMPOSER) << "Composed grid of" << rows.size() << "rows and size"
+                          << gridSize << "in" << timer.elapsed() << "ms";
+
+    return grid;
+}
+
+void GridComposer::composeRow(uchar *gridBits, const int bytesPerLine,
+                              const QSize& gridSize, const QImage::Format format,
+                              const QVector<int>& frameRow,
+                              const QVector<QRect>& areas) const
+{
+    for(int column = 0; column < frameRow.size(); ++column) {
+        const int frameNum = frameRow.at(column);
+        const QRect area = areas.at(column);
+
+        QImage frame = frameSource(frameNum);
+        if(frame.isNull()) {
+            qCWarning(GRIDCOMPOSER) << "Frame" << frameNum << "is not available";
+            continue;
+        }
+
+        // Scale and release the full size frame before fetching the next one
+        frame = frame.scaled(area.size(), Qt::KeepAspectRatio, Qt::SmoothTransformation)
+                     .convertToFormat(format);
+
+        // Centered in its area if the aspect ratio differs, and clipped to the grid
+        const QRect target = QRect(area.x() + (area.width() - frame.width()) / 2,
+                                   area.y() + (area.height() - frame.height()) / 2,
+                                   frame.width(), frame.height());
+        const QRect clipped = target.intersected(QRect(QPoint(0, 0), gridSize));
+        if(clipped.isEmpty()) {
+            continue;
+        }
+
+        const int left = clipped.x() - target.x();
+        const int top = clipped.y() - target.y();
+        const int lineBytes = clipped.width() * 4;
+        for(int line = 0; line < clipped.height(); ++line) {
+            std::memcpy(gridBits + (clipped.y() + line) * bytesPerLine + clipped.x() * 4,
+                        frame.constScanLine(top + line) + left * 4, lineBytes);
+        }
+    }
+}
+
+} // namespace core
+} // namespace vfg
@@ -0,0 +1,159 @@
+#ifndef VFG_GRIDCOMPOSER_H
+#define VFG_GRIDCOMPOSER_H
+
+#include <functional>
+#include <QColor>
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The GridComposer class
+ *
+ * Composes frames into a single grid image. Each row is scaled to fill
+ * the grid width, frames in a row are equally wide, and the spacing
+ * surrounds every frame.
+ *
+ * The output is allocated once at its final size. Rows are composed in
+ * parallel, each fetching its frames one at a time and copying them to
+ * the output at the final scale, so only one full size frame per thread
+ * is held in memory regardless of the number of frames in the grid.
+ */
+class GridComposer
+{
+public:
+    /**
+     * @brief Function that returns a full size frame
+     *
+     * Called from several threads at once, so it must be thread-safe.
+     * Returns a null QImage if the frame is not available.
+     */
+    using FrameSource = std::function<QImage(int)>;
+
+    /**
+     * @brief Store a frame number in a thumbnail
+     *
+     * The number is stored as image text, which is kept when the
+     * thumbnail is serialized, for example to drag and drop an icon
+     *
+     * @param thumbnail Thumbnail of the frame
+     * @param frameNum Frame number
+     * @return Thumbnail with the frame number
+     */
+    static QImage tagThumbnail(const QImage& thumbnail, int frameNum);
+
+    /**
+     * @brief Get the frame number stored in a thumbnail
+     * @param thumbnail Thumbnail from \link tagThumbnail \endlink
+     * @return Frame number, -1 if the thumbnail has none
+     */
+    static int taggedFrame(const QImage& thumbnail);
+
+    /**
+     * @brief Constructor
+     * @param source Source of the frames
+     * @param frameSize Size of the frames, sets the row heights
+     * @exception std::invalid_argument If source is empty or frameSize is empty
+     */
+    GridComposer(FrameSource source, const QSize& frameSize);
+
+    /**
+     * @brief Set frame numbers of the grid
+     * @param frameRows Frame numbers of each row
+     */
+    void setRows(const QVector<QVector<int>>& frameRows);
+
+    /**
+     * @brief Set grid width
+     *
+     * The grid is widened if the width doesn't fit the spacing and
+     * a pixel wide frame for every column
+     *
+     * @param value Width in pixels, the frame width by default
+     */
+    void setWidth(int value);
+
+    /**
+     * @brief Set spacing around the frames
+     * @param value Spacing in pixels
+     */
+    void setSpacing(int value);
+
+    /**
+     * @brief Set spacing color
+     *
+     * A transparent color gives a transparent grid
+     *
+     * @param color Spacing color
+     */
+    void setSpacingColor(const QColor& color);
+
+    /**
+     * @brief Get size of the composed grid
+     * @return Grid size, empty if there are no rows
+     */
+    QSize size() const;
+
+    /**
+     * @brief Compose the grid
+     * @return Grid image, null if there are no rows
+     */
+    QImage compose() const;
+
+private:
+    //! Source of the frames
+    FrameSource frameSource;
+
+    //! Size of the frames
+    QSize frameSize;
+
+    //! Frame numbers of each row
+    QVector<QVector<int>> rows {};
+
+    //! Width of the grid
+    int width;
+
+    //! Spacing around the frames
+    int spacing {0};
+
+    //! Spacing color
+    QColor spacingColor {Qt::transparent};
+
+    /**
+     * @brief Get width of the composed grid
+     * @return Grid width, at least wide enough for every row
+     */
+    int gridWidth() const;
+
+    /**
+     * @brief Get areas of the frames of every row in the grid
+     * @return Frame areas of each row
+     */
+    QVector<QVector<QRect>> layout() const;
+
+    /**
+     * @brief Compose a row into the grid
+     *
+     * Rows write to disjoint lines of the grid, so they can be
+     * composed in parallel without painting on the same image
+     *
+     * @param gridBits Pixel data of the grid
+     * @param bytesPerLine Bytes per line of the grid
+     * @param gridSize Size of the grid, frames are clipped to it
+     * @param format Pixel format of the grid
+     * @param frameRow Frame numbers of the row
+     * @param areas Frame areas of the row
+     */
+    void composeRow(uchar *gridBits, int bytesPerLine, const QSize& gridSize,
+                    QImage::Format format, const QVector<int>& frameRow,
+                    const QVector<QRect>& areas) const;
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_GRIDCOMPOSER_H
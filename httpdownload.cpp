@@ -1,15 +1,56 @@
+#include <algorithm>
 #include <memory>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QPair>
+#include <QSaveFile>
 #include <QString>
 #include <QTime>
 #include <QUrl>
 #include <QVariant>
+#include <QVector>
+#include "bandwidthlimiter.hpp"
+#include "downloadwriter.hpp"
 #include "httpdownload.hpp"
+#include "ptrutil.hpp"
+
+Q_LOGGING_CATEGORY(HTTPDOWNLOAD, "httpdownload")
+
+namespace {
+
+//! Smallest segment worth its own connection
+constexpr qint64 MinSegmentSize = 1024 * 1024;
+
+//! Number of times a failed segment is requested again before giving up
+constexpr int MaxSegmentAttempts = 3;
+
+//! Writer stream of a non-segmented download, segments use their index
+constexpr int SingleStream = -1;
+
+/**
+ * @brief Delete reply once control returns to the event loop
+ *
+ * Replies may be discarded from their own signal handlers,
+ * so they can't be deleted immediately
+ *
+ * @param reply Reply to discard
+ */
+void discardReply(std::unique_ptr<QNetworkReply>& reply) {
+    if(reply) {
+        reply->disconnect();
+        reply.release()->deleteLater();
+    }
+}
+
+} // namespace
 
 namespace vfg {
 namespace net {
@@ -17,8 +58,11 @@ namespace net {
 HttpDownload::HttpDownload(const QNetworkRequest& request, const QDir& cachePath, QObject *parent) :
     QObject(parent),
     request(request),
-    outFile(cachePath.absoluteFilePath(request.url().fileName()))
+    outFile(cachePath.absoluteFilePath(request.url().fileName())),
+    writer(vfg::make_unique<DownloadWriter>())
 {
+    connectWriter();
+
     if(!cachePath.exists()) {
         cachePath.mkpath(cachePath.path());
     }
@@ -36,29 +80,612 @@ HttpDownload::HttpDownload(const QNetworkRequest& request, const QDir& cachePath
     }
 }
 
+HttpDownload::HttpDownload(const QNetworkRequest& request, const QFileInfo& file, QObject *parent) :
+    QObject(parent),
+    request(request),
+    outFile(file.absoluteFilePath()),
+    writer(vfg::make_unique<DownloadWriter>())
+{
+    connectWriter();
+
+    file.absoluteDir().mkpath(".");
+
+    // Show progress of the previous session until the download is started
+    loadState();
+}
+
 HttpDownload::~HttpDownload()
 {
-    outFile.remove();
+    const bool remove = status == Status::Finished || !keepPartial || received == 0;
+
+    // The state only claims bytes already on disk, so the writer can
+    // drop its queue instead of making the caller wait for it
+    if(!remove) {
+        saveState();
+    }
+
+    writer.reset();
+
+    if(remove) {
+        outFile.remove();
+        removeState();
+    }
+}
+
+void HttpDownload::connectWriter()
+{
+    // Emitted from the writer thread
+    connect(writer.get(), &DownloadWriter::failed, this, [this](const QString& message) {
+        error = QNetworkReply::UnknownContentError;
+        errorText = message;
+        abort();
+    });
+
+    connect(writer.get(), &DownloadWriter::ready,
+            this,         &HttpDownload::resumeReading);
+
+    // The download is finished once its data is on disk
+    connect(writer.get(), &DownloadWriter::closed, this, [this]() {
+        if(!finishing) {
+            return;
+        }
+
+        finishing = false;
+        if(status == Status::Running) {
+            removeState();
+            status = Status::Finished;
+
+            emit updated();
+        }
+    });
+}
+
+void HttpDownload::resumeReading()
+{
+    if(status != Status::Running) {
+        return;
+    }
+
+    if(reply) {
+        readSingle(false);
+    }
+
+    for(std::size_t i = 0; i < segments.size(); ++i) {
+        writeSegment(i);
+    }
+}
+
+void HttpDownload::setMaxSegments(const int count)
+{
+    maxSegments = std::max(1, count);
+}
+
+int HttpDownload::getMaxSegments() const
+{
+    return maxSegments;
+}
+
+void HttpDownload::setBandwidthLimiter(BandwidthLimiter *rateLimiter)
+{
+    if(limiter) {
+        disconnect(limiter, &BandwidthLimiter::available,
+                   this,    &HttpDownload::resumeReading);
+    }
+
+    limiter = rateLimiter;
+
+    if(limiter) {
+        connect(limiter,    &BandwidthLimiter::available,
+                this,       &HttpDownload::resumeReading);
+    }
+}
+
+void HttpDownload::setReadBufferSize(const qint64 size)
+{
+    readBufferSize = std::max<qint64>(0, size);
+}
+
+void HttpDownload::setWriteBufferSize(const int size)
+{
+    writer->setBufferSize(size);
 }
 
 void HttpDownload::start(QNetworkAccessManager* netMan)
 {
-    received = total = dlDuration = downloaded = speed = 0;
+    manager = netMan;
+    error = QNetworkReply::NoError;
+    errorText.clear();
+    httpStatus = 0;
+    httpReason.clear();
+
+    discardReply(reply);
+    discardReply(probe);
+    for(Segment& segment : segments) {
+        discardReply(segment.reply);
+    }
+    finishing = false;
+    writer->close();
+
+    const bool resumable = loadState();
+    if(!resumable) {
+        received = total = 0;
+        segments.clear();
+        etag.clear();
+        lastModified.clear();
+    }
+
+    dlDuration = 0;
+    downloaded = received;
+    speed = 0.0;
+
+    timer.start();
+    speedTimer.start();
+
+    status = Status::Running;
+
+    const QString scheme = request.url().scheme();
+    if((maxSegments > 1 || resumable) && (scheme == "http" || scheme == "https")) {
+        // Check range support and validate the partial file before resuming
+        probe.reset(manager->head(request));
+
+        connect(probe.get(), &QNetworkReply::finished,
+                this, &HttpDownload::probeFinished);
+    }
+    else {
+        startSingle(0);
+    }
+
+    emit updated();
+}
+
+void HttpDownload::probeFinished()
+{
+    const bool acceptsRanges = probe->error() == QNetworkReply::NoError
+            && probe->rawHeader("Accept-Ranges").toLower().contains("bytes");
+    const qint64 length = probe->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+    const QByteArray newEtag = probe->rawHeader("ETag");
+    const QByteArray newLastModified = probe->rawHeader("Last-Modified");
+    discardReply(probe);
+
+    if(status != Status::Running) {
+        return;
+    }
 
-    outFile.open(QIODevice::WriteOnly);
+    // Weak validation: an ETag is preferred, otherwise Last-Modified must match
+    const bool unchanged = !etag.isEmpty() ? etag == newEtag
+                                           : !lastModified.isEmpty() && lastModified == newLastModified;
+    const bool resume = acceptsRanges && received > 0 && unchanged && length == total;
+    etag = newEtag;
+    lastModified = newLastModified;
 
-    reply.reset(netMan->get(request));
+    if(resume && !segments.empty() && resumeSegmented()) {
+        return;
+    }
+    else if(resume && segments.empty()) {
+        startSingle(received);
+        return;
+    }
+
+    if(received > 0) {
+        qCDebug(HTTPDOWNLOAD) << "Partial file can't be resumed, downloading from the beginning";
+    }
+
+    segments.clear();
+    received = downloaded = 0;
+
+    const int count = static_cast<int>(std::min<qint64>(maxSegments, length / MinSegmentSize));
+    if(acceptsRanges && count > 1) {
+        startSegmented(length, count);
+    }
+    else {
+        qCDebug(HTTPDOWNLOAD) << "Ranges not supported or file too small, using a single request";
+
+        startSingle(0);
+    }
+}
+
+void HttpDownload::startSingle(const qint64 offset)
+{
+    resumeOffset = offset;
+
+    QNetworkRequest singleRequest(request);
+    if(offset > 0) {
+        qCDebug(HTTPDOWNLOAD) << "Resuming download from byte" << offset;
+
+        // Drop anything written after the last saved state
+        writer->open(outFile.fileName(), false);
+        writer->resize(offset);
+
+        singleRequest.setRawHeader("Range", QString("bytes=%1-").arg(offset).toLatin1());
+        const QByteArray validator = !etag.isEmpty() ? etag : lastModified;
+        if(!validator.isEmpty()) {
+            singleRequest.setRawHeader("If-Range", validator);
+        }
+    }
+    else {
+        writer->open(outFile.fileName(), true);
+        received = 0;
+    }
+    singleWritten = offset;
+
+    reply.reset(manager->get(singleRequest));
+
+    // Bounds memory use while the writer is busy
+    reply->setReadBufferSize(readBufferSize);
+
+    connect(reply.get(), &QNetworkReply::metaDataChanged, this, [this]() {
+        // If-Range returns the whole file if it has changed
+        const int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if(resumeOffset > 0 && code != 206) {
+            qCDebug(HTTPDOWNLOAD) << "File has changed, downloading from the beginning";
+
+            resumeOffset = 0;
+            received = downloaded = singleWritten = 0;
+            writer->resize(0);
+        }
+
+        // Reserve space up front to avoid fragmenting the file
+        const qint64 length = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+        if(length > 0) {
+            writer->preallocate(singleWritten + length);
+        }
+
+        if(etag.isEmpty() && lastModified.isEmpty()) {
+            etag = reply->rawHeader("ETag");
+            lastModified = reply->rawHeader("Last-Modified");
+        }
+    });
 
     connect(reply.get(), &QNetworkReply::downloadProgress,
             this, &HttpDownload::updateProgress);
 
     connect(reply.get(), &QNetworkReply::finished,
             this, &HttpDownload::downloadFinished);
+}
 
-    timer.start();
-    speedTimer.start();
+void HttpDownload::startSegmented(const qint64 length, const int count)
+{
+    qCDebug(HTTPDOWNLOAD) << "Downloading" << length << "bytes in" << count << "segments";
 
-    status = Status::Running;
+    total = length;
+
+    // Failing to open the file aborts the download through the writer's failed signal
+    writer->open(outFile.fileName(), true);
+
+    // Preallocate so that segments can be written at their offsets
+    writer->preallocate(length);
+
+    segments = std::vector<Segment>(static_cast<std::size_t>(count));
+    const qint64 segmentSize = length / count;
+    for(std::size_t i = 0; i < segments.size(); ++i) {
+        segments[i].start = static_cast<qint64>(i) * segmentSize;
+        segments[i].end = i + 1 == segments.size() ? length - 1
+                                                   : static_cast<qint64>(i + 1) * segmentSize - 1;
+    }
+
+    saveState();
+
+    for(std::size_t i = 0; i < segments.size(); ++i) {
+        requestSegment(i);
+    }
+}
+
+bool HttpDownload::resumeSegmented()
+{
+    if(outFile.size() != total) {
+        return false;
+    }
+
+    writer->open(outFile.fileName(), false);
+
+    qCDebug(HTTPDOWNLOAD) << "Resuming segmented download at" << received << "of" << total << "bytes";
+
+    for(std::size_t i = 0; i < segments.size(); ++i) {
+        if(!segments[i].isComplete()) {
+            segments[i].attempts = 0;
+            requestSegment(i);
+        }
+    }
+
+    return true;
+}
+
+void HttpDownload::requestSegment(const std::size_t index)
+{
+    Segment& segment = segments[index];
+
+    QNetworkRequest segmentRequest(request);
+    segmentRequest.setRawHeader("Range", QString("bytes=%1-%2")
+                                .arg(segment.start + segment.written)
+                                .arg(segment.end).toLatin1());
+
+    const QByteArray validator = !etag.isEmpty() ? etag : lastModified;
+    if(!validator.isEmpty()) {
+        segmentRequest.setRawHeader("If-Range", validator);
+    }
+
+    discardReply(segment.reply);
+    segment.reply.reset(manager->get(segmentRequest));
+    segment.reply->setReadBufferSize(readBufferSize);
+
+    connect(segment.reply.get(), &QNetworkReply::readyRead, this, [this, index]() {
+        writeSegment(index);
+    });
+
+    connect(segment.reply.get(), &QNetworkReply::finished, this, [this, index]() {
+        segmentFinished(index);
+    });
+}
+
+void HttpDownload::writeSegment(const std::size_t index)
+{
+    Segment& segment = segments[index];
+    if(!segment.reply || segment.reply->bytesAvailable() == 0) {
+        return;
+    }
+
+    // A server that ignores the range, or a file that has changed,
+    // would send the whole file
+    if(segment.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206) {
+        qCWarning(HTTPDOWNLOAD) << "Segment" << index << "request did not return partial content";
+
+        segment.reply->abort();
+        return;
+    }
+
+    // Leave the data in the reply until the writer catches up,
+    // the read buffer limit then throttles the connection
+    const bool finished = segment.reply->isFinished();
+    if(writer->isBusy() && !finished) {
+        return;
+    }
+
+    const qint64 allowed = readAllowance(segment.reply->bytesAvailable(), finished);
+    if(allowed == 0) {
+        return;
+    }
+
+    const QByteArray data = segment.reply->read(allowed);
+    const qint64 offset = segment.start + segment.written;
+    const qint64 size = std::min<qint64>(data.size(), segment.end + 1 - offset);
+    writer->write(static_cast<int>(index), offset, size == data.size() ? data : data.left(static_cast<int>(size)));
+
+    segment.written += size;
+    received += size;
+    dlDuration = timer.elapsed();
+    updateSpeed();
+
+    // The segment may have been shortened by a prioritized range
+    if(segment.isComplete() && !segment.reply->isFinished()) {
+        segment.reply->disconnect();
+        segment.reply->abort();
+        discardReply(segment.reply);
+        finishIfComplete();
+    }
+
+    emit updated();
+}
+
+void HttpDownload::segmentFinished(const std::size_t index)
+{
+    if(status != Status::Running) {
+        return;
+    }
+
+    Segment& segment = segments[index];
+    writeSegment(index);
+
+    if(status != Status::Running) {
+        return;
+    }
+
+    if(!segment.isComplete()) {
+        if(segment.attempts < MaxSegmentAttempts) {
+            ++segment.attempts;
+
+            qCDebug(HTTPDOWNLOAD) << "Requesting segment" << index << "again, attempt" << segment.attempts;
+
+            requestSegment(index);
+            return;
+        }
+
+        qCWarning(HTTPDOWNLOAD) << "Segment" << index << "failed:" << segment.reply->errorString();
+
+        storeReplyStatus(*segment.reply);
+        if(error == QNetworkReply::NoError) {
+            error = QNetworkReply::UnknownContentError;
+            errorText = tr("Incomplete segment");
+        }
+
+        abort();
+        return;
+    }
+
+    storeReplyStatus(*segment.reply);
+    discardReply(segment.reply);
+
+    finishIfComplete();
+}
+
+void HttpDownload::finishIfComplete()
+{
+    const bool complete = std::all_of(segments.cbegin(), segments.cend(), [](const Segment& s) {
+        return s.isComplete();
+    });
+    if(complete && status == Status::Running && !finishing) {
+        // Finished once the writer has closed the file, see connectWriter
+        dlDuration = timer.elapsed();
+        finishing = true;
+        writer->close();
+    }
+}
+
+void HttpDownload::prioritizeRange(const qint64 first, const qint64 last)
+{
+    if(status != Status::Running || segments.empty()) {
+        return;
+    }
+
+    for(std::size_t i = 0; i < segments.size(); ++i) {
+        Segment& segment = segments[i];
+        const qint64 front = segment.start + segment.written;
+        if(segment.isComplete() || first > segment.end || last < front) {
+            continue;
+        }
+
+        // The connection will reach the range soon enough on its own
+        if(first - front < MinSegmentSize) {
+            return;
+        }
+
+        qCDebug(HTTPDOWNLOAD) << "Splitting segment" << i << "at byte" << first;
+
+        // The running request stops once it reaches the end of the shortened segment
+        Segment split;
+        split.start = first;
+        split.end = segment.end;
+        segment.end = first - 1;
+        segments.push_back(std::move(split));
+
+        saveState();
+        requestSegment(segments.size() - 1);
+        return;
+    }
+}
+
+QVector<QPair<qint64, qint64>> HttpDownload::availableRanges() const
+{
+    QVector<QPair<qint64, qint64>> ranges;
+    if(status == Status::Finished) {
+        ranges.append(qMakePair(qint64(0), total - 1));
+    }
+    else if(segments.empty()) {
+        const qint64 written = singleWritten - writer->pendingBytes(SingleStream);
+        if(written > 0) {
+            ranges.append(qMakePair(qint64(0), written - 1));
+        }
+    }
+    else {
+        for(std::size_t i = 0; i < segments.size(); ++i) {
+            const qint64 written = segments[i].written - writer->pendingBytes(static_cast<int>(i));
+            if(written > 0) {
+                ranges.append(qMakePair(segments[i].start, segments[i].start + written - 1));
+            }
+        }
+
+        std::sort(ranges.begin(), ranges.end());
+    }
+
+    return ranges;
+}
+
+bool HttpDownload::isPreallocated() const
+{
+    return status == Status::Finished || !segments.empty();
+}
+
+void HttpDownload::storeReplyStatus(const QNetworkReply& from)
+{
+    error = from.error();
+    errorText = error == QNetworkReply::NoError ? QString() : from.errorString();
+    httpStatus = from.attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    httpReason = from.attribute(QNetworkRequest::HttpReasonPhraseAttribute).toString();
+}
+
+void HttpDownload::updateSpeed()
+{
+    // Calculate download speed in the last second
+    if(speedTimer.elapsed() > 1000) {
+        downloaded = received - downloaded;
+        speed = static_cast<double>(downloaded) / (speedTimer.elapsed() / 1000.0);
+        downloaded = received;
+        speedTimer.restart();
+
+        // Checkpoint progress so that at most a second of data is lost
+        saveState();
+    }
+}
+
+QString HttpDownload::statePath() const
+{
+    return outFile.fileName() + ".state";
+}
+
+bool HttpDownload::loadState()
+{
+    QFile stateFile(statePath());
+    if(!outFile.exists() || !stateFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject state = QJsonDocument::fromJson(stateFile.readAll()).object();
+    if(state.value("url").toString() != request.url().toString()) {
+        qCWarning(HTTPDOWNLOAD) << "State file" << statePath() << "belongs to another download";
+
+        return false;
+    }
+
+    etag = state.value("etag").toString().toLatin1();
+    lastModified = state.value("lastmodified").toString().toLatin1();
+    total = static_cast<qint64>(state.value("total").toDouble());
+    received = static_cast<qint64>(state.value("received").toDouble());
+
+    const QJsonArray savedSegments = state.value("segments").toArray();
+    segments = std::vector<Segment>(static_cast<std::size_t>(savedSegments.size()));
+    received = savedSegments.isEmpty() ? received : 0;
+    for(int i = 0; i < savedSegments.size(); ++i) {
+        const QJsonObject saved = savedSegments.at(i).toObject();
+        Segment& segment = segments[static_cast<std::size_t>(i)];
+        segment.start = static_cast<qint64>(saved.value("start").toDouble());
+        segment.end = static_cast<qint64>(saved.value("end").toDouble());
+        segment.written = static_cast<qint64>(saved.value("written").toDouble());
+        received += segment.written;
+    }
+
+    return true;
+}
+
+void HttpDownload::saveState()
+{
+    if(received == 0 || status == Status::Finished) {
+        return;
+    }
+
+    // Only claim bytes that the writer has put on disk
+    QJsonArray savedSegments;
+    for(std::size_t i = 0; i < segments.size(); ++i) {
+        QJsonObject saved;
+        saved.insert("start", static_cast<double>(segments[i].start));
+        saved.insert("end", static_cast<double>(segments[i].end));
+        saved.insert("written", static_cast<double>(segments[i].written
+                                                    - writer->pendingBytes(static_cast<int>(i))));
+        savedSegments.append(saved);
+    }
+    const qint64 saved = segments.empty() ? singleWritten - writer->pendingBytes(SingleStream)
+                                          : received;
+
+    QJsonObject state;
+    state.insert("url", request.url().toString());
+    state.insert("etag", QString::fromLatin1(etag));
+    state.insert("lastmodified", QString::fromLatin1(lastModified));
+    state.insert("total", static_cast<double>(total));
+    state.insert("received", static_cast<double>(saved));
+    state.insert("segments", savedSegments);
+
+    QSaveFile stateFile(statePath());
+    if(!stateFile.open(QIODevice::WriteOnly)) {
+        qCWarning(HTTPDOWNLOAD) << "Unable to write" << statePath() << stateFile.errorString();
+
+        return;
+    }
+
+    stateFile.write(QJsonDocument(state).toJson(QJsonDocument::Compact));
+    stateFile.commit();
+}
+
+void HttpDownload::removeState()
+{
+    QFile::remove(statePath());
 }
 
 double HttpDownload::percentCompleted() const
@@ -71,26 +698,37 @@ bool HttpDownload::sizeKnown() const
     return total >= 0;
 }
 
-int HttpDownload::bytesDownloaded() const
+qint64 HttpDownload::bytesDownloaded() const
 {
     return received;
 }
 
-int HttpDownload::bytesTotal() const
+qint64 HttpDownload::bytesTotal() const
 {
     return total;
 }
 
 bool HttpDownload::isFinished() const
 {
-    return reply->isFinished();
+    return status == Status::Finished || status == Status::Aborted;
 }
 
-int HttpDownload::duration() const
+qint64 HttpDownload::duration() const
 {
     return dlDuration;
 }
 
+int HttpDownload::activeConnections() const
+{
+    if(reply && !reply->isFinished()) {
+        return 1;
+    }
+
+    return static_cast<int>(std::count_if(segments.cbegin(), segments.cend(), [](const Segment& s) {
+        return s.reply && !s.isComplete();
+    }));
+}
+
 QString HttpDownload::fileName() const
 {
     const QFileInfo info(outFile);
@@ -104,19 +742,58 @@ QString HttpDownload::path() const
 
 void HttpDownload::abort()
 {
-    if(reply->isFinished()) {
+    if(status == Status::Pending) {
+        status = Status::Aborted;
+
+        emit updated();
+        return;
+    }
+    else if(status != Status::Running) {
         return;
     }
 
-    reply->abort();
-
+    // Set before aborting so that the finished handlers ignore the replies
     status = Status::Aborted;
 
-    outFile.close();
+    if(probe) {
+        probe->abort();
+    }
+
+    if(reply) {
+        reply->abort();
+    }
+
+    for(Segment& segment : segments) {
+        if(segment.reply) {
+            segment.reply->abort();
+        }
+    }
+
+    writer->close();
+    saveState();
 
     emit updated();
 }
 
+void HttpDownload::markPending()
+{
+    if(status == Status::Running) {
+        return;
+    }
+
+    status = Status::Pending;
+    speed = 0.0;
+
+    emit updated();
+}
+
+void HttpDownload::discard()
+{
+    abort();
+
+    keepPartial = false;
+}
+
 HttpDownload::Status HttpDownload::getStatus() const
 {
     return status;
@@ -127,6 +804,11 @@ QUrl HttpDownload::url() const
     return request.url();
 }
 
+QNetworkRequest HttpDownload::getRequest() const
+{
+    return request;
+}
+
 double HttpDownload::downloadSpeed() const
 {
     return speed;
@@ -134,56 +816,111 @@ double HttpDownload::downloadSpeed() const
 
 bool HttpDownload::hasError() const
 {
-    return reply->error() != QNetworkReply::NoError;
+    return error != QNetworkReply::NoError;
 }
 
 QString HttpDownload::errorString() const
 {
-    return reply->errorString();
+    return errorText;
 }
 
 int HttpDownload::statusCode() const
 {
-    return reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return httpStatus;
 }
 
 QString HttpDownload::reason() const
 {
-    return reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toString();
+    return httpReason;
 }
 
 void HttpDownload::retry()
 {
-    start(reply->manager());
+    if(!manager) {
+        return;
+    }
+
+    // Progress is picked up from the state file, which is
+    // kept again if the download was discarded
+    keepPartial = true;
+    saveState();
+    start(manager);
 }
 
 void HttpDownload::downloadFinished()
 {
     dlDuration = timer.elapsed();
 
-    // Prevent aborted requests from being marked as finished
-    if(status == Status::Running) {
-        status = Status::Finished;
+    // Write data left in the reply. It's already counted in received
+    // by the progress updates, the written bytes are in singleWritten
+    readSingle(true);
+
+    storeReplyStatus(*reply);
+
+    if(status == Status::Running && hasError()) {
+        // Keep the partial file so that it can be resumed
+        status = Status::Aborted;
+        writer->close();
+        saveState();
+    }
+    else if(status == Status::Running) {
+        // Drop any space preallocated beyond the received data. The download
+        // is finished once the writer has closed the file, see connectWriter
+        writer->resize(singleWritten);
+        finishing = true;
+        writer->close();
     }
+    else {
+        writer->close();
+    }
+
+    emit updated();
+}
+
+qint64 HttpDownload::readSingle(const bool force)
+{
+    // Leave the data in the reply until the writer catches up,
+    // the read buffer limit then throttles the connection
+    if(reply->bytesAvailable() == 0 || (!force && writer->isBusy())) {
+        return 0;
+    }
+
+    const qint64 allowed = readAllowance(reply->bytesAvailable(), force);
+    if(allowed == 0) {
+        return 0;
+    }
+
+    // reply->readAll() fails to return complete data
+    const QByteArray data = reply->read(allowed);
+    writer->write(SingleStream, singleWritten, data);
+    singleWritten += data.size();
+
+    return data.size();
+}
+
+qint64 HttpDownload::readAllowance(const qint64 available, const bool force)
+{
+    if(!limiter) {
+        return available;
+    }
+    else if(force) {
+        limiter->consume(available);
+        return available;
+    }
+
+    return limiter->acquire(available);
 }
 
 void HttpDownload::updateProgress(const qint64 bytesReceived, const qint64 bytesTotal)
 {
-    received = bytesReceived;
-    total = bytesTotal;
+    received = resumeOffset + bytesReceived;
+    total = bytesTotal < 0 ? bytesTotal : resumeOffset + bytesTotal;
 
     dlDuration = timer.elapsed();
 
-    // Calculate download speed in the last second
-    if(speedTimer.elapsed() > 1000) {
-        downloaded = received - downloaded;
-        speed = static_cast<double>(downloaded) / (speedTimer.elapsed() / 1000.0);
-        downloaded = received;
-        speedTimer.restart();
-    }
+    readSingle(false);
 
-    // reply->readAll() fails to return complete data
-    outFile.write(reply->read(reply->bytesAvailable()));
+    updateSpeed();
 
     emit updated();
 }
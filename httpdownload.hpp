@@ -2,15 +2,19 @@
 #define VFG_NET_HTTPDOWNLOAD_HPP
 
 #include <memory>
+#include <vector>
 #include <QFile>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QObject>
+#include <QPair>
 #include <QTime>
+#include <QVector>
 
 Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
 
 class QDir;
+class QFileInfo;
 class QNetworkAccessManager;
 class QString;
 class QUrl;
@@ -18,6 +22,26 @@ class QUrl;
 namespace vfg {
 namespace net {
 
+class BandwidthLimiter;
+class DownloadWriter;
+
+/**
+ * @brief The HttpDownload class
+ *
+ * Downloads a file into the cache directory. If the server accepts
+ * byte ranges and the file is large enough, the file is split into
+ * segments that are downloaded in parallel into a preallocated file.
+ * Failed segments are requested again from where they left off.
+ *
+ * Data is written to disk by a \link DownloadWriter \endlink in its own
+ * thread. Reading from the network pauses while the writer is busy or
+ * while a shared \link BandwidthLimiter \endlink has no bytes to spare.
+ * The download is finished once the writer has closed the file.
+ *
+ * Progress is saved to a state file next to the output file so that
+ * an interrupted download can be resumed, even after a restart, if the
+ * server reports the same ETag or Last-Modified date for the file.
+ */
 class HttpDownload : public QObject
 {
     Q_OBJECT
@@ -31,9 +55,75 @@ public:
     };
 
 private:
-    //! Network reply for the request
+    /**
+     * @brief Byte range of the file downloaded with a single request
+     */
+    struct Segment
+    {
+        //! First byte of the range
+        qint64 start {0};
+
+        //! Last byte of the range (inclusive)
+        qint64 end {0};
+
+        //! Bytes written from the start of the range
+        qint64 written {0};
+
+        //! Number of times the segment has been requested again
+        int attempts {0};
+
+        //! Network reply for the range
+        std::unique_ptr<QNetworkReply> reply {};
+
+        /**
+         * @brief Check if the whole range has been written
+         * @return True if complete, otherwise false
+         */
+        bool isComplete() const { return start + written > end; }
+    };
+
+    //! Network reply for a non-segmented download
     std::unique_ptr<QNetworkReply> reply {};
 
+    //! Network reply for the HEAD request that checks range support
+    std::unique_ptr<QNetworkReply> probe {};
+
+    //! Segments of a segmented download, empty otherwise
+    std::vector<Segment> segments {};
+
+    //! Maximum number of segments
+    int maxSegments {1};
+
+    //! Network manager used for the requests
+    QNetworkAccessManager *manager {nullptr};
+
+    //! Network error of the failed or last finished request
+    QNetworkReply::NetworkError error {QNetworkReply::NoError};
+
+    //! Error message of the failed or last finished request
+    QString errorText {};
+
+    //! HTTP status code of the failed or last finished request
+    int httpStatus {0};
+
+    //! HTTP reason phrase of the failed or last finished request
+    QString httpReason {};
+
+    //! ETag of the file, used to validate resumed downloads
+    QByteArray etag {};
+
+    //! Last-Modified date of the file, used if there's no ETag
+    QByteArray lastModified {};
+
+    //! Offset where a resumed non-segmented download continues
+    qint64 resumeOffset {0};
+
+    //! Keep the partial output file when destroyed so it can be resumed
+    bool keepPartial {true};
+
+    //! All data has been received and the writer is closing the file
+    bool finishing {false};
+
     //! Network request
     QNetworkRequest request;
 
@@ -52,6 +142,18 @@ private:
     //! Output file
     QFile outFile;
 
+    //! Writes received data to the output file
+    std::unique_ptr<DownloadWriter> writer;
+
+    //! Read buffer size of the network replies, 0 for unlimited
+    qint64 readBufferSize {1024 * 1024};
+
+    //! Bytes passed to the writer by a non-segmented download
+    qint64 singleWritten {0};
+
+    //! Shared rate limit, nullptr if unlimited
+    BandwidthLimiter *limiter {nullptr};
+
     //! Download status
     Status status {Status::Pending};
 
@@ -62,7 +164,113 @@ private:
     double speed {0.0};
 
     //! Download amount in the last second
-    int downloaded {0};
+    qint64 downloaded {0};
+
+    /**
+     * @brief Start a download with a single request
+     * @param offset Offset to resume from, 0 downloads the whole file
+     */
+    void startSingle(qint64 offset);
+
+    /**
+     * @brief Request incomplete segments of a resumed segmented download
+     * @return True on success, false if the output file doesn't match the state
+     */
+    bool resumeSegmented();
+
+    /**
+     * @brief Get path to the resume state file
+     * @return Path to the state file
+     */
+    QString statePath() const;
+
+    /**
+     * @brief Load resume state from the state file
+     *
+     * Sets the received bytes, total bytes, validators and segments
+     *
+     * @return True if the state matches this download and its file exists
+     */
+    bool loadState();
+
+    /**
+     * @brief Save resume state to the state file
+     */
+    void saveState();
+
+    /**
+     * @brief Remove the state file
+     */
+    void removeState();
+
+    /**
+     * @brief Start a segmented download
+     * @param length Size of the file
+     * @param count Number of segments
+     */
+    void startSegmented(qint64 length, int count);
+
+    /**
+     * @brief Request the remaining bytes of a segment
+     * @param index Segment index
+     */
+    void requestSegment(std::size_t index);
+
+    /**
+     * @brief Write available data of a segment to the output file
+     * @param index Segment index
+     */
+    void writeSegment(std::size_t index);
+
+    /**
+     * @brief Handle a finished segment request
+     *
+     * Requests the segment again if it is incomplete
+     *
+     * @param index Segment index
+     */
+    void segmentFinished(std::size_t index);
+
+    /**
+     * @brief Finish the download if every segment is complete
+     */
+    void finishIfComplete();
+
+    /**
+     * @brief Store the status and error of a reply
+     * @param from Reply to store the status of
+     */
+    void storeReplyStatus(const QNetworkReply& from);
+
+    /**
+     * @brief Update download speed from the received bytes
+     */
+    void updateSpeed();
+
+    /**
+     * @brief Connect writer signals
+     */
+    void connectWriter();
+
+    /**
+     * @brief Pass available data of a non-segmented download to the writer
+     * @param force Read even if the writer is busy
+     * @return Bytes read
+     */
+    qint64 readSingle(bool force);
+
+    /**
+     * @brief Get number of bytes that may be read now
+     * @param available Bytes available in the reply
+     * @param force Read everything, e.g. from a finished reply
+     * @return Bytes to read
+     */
+    qint64 readAllowance(qint64 available, bool force);
+
+    /**
+     * @brief Read data left in the replies after reading was paused
+     */
+    void resumeReading();
 
 public:
     /**
@@ -73,17 +281,79 @@ public:
      */
     explicit HttpDownload(const QNetworkRequest& url, const QDir& cachePath, QObject *parent = 0);
 
+    /**
+     * @brief Constructor for resuming a download into an existing file
+     *
+     * Progress is read from the state file if it exists
+     *
+     * @param url Request URL
+     * @param file Output file
+     * @param parent Owner of the object
+     */
+    HttpDownload(const QNetworkRequest& url, const QFileInfo& file, QObject *parent = 0);
+
     /**
      * Destructor
+     *
+     * Removes the output file if the download finished or was discarded.
+     * Otherwise the partial file and its state are kept for resuming.
      */
     ~HttpDownload();
 
+    /**
+     * @brief Set maximum number of parallel segments
+     *
+     * Must be called before \link start \endlink
+     *
+     * @param count Maximum number of segments (1 disables segmenting)
+     */
+    void setMaxSegments(int count);
+
+    /**
+     * @brief Get maximum number of parallel segments
+     * @return Maximum number of segments
+     */
+    int getMaxSegments() const;
+
+    /**
+     * @brief Share a rate limit with other downloads
+     *
+     * The limit is enforced by leaving data in the replies, so it needs
+     * a limited read buffer (see \link setReadBufferSize \endlink) to
+     * slow down the connections themselves
+     *
+     * @param rateLimiter Rate limit, nullptr for unlimited
+     */
+    void setBandwidthLimiter(BandwidthLimiter *rateLimiter);
+
+    /**
+     * @brief Set read buffer size of the network replies
+     *
+     * Limits the memory used when data arrives faster than it can be
+     * written. Must be called before \link start \endlink
+     *
+     * @param size Buffer size in bytes, 0 for unlimited
+     */
+    void setReadBufferSize(qint64 size);
+
+    /**
+     * @brief Set size of the blocks written to disk
+     * @param size Block size in bytes
+     */
+    void setWriteBufferSize(int size);
+
     /**
      * @brief Start request
      * @param netMan Network manager to use
      */
     void start(QNetworkAccessManager* netMan);
 
+    /**
+     * @brief Get number of requests currently receiving data
+     * @return Number of active connections
+     */
+    int activeConnections() const;
+
     /**
      * @brief Percent completed
      * @return Percent completed
@@ -100,13 +370,13 @@ public:
      * @brief Bytes downloaded
      * @return Bytes downloaded
      */
-    int bytesDownloaded() const;
+    qint64 bytesDownloaded() const;
 
     /**
      * @brief Bytes total (size of the download)
      * @return Bytes total
      */
-    int bytesTotal() const;
+    qint64 bytesTotal() const;
 
     /**
      * @brief Is download finished
@@ -118,7 +388,7 @@ public:
      * @brief Duration of the download
      * @return Duration of the download
      */
-    int duration() const;
+    qint64 duration() const;
 
     /**
      * @brief Filename for the file being downloaded
@@ -134,9 +404,18 @@ public:
 
     /**
      * @brief Abort download
+     *
+     * A pending download is marked aborted without starting
      */
     void abort();
 
+    /**
+     * @brief Mark a download as waiting to be started
+     *
+     * Used when a stopped download is queued again
+     */
+    void markPending();
+
     /**
      * @brief Get reply status
      * @return Reply status
@@ -181,15 +460,50 @@ public:
 
     /**
      * @brief Attempt to restart the download
+     *
+     * Resumes from the bytes already on disk if the file
+     * has not changed on the server
      */
     void retry();
 
+    /**
+     * @brief Abort the download and remove its files when destroyed
+     */
+    void discard();
+
+    /**
+     * @brief Get network request
+     * @return Network request
+     */
+    QNetworkRequest getRequest() const;
+
+    /**
+     * @brief Get byte ranges written to the output file
+     * @return Sorted first and last byte (inclusive) of every written range
+     */
+    QVector<QPair<qint64, qint64>> availableRanges() const;
+
+    /**
+     * @brief Check if the output file has its final size
+     *
+     * Segmented downloads preallocate the file, so data can be
+     * read at its final offset while the download is running
+     *
+     * @return True if segmented or finished, otherwise false
+     */
+    bool isPreallocated() const;
+
 private slots:
     /**
      * @brief Triggered after download has finished
      */
     void downloadFinished();
 
+    /**
+     * @brief Triggered after the HEAD request has finished
+     */
+    void probeFinished();
+
 signals:
     /**
      * @brief Emitted when data has changed
@@ -204,6 +518,17 @@ public slots:
      */
     void updateProgress(qint64 bytesReceived, qint64 bytesTotal);
 
+    /**
+     * @brief Download a byte range before the rest of the file
+     *
+     * Splits the segment containing the range so that a new connection
+     * starts at the range. Has no effect on non-segmented downloads.
+     *
+     * @param first First byte of the range
+     * @param last Last byte of the range (inclusive)
+     */
+    void prioritizeRange(qint64 first, qint64 last);
+
 };
 
 } // namespace net
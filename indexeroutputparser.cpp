@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cctype>
+#include <QFileInfo>
+#include "indexeroutputparser.h"
+
+namespace {
+
+bool isTerminator(const char c) {
+    return c == '\n' || c == '\r';
+}
+
+} // namespace
+
+namespace vfg {
+
+void IndexerOutputParser::reset(const QStringList& inputFiles)
+{
+    pending.clear();
+    files = inputFiles;
+    fileEnds.clear();
+    current = IndexerProgress();
+
+    for(const QString& file : files) {
+        current.bytesTotal += QFileInfo(file).size();
+        fileEnds.append(current.bytesTotal);
+    }
+
+    if(!files.isEmpty()) {
+        current.currentFile = files.first();
+    }
+
+    elapsed.start();
+}
+
+bool IndexerOutputParser::feed(const char *data, const qint64 size)
+{
+    bool advanced = false;
+    const char *const end = data + size;
+    const char *record = data;
+
+    for(const char *pos = data; pos < end; ++pos) {
+        if(!isTerminator(*pos)) {
+            continue;
+        }
+
+        // Complete a record that started in a previous chunk
+        if(!pending.isEmpty()) {
+            pending.append(record, static_cast<int>(pos - record));
+            advanced |= parseRecord(pending.constData(), pending.constData() + pending.size());
+            pending.resize(0);
+        }
+        else {
+            advanced |= parseRecord(record, pos);
+        }
+
+        record = pos + 1;
+    }
+
+    // resize(0) keeps the capacity, so the buffer is reused
+    pending.append(record, static_cast<int>(end - record));
+
+    return advanced;
+}
+
+bool IndexerOutputParser::parseRecord(const char *begin, const char *end)
+{
+    // The percentage is the last number of the record
+    while(end > begin && !std::isdigit(static_cast<unsigned char>(end[-1]))) {
+        --end;
+    }
+
+    int value = 0;
+    int digits = 0;
+    for(int scale = 1; end > begin && std::isdigit(static_cast<unsigned char>(end[-1])) && digits < 4;
+        --end, scale *= 10, ++digits) {
+        value += (end[-1] - '0') * scale;
+    }
+
+    // DGIndex may print values smaller than the last one
+    if(digits == 0 || value > 100 || value <= current.percent) {
+        return false;
+    }
+
+    current.percent = value;
+    current.bytesProcessed = current.bytesTotal * value / 100;
+
+    const auto file = std::upper_bound(fileEnds.cbegin(), fileEnds.cend(), current.bytesProcessed);
+    if(file != fileEnds.cend()) {
+        current.currentFile = files.at(static_cast<int>(std::distance(fileEnds.cbegin(), file)));
+    }
+
+    const qint64 msecs = elapsed.elapsed();
+    if(msecs > 0) {
+        current.bytesPerSecond = current.bytesProcessed * 1000 / msecs;
+        current.remainingMsecs = msecs * (100 - value) / value;
+    }
+
+    return true;
+}
+
+const IndexerProgress& IndexerOutputParser::progress() const
+{
+    return current;
+}
+
+} // namespace vfg
@@ -0,0 +1,98 @@
+#ifndef VFG_INDEXEROUTPUTPARSER_H
+#define VFG_INDEXEROUTPUTPARSER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace vfg {
+
+/**
+ * @brief Progress of an indexer process
+ */
+struct IndexerProgress
+{
+    //! Progress in range 0-100
+    int percent {0};
+
+    //! Estimated bytes of the input files processed
+    qint64 bytesProcessed {0};
+
+    //! Total size of the input files in bytes
+    qint64 bytesTotal {0};
+
+    //! Input file being processed
+    QString currentFile {};
+
+    //! Average throughput in bytes per second, 0 until known
+    qint64 bytesPerSecond {0};
+
+    //! Estimated time left in milliseconds, -1 until known
+    qint64 remainingMsecs {-1};
+};
+
+/**
+ * @brief The IndexerOutputParser class parses indexer output incrementally
+ *
+ * Output is fed in chunks as it arrives. Chunks are split into records
+ * at line feeds and carriage returns, and a record cut off at the end
+ * of a chunk is kept until the rest arrives. The buffer is reused, so
+ * steady output doesn't allocate.
+ *
+ * DGIndex prints only a percentage per record. Bytes processed, the
+ * current input file and the time left are estimated from it and the
+ * sizes of the input files.
+ */
+class IndexerOutputParser
+{
+private:
+    //! Incomplete record from the previous chunk
+    QByteArray pending {};
+
+    //! Input files
+    QStringList files {};
+
+    //! End offset of each input file within all the input
+    QVector<qint64> fileEnds {};
+
+    //! Started when parsing starts
+    QElapsedTimer elapsed {};
+
+    //! Latest progress
+    IndexerProgress current {};
+
+    /**
+     * @brief Parse a complete record
+     * @param begin First character
+     * @param end One past the last character
+     * @return True if progress advanced, otherwise false
+     */
+    bool parseRecord(const char *begin, const char *end);
+
+public:
+    /**
+     * @brief Start parsing the output of a new process
+     * @param inputFiles Files given to the indexer, used for the estimates
+     */
+    void reset(const QStringList& inputFiles);
+
+    /**
+     * @brief Parse a chunk of output
+     * @param data Chunk
+     * @param size Size of the chunk
+     * @return True if progress advanced, otherwise false
+     */
+    bool feed(const char *data, qint64 size);
+
+    /**
+     * @brief Get latest progress
+     * @return Progress
+     */
+    const IndexerProgress& progress() const;
+};
+
+} // namespace vfg
+
+#endif // VFG_INDEXEROUTPUTPARSER_H
@@ -7,6 +7,7 @@
 #include <QSettings>
 #include <QString>
 #include <QVariant>
+#include "framequalityfilter.h"
 
 namespace vfg {
 namespace config {
@@ -29,11 +30,29 @@ QMap<QString, QVariant> getDefaultSettings()
     cfg["savedgindexfiles"] = false;
     cfg["showvideosettings"] = false;
     cfg["resumegeneratorafterclear"] = false;
+    cfg["livescrubbing"] = true;
+    cfg["keyframeseeking"] = false;
+    cfg["ffmsindexpath"] = QDir::currentPath().append("/ffmsindex.exe");
+    cfg["filmstriptiles"] = 160;
     cfg["gifsiclepath"] = QDir::currentPath().append("/gifsicle.exe");
     cfg["imagemagicktimeout"] = 90;
     cfg["gifsicletimeout"] = 30;
     cfg["enable_logging"] = false;
     cfg["cachedirectory"] = QDir::currentPath().append("/cache");
+    cfg["qualityfilter"] = false;
+    const vfg::core::FrameQualityFilter::Settings quality;
+    cfg["qualityminsharpness"] = quality.minSharpness;
+    cfg["qualityminluma"] = quality.minLuma;
+    cfg["qualitymaxluma"] = quality.maxLuma;
+    cfg["qualitysearchwindow"] = quality.searchWindow;
+    cfg["recordframetimings"] = false;
+    cfg["spillstore"] = false;
+    cfg["spillcompression"] = false;
+    cfg["downloadsegments"] = 4;
+    cfg["downloadreadbuffer"] = 1024;
+    cfg["downloadmaxactive"] = 3;
+    cfg["downloadmaxperhost"] = 8;
+    cfg["downloadbandwidth"] = 0;
     return cfg;
 }
 
@@ -0,0 +1,213 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QLoggingCategory>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+#include "keyframeindex.h"
+
+Q_LOGGING_CATEGORY(KEYFRAMES, "keyframeindex")
+
+namespace {
+
+//! Terminates the flags of the last GOP
+const int EndOfStream = 0xff;
+
+//! Repeat first field flag of a picture
+const int RepeatFirstField = 0x01;
+
+//! Flags of the first picture start at this column of a GOP line
+const int FirstFlagColumn = 7;
+
+//! Time limit for indexing a file with ffmsindex in milliseconds
+const int IndexTimeout = 10 * 60 * 1000;
+
+/**
+ * @brief Find keyframe lists written by ffmsindex -k for a file
+ * @param info Source file
+ * @return Paths of the lists, one per video track
+ */
+QStringList keyframeLists(const QFileInfo& info)
+{
+    // ffmsindex -k writes <index>_track<nn>.kf.txt for each video track
+    const QDir dir = info.absoluteDir();
+    QStringList lists = dir.entryList(
+                QStringList(QString("%1.ffindex_track*.kf.txt").arg(info.fileName())),
+                QDir::Files, QDir::Name);
+    for(QString& list : lists) {
+        list = dir.absoluteFilePath(list);
+    }
+
+    return lists;
+}
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+KeyframeIndex KeyframeIndex::fromD2v(const QString& path)
+{
+    KeyframeIndex index;
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCDebug(KEYFRAMES) << "Unable to open" << path;
+        return index;
+    }
+
+    QTextStream in(&file);
+    if(!in.readLine().startsWith("DGIndexProjectFile")) {
+        qCDebug(KEYFRAMES) << "Not a DGIndex project:" << path;
+        return index;
+    }
+
+    // Input files and settings each end in an empty line.
+    // Unless pulldown is honored, every picture is a frame
+    bool countPictures = false;
+    for(int sections = 0; sections < 2 && !in.atEnd();) {
+        const QString line = in.readLine();
+        if(line.isEmpty()) {
+            ++sections;
+        }
+        else if(line.startsWith("Field_Operation=")) {
+            countPictures = line.section('=', 1).toInt() != 0;
+        }
+    }
+
+    // Every line is a GOP that starts with an I-frame
+    int pictures = 0;
+    int fields = 0;
+    bool finished = false;
+    while(!finished && !in.atEnd()) {
+        const QString line = in.readLine();
+        const QStringList columns = line.split(' ', QString::SkipEmptyParts);
+        if(columns.size() <= FirstFlagColumn) {
+            break;
+        }
+
+        index.keyframes.append(countPictures ? pictures : fields / 2);
+
+        for(int col = FirstFlagColumn; col < columns.size(); ++col) {
+            bool ok = false;
+            const int flags = columns.at(col).toInt(&ok, 16);
+            if(!ok || flags == EndOfStream) {
+                finished = true;
+                break;
+            }
+
+            ++pictures;
+            fields += (flags & RepeatFirstField) ? 3 : 2;
+        }
+    }
+
+    index.frameCount = countPictures ? pictures : fields / 2;
+
+    qCDebug(KEYFRAMES) << "Read" << index.keyframes.size() << "keyframes of"
+                       << index.frameCount << "frames from" << path;
+
+    return index;
+}
+
+KeyframeIndex KeyframeIndex::fromKeyframeList(const QString& path)
+{
+    KeyframeIndex index;
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCDebug(KEYFRAMES) << "Unable to open" << path;
+        return index;
+    }
+
+    QTextStream in(&file);
+    if(!in.readLine().startsWith("# keyframe format")) {
+        qCDebug(KEYFRAMES) << "Not a keyframe list:" << path;
+        return index;
+    }
+
+    while(!in.atEnd()) {
+        bool ok = false;
+        const int frame = in.readLine().trimmed().toInt(&ok);
+        // Skips the fps line
+        if(ok && (index.keyframes.isEmpty() || frame > index.keyframes.last())) {
+            index.keyframes.append(frame);
+        }
+    }
+
+    qCDebug(KEYFRAMES) << "Read" << index.keyframes.size() << "keyframes from" << path;
+
+    return index;
+}
+
+KeyframeIndex KeyframeIndex::generate(const QString& sourcePath, const QString& indexerPath)
+{
+    const QFileInfo info(sourcePath);
+    if(!info.isFile() || !QFileInfo(indexerPath).isFile()) {
+        return {};
+    }
+
+    qCDebug(KEYFRAMES) << "Indexing" << sourcePath << "with" << indexerPath;
+
+    // Same index name as FFVideoSource's default cache file
+    QProcess indexer;
+    indexer.start(indexerPath, QStringList() << "-f" << "-k" << info.absoluteFilePath()
+                                             << info.absoluteFilePath() + ".ffindex");
+    if(!indexer.waitForFinished(IndexTimeout)) {
+        qCWarning(KEYFRAMES) << "Indexing" << sourcePath << "failed:" << indexer.errorString();
+        indexer.kill();
+        indexer.waitForFinished();
+
+        return {};
+    }
+
+    if(indexer.exitStatus() != QProcess::NormalExit || indexer.exitCode() != 0) {
+        qCWarning(KEYFRAMES) << "Indexing" << sourcePath << "failed with exit code" << indexer.exitCode();
+
+        return {};
+    }
+
+    const QStringList lists = keyframeLists(info);
+    if(lists.isEmpty()) {
+        return {};
+    }
+
+    return fromKeyframeList(lists.first());
+}
+
+KeyframeIndex KeyframeIndex::forSource(const QString& sourcePath, const QString& indexerPath)
+{
+    if(sourcePath.isEmpty()) {
+        return {};
+    }
+
+    const QFileInfo info(sourcePath);
+    if(info.suffix().compare("d2v", Qt::CaseInsensitive) == 0) {
+        return fromD2v(sourcePath);
+    }
+
+    const QStringList lists = keyframeLists(info);
+    if(lists.isEmpty()) {
+        return indexerPath.isEmpty() ? KeyframeIndex() : generate(sourcePath, indexerPath);
+    }
+
+    return fromKeyframeList(lists.first());
+}
+
+const QVector<int>& KeyframeIndex::frames() const
+{
+    return keyframes;
+}
+
+bool KeyframeIndex::matches(const int numFrames) const
+{
+    if(keyframes.isEmpty() || keyframes.last() >= numFrames) {
+        return false;
+    }
+
+    return frameCount == -1 || frameCount == numFrames;
+}
+
+} // namespace core
+} // namespace vfg
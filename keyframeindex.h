@@ -0,0 +1,88 @@
+#ifndef VFG_KEYFRAMEINDEX_H
+#define VFG_KEYFRAMEINDEX_H
+
+#include <QString>
+#include <QVector>
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The KeyframeIndex class
+ *
+ * Keyframe positions of a source file, read from the index the source
+ * filter uses. DGIndex projects (.d2v) list one GOP per line. For FFMS2
+ * the binary index isn't readable without the library, so the keyframe
+ * list written by ffmsindex -k next to the index is read. FFVideoSource
+ * doesn't write the list, so it is generated with ffmsindex if missing.
+ */
+class KeyframeIndex
+{
+private:
+    //! Sorted keyframe numbers
+    QVector<int> keyframes {};
+
+    //! Number of frames in the index, -1 if unknown
+    int frameCount {-1};
+
+public:
+    /**
+     * @brief Read keyframes of a DGIndex project
+     *
+     * Frame numbers follow the project's field operation, so they
+     * match the frames returned by MPEG2Source
+     *
+     * @param path Path to .d2v file
+     * @return Index, empty if the file can't be read
+     */
+    static KeyframeIndex fromD2v(const QString& path);
+
+    /**
+     * @brief Read a keyframe list in the format written by ffmsindex -k
+     * @param path Path to keyframe list
+     * @return Index, empty if the file can't be read
+     */
+    static KeyframeIndex fromKeyframeList(const QString& path);
+
+    /**
+     * @brief Index a file with ffmsindex -k and read the keyframe list
+     *
+     * Blocks until ffmsindex has finished. The index and the keyframe
+     * list are written next to the file, so they are indexed only once.
+     *
+     * @param sourcePath Path to the file to index
+     * @param indexerPath Path to ffmsindex
+     * @return Index, empty if indexing fails
+     */
+    static KeyframeIndex generate(const QString& sourcePath, const QString& indexerPath);
+
+    /**
+     * @brief Read keyframes of a source file from its index
+     * @param sourcePath Path to the file passed to the source filter
+     * @param indexerPath Path to ffmsindex, empty to not generate missing keyframe lists
+     * @return Index, empty if there is no readable index
+     */
+    static KeyframeIndex forSource(const QString& sourcePath, const QString& indexerPath = {});
+
+    /**
+     * @brief Get keyframe numbers
+     * @return Sorted keyframe numbers
+     */
+    const QVector<int>& frames() const;
+
+    /**
+     * @brief Check if the index fits a clip
+     *
+     * Filters that change the frame count, e.g. decimation, invalidate
+     * the positions
+     *
+     * @param numFrames Number of frames in the clip
+     * @return True if the keyframes can be used, otherwise false
+     */
+    bool matches(int numFrames) const;
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_KEYFRAMEINDEX_H
@@ -11,13 +11,20 @@
 #include "aboutwidget.hpp"
 #include "avisynthvideosource.h"
 #include "configdialog.h"
+#include "discjobmanager.h"
 #include "downloadsdialog.hpp"
-#include "dvdprocessor.h"
 #include "extractorfactory.hpp"
 #include "extractors/baseextractor.hpp"
+#include "filmstrip.h"
+#include "filmstripbuilder.h"
+#include "framefilter.h"
+#include "framequalityfilter.h"
+#include "framespillstore.h"
 #include "gifmakerwidget.hpp"
+#include "httpdownload.hpp"
 #include "jumptoframedialog.hpp"
 #include "opendialog.hpp"
+#include "progressivevideosource.h"
 #include "ptrutil.hpp"
 #include "savegriddialog.hpp"
 #include "scripteditor.h"
@@ -25,8 +32,10 @@
 #include "videoframegenerator.h"
 #include "videoframegrabber.h"
 #include "videoframethumbnail.h"
+#include "videosourceinstrumentation.h"
 #include "videosettingswidget.h"
 #include "x264encoderdialog.hpp"
+#include "y4mvideosource.h"
 
 Q_LOGGING_CATEGORY(MAINWINDOW, "mainwindow")
 
@@ -196,6 +205,12 @@ MainWindow::MainWindow(QWidget *parent) :
             gifMaker->updateLastFrame(ui.seekSlider->value());
         }
     });
+
+    // Resume downloads left unfinished by the previous session
+    const QDir cacheDir(config.value("cachedirectory", "cache").toString());
+    if(QFile::exists(cacheDir.absoluteFilePath("downloads.json"))) {
+        getDownloadsWindow();
+    }
 }
 
 MainWindow::~MainWindow()
@@ -223,9 +238,25 @@ void MainWindow::closeEvent(QCloseEvent *ev)
         return;
     }
 
+    filmstripBuilder->cancel();
+    filmstripThread->quit();
+    filmstripThread->wait();
     frameGeneratorThread->quit();
     frameGrabberThread->quit();
 
+    if(frameTimings) {
+        const QDir cacheDir(config.value("cachedirectory", "cache").toString());
+        const QString timingsPath = cacheDir.absoluteFilePath("frametimings.txt");
+        if(!cacheDir.exists()) {
+            cacheDir.mkpath(cacheDir.path());
+        }
+
+        qCDebug(MAINWINDOW) << "Writing frame timings to" << timingsPath;
+        if(!frameTimings->dump(timingsPath)) {
+            qCWarning(MAINWINDOW) << "Failed to write frame timings to" << timingsPath;
+        }
+    }
+
     scriptEditor.reset();
     videoSettingsWindow.reset();
     downloadsWindow.reset();
@@ -331,7 +362,7 @@ void MainWindow::updateSeekSlider(const int value, const MainWindow::SeekSlider
             mediaPlayer->setPosition(convertFrameToMs(value));
         }
         else {
-            frameGrabber->requestFrame(value);
+            frameGrabber->seekToFrame(value);
         }
     }
 }
@@ -346,6 +377,9 @@ vfg::ui::DownloadsDialog *MainWindow::getDownloadsWindow()
             resetUi();
             loadFile(path);
         });
+
+        connect(downloadsWindow.get(),  &vfg::ui::DownloadsDialog::playPartial,
+                this,                   &MainWindow::loadPartialDownload);
     }
 
     return downloadsWindow.get();
@@ -359,7 +393,15 @@ vfg::ui::OpenDialog *MainWindow::getOpenDialog()
         // When user wants to open URL via open dialog, add it to downloads
         connect(openDialog.get(), &vfg::ui::OpenDialog::openUrl, [this](const QNetworkRequest &req) {
             auto downloadsWindow = getDownloadsWindow();
-            downloadsWindow->addDownload(req);
+            // The user is waiting for this one, so it skips ahead of bulk downloads
+            downloadsWindow->addDownload(req, vfg::net::DownloadScheduler::Priority::High);
+            downloadsWindow->show();
+        });
+
+        // URLs resolved in the batch tab are queued behind the user's own downloads
+        connect(openDialog.get(), &vfg::ui::OpenDialog::enqueueUrl, [this](const QNetworkRequest &req) {
+            auto downloadsWindow = getDownloadsWindow();
+            downloadsWindow->addDownload(req, vfg::net::DownloadScheduler::Priority::Normal);
             downloadsWindow->show();
         });
 
@@ -391,6 +433,16 @@ vfg::ui::VideoSettingsWidget *MainWindow::getVideoSettingsWindow()
         // Draw crop border on video preview when crop changes in video settings
         connect(videoSettingsWindow.get(),  &vfg::ui::VideoSettingsWidget::cropChanged,
                 ui.videoPreviewWidget,     &vfg::ui::VideoPreviewWidget::setCrop);
+
+        // Show video settings on the current frame without reloading the script
+        connect(videoSettingsWindow.get(),  &vfg::ui::VideoSettingsWidget::previewChanged,
+                [this](const vfg::core::FrameFilter::Settings& settings) {
+            const auto filter = std::make_shared<vfg::core::FrameFilter>(settings);
+            frameGrabber->setPreviewFilter(filter->isIdentity() ? nullptr : filter);
+            if(frameGrabber->hasVideo()) {
+                frameGrabber->refreshFrame(ui.seekSlider->value());
+            }
+        });
     }
 
     return videoSettingsWindow.get();
@@ -466,33 +518,78 @@ QMediaPlayer *MainWindow::getMediaPlayer()
     return mediaPlayer.get();
 }
 
-vfg::DvdProcessor *MainWindow::getDvdProcessor()
+vfg::DiscJobManager *MainWindow::getDiscJobManager()
 {
-    if(!dvdProcessor) {
-        dvdProcessor = vfg::make_unique<vfg::DvdProcessor>(config.value("dgindexexecpath").toString());
+    if(!discJobs) {
+        const QDir cacheDir(config.value("cachedirectory").toString());
+        discJobs = vfg::make_unique<vfg::DiscJobManager>(config.value("dgindexexecpath").toString(),
+                                                         cacheDir.absoluteFilePath("dgindex"));
 
-        // When DVD processor finishes, hide dialog window and load the processed file
-        connect(dvdProcessor.get(), &vfg::DvdProcessor::finished, [this](const QString& filename) {
+        // When every title is indexed, hide dialog window and load the selected title
+        connect(discJobs.get(), &vfg::DiscJobManager::finished, [this](const QStringList& filenames) {
             auto dvdProgress = getDvdProgress();
             dvdProgress->accept();
+
+            QString filename = filenames.first();
+            if(filenames.size() > 1) {
+                QStringList titles;
+                for(int i = 0; i < filenames.size(); ++i) {
+                    titles.append(discJobs->jobName(i));
+                }
+
+                bool ok = false;
+                const QString title = QInputDialog::getItem(this, tr("Select title"), tr("Title:"),
+                                                            titles, 0, false, &ok);
+                if(!ok) {
+                    return;
+                }
+
+                filename = filenames.at(titles.indexOf(title));
+            }
+
             loadFile(filename);
         });
 
-        // When DVD processor emits an error, hide dialog window and show error
-        connect(dvdProcessor.get(), &vfg::DvdProcessor::error, [this](const QString &msg) {
+        // When a title fails, hide dialog window and show error
+        connect(discJobs.get(), &vfg::DiscJobManager::error, [this](const QString &msg) {
             auto dvdProgress = getDvdProgress();
             dvdProgress->cancel();
             QMessageBox::warning(this, tr("Video error"), msg);
         });
 
-        // When DVD processor emits an update value, update the dialog window progress
-        connect(dvdProcessor.get(), &vfg::DvdProcessor::progressUpdate, [this](const int progress) {
+        // Show overall progress in the bar and each title in the label
+        connect(discJobs.get(), &vfg::DiscJobManager::progressUpdate, [this](const int progress) {
             auto dvdProgress = getDvdProgress();
             dvdProgress->setValue(progress);
         });
+
+        connect(discJobs.get(), &vfg::DiscJobManager::jobProgress, [this]() {
+            QStringList lines(discJobs->jobCount() < 2 ? tr("Processing DVD...")
+                                                       : tr("Indexing %1 titles...").arg(discJobs->jobCount()));
+            for(int i = 0; i < discJobs->jobCount(); ++i) {
+                QString line = QString("%1: %2%").arg(discJobs->jobName(i)).arg(discJobs->jobPercent(i));
+                const QString file = discJobs->jobFile(i);
+                if(!file.isEmpty()) {
+                    line.append(QString(" (%1)").arg(QFileInfo(file).fileName()));
+                }
+                lines.append(line);
+            }
+
+            const qint64 rate = discJobs->bytesPerSecond();
+            const qint64 remaining = discJobs->remainingMsecs();
+            if(rate > 0 && remaining >= 0) {
+                const QTime left = QTime(0, 0).addMSecs(static_cast<int>(remaining));
+                lines.append(tr("%1 MB/s, %2 left")
+                             .arg(rate / (1024.0 * 1024.0), 0, 'f', 1)
+                             .arg(left.toString(remaining >= 3600000 ? "h:mm:ss" : "m:ss")));
+            }
+
+            auto dvdProgress = getDvdProgress();
+            dvdProgress->setLabelText(lines.join('\n'));
+        });
     }
 
-    return dvdProcessor.get();
+    return discJobs.get();
 }
 
 QProgressDialog *MainWindow::getDvdProgress()
@@ -501,9 +598,9 @@ QProgressDialog *MainWindow::getDvdProgress()
         dvdProgress = vfg::make_unique<QProgressDialog>(tr("Processing DVD..."), tr("Abort"), 0, 100);
 
         // When user wants to cancel DVD loading...
-        auto dvdProcessor = getDvdProcessor();
+        auto discJobs = getDiscJobManager();
         connect(dvdProgress.get(),  &QProgressDialog::canceled,
-                dvdProcessor, &vfg::DvdProcessor::handleAbortProcess);
+                discJobs,           &vfg::DiscJobManager::abort);
     }
 
     return dvdProgress.get();
@@ -571,13 +668,23 @@ void MainWindow::setupInternal()
     qCDebug(MAINWINDOW) << "Setting up internal state";
 
     // Set Avisynth as the default video source
-    videoSource = std::make_shared<vfg::core::AvisynthVideoSource>();
+    defaultVideoSource = std::make_shared<vfg::core::AvisynthVideoSource>();
+    videoSource = defaultVideoSource;
+    updateKeyframeIndexer();
+
+    // Collect per-call frame timings for tuning
+    if(config.value("recordframetimings").toBool()) {
+        qCDebug(MAINWINDOW) << "Recording frame timings";
+        frameTimings = std::make_shared<vfg::core::HistogramInstrumentation>();
+        videoSource->setInstrumentation(frameTimings);
+    }
 
     // Once the video source has loaded the video successfully
     connect(videoSource.get(),  &vfg::core::AbstractVideoSource::videoLoaded,
             this,               &MainWindow::videoLoaded);
 
     frameGrabber = std::make_shared<vfg::core::VideoFrameGrabber>(videoSource);
+    frameGrabber->setKeyframeSeeking(config.value("keyframeseeking").toBool());
 
     // When frame grabber emits an error, display it to user
     connect(frameGrabber.get(), &vfg::core::VideoFrameGrabber::errorOccurred,
@@ -590,6 +697,11 @@ void MainWindow::setupInternal()
             ui.videoPreviewWidget, static_cast<void(vfg::ui::VideoPreviewWidget::*)(int, const QImage&)>(&vfg::ui::VideoPreviewWidget::setFrame),
             Qt::QueuedConnection);
 
+    // Display low resolution frames while scrubbing
+    connect(frameGrabber.get(),     &vfg::core::VideoFrameGrabber::scrubFrameGrabbed,
+            ui.videoPreviewWidget,  &vfg::ui::VideoPreviewWidget::setScrubFrame,
+            Qt::QueuedConnection);
+
     frameGenerator = vfg::make_unique<vfg::core::VideoFrameGenerator>(frameGrabber);
 
     // When frame generator finishes, update UI, and conditionally go to last generated frame
@@ -613,6 +725,32 @@ void MainWindow::setupInternal()
         ui.generatorProgressBar->setValue(ui.generatorProgressBar->value() + 1);
     });
 
+    // Frames rejected by the quality filter still count towards generator progress
+    connect(frameGenerator.get(),   &vfg::core::VideoFrameGenerator::frameSkipped,
+            this, [this](const int frameNum) {
+        Q_UNUSED(frameNum);
+        ui.generatorProgressBar->setValue(ui.generatorProgressBar->value() + 1);
+    });
+
+    filmstripBuilder = vfg::make_unique<vfg::core::FilmstripBuilder>(frameGrabber);
+
+    // Show filmstrip tiles as they are decoded
+    connect(filmstripBuilder.get(), &vfg::core::FilmstripBuilder::tilesReady,
+            ui.filmstrip,           &vfg::ui::FilmstripWidget::setTiles,
+            Qt::QueuedConnection);
+
+    // Hovering the seek slider shows the nearest tile
+    connect(ui.seekSlider,  &vfg::ui::AvailabilitySlider::hovered,
+            ui.filmstrip,   &vfg::ui::FilmstripWidget::showTile);
+    connect(ui.seekSlider,  &vfg::ui::AvailabilitySlider::hoverLeft,
+            ui.filmstrip,   &vfg::ui::FilmstripWidget::hideTile);
+
+    // Jump to a frame clicked in the filmstrip
+    connect(ui.filmstrip,   &vfg::ui::FilmstripWidget::frameClicked,
+            [this](const int frameNumber) {
+        updateSeekSlider(frameNumber, SeekSlider::UpdateAll);
+    });
+
     qCDebug(MAINWINDOW) << "Creating frame grabber thread";
     frameGrabberThread = vfg::make_unique<QThread>();
 
@@ -626,10 +764,102 @@ void MainWindow::setupInternal()
     qCDebug(MAINWINDOW) << "Starting frame generator thread";
     frameGenerator->moveToThread(frameGeneratorThread.get());
     frameGeneratorThread->start();
+
+    qCDebug(MAINWINDOW) << "Creating filmstrip thread";
+    filmstripThread = vfg::make_unique<QThread>();
+
+    qCDebug(MAINWINDOW) << "Starting filmstrip thread";
+    filmstripBuilder->moveToThread(filmstripThread.get());
+    filmstripThread->start();
+}
+
+void MainWindow::setVideoSource(std::shared_ptr<vfg::core::AbstractVideoSource> newSource)
+{
+    if(newSource == videoSource) {
+        return;
+    }
+
+    // Frame grabber disconnects the previous source
+    frameGrabber->setVideoSource(newSource);
+    videoSource = std::move(newSource);
+
+    if(frameTimings) {
+        videoSource->setInstrumentation(frameTimings);
+    }
+
+    connect(videoSource.get(),  &vfg::core::AbstractVideoSource::videoLoaded,
+            this,               &MainWindow::videoLoaded);
+}
+
+void MainWindow::loadPartialDownload(std::shared_ptr<vfg::net::HttpDownload> download)
+{
+    const QFileInfo info(download->path());
+    if(info.suffix().toLower() != "y4m") {
+        QMessageBox::information(this, tr("Unsupported format"),
+                                 tr("Only YUV4MPEG2 (*.y4m) videos can be opened before "
+                                    "the download has finished."));
+        return;
+    }
+
+    resetUi();
+
+    qCDebug(MAINWINDOW) << "Opening partial download" << info.absoluteFilePath();
+    config.setValue("last_opened", info.absoluteFilePath());
+
+    auto decoder = std::make_shared<vfg::core::Y4mVideoSource>();
+    if(frameTimings) {
+        decoder->setInstrumentation(frameTimings);
+    }
+
+    progressiveSource = std::make_shared<vfg::core::ProgressiveVideoSource>(decoder, std::move(download));
+
+    // Show downloaded frames on the seek slider
+    connect(progressiveSource.get(), &vfg::core::ProgressiveVideoSource::availabilityChanged,
+            this, [this]() {
+        if(progressiveSource && progressiveSource->hasVideo()) {
+            ui.seekSlider->setAvailableRanges(progressiveSource->availableFrames());
+        }
+    });
+
+    // Display the current frame once it arrives
+    connect(progressiveSource.get(), &vfg::core::ProgressiveVideoSource::frameAvailable,
+            this, [this](const int frameNum) {
+        if(frameNum == ui.seekSlider->value()) {
+            frameGrabber->refreshFrame(frameNum);
+        }
+    });
+
+    setVideoSource(progressiveSource);
+
+    try
+    {
+        progressiveSource->load(info.absoluteFilePath());
+        ui.seekSlider->setAvailableRanges(progressiveSource->availableFrames());
+    }
+    catch(const vfg::core::VideoSourceError& ex)
+    {
+        qCCritical(MAINWINDOW) << "Partial download error:" << ex.what();
+        QMessageBox::warning(this, tr("Error while loading file"), QString(ex.what()));
+    }
+}
+
+void MainWindow::updateKeyframeIndexer()
+{
+    // Indexing with ffmsindex only pays off if keyframes are used
+    const bool seeking = config.value("keyframeseeking").toBool();
+    defaultVideoSource->setKeyframeIndexer(seeking ? config.value("ffmsindexpath").toString()
+                                                   : QString());
 }
 
 void MainWindow::loadFile(const QString& path)
 {
+    // Regular files are always loaded with the default source
+    if(progressiveSource) {
+        progressiveSource.reset();
+        ui.seekSlider->clearAvailableRanges();
+        setVideoSource(defaultVideoSource);
+    }
+
     try
     {      
         if(frameGenerator->isRunning()) {
@@ -651,6 +881,7 @@ void MainWindow::loadFile(const QString& path)
         videoSettings.insert("crop", config.value("video/crop", QRect{}));
         videoSettings.insert("deinterlace", config.value("video/deinterlace", false));
         videoSettings.insert("ivtc", config.value("video/ivtc", false));
+        videoSettings.insert("resizekernel", config.value("video/resizekernel", "Spline36"));
         videoSettings.insert("avisynthpluginspath", config.value("avisynthpluginspath"));
 
         // When loading video for the first time we must
@@ -832,6 +1063,11 @@ void MainWindow::videoLoaded()
 {
     qCDebug(MAINWINDOW) << "Video loaded";
 
+    // Stored frames belong to the previous video or script
+    if(spillStore) {
+        spillStore->clear();
+    }
+
     setWindowTitle(config.value("last_opened").toString());
     appendRecentMenu(config.value("last_opened").toString());
 
@@ -870,6 +1106,19 @@ void MainWindow::videoLoaded()
     frameGrabber->requestFrame(std::min(frameGrabber->lastFrame(),
                                         videoSource->getNumFrames() - 1));
 
+    // Decode the filmstrip, or load it from the cache if the file has been opened before.
+    // Downloads that are still running would make the builder wait for missing frames
+    const int filmstripGeneration = filmstripBuilder->cancel();
+    ui.filmstrip->clear();
+    const int filmstripTiles = config.value("filmstriptiles").toInt();
+    if(filmstripTiles > 0 && !progressiveSource) {
+        filmstripBuilder->setCacheDirectory(config.value("cachedirectory", "cache").toString());
+        QMetaObject::invokeMethod(filmstripBuilder.get(), "build", Qt::QueuedConnection,
+                                  Q_ARG(QString, vfg::core::Filmstrip::cacheKey(videoSource->fileName())),
+                                  Q_ARG(int, filmstripTiles),
+                                  Q_ARG(int, filmstripGeneration));
+    }
+
     if(config.value("showscripteditor").toBool()) {
         auto scriptEditor = getScriptEditor();
         scriptEditor->show();
@@ -885,16 +1134,30 @@ void MainWindow::on_nextButton_clicked()
 {
     qCDebug(MAINWINDOW) << "Clicked next button";
 
-    frameGrabber->requestNextFrame();
-    updateSeekSlider(frameGrabber->lastFrame(), SeekSlider::UpdateText);
+    // Step from the latest requested frame, which is already on the
+    // seek slider, and decode it without blocking the GUI thread
+    const int frameNum = ui.seekSlider->value() + 1;
+    if(frameNum > ui.seekSlider->maximum()) {
+        QMessageBox::warning(this, tr("Video error"), tr("Reached last frame"));
+        return;
+    }
+
+    frameGrabber->requestLatestFrame(frameNum);
+    updateSeekSlider(frameNum, SeekSlider::UpdateText);
 }
 
 void MainWindow::on_previousButton_clicked()
 {
     qCDebug(MAINWINDOW) << "Clicked previous button";
 
-    frameGrabber->requestPreviousFrame();
-    updateSeekSlider(frameGrabber->lastFrame(), SeekSlider::UpdateText);
+    const int frameNum = ui.seekSlider->value() - 1;
+    if(frameNum < ui.seekSlider->minimum()) {
+        QMessageBox::warning(this, tr("Video error"), tr("Reached first frame"));
+        return;
+    }
+
+    frameGrabber->requestLatestFrame(frameNum);
+    updateSeekSlider(frameNum, SeekSlider::UpdateText);
 }
 
 void MainWindow::on_seekSlider_sliderReleased()
@@ -909,13 +1172,19 @@ void MainWindow::on_seekSlider_sliderReleased()
         mediaPlayer->setPosition(convertFrameToMs(frameNumber));
     }
     else {
-        frameGrabber->requestFrame(frameNumber);
+        frameGrabber->seekToFrame(frameNumber);
     }
 }
 
 void MainWindow::on_seekSlider_sliderMoved(const int position)
 {
     ui.currentFrameLabel->setText(QString::number(position));
+
+    // Positions passed while a frame is decoded are dropped
+    if(config.value("livescrubbing").toBool()
+            && getMediaPlayer()->state() != QMediaPlayer::PlayingState) {
+        frameGrabber->scrubToFrame(position);
+    }
 }
 
 void MainWindow::on_generateButton_clicked()
@@ -932,6 +1201,11 @@ void MainWindow::on_generateButton_clicked()
         frameGenerator->stop();
     }
 
+    // Previewed video settings are applied to the script before generating
+    if(videoSettingsWindow && videoSettingsWindow->hasPendingPreview()) {
+        videoSettingsWindow->apply();
+    }
+
     const bool pauseAfterLimit = config.value("pauseafterlimit").toBool();
     if(pauseAfterLimit && ui.unsavedWidget->isFull()) {
         // Can't start the generator if the unsaved widget container is full
@@ -958,6 +1232,36 @@ void MainWindow::on_generateButton_clicked()
 
     frameGenerator->enqueue(queue);
 
+    if(config.value("qualityfilter").toBool()) {
+        vfg::core::FrameQualityFilter::Settings settings;
+        settings.minSharpness = config.value("qualityminsharpness").toDouble();
+        settings.minLuma = config.value("qualityminluma").toDouble();
+        settings.maxLuma = config.value("qualitymaxluma").toDouble();
+        settings.searchWindow = config.value("qualitysearchwindow").toInt();
+        frameGenerator->setQualityFilter(std::make_shared<vfg::core::FrameQualityFilter>(settings));
+    }
+    else {
+        frameGenerator->setQualityFilter(nullptr);
+    }
+
+    if(config.value("spillstore").toBool()) {
+        // Compression can only change while the store is empty
+        if(!spillStore || spillStore->count() == 0) {
+            const QDir cacheDir(config.value("cachedirectory", "cache").toString());
+            const QString spillPath = cacheDir.absoluteFilePath(
+                        QString("framespill-%1.bin").arg(QCoreApplication::applicationPid()));
+            const auto compression = config.value("spillcompression").toBool()
+                    ? vfg::core::FrameSpillStore::Compression::Fast
+                    : vfg::core::FrameSpillStore::Compression::None;
+            spillStore = std::make_shared<vfg::core::FrameSpillStore>(spillPath, compression);
+        }
+
+        frameGenerator->setSpillStore(spillStore);
+    }
+    else {
+        frameGenerator->setSpillStore(nullptr);
+    }
+
     // Update generator widgets
     ui.generateButton->setEnabled(false);
     ui.btnPauseGenerator->setEnabled(true);
@@ -975,9 +1279,17 @@ void MainWindow::on_grabButton_clicked()
 {
     qCDebug(MAINWINDOW) << "Clicked grab button";
 
+    if(videoSettingsWindow && videoSettingsWindow->hasPendingPreview()) {
+        videoSettingsWindow->apply();
+    }
+
     const int selectedFrame = ui.seekSlider->value();
-    ui.savedWidget->addThumbnail(vfg::make_unique<vfg::ui::VideoFrameThumbnail>(selectedFrame,
-                                                                                 frameGrabber->getFrame(selectedFrame)));
+    const QImage frame = getFullFrame(selectedFrame);
+    if(spillStore && config.value("spillstore").toBool() && !spillStore->contains(selectedFrame)) {
+        spillStore->append(selectedFrame, frame);
+    }
+
+    ui.savedWidget->addThumbnail(vfg::make_unique<vfg::ui::VideoFrameThumbnail>(selectedFrame, frame));
     statusBar()->showMessage(tr("Grabbed frame #%1").arg(selectedFrame), 3000);
 }
 
@@ -1046,7 +1358,7 @@ void MainWindow::on_saveThumbnailsButton_clicked()
         const auto frameNumber = widget.frameNum();
         const auto filename = QString("%1.png").arg(QString::number(frameNumber));
         const auto savePath = saveDir.absoluteFilePath(filename);
-        const auto frame = frameGrabber->getFrame(frameNumber);
+        const auto frame = getFullFrame(frameNumber);
         frame.save(savePath, "PNG");
     }
 
@@ -1109,9 +1421,11 @@ void MainWindow::on_actionOptions_triggered()
     const auto saved = configDialog.exec();
     if(saved) {
         ui.unsavedWidget->setMaxThumbnails(config.value("maxthumbnails").toInt());
+        frameGrabber->setKeyframeSeeking(config.value("keyframeseeking").toBool());
+        updateKeyframeIndexer();
 
-        auto dvdProcessor = getDvdProcessor();
-        dvdProcessor->setProcessor(config.value("dgindexexecpath").toString());
+        auto discJobs = getDiscJobManager();
+        discJobs->setProcessor(config.value("dgindexexecpath").toString());
     }
 }
 
@@ -1260,7 +1574,7 @@ void MainWindow::on_actionSave_as_PNG_triggered()
     const auto outFilename = QFileDialog::getSaveFileName(this, tr("Save as..."),
                                                           defaultSavePath, tr("PNG (*.png)"));
     config.setValue("last_save_dir", QFileInfo{outFilename}.absoluteDir().absolutePath());
-    const auto frame = frameGrabber->getFrame(selected);
+    const auto frame = getFullFrame(selected);
     frame.save(outFilename);
 }
 
@@ -1372,20 +1686,15 @@ void MainWindow::processDiscFiles(const QStringList& files)
 
         // Get path without suffix
         const QFileInfo outInfo(out);
-        QString outputPath = outInfo.absoluteDir().absoluteFilePath(
+        const QString outputPath = outInfo.absoluteDir().absoluteFilePath(
                                     outInfo.completeBaseName());
-        auto dvdProcessor = getDvdProcessor();
-        dvdProcessor->setOutputPath(std::move(outputPath));
+        auto discJobs = getDiscJobManager();
+        discJobs->setSavePath(outputPath);
     }
     else {
-        // Remove existing output file to prevent DGIndex from creating
-        // lots of different .d2v files
-        if(QFile::exists("dgindex_tmp.d2v")) {
-            QFile::remove("dgindex_tmp.d2v");
-        }
-
-        auto dvdProcessor = getDvdProcessor();
-        dvdProcessor->setOutputPath("dgindex_tmp");
+        // Indexed files are only kept in the cache
+        auto discJobs = getDiscJobManager();
+        discJobs->setSavePath({});
     }
 
     // Reset all states back to zero
@@ -1398,17 +1707,41 @@ void MainWindow::processDiscFiles(const QStringList& files)
     if(openedVobFile.suffix() == "m2ts") {
         dvdProgress->setLabelText(tr("Processing Blu-ray..."));
     }
+    else {
+        dvdProgress->setLabelText(tr("Processing DVD..."));
+    }
 
-    auto dvdProcessor = getDvdProcessor();
-    dvdProcessor->process(files);
+    auto discJobs = getDiscJobManager();
+    discJobs->process(files);
+}
+
+QImage MainWindow::getFullFrame(const int frameNumber)
+{
+    if(spillStore) {
+        QImage frame = spillStore->frame(frameNumber);
+        if(!frame.isNull()) {
+            return frame;
+        }
+    }
+
+    return frameGrabber->getFrame(frameNumber);
 }
 
 void MainWindow::on_saveGridButton_clicked()
 {
-    vfg::ui::SaveGridDialog dialog;
+    const QSize frameSize = frameGrabber->resolution();
+    if(frameSize.isEmpty()) {
+        return;
+    }
+
+    // Frames are only decoded when the grid is saved, and come from
+    // the spill store if they were saved from the generator
+    vfg::ui::SaveGridDialog dialog([this](const int frameNum) {
+        return getFullFrame(frameNum);
+    }, frameSize);
 
     for(const auto &widget : ui.savedWidget) {
-        dialog.addPixmap(QPixmap::fromImage(frameGrabber->getFrame(widget.frameNum())));
+        dialog.addFrame(widget.frameNum(), widget.thumbnail());
     }
 
     dialog.exec();
@@ -25,15 +25,23 @@ class QThread;
 class QUrl;
 
 namespace vfg {
-    class DvdProcessor;
+    class DiscJobManager;
 namespace core {
     class AbstractVideoSource;
+    class AvisynthVideoSource;
+    class FilmstripBuilder;
+    class FrameSpillStore;
+    class HistogramInstrumentation;
+    class ProgressiveVideoSource;
     class VideoFrameGenerator;
     class VideoFrameGrabber;
 }
 namespace extractor {
     class BaseExtractor;
 }
+namespace net {
+    class HttpDownload;
+}
 namespace ui {
     class DownloadsDialog;
     class GifMakerWidget;
@@ -131,15 +139,32 @@ private:
 
     std::unique_ptr<QThread> frameGrabberThread;
     std::unique_ptr<QThread> frameGeneratorThread;
+    std::unique_ptr<QThread> filmstripThread;
 
     //! Display DVD loading progress in a dialog
     std::unique_ptr<QProgressDialog> dvdProgress;
 
     std::shared_ptr<vfg::core::AbstractVideoSource> videoSource;
+
+    //! Avisynth source used for regular files
+    std::shared_ptr<vfg::core::AvisynthVideoSource> defaultVideoSource;
+
+    //! Source of a download that is still running, only set while it's open
+    std::shared_ptr<vfg::core::ProgressiveVideoSource> progressiveSource;
     std::shared_ptr<vfg::core::VideoFrameGrabber> frameGrabber;
     std::unique_ptr<vfg::core::VideoFrameGenerator> frameGenerator;
 
-    std::unique_ptr<vfg::DvdProcessor> dvdProcessor;
+    //! Decodes the filmstrip above the seek slider
+    std::unique_ptr<vfg::core::FilmstripBuilder> filmstripBuilder;
+
+    //! Frame timing histograms, only set if enabled in config
+    std::shared_ptr<vfg::core::HistogramInstrumentation> frameTimings;
+
+    //! Generated and grabbed frames, only set if enabled in config
+    std::shared_ptr<vfg::core::FrameSpillStore> spillStore;
+
+    //! Indexes the titles of DVDs and Blu-rays
+    std::unique_ptr<vfg::DiscJobManager> discJobs;
 
     //! Current context menu for preview widget
     vfg::observer_ptr<QMenu> previewContext;
@@ -169,12 +194,33 @@ private:
      */
     void setupInternal();
 
+    /**
+     * @brief Pass ffmsindex to the default source if keyframe seeking is enabled
+     */
+    void updateKeyframeIndexer();
+
     /**
      * @brief Load the given file with the current video source
      * @param path Path to the file to load
      */
     void loadFile(const QString& path);
 
+    /**
+     * @brief Open a download that has not finished yet
+     *
+     * Frames are read as they are downloaded, see
+     * \link vfg::core::ProgressiveVideoSource \endlink
+     *
+     * @param download Running download
+     */
+    void loadPartialDownload(std::shared_ptr<vfg::net::HttpDownload> download);
+
+    /**
+     * @brief Replace the video source frames are grabbed from
+     * @param newSource New video source
+     */
+    void setVideoSource(std::shared_ptr<vfg::core::AbstractVideoSource> newSource);
+
     void activateGifMaker();
 
     /**
@@ -189,6 +235,17 @@ private:
      */
     void resumeFrameGenerator();
 
+    /**
+     * @brief Get full size frame for saving
+     *
+     * Returns the frame from the spill store if it's stored there,
+     * otherwise requests it from the frame grabber
+     *
+     * @param frameNumber Frame to get
+     * @return Frame (may be null)
+     */
+    QImage getFullFrame(int frameNumber);
+
     /**
      * @brief Append new item to recent menu items
      * @param item Item to append
@@ -240,7 +297,7 @@ private:
 
     QMediaPlayer *getMediaPlayer();
 
-    vfg::DvdProcessor *getDvdProcessor();
+    vfg::DiscJobManager *getDiscJobManager();
 
     QProgressDialog *getDvdProgress();
 
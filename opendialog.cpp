@@ -1,9 +1,13 @@
+#include <algorithm>
 #include <memory>
 #include <QComboBox>
+#include <QDir>
+#include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QList>
 #include <QNetworkRequest>
+#include <QProgressBar>
 #include <QSettings>
 #include <QString>
 #include <QStringList>
@@ -17,9 +21,33 @@ namespace vfg {
 namespace ui {
 
 OpenDialog::OpenDialog(QWidget *parent) :
-    QDialog(parent)
+    QDialog(parent),
+    factory(QDir(config.value("cachedirectory").toString()).absoluteFilePath("extractors")),
+    resolver(factory)
 {
     ui.setupUi(this);
+
+    // Extract once the user pauses typing instead of on every keystroke
+    extractTimer.setSingleShot(true);
+    extractTimer.setInterval(500);
+    connect(&extractTimer,  &QTimer::timeout,
+            this,           &OpenDialog::extractNetworkUrl);
+
+    connect(&resolver,      &vfg::extractor::BatchResolver::requestReady,
+            this,           &OpenDialog::enqueueUrl);
+    connect(&resolver,      &vfg::extractor::BatchResolver::logReady,
+            ui.batchLog,    &QPlainTextEdit::appendPlainText);
+    connect(&resolver,      &vfg::extractor::BatchResolver::urlFailed,
+            [this](const QUrl& url, const QString& error) {
+        ui.batchLog->appendPlainText(tr("%1: %2").arg(url.toString()).arg(error));
+    });
+    connect(&resolver,      &vfg::extractor::BatchResolver::progress,
+            [this](const int finished, const int count) {
+        ui.batchProgress->setMaximum(count);
+        ui.batchProgress->setValue(finished);
+    });
+    connect(&resolver,      &vfg::extractor::BatchResolver::finished,
+            this,           &OpenDialog::batchFinished);
 }
 
 void OpenDialog::setActiveTab(const OpenDialog::Tab tabName)
@@ -30,21 +58,37 @@ void OpenDialog::setActiveTab(const OpenDialog::Tab tabName)
     else if(tabName == Tab::OpenStream) {
         ui.tabWidget->setCurrentIndex(1);
     }
+    else if(tabName == Tab::OpenBatch) {
+        ui.tabWidget->setCurrentIndex(2);
+    }
 }
 
 void OpenDialog::on_networkUrl_textEdited(const QString &arg1)
+{
+    Q_UNUSED(arg1);
+
+    // Streams of a partially typed URL are stale
+    ui.streamsComboBox->clear();
+    ui.openButton->setEnabled(false);
+    extractTimer.start();
+}
+
+void OpenDialog::extractNetworkUrl()
 {
     // TODO: Display loading GIF
-    static const vfg::extractor::ExtractorFactory factory;
+    const QUrl url(ui.networkUrl->text().trimmed());
+    if(!url.isValid() || url.host().isEmpty()) {
+        return;
+    }
 
-    extractor = factory.getExtractor(arg1);
+    extractor = factory.getExtractor(url);
     connect(extractor.get(),    &vfg::extractor::BaseExtractor::streamsReady,
             this,               &OpenDialog::streamsReady);
     connect(extractor.get(),    &vfg::extractor::BaseExtractor::requestReady,
             this,               &OpenDialog::openUrl);
     connect(extractor.get(),    &vfg::extractor::BaseExtractor::logReady,
             ui.log,             &QPlainTextEdit::appendPlainText);
-    extractor->fetchStreams(arg1);
+    extractor->fetchStreams(url);
 
     ui.streamsComboBox->clear();
     ui.log->clear();
@@ -68,7 +112,7 @@ void OpenDialog::on_openButton_clicked()
 
         emit processDiscFiles(files);
     }
-    else if(ui.tabWidget->currentIndex() == 1) {
+    else if(ui.tabWidget->currentIndex() == 1 && extractor) {
         // Open the selected stream
         extractor->download(ui.streamsComboBox->currentText());
     }
@@ -112,5 +156,54 @@ void OpenDialog::on_removeButton_clicked()
                     ui.fileList->currentIndex().row())};
 }
 
+void OpenDialog::on_loadUrlsButton_clicked()
+{
+    const QString path = QFileDialog::getOpenFileName(this, tr("Select URL list"),
+                                                      config.value("last_opened_urls", "").toString(),
+                                                      "Text files (*.txt);;All files (*)");
+    if(path.isEmpty()) {
+        return;
+    }
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        ui.batchLog->appendPlainText(tr("Unable to open %1: %2").arg(path).arg(file.errorString()));
+        return;
+    }
+
+    ui.batchUrls->appendPlainText(QString::fromUtf8(file.readAll()));
+    config.setValue("last_opened_urls", QFileInfo(path).absolutePath());
+}
+
+void OpenDialog::on_batchButton_clicked()
+{
+    const QList<QUrl> urls = vfg::extractor::BatchResolver::parseUrls(ui.batchUrls->toPlainText());
+    if(urls.isEmpty()) {
+        ui.batchLog->appendPlainText(tr("No valid URLs found"));
+        return;
+    }
+
+    // Order matches the items of the quality combo box
+    static const int maxHeights[] = {0, 0, 1080, 720, 480};
+    const int index = std::max(0, ui.batchQuality->currentIndex());
+    vfg::extractor::BatchResolver::Policy policy;
+    policy.quality = index == 1 ? vfg::extractor::BatchResolver::Quality::Lowest
+                                : vfg::extractor::BatchResolver::Quality::Highest;
+    policy.maxHeight = maxHeights[index];
+
+    ui.batchLog->clear();
+    ui.batchButton->setEnabled(false);
+    ui.batchUrls->clear();
+
+    resolver.setPolicy(policy);
+    resolver.resolve(urls);
+}
+
+void OpenDialog::batchFinished()
+{
+    ui.batchButton->setEnabled(true);
+    ui.batchLog->appendPlainText(tr("Batch finished"));
+}
+
 } // namespace ui
 } // namespace vfg
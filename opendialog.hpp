@@ -4,6 +4,9 @@
 #include <memory>
 #include <QDialog>
 #include <QSettings>
+#include <QTimer>
+#include "batchresolver.hpp"
+#include "extractorfactory.hpp"
 #include "extractors/baseextractor.hpp"
 #include "ui_opendialog.h"
 
@@ -28,7 +31,8 @@ public:
 
     enum class Tab {
         OpenDisc,
-        OpenStream
+        OpenStream,
+        OpenBatch
     };
 
     void setActiveTab(Tab tabName);
@@ -40,9 +44,20 @@ private:
 
     QSettings config {"config.ini", QSettings::IniFormat};
 
+    //! Creates extractors, shared by the network and batch tabs
+    vfg::extractor::ExtractorFactory factory;
+
+    //! Resolves the URLs of the batch tab
+    vfg::extractor::BatchResolver resolver;
+
+    //! Delays extraction until the user stops typing the URL
+    QTimer extractTimer;
+
 private slots:
     void on_networkUrl_textEdited(const QString &arg1);
 
+    void extractNetworkUrl();
+
     void streamsReady();
 
     void on_openButton_clicked();
@@ -55,9 +70,17 @@ private slots:
 
     void on_removeButton_clicked();
 
+    void on_loadUrlsButton_clicked();
+
+    void on_batchButton_clicked();
+
+    void batchFinished();
+
 signals:
     void openUrl(const QNetworkRequest& url);
 
+    void enqueueUrl(const QNetworkRequest& url);
+
     void processDiscFiles(const QStringList& files);
 };
 
@@ -6,32 +6,31 @@
 class QModelIndex;
 class QObject;
 class QPainter;
-class QSize;
 class QStyleOptionViewItem;
 
 namespace vfg {
 namespace ui {
 
+/**
+ * @brief The ProgressBarDelegate class
+ *
+ * Draws the progress column of the downloads model as a progress bar
+ * while the download is running. Reads only the typed roles of
+ * \link vfg::core::DownloadsListModel \endlink.
+ */
 class ProgressBarDelegate : public QStyledItemDelegate
 {
     Q_OBJECT
 
-private:
-    //! Height of the delegate in pixels
-    int height {70};
-
 public:
     /**
      * @brief Constructor
-     * @param height Height of the widget that's drawn
      * @param parent Owner of the widget
      */
     explicit ProgressBarDelegate(QObject *parent = 0);
 
     void paint(QPainter *painter, const QStyleOptionViewItem &option,
-                      const QModelIndex &index) const override;
-
-    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+               const QModelIndex &index) const override;
 };
 
 } // namespace ui
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include <QSize>
+#include <QThread>
+#include "httpdownload.hpp"
+#include "progressivevideosource.h"
+#include "scriptparser.h"
+
+Q_LOGGING_CATEGORY(PROGRESSIVESOURCE, "progressivevideosource")
+
+namespace {
+
+//! Bytes from the start of the file needed to read the stream header
+constexpr qint64 HeaderSize = 4096;
+
+//! Interval between availability updates in milliseconds
+constexpr int UpdateInterval = 250;
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+ProgressiveVideoSource::ProgressiveVideoSource(std::shared_ptr<vfg::core::AbstractVideoSource> decoder,
+                                               std::shared_ptr<vfg::net::HttpDownload> fileDownload) :
+    AbstractVideoSource(),
+    source(std::move(decoder)),
+    download(std::move(fileDownload))
+{
+    setInstrumentation(source->instrumentation());
+
+    connect(source.get(),   &vfg::core::AbstractVideoSource::videoLoaded,
+            this,           &vfg::core::AbstractVideoSource::videoLoaded);
+
+    updateTimer.setSingleShot(true);
+    updateTimer.setInterval(UpdateInterval);
+
+    connect(&updateTimer,   &QTimer::timeout,
+            this,           &ProgressiveVideoSource::updateAvailability);
+
+    connect(download.get(), &vfg::net::HttpDownload::updated,
+            this,           &ProgressiveVideoSource::scheduleUpdate);
+
+    // Frame requests may come from other threads
+    connect(this,           &ProgressiveVideoSource::rangeRequested,
+            download.get(), &vfg::net::HttpDownload::prioritizeRange,
+            Qt::QueuedConnection);
+
+    updateAvailability();
+}
+
+void ProgressiveVideoSource::setWaitTimeout(const unsigned long msecs)
+{
+    waitTimeout = msecs;
+}
+
+void ProgressiveVideoSource::scheduleUpdate()
+{
+    if(download->isFinished()) {
+        updateTimer.stop();
+        updateAvailability();
+        return;
+    }
+
+    if(!updateTimer.isActive()) {
+        updateTimer.start();
+    }
+}
+
+void ProgressiveVideoSource::updateAvailability()
+{
+    // Merge adjacent ranges so that frames crossing segment boundaries are found
+    QVector<QPair<qint64, qint64>> merged;
+    for(const auto& range : download->availableRanges()) {
+        if(!merged.isEmpty() && range.first <= merged.last().second + 1) {
+            merged.last().second = std::max(merged.last().second, range.second);
+        }
+        else {
+            merged.append(range);
+        }
+    }
+
+    QMutexLocker lock(&mutex);
+    ranges = std::move(merged);
+    complete = download->getStatus() == vfg::net::HttpDownload::Status::Finished;
+    stopped = download->isFinished();
+
+    int availableFrame = -1;
+    if(missedFrame >= 0 && isRangeAvailable(source->frameByteRange(missedFrame))) {
+        availableFrame = missedFrame;
+        missedFrame = -1;
+    }
+
+    dataArrived.wakeAll();
+    lock.unlock();
+
+    emit availabilityChanged();
+
+    if(availableFrame >= 0) {
+        emit frameAvailable(availableFrame);
+    }
+}
+
+bool ProgressiveVideoSource::isRangeAvailable(const std::pair<qint64, qint64>& range) const
+{
+    if(range.first < 0) {
+        return false;
+    }
+
+    const auto it = std::upper_bound(ranges.cbegin(), ranges.cend(), range.first,
+                                     [](const qint64 pos, const QPair<qint64, qint64>& available) {
+        return pos < available.first;
+    });
+
+    return it != ranges.cbegin() && range.second <= std::prev(it)->second;
+}
+
+void ProgressiveVideoSource::load(const QString& fileName)
+{
+    if(!download->isPreallocated()) {
+        throw VideoSourceError("The server does not support partial downloads, "
+                               "so the file can't be opened before it has finished");
+    }
+
+    const qint64 headerEnd = std::min(HeaderSize, download->bytesTotal()) - 1;
+    {
+        QMutexLocker lock(&mutex);
+        if(!isRangeAvailable({0, headerEnd})) {
+            emit rangeRequested(0, headerEnd);
+            throw VideoSourceError("The beginning of the file has not been downloaded yet. "
+                                   "Try again in a moment.");
+        }
+    }
+
+    qCDebug(PROGRESSIVESOURCE) << "Loading" << fileName << "while downloading";
+
+    source->load(fileName);
+}
+
+bool ProgressiveVideoSource::hasVideo() const
+{
+    return source->hasVideo();
+}
+
+int ProgressiveVideoSource::getNumFrames() const
+{
+    return source->getNumFrames();
+}
+
+QImage ProgressiveVideoSource::getFrame(const int frameNumber)
+{
+    const auto range = source->frameByteRange(frameNumber);
+
+    QMutexLocker lock(&mutex);
+    if(!complete && !isRangeAvailable(range)) {
+        if(range.first >= 0) {
+            // Fail fast, frameAvailable tells when to request it again
+            emit rangeRequested(range.first, range.second);
+            missedFrame = frameNumber;
+        }
+
+        return {};
+    }
+    lock.unlock();
+
+    return source->getFrame(frameNumber);
+}
+
+bool ProgressiveVideoSource::waitForFrame(const int frameNumber)
+{
+    const auto range = source->frameByteRange(frameNumber);
+
+    QMutexLocker lock(&mutex);
+    if(complete || isRangeAvailable(range)) {
+        return true;
+    }
+    else if(range.first < 0) {
+        return false;
+    }
+
+    emit rangeRequested(range.first, range.second);
+
+    // Waiting in the download's thread would stop the download
+    if(QThread::currentThread() == thread()) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    while(!stopped && !isRangeAvailable(range)) {
+        const qint64 remaining = static_cast<qint64>(waitTimeout) - timer.elapsed();
+        if(remaining <= 0 || !dataArrived.wait(&mutex, static_cast<unsigned long>(remaining))) {
+            break;
+        }
+    }
+
+    if(!isRangeAvailable(range)) {
+        qCWarning(PROGRESSIVESOURCE) << "Frame" << frameNumber << "was not downloaded in time";
+
+        return false;
+    }
+
+    return true;
+}
+
+QString ProgressiveVideoSource::getSupportedFormats()
+{
+    return source->getSupportedFormats();
+}
+
+bool ProgressiveVideoSource::isValidFrame(const int frameNum) const
+{
+    return source->isValidFrame(frameNum);
+}
+
+vfg::ScriptParser ProgressiveVideoSource::getParser(const QFileInfo& info) const
+{
+    return source->getParser(info);
+}
+
+QSize ProgressiveVideoSource::resolution() const
+{
+    return source->resolution();
+}
+
+QString ProgressiveVideoSource::fileName() const
+{
+    return source->fileName();
+}
+
+std::pair<qint64, qint64> ProgressiveVideoSource::frameByteRange(const int frameNumber) const
+{
+    return source->frameByteRange(frameNumber);
+}
+
+QVector<int> ProgressiveVideoSource::keyframes() const
+{
+    return source->keyframes();
+}
+
+bool ProgressiveVideoSource::isFrameAvailable(const int frameNumber) const
+{
+    const auto range = source->frameByteRange(frameNumber);
+
+    QMutexLocker lock(&mutex);
+    return complete ? isValidFrame(frameNumber) : isRangeAvailable(range);
+}
+
+QVector<QPair<int, int>> ProgressiveVideoSource::availableFrames() const
+{
+    const int numFrames = source->getNumFrames();
+
+    QMutexLocker lock(&mutex);
+    if(complete) {
+        return {qMakePair(0, numFrames - 1)};
+    }
+
+    // Frame byte ranges increase with the frame number, so binary search
+    // for the frames that lie completely inside each downloaded range
+    QVector<QPair<int, int>> frames;
+    for(const auto& range : ranges) {
+        int low = 0;
+        int high = numFrames;
+        while(low < high) {
+            const int mid = low + (high - low) / 2;
+            if(source->frameByteRange(mid).first < range.first) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        const int first = low;
+
+        high = numFrames;
+        while(low < high) {
+            const int mid = low + (high - low) / 2;
+            if(source->frameByteRange(mid).second <= range.second) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        const int last = low - 1;
+
+        if(first <= last) {
+            frames.append(qMakePair(first, last));
+        }
+    }
+
+    return frames;
+}
+
+} // namespace core
+} // namespace vfg
@@ -0,0 +1,189 @@
+#ifndef VFG_PROGRESSIVEVIDEOSOURCE_H
+#define VFG_PROGRESSIVEVIDEOSOURCE_H
+
+#include <memory>
+#include <utility>
+#include <QMutex>
+#include <QPair>
+#include <QTimer>
+#include <QVector>
+#include <QWaitCondition>
+#include "abstractvideosource.h"
+
+namespace vfg {
+namespace net {
+    class HttpDownload;
+}
+}
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The ProgressiveVideoSource class
+ *
+ * Reads frames from a file that is still being downloaded. Frame requests
+ * are forwarded to a source that reports frame byte ranges, such as
+ * \link Y4mVideoSource \endlink, once the frame's bytes are on disk.
+ *
+ * Missing frames are moved to the front of the download. Frame requests
+ * never wait for data, they return an empty frame and
+ * \link frameAvailable \endlink is emitted when it arrives. Callers that
+ * need the frame, e.g. the frame generator, call \link waitForFrame \endlink
+ * first, which waits for the data unless called from the download's thread.
+ *
+ * Only sources that report frame byte ranges can be read while
+ * downloading, which currently means YUV4MPEG2 files.
+ *
+ * The download must be preallocated (see
+ * \link vfg::net::HttpDownload::isPreallocated \endlink) so that frames
+ * are located from the final file size.
+ */
+class ProgressiveVideoSource : public vfg::core::AbstractVideoSource
+{
+    Q_OBJECT
+
+private:
+    //! Source that decodes the frames
+    std::shared_ptr<vfg::core::AbstractVideoSource> source;
+
+    //! Download writing the file
+    std::shared_ptr<vfg::net::HttpDownload> download;
+
+    //! Coalesces download updates into one availability update
+    QTimer updateTimer {};
+
+    //! Guards ranges, complete, stopped and missedFrame
+    mutable QMutex mutex {};
+
+    //! Signaled when new data is available
+    QWaitCondition dataArrived {};
+
+    //! Byte ranges on disk, copied from the download
+    QVector<QPair<qint64, qint64>> ranges {};
+
+    //! Set when the download has finished successfully
+    bool complete {false};
+
+    //! Set when the download is no longer running
+    bool stopped {false};
+
+    //! Last frame that could not be returned, -1 if none
+    int missedFrame {-1};
+
+    //! Maximum time to wait for a frame in milliseconds
+    unsigned long waitTimeout {30000};
+
+    /**
+     * @brief Check if a byte range is on disk
+     * @pre mutex must be locked
+     * @param range First and last byte (inclusive)
+     * @return True if available, otherwise false
+     */
+    bool isRangeAvailable(const std::pair<qint64, qint64>& range) const;
+
+private slots:
+    /**
+     * @brief Schedule an availability update for a download update
+     *
+     * Updates arrive for every network chunk, so they're coalesced,
+     * except when the download stops
+     */
+    void scheduleUpdate();
+
+    /**
+     * @brief Copy available ranges from the download and wake waiting requests
+     */
+    void updateAvailability();
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * Create in the thread that owns the download
+     *
+     * @param decoder Source that decodes the downloaded file
+     * @param fileDownload Download writing the file
+     */
+    ProgressiveVideoSource(std::shared_ptr<vfg::core::AbstractVideoSource> decoder,
+                           std::shared_ptr<vfg::net::HttpDownload> fileDownload);
+    ~ProgressiveVideoSource() override = default;
+
+    /**
+     * @brief Set how long \link waitForFrame \endlink waits for a frame
+     * @param msecs Timeout in milliseconds
+     */
+    void setWaitTimeout(unsigned long msecs);
+
+    /**
+     * @brief Load file once its header has been downloaded
+     * @param fileName Path to the file being downloaded
+     * @throws vfg::core::VideoSourceError If the header isn't on disk yet
+     * @throws vfg::core::VideoSourceError If the decoding source fails to load the file
+     */
+    void load(const QString& fileName) override;
+    bool hasVideo() const override;
+    int getNumFrames() const override;
+
+    /**
+     * @brief Get frame if it has been downloaded
+     * @param frameNumber Frame to request
+     * @return The requested frame, empty QImage if it hasn't been downloaded yet
+     */
+    QImage getFrame(int frameNumber) override;
+
+    /**
+     * @brief Wait until a frame has been downloaded
+     *
+     * Returns immediately in the thread that owns the download, as
+     * waiting there would stop the download
+     *
+     * @param frameNumber Frame to wait for
+     * @return True if downloaded, false if not downloaded in time
+     */
+    bool waitForFrame(int frameNumber) override;
+    QString getSupportedFormats() override;
+    bool isValidFrame(int frameNum) const override;
+    vfg::ScriptParser getParser(const QFileInfo& info) const override;
+    QSize resolution() const override;
+    QString fileName() const override;
+    std::pair<qint64, qint64> frameByteRange(int frameNumber) const override;
+    QVector<int> keyframes() const override;
+
+    /**
+     * @brief Check if a frame has been downloaded
+     * @param frameNumber Frame to check
+     * @return True if available, otherwise false
+     */
+    bool isFrameAvailable(int frameNumber) const;
+
+    /**
+     * @brief Get frames that have been downloaded
+     * @return Sorted first and last frame (inclusive) of every available range
+     */
+    QVector<QPair<int, int>> availableFrames() const;
+
+signals:
+    /**
+     * @brief Emitted when downloaded data has changed
+     */
+    void availabilityChanged();
+
+    /**
+     * @brief Emitted when a frame that could not be returned has been downloaded
+     * @param frameNumber Available frame
+     */
+    void frameAvailable(int frameNumber);
+
+    /**
+     * @brief Emitted when a missing byte range is needed
+     * @param first First byte of the range
+     * @param last Last byte of the range (inclusive)
+     */
+    void rangeRequested(qint64 first, qint64 last);
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_PROGRESSIVEVIDEOSOURCE_H
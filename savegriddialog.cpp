@@ -1,12 +1,14 @@
+#include <utility>
 #include <QColor>
 #include <QFileDialog>
 #include <QIcon>
 #include <QImage>
 #include <QMap>
 #include <QListWidgetItem>
+#include <QMessageBox>
 #include <QPixmap>
 #include <QSpinBox>
-#include "libs/qimagegrid/qimagegrid.hpp"
+#include <QVector>
 #include "savegriddialog.hpp"
 
 namespace {
@@ -36,8 +38,11 @@ const QMap<QString, Qt::GlobalColor> colors {
 namespace vfg {
 namespace ui {
 
-SaveGridDialog::SaveGridDialog(QWidget *parent) :
-    QDialog(parent)
+SaveGridDialog::SaveGridDialog(vfg::core::GridComposer::FrameSource source,
+                               const QSize& size, QWidget *parent) :
+    QDialog(parent),
+    frameSource(std::move(source)),
+    frameSize(size)
 {
     ui.setupUi(this);
     ui.iconList->setUniformItemSizes(true);
@@ -51,43 +56,68 @@ SaveGridDialog::SaveGridDialog(QWidget *parent) :
 
     connect(ui.resizeToWidth,   static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
             ui.gridWidget,      &ImageGridWidget::setWidth);
+
+    ui.resizeToWidth->setValue(frameSize.width());
 }
 
-void SaveGridDialog::addPixmap(const QPixmap &img)
+void SaveGridDialog::addFrame(const int frameNum, const QPixmap &thumbnail)
 {
+    // The grid widget only keeps a copy of the icon, so the frame number
+    // is stored in the thumbnail, which survives the drag and drop
+    const QImage image = vfg::core::GridComposer::tagThumbnail(thumbnail.toImage(), frameNum);
+
     auto item = new QListWidgetItem;
-    item->setIcon({img});
+    item->setIcon({QPixmap::fromImage(image)});
     ui.iconList->insertItem(0, item);
-    ui.iconList->setIconSize(img.scaledToWidth(150).size());
-    ui.resizeToWidth->setValue(img.width());
+    ui.iconList->setIconSize(thumbnail.scaledToWidth(150).size());
 }
 
 void SaveGridDialog::on_pushButton_clicked()
 {
     const QString path = QFileDialog::getSaveFileName(this, tr("Save as..."), {},
                                                       "PNG Images (*.png)");
-    QImageGrid imageGrid;
-    imageGrid.setSpacing(ui.spacingSpinBox->value());
-    const QColor color(colors.value(ui.comboBox->currentText()));
-    if(color == Qt::transparent) {
-        imageGrid.setImageFormat(QImage::Format_ARGB32);
-    }
-    else {
-        imageGrid.setImageFormat(QImage::Format_RGB32);
+    if(path.isEmpty()) {
+        return;
     }
 
-    imageGrid.setSpacingColor(color);
-    imageGrid.setWidth(ui.resizeToWidth->value());
+    QVector<QVector<int>> frameRows;
+    int missing = 0;
     const auto rows = ui.gridWidget->getRowCount();
     for(auto idx = 0; idx < rows; ++idx) {
+        QVector<int> frameRow;
         const auto cols = ui.gridWidget->getColumnCount(idx);
         for(auto idx2 = 0; idx2 < cols; ++idx2) {
             const QIcon icon = ui.gridWidget->iconAt(idx, idx2);
-            imageGrid.addImage(idx, idx2, icon.pixmap(icon.availableSizes().first()).toImage());
+            const QImage thumbnail = icon.pixmap(icon.availableSizes().first()).toImage();
+            const int frameNum = vfg::core::GridComposer::taggedFrame(thumbnail);
+            if(frameNum >= 0) {
+                frameRow.append(frameNum);
+            }
+            else {
+                ++missing;
+            }
         }
+
+        frameRows.append(frameRow);
     }
 
-    imageGrid.save(path);
+    if(missing > 0) {
+        QMessageBox::critical(this, tr("Saving failed"),
+                              tr("Unable to find the frames of %1 images in the grid").arg(missing));
+        return;
+    }
+
+    vfg::core::GridComposer composer(frameSource, frameSize);
+    composer.setRows(frameRows);
+    composer.setSpacing(ui.spacingSpinBox->value());
+    composer.setSpacingColor(colors.value(ui.comboBox->currentText()));
+    composer.setWidth(ui.resizeToWidth->value());
+
+    const QImage grid = composer.compose();
+    if(grid.isNull() || !grid.save(path, "PNG")) {
+        QMessageBox::critical(this, tr("Saving failed"),
+                              tr("Unable to save the grid to %1").arg(path));
+    }
 }
 
 void SaveGridDialog::on_comboBox_currentIndexChanged(const QString &arg1)
@@ -2,8 +2,11 @@
 #define VFG_UI_SAVEGRIDDIALOG_HPP
 
 #include <QDialog>
+#include <QSize>
+#include "gridcomposer.h"
 #include "ui_savegriddialog.h"
 
+class QImage;
 class QPixmap;
 class QString;
 
@@ -14,14 +17,36 @@ namespace Ui {
 class SaveGridDialog;
 }
 
+/**
+ * @brief The SaveGridDialog class
+ *
+ * Frames are arranged using their thumbnails and composed from full
+ * size frames only when the grid is saved
+ */
 class SaveGridDialog : public QDialog
 {
     Q_OBJECT
 
 public:
-    explicit SaveGridDialog(QWidget *parent = 0);
+    /**
+     * @brief Constructor
+     * @param source Source of the full size frames, see \link vfg::core::GridComposer \endlink
+     * @param size Size of the full size frames
+     * @param parent Owner of the dialog
+     */
+    SaveGridDialog(vfg::core::GridComposer::FrameSource source, const QSize& size,
+                   QWidget *parent = 0);
 
-    void addPixmap(const QPixmap &img);
+    /**
+     * @brief Add frame to the list of arrangeable frames
+     *
+     * The frame number is stored in the thumbnail, see
+     * \link vfg::core::GridComposer::tagThumbnail \endlink
+     *
+     * @param frameNum Frame number
+     * @param thumbnail Thumbnail of the frame
+     */
+    void addFrame(int frameNum, const QPixmap &thumbnail);
 
 private slots:
     void on_pushButton_clicked();
@@ -30,6 +55,12 @@ private slots:
 
 private:
     Ui::SaveGridDialog ui;
+
+    //! Source of the full size frames
+    vfg::core::GridComposer::FrameSource frameSource;
+
+    //! Size of the full size frames
+    QSize frameSize;
 };
 
 
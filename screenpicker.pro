@@ -20,6 +20,9 @@ SOURCES += main.cpp\
     configdialog.cpp \
     videoframegenerator.cpp \
     dvdprocessor.cpp \
+    discjobmanager.cpp \
+    indexeroutputparser.cpp \
+    keyframeindex.cpp \
     scriptparser.cpp \
     videosettingswidget.cpp \
     videopreviewwidget.cpp \
@@ -30,6 +33,9 @@ SOURCES += main.cpp\
     x264encoderdialog.cpp \
     opendialog.cpp \
     httpdownload.cpp \
+    downloadwriter.cpp \
+    bandwidthlimiter.cpp \
+    downloadscheduler.cpp \
     downloadsdialog.cpp \
     progressbardelegate.cpp \
     downloadslistmodel.cpp \
@@ -39,10 +45,24 @@ SOURCES += main.cpp\
     extractors/youtubeextractor.cpp \
     extractors/instagramextractor.cpp \
     extractors/tumblrextractor.cpp \
+    extractors/youtubeplayercache.cpp \
+    extractors/jsonscanner.cpp \
+    batchresolver.cpp \
     jumptoframedialog.cpp \
     libs\imagegridwidget\imagegridwidget.cpp \
-    libs\qimagegrid\qimagegrid.cpp \
-    savegriddialog.cpp
+    savegriddialog.cpp \
+    filmstrip.cpp \
+    filmstripbuilder.cpp \
+    filmstripwidget.cpp \
+    framefilter.cpp \
+    framequalityfilter.cpp \
+    gridcomposer.cpp \
+    abstractvideosource.cpp \
+    videosourceinstrumentation.cpp \
+    framespillstore.cpp \
+    y4mvideosource.cpp \
+    progressivevideosource.cpp \
+    availabilityslider.cpp
 
 HEADERS  += mainwindow.h \
     flowlayout.h \
@@ -56,6 +76,9 @@ HEADERS  += mainwindow.h \
     init.h \
     videoframegenerator.h \
     dvdprocessor.h \
+    discjobmanager.h \
+    indexeroutputparser.h \
+    keyframeindex.h \
     scriptparser.h \
     videosettingswidget.h \
     videopreviewwidget.h \
@@ -67,20 +90,37 @@ HEADERS  += mainwindow.h \
     raiideleter.hpp \
     opendialog.hpp \
     httpdownload.hpp \
+    downloadwriter.hpp \
+    bandwidthlimiter.hpp \
+    downloadscheduler.hpp \
     downloadsdialog.hpp \
     progressbardelegate.hpp \
     downloadslistmodel.hpp \
     extractorfactory.hpp \
+    batchresolver.hpp \
     extractors/baseextractor.hpp \
     extractors/dailymotionextractor.hpp \
     extractors/youtubeextractor.hpp \
     extractors/instagramextractor.hpp \
     extractors/tumblrextractor.hpp \
+    extractors/youtubeplayercache.hpp \
+    extractors/jsonscanner.hpp \
+    extractors/regexutil.hpp \
     jumptoframedialog.hpp \
     common.hpp \
     libs\imagegridwidget\imagegridwidget.hpp \
-    libs\qimagegrid\qimagegrid.hpp \
-    savegriddialog.hpp
+    savegriddialog.hpp \
+    filmstrip.h \
+    filmstripbuilder.h \
+    filmstripwidget.hpp \
+    framefilter.h \
+    framequalityfilter.h \
+    gridcomposer.h \
+    videosourceinstrumentation.h \
+    framespillstore.h \
+    y4mvideosource.h \
+    progressivevideosource.h \
+    availabilityslider.hpp
 
 FORMS    += mainwindow.ui \
     scripteditor.ui \
@@ -1,11 +1,17 @@
 #include <string>
 #include <sstream>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
 #include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRect>
 #include <QSettings>
 #include <QSize>
 #include <QString>
+#include <QStringList>
 #include <QTextStream>
 #include <QVariant>
 #include "scriptparser.h"
@@ -23,6 +29,41 @@ QString readTemplate(const QString& path) {
     return stream.readAll();
 }
 
+struct CachedTemplate
+{
+    QDateTime modified {};
+    qint64 size {-1};
+    std::string source {};
+
+    // Rendered scripts keyed by the template data
+    QHash<QString, QString> rendered {};
+};
+
+// Number of rendered scripts kept per template
+const int maxRendered = 32;
+
+QMutex cacheMutex;
+QHash<QString, CachedTemplate> cache;
+
+/**
+ * @brief Get cached template, reading it if the file has changed
+ * @param path Path to the template
+ * @exception vfg::ScriptParserError If the template can't be read
+ * @return Cached template, valid until the cache is modified
+ */
+CachedTemplate& cachedTemplate(const QString& path) {
+    const QFileInfo info(path);
+    CachedTemplate& tpl = cache[path];
+    if(tpl.size != info.size() || tpl.modified != info.lastModified()) {
+        tpl.source = readTemplate(path).toStdString();
+        tpl.size = info.size();
+        tpl.modified = info.lastModified();
+        tpl.rendered.clear();
+    }
+
+    return tpl;
+}
+
 } // namespace
 
 namespace vfg {
@@ -37,21 +78,33 @@ void ScriptParser::setTemplate(const QString &path)
     tplPath = path;
 }
 
+void ScriptParser::clearCache()
+{
+    QMutexLocker lock(&cacheMutex);
+    cache.clear();
+}
+
 QString ScriptParser::parse(const QMap<QString, QVariant>& settings) const try
 {
     using templet::make_data;
 
+    // Identifies the template data for the render cache
+    QStringList key;
+
     templet::DataMap data;
+    const QString plugins = settings.value("avisynthpluginspath").toString();
     data["source_path"] = make_data(path.toStdString());
-    data["avs_plugins"] = make_data(settings.value("avisynthpluginspath")
-                                    .toString().toStdString());
+    data["avs_plugins"] = make_data(plugins.toStdString());
+    key << path << plugins;
 
     if(settings.value("ivtc", 0).toInt()) {
         data["ivtc"] = make_data("true");
+        key << "ivtc";
     }
 
     if(settings.value("deinterlace", 0).toInt()) {
         data["deinterlace"] = make_data("true");
+        key << "deinterlace";
     }
 
     const QSize resized = settings.value("resize").toSize();
@@ -59,7 +112,10 @@ QString ScriptParser::parse(const QMap<QString, QVariant>& settings) const try
         templet::DataMap resize;
         resize["width"] = make_data(resized.width());
         resize["height"] = make_data(resized.height());
+        const QString kernel = settings.value("resizekernel", "Spline36").toString();
+        resize["kernel"] = make_data(kernel.toStdString());
         data["resize"] = make_data(resize);
+        key << QString("resize=%1x%2,%3").arg(resized.width()).arg(resized.height()).arg(kernel);
     }
 
     const QRect crop = settings.value("crop").toRect();
@@ -74,13 +130,29 @@ QString ScriptParser::parse(const QMap<QString, QVariant>& settings) const try
         crop["bottom"] = make_data(cropBottom);
         crop["left"] = make_data(cropLeft);
         data["crop"] = make_data(crop);
+        key << QString("crop=%1,%2,%3,%4").arg(cropTop).arg(cropRight).arg(cropBottom).arg(cropLeft);
+    }
+
+    const QString renderKey = key.join('\n');
+
+    QMutexLocker lock(&cacheMutex);
+    CachedTemplate& tpl = cachedTemplate(tplPath);
+    const auto rendered = tpl.rendered.constFind(renderKey);
+    if(rendered != tpl.rendered.cend()) {
+        return rendered.value();
     }
 
-    const std::string tpl = readTemplate(tplPath).toStdString();
     std::ostringstream oss;
-    templet::parse(tpl, data, oss);
+    templet::parse(tpl.source, data, oss);
+
+    if(tpl.rendered.size() >= maxRendered) {
+        tpl.rendered.clear();
+    }
+
+    const QString script = QString::fromStdString(oss.str());
+    tpl.rendered.insert(renderKey, script);
 
-    return QString::fromStdString(oss.str());
+    return script;
 }
 catch(const vfg::ScriptParserError& ex)
 {
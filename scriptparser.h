@@ -24,6 +24,10 @@ public:
 
     void setTemplate(const QString &path);
 
+    // Templates are read once and kept until their file changes,
+    // and the output is reused while the settings stay the same
+    static void clearCache();
+
 protected:
     const QString path;
     QString tplPath {":/scripts/default_template.avs"};
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstdint>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QThread>
+#include "scriptparser.h"
+#include "syntheticvideosource.h"
+
+namespace {
+
+/**
+ * @brief Render a deterministic test pattern for a frame
+ *
+ * The pattern is a checkerboard that scrolls with the frame number,
+ * tinted by a vertical gradient, with a moving vertical bar
+ *
+ * @param frameNumber Frame to render
+ * @param size Frame resolution
+ * @return Rendered frame
+ */
+QImage renderFrame(const int frameNumber, const QSize& size) {
+    QImage image(size, QImage::Format_ARGB32);
+    const int width = size.width();
+    const int height = size.height();
+    const int barX = (frameNumber * 8) % width;
+    const int phase = frameNumber * 2;
+    for(int y = 0; y < height; ++y) {
+        auto row = reinterpret_cast<std::uint32_t*>(image.scanLine(y));
+        const std::uint32_t tint = static_cast<std::uint32_t>(255 * y / height);
+        const int checkerY = ((y + phase) / 16) & 1;
+        for(int x = 0; x < width; ++x) {
+            const std::uint32_t level = ((((x + phase) / 16) & 1) ^ checkerY) ? 200 : 56;
+            row[x] = 0xff000000 | (level << 16) | (tint << 8) | (255 - tint);
+        }
+
+        for(int x = barX, end = std::min(width, barX + 32); x < end; ++x) {
+            row[x] = 0xffffffff;
+        }
+    }
+
+    return image;
+}
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+SyntheticVideoSource::SyntheticVideoSource(const QSize& resolution, const int numFrames,
+                                           const int decodeLatency) :
+    AbstractVideoSource(),
+    frameSize(resolution),
+    frameCount(numFrames),
+    latency(std::max(0, decodeLatency))
+{
+}
+
+void SyntheticVideoSource::load(const QString& fileName)
+{
+    if(frameSize.isEmpty() || frameCount < 1) {
+        throw VideoSourceError("Synthetic video must have a valid resolution and frame count");
+    }
+
+    loadedName = fileName;
+    loaded = true;
+
+    emit videoLoaded();
+}
+
+bool SyntheticVideoSource::hasVideo() const
+{
+    return loaded;
+}
+
+int SyntheticVideoSource::getNumFrames() const
+{
+    return loaded ? frameCount : 0;
+}
+
+QImage SyntheticVideoSource::getFrame(const int frameNumber)
+{
+    if(!isValidFrame(frameNumber)) {
+        return {};
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if(latency > 0) {
+        QThread::usleep(static_cast<unsigned long>(latency));
+    }
+    QImage frame = renderFrame(frameNumber, frameSize);
+    recordFrameTiming(frameNumber, timer.nsecsElapsed() / 1000, 0);
+
+    return frame;
+}
+
+QString SyntheticVideoSource::getSupportedFormats()
+{
+    static const QString formats = "Synthetic video (*)";
+    return formats;
+}
+
+bool SyntheticVideoSource::isValidFrame(const int frameNum) const
+{
+    return loaded && frameNum >= 0 && frameNum < frameCount;
+}
+
+vfg::ScriptParser SyntheticVideoSource::getParser(const QFileInfo& info) const
+{
+    return vfg::ScriptParser(info.absoluteFilePath());
+}
+
+QSize SyntheticVideoSource::resolution() const
+{
+    return frameSize;
+}
+
+QString SyntheticVideoSource::fileName() const
+{
+    return loadedName;
+}
+
+int SyntheticVideoSource::decodeLatency() const
+{
+    return latency;
+}
+
+} // namespace core
+} // namespace vfg
@@ -0,0 +1,78 @@
+#ifndef VFG_SYNTHETICVIDEOSOURCE_H
+#define VFG_SYNTHETICVIDEOSOURCE_H
+
+#include <QSize>
+#include <QString>
+#include "abstractvideosource.h"
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The SyntheticVideoSource class
+ *
+ * Procedurally generates frames without any decoder so that the
+ * frame pipeline can be exercised and measured on any platform.
+ * Every frame is deterministic for a given frame number.
+ */
+class SyntheticVideoSource : public vfg::core::AbstractVideoSource
+{
+private:
+    //! Resolution of the generated frames
+    QSize frameSize {1920, 1080};
+
+    //! Number of frames in the video
+    int frameCount {0};
+
+    //! Extra time spent in getFrame() to simulate a slow decoder, in microseconds
+    int latency {0};
+
+    //! Name given to load()
+    QString loadedName {};
+
+    //! Set after load()
+    bool loaded {false};
+
+public:
+    /**
+     * @brief Constructor
+     * @param resolution Resolution of the generated frames
+     * @param numFrames Number of frames in the video
+     * @param decodeLatency Time each frame request takes
+     *                      in addition to rendering, in microseconds
+     */
+    explicit SyntheticVideoSource(const QSize& resolution = {1920, 1080},
+                                  int numFrames = 100000,
+                                  int decodeLatency = 0);
+    ~SyntheticVideoSource() override = default;
+
+    /**
+     * @brief Load synthetic video
+     *
+     * The file is not read. The name is only stored and
+     * returned from \link fileName \endlink
+     *
+     * @param fileName Name for the video
+     * @throws vfg::core::VideoSourceError If resolution or frame count is invalid
+     */
+    void load(const QString& fileName) override;
+    bool hasVideo() const override;
+    int getNumFrames() const override;
+    QImage getFrame(int frameNumber) override;
+    QString getSupportedFormats() override;
+    bool isValidFrame(int frameNum) const override;
+    vfg::ScriptParser getParser(const QFileInfo& info) const override;
+    QSize resolution() const override;
+    QString fileName() const override;
+
+    /**
+     * @brief Get simulated decode latency
+     * @return Latency in microseconds
+     */
+    int decodeLatency() const;
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_SYNTHETICVIDEOSOURCE_H
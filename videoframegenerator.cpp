@@ -3,6 +3,8 @@
 #include <QImage>
 #include <QLoggingCategory>
 #include <QMutexLocker>
+#include "framequalityfilter.h"
+#include "framespillstore.h"
 #include "videoframegrabber.h"
 #include "videoframegenerator.h"
 
@@ -41,10 +43,22 @@ void VideoFrameGenerator::start()
             break;
         }
         const int current = frames.first();
+        const auto filter = qualityFilter;
+        const auto store = spillStore;
 
         lock.unlock();
         // Lock not needed so free it for other member functions
-        const QImage frame = frameGrabber->getFrame(current);
+        QImage frame = frameGrabber->getFrame(current);
+        int frameNum = current;
+        bool accepted = true;
+        if(filter) {
+            const auto result = filter->apply(current, frame, [this](const int num) {
+                return frameGrabber->getFrame(num);
+            }, frameGrabber->totalFrames() - 1);
+            accepted = result.accepted;
+            frameNum = result.frameNum;
+            frame = result.frame;
+        }
 
         lock.relock();
         if(state == State::Paused || state == State::Stopped) {
@@ -57,7 +71,16 @@ void VideoFrameGenerator::start()
         frames.takeFirst();
         lock.unlock();
 
-        emit frameReady(current, frame);
+        if(accepted) {
+            if(store && !store->append(frameNum, frame)) {
+                qCWarning(GENERATOR) << "Failed to spill frame" << frameNum;
+            }
+
+            emit frameReady(frameNum, frame);
+        }
+        else {
+            emit frameSkipped(current);
+        }
     }
 
     if(state != State::Paused) {
@@ -133,5 +156,21 @@ int VideoFrameGenerator::remaining() const
     return frames.count();
 }
 
+void VideoFrameGenerator::setQualityFilter(std::shared_ptr<vfg::core::FrameQualityFilter> filter)
+{
+    QMutexLocker lock(&mutex);
+    qualityFilter = std::move(filter);
+
+    qCDebug(GENERATOR) << "Quality filter" << (qualityFilter ? "enabled" : "disabled");
+}
+
+void VideoFrameGenerator::setSpillStore(std::shared_ptr<vfg::core::FrameSpillStore> store)
+{
+    QMutexLocker lock(&mutex);
+    spillStore = std::move(store);
+
+    qCDebug(GENERATOR) << "Spill store" << (spillStore ? "enabled" : "disabled");
+}
+
 } // namespace core
 } // namespace vfg
@@ -10,6 +10,8 @@ class QImage;
 
 namespace vfg {
 namespace core {
+    class FrameQualityFilter;
+    class FrameSpillStore;
     class VideoFrameGrabber;
 }
 }
@@ -73,6 +75,22 @@ public:
      * @return Number of frames
      */
     int remaining() const;
+
+    /**
+     * @brief Set filter used to reject or replace low quality frames
+     * @param filter Quality filter, or nullptr to disable filtering
+     */
+    void setQualityFilter(std::shared_ptr<vfg::core::FrameQualityFilter> filter);
+
+    /**
+     * @brief Set store that receives every generated frame
+     *
+     * Frames are appended in the generator thread before
+     * \link frameReady \endlink is emitted
+     *
+     * @param store Spill store, or nullptr to disable
+     */
+    void setSpillStore(std::shared_ptr<vfg::core::FrameSpillStore> store);
     
 signals:
     /**
@@ -81,6 +99,13 @@ signals:
      */
     void frameReady(int frameNum, const QImage& frame);
 
+    /**
+     * @brief Emitted when a frame is rejected by the quality filter
+     * and no replacement was found
+     * @param frameNum Rejected frame number
+     */
+    void frameSkipped(int frameNum);
+
     /**
      * @brief Finished signal is emitted when explicitly stopped
      * or when all frames have been processed
@@ -133,6 +158,8 @@ private:
     
 private:
     std::shared_ptr<vfg::core::VideoFrameGrabber> frameGrabber;
+    std::shared_ptr<vfg::core::FrameQualityFilter> qualityFilter {};
+    std::shared_ptr<vfg::core::FrameSpillStore> spillStore {};
     QList<int> frames {};
     mutable QMutex mutex {};
     State state {State::Stopped};
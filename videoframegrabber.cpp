@@ -1,13 +1,19 @@
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
 #include <utility>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QImage>
 #include <QLoggingCategory>
+#include <QMetaObject>
 #include <QMutexLocker>
 #include <QSize>
 #include <QThread>
+#include <QVector>
 #include "videoframegrabber.h"
 #include "abstractvideosource.h"
+#include "framefilter.h"
 
 Q_LOGGING_CATEGORY(GRABBER, "videoframegrabber")
 
@@ -48,6 +54,13 @@ void VideoFrameGrabber::setVideoSource(
     currentFrame = 0;
 }
 
+void VideoFrameGrabber::setPreviewFilter(std::shared_ptr<const vfg::core::FrameFilter> filter)
+{
+    QMutexLocker lock(&mutex);
+
+    previewFilter = std::move(filter);
+}
+
 int VideoFrameGrabber::lastFrame() const
 {
     QMutexLocker lock(&mutex);
@@ -67,7 +80,149 @@ void VideoFrameGrabber::requestFrame(const int frameNum)
     }
 
     currentFrame = frameNum;
-    emit frameGrabbed(frameNum, avs->getFrame(frameNum));
+    emit frameGrabbed(frameNum, preview(fetchFrame(frameNum)));
+}
+
+void VideoFrameGrabber::setKeyframeSeeking(const bool enabled)
+{
+    QMutexLocker lock(&requestMutex);
+
+    keyframeSeeking = enabled;
+}
+
+void VideoFrameGrabber::requestLatestFrame(const int frameNum)
+{
+    QMutexLocker lock(&requestMutex);
+
+    queueLatestRequest(frameNum, RequestKind::Exact);
+}
+
+void VideoFrameGrabber::refreshFrame(const int frameNum)
+{
+    QMutexLocker lock(&requestMutex);
+
+    if(pendingFrame != -1 && pendingKind != RequestKind::Scrub) {
+        return;
+    }
+
+    queueLatestRequest(frameNum, RequestKind::Exact);
+}
+
+void VideoFrameGrabber::seekToFrame(const int frameNum)
+{
+    QMutexLocker lock(&requestMutex);
+
+    queueLatestRequest(frameNum, RequestKind::Seek);
+}
+
+void VideoFrameGrabber::scrubToFrame(const int frameNum)
+{
+    QMutexLocker lock(&requestMutex);
+
+    queueLatestRequest(frameNum, RequestKind::Scrub);
+}
+
+void VideoFrameGrabber::queueLatestRequest(const int frameNum, const RequestKind kind)
+{
+    if(pendingFrame != -1) {
+        ++supersededRequests;
+    }
+
+    pendingFrame = frameNum;
+    pendingKind = kind;
+
+    // One queued call serves every request made before it runs
+    if(!requestQueued) {
+        requestQueued = true;
+        QMetaObject::invokeMethod(this, "processLatestRequest", Qt::QueuedConnection);
+    }
+}
+
+void VideoFrameGrabber::processLatestRequest()
+{
+    int frameNum = -1;
+    RequestKind kind = RequestKind::Exact;
+    bool snap = false;
+    int superseded = 0;
+    {
+        QMutexLocker lock(&requestMutex);
+        std::swap(frameNum, pendingFrame);
+        std::swap(superseded, supersededRequests);
+        kind = pendingKind;
+        snap = keyframeSeeking;
+        requestQueued = false;
+    }
+
+    if(frameNum == -1) {
+        return;
+    }
+
+    if(superseded > 0) {
+        qCDebug(GRABBER) << "Dropped" << superseded << "superseded requests before frame" << frameNum;
+    }
+
+    if(kind == RequestKind::Exact || (kind == RequestKind::Seek && !snap)) {
+        requestFrame(frameNum);
+        return;
+    }
+
+    QMutexLocker ml(&mutex);
+
+    if(!avs->isValidFrame(frameNum)) {
+        if(kind == RequestKind::Seek) {
+            qCCritical(GRABBER) << "Frame number out of range:" << frameNum;
+            emit errorOccurred(tr("Frame number out of range: %1")
+                               .arg(QString::number(frameNum)));
+        }
+        return;
+    }
+
+    const int keyframe = snap ? nearestKeyframe(frameNum) : frameNum;
+
+    if(kind == RequestKind::Scrub) {
+        QImage frame = preview(fetchFrame(keyframe));
+        if(frame.width() > scrubWidth) {
+            frame = frame.scaledToWidth(scrubWidth, Qt::FastTransformation);
+        }
+
+        emit scrubFrameGrabbed(keyframe, frame);
+        return;
+    }
+
+    currentFrame = frameNum;
+    if(keyframe != frameNum) {
+        qCDebug(GRABBER) << "Seeking to keyframe" << keyframe << "before frame" << frameNum;
+        emit frameGrabbed(keyframe, preview(fetchFrame(keyframe)));
+
+        // Refine to the exact frame unless a newer request has come in
+        QMutexLocker lock(&requestMutex);
+        if(pendingFrame == -1) {
+            queueLatestRequest(frameNum, RequestKind::Exact);
+        }
+        return;
+    }
+
+    emit frameGrabbed(frameNum, preview(fetchFrame(frameNum)));
+}
+
+int VideoFrameGrabber::nearestKeyframe(const int frameNum) const
+{
+    const QVector<int> keyframes = avs->keyframes();
+    if(keyframes.isEmpty()) {
+        return frameNum;
+    }
+
+    const auto next = std::lower_bound(keyframes.cbegin(), keyframes.cend(), frameNum);
+    if(next == keyframes.cbegin()) {
+        return *next;
+    }
+
+    const auto previous = std::prev(next);
+    if(next == keyframes.cend() || frameNum - *previous <= *next - frameNum) {
+        return *previous;
+    }
+
+    return *next;
 }
 
 void VideoFrameGrabber::requestNextFrame()
@@ -82,7 +237,7 @@ void VideoFrameGrabber::requestNextFrame()
     }
 
     ++currentFrame;
-    emit frameGrabbed(nextFrame, avs->getFrame(nextFrame));
+    emit frameGrabbed(nextFrame, preview(fetchFrame(nextFrame)));
 }
 
 void VideoFrameGrabber::requestPreviousFrame()
@@ -96,11 +251,20 @@ void VideoFrameGrabber::requestPreviousFrame()
     }
 
     --currentFrame;
-    emit frameGrabbed(currentFrame, avs->getFrame(currentFrame));
+    emit frameGrabbed(currentFrame, preview(fetchFrame(currentFrame)));
 }
 
 QImage VideoFrameGrabber::getFrame(const int frameNum)
 {
+    // Wait for a frame that is still downloading without holding the lock,
+    // so that the GUI and the display requests aren't blocked meanwhile
+    std::shared_ptr<vfg::core::AbstractVideoSource> source;
+    {
+        QMutexLocker lock(&mutex);
+        source = avs;
+    }
+    source->waitForFrame(frameNum);
+
     QMutexLocker ml(&mutex);
 
     if(!avs->isValidFrame(frameNum)) {
@@ -108,7 +272,32 @@ QImage VideoFrameGrabber::getFrame(const int frameNum)
         return {};
     }
 
-    return avs->getFrame(frameNum);
+    return fetchFrame(frameNum);
+}
+
+QImage VideoFrameGrabber::fetchFrame(const int frameNum)
+{
+    const auto instrumentation = avs->instrumentation();
+    if(!instrumentation) {
+        return avs->getFrame(frameNum);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QImage frame = avs->getFrame(frameNum);
+    instrumentation->recordRequest(frameNum, timer.nsecsElapsed() / 1000);
+
+    return frame;
+}
+
+QImage VideoFrameGrabber::preview(const QImage& frame) const
+{
+    if(!previewFilter) {
+        return frame;
+    }
+
+    const QImage filtered = previewFilter->apply(frame);
+    return filtered.isNull() ? frame : filtered;
 }
 
 bool VideoFrameGrabber::isValidFrame(const int frameNum) const
@@ -13,6 +13,7 @@ class QString;
 namespace vfg {
 namespace core {
     class AbstractVideoSource;
+    class FrameFilter;
 }
 }
 
@@ -39,7 +40,70 @@ private:
 
     mutable QMutex mutex {};
 
+    //! Applied to frames emitted by \link frameGrabbed \endlink
+    std::shared_ptr<const vfg::core::FrameFilter> previewFilter {};
+
+    //! Kind of request in the latest-wins channel
+    enum class RequestKind {
+        Exact,  //!< Decode the requested frame
+        Seek,   //!< Snap to a keyframe first if keyframe seeking is enabled
+        Scrub   //!< Low resolution preview
+    };
+
+    //! Guards the latest request, never held while decoding
+    QMutex requestMutex {};
+
+    //! Latest frame requested through the latest-wins channel, -1 if none
+    int pendingFrame {-1};
+
+    //! Kind of the pending request
+    RequestKind pendingKind {RequestKind::Exact};
+
+    //! Seeks and scrubbing snap to keyframes
+    bool keyframeSeeking {false};
+
+    //! A call to \link processLatestRequest \endlink is queued
+    bool requestQueued {false};
+
+    //! Requests superseded before they were decoded
+    int supersededRequests {0};
+
+    /**
+     * @brief Replace the pending request and queue processing if needed
+     * @pre requestMutex must be locked
+     * @param frameNum Frame to request
+     * @param kind Kind of request
+     */
+    void queueLatestRequest(int frameNum, RequestKind kind);
+
+    /**
+     * @brief Get keyframe nearest to a frame
+     * @pre mutex must be locked
+     * @param frameNum Frame number
+     * @return Nearest keyframe, or frameNum if the source has no keyframes
+     */
+    int nearestKeyframe(int frameNum) const;
+
+    /**
+     * @brief Apply preview filter to a frame
+     * @pre mutex must be locked
+     * @param frame Frame to filter
+     * @return Filtered frame, or frame if there is no filter
+     */
+    QImage preview(const QImage& frame) const;
+
+    /**
+     * @brief Get frame from video source and record the request time
+     * @pre mutex must be locked and frameNum must be valid
+     * @param frameNum Frame to request
+     * @return Frame (may be null)
+     */
+    QImage fetchFrame(int frameNum);
+
 public:
+    //! Maximum width of the frames emitted while scrubbing
+    static const int scrubWidth = 640;
+
     /**
      * @brief Constructor
      * @pre avs must not be nullptr
@@ -64,6 +128,29 @@ public:
      */
     void setVideoSource(std::shared_ptr<vfg::core::AbstractVideoSource> newAvs);
 
+    /**
+     * @brief Set filter applied to the frames that are displayed
+     *
+     * Only frames emitted by \link frameGrabbed \endlink are filtered,
+     * \link getFrame \endlink always returns unfiltered frames
+     *
+     * @param filter Filter, or nullptr to disable
+     */
+    void setPreviewFilter(std::shared_ptr<const vfg::core::FrameFilter> filter);
+
+    /**
+     * @brief Enable snapping seeks to keyframes
+     *
+     * Seeks requested with \link seekToFrame \endlink first display the
+     * nearest keyframe reported by the source, which decodes without
+     * decoding the frames before it, and then the exact frame unless a
+     * newer request has come in. Scrubbing displays only keyframes.
+     * Has no effect on sources that don't report keyframes.
+     *
+     * @param enabled True to enable
+     */
+    void setKeyframeSeeking(bool enabled);
+
     /**
      * @brief Get last requested frame number
      * @return Last requested frame number
@@ -78,6 +165,11 @@ public:
 
     /**
      * @brief Get frame from video source
+     *
+     * Waits for frames that are still downloading, see
+     * \link AbstractVideoSource::waitForFrame \endlink. The request
+     * slots don't wait and return null frames instead.
+     *
      * @pre frameNum must be between [0, numFrames)
      * @param frameNum Frame to request
      * @return Frame (may be null)
@@ -123,6 +215,68 @@ public slots:
      */
     void requestFrame(int frameNum);
 
+    /**
+     * @brief Request frame, superseding earlier requests not yet decoded
+     *
+     * The request is stored and processed in the frame grabber's thread,
+     * so the caller doesn't wait for the decode. If another request comes
+     * in before the frame is decoded, the earlier one is dropped. A
+     * burst of requests costs at most the decode in progress plus the
+     * latest request.
+     *
+     * Safe to call from any thread.
+     *
+     * @param frameNum Frame to request, emitted by \link frameGrabbed \endlink
+     */
+    void requestLatestFrame(int frameNum);
+
+    /**
+     * @brief Decode the displayed frame again, such as after the preview filter changed
+     *
+     * Unlike \link requestLatestFrame \endlink, a pending seek is not
+     * replaced, as it is decoded with the new state anyway.
+     *
+     * Safe to call from any thread.
+     *
+     * @param frameNum Displayed frame, decoded if no seek is pending
+     */
+    void refreshFrame(int frameNum);
+
+    /**
+     * @brief Seek to frame through the latest-wins channel
+     *
+     * Like \link requestLatestFrame \endlink, but with keyframe seeking
+     * enabled the nearest keyframe is emitted before the exact frame
+     *
+     * Safe to call from any thread.
+     *
+     * @param frameNum Frame to seek to
+     */
+    void seekToFrame(int frameNum);
+
+    /**
+     * @brief Request low resolution preview frame while scrubbing
+     *
+     * Shares the latest-wins channel with \link requestLatestFrame \endlink.
+     * With keyframe seeking enabled the nearest keyframe is decoded
+     * instead of the frame. The frame is scaled down to at most
+     * \link scrubWidth \endlink pixels wide, so it is cheap to pass to
+     * and paint in the GUI thread, and is emitted by
+     * \link scrubFrameGrabbed \endlink. The last frame number is not
+     * changed.
+     *
+     * Safe to call from any thread.
+     *
+     * @param frameNum Frame to preview
+     */
+    void scrubToFrame(int frameNum);
+
+private slots:
+    /**
+     * @brief Decode the latest pending request
+     */
+    void processLatestRequest();
+
 signals:
     /**
      * @brief Emit grabbed frame
@@ -130,6 +284,13 @@ signals:
      */
     void frameGrabbed(int frameNum, const QImage& frame);
 
+    /**
+     * @brief Emit low resolution frame requested by \link scrubToFrame \endlink
+     * @param frameNum Frame number
+     * @param frame Frame image, at most \link scrubWidth \endlink pixels wide
+     */
+    void scrubFrameGrabbed(int frameNum, const QImage& frame);
+
     /**
      * @brief Emit errors
      * @param msg Error message
@@ -49,6 +49,11 @@ int VideoFrameThumbnail::frameNum() const
     return frameNumber;
 }
 
+const QPixmap& VideoFrameThumbnail::thumbnail() const
+{
+    return thumb;
+}
+
 void VideoFrameThumbnail::mouseDoubleClickEvent(QMouseEvent *event)
 {
     Q_UNUSED(event);
@@ -46,6 +46,12 @@ public:
      */
     int frameNum() const;
 
+    /**
+     * @brief Retrieves the thumbnail at its original size
+     * @return Thumbnail
+     */
+    const QPixmap& thumbnail() const;
+
 private:
     vfg::observer_ptr<QLabel> pixmapLabel;
     QPixmap thumb;
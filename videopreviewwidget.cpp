@@ -1,5 +1,8 @@
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
 #include <QImage>
-#include <QLabel>
+#include <QLoggingCategory>
 #include <QMap>
 #include <QPainter>
 #include <QPair>
@@ -14,21 +17,36 @@
 #include <QWidget>
 #include "videopreviewwidget.h"
 
+Q_LOGGING_CATEGORY(PREVIEW, "videopreviewwidget")
+
+namespace {
+
+// Time after the last frame or resize before the frame is scaled smoothly
+const int idleInterval = 150;
+
+} // namespace
+
 vfg::ui::VideoPreviewWidget::VideoPreviewWidget(QWidget *parent) :
     QWidget(parent),
     layout(new QVBoxLayout),
-    frameLabel(new QLabel),
+    frameView(new QWidget),
     videoWidget(new QVideoWidget)
 {
-    frameLabel->setAlignment(Qt::AlignHCenter|Qt::AlignTop);
     // If size policy is not ignored,
     // it prevents the resizeEvent() from being called properly
     // when the widget is resized smaller
-    frameLabel->setSizePolicy(QSizePolicy::Ignored,
-                              QSizePolicy::Ignored);
+    frameView->setSizePolicy(QSizePolicy::Ignored,
+                             QSizePolicy::Ignored);
+    frameView->installEventFilter(this);
+
+    idleTimer.setSingleShot(true);
+    idleTimer.setInterval(idleInterval);
+    connect(&idleTimer, &QTimer::timeout, [this] {
+        frameView->update();
+    });
 
     layout->setContentsMargins(0, 0, 0, 0);
-    layout->addWidget(frameLabel.get());
+    layout->addWidget(frameView.get());
     setLayout(layout.get());
 
     QPalette plt = palette();
@@ -43,8 +61,8 @@ vfg::ui::VideoPreviewWidget::VideoPreviewWidget(QWidget *parent) :
 
 void vfg::ui::VideoPreviewWidget::showVideo()
 {
-    layout->removeWidget(frameLabel.get());
-    frameLabel->setParent(0);
+    layout->removeWidget(frameView.get());
+    frameView->setParent(0);
     layout->addWidget(videoWidget.get());
     state = VideoState::Playing;
 }
@@ -53,7 +71,7 @@ void vfg::ui::VideoPreviewWidget::hideVideo()
 {
     layout->removeWidget(videoWidget.get());
     videoWidget->setParent(0);
-    layout->addWidget(frameLabel.get());
+    layout->addWidget(frameView.get());
     state = VideoState::Stopped;
 }
 
@@ -61,13 +79,26 @@ void vfg::ui::VideoPreviewWidget::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
 
+    idleTimer.start();
     updateFrame();
 }
 
+bool vfg::ui::VideoPreviewWidget::eventFilter(QObject *watched, QEvent *event)
+{
+    if(watched == frameView.get() && event->type() == QEvent::Paint) {
+        paintFrame();
+        return true;
+    }
+
+    return QWidget::eventFilter(watched, event);
+}
+
 void vfg::ui::VideoPreviewWidget::setFrame(const QImage& img)
 {
     original = QPixmap::fromImage(img);
-    framePixmap = original.copy();
+    frameSize = original.size();
+    scaledFrames.clear();
+    idleTimer.start();
     updateFrame();
 }
 
@@ -78,23 +109,24 @@ void vfg::ui::VideoPreviewWidget::setFrame(const int frameNum, const QImage& fra
     setFrame(frame);
 }
 
-void vfg::ui::VideoPreviewWidget::setCrop(const QRect& area)
+void vfg::ui::VideoPreviewWidget::setScrubFrame(const int frameNum, const QImage& frame)
 {
-    if(area == QRect{}) {
-        framePixmap = original.copy();
-        cropBorders.clear();
-    }
-    else {
-        const QRect left(0, 0, area.left(), framePixmap.height());
-        const QRect top(0, 0, framePixmap.width(), area.top());
-        const QRect right(framePixmap.width() - area.width(), 0,
-                            area.width(), framePixmap.height());
-        const QRect bottom(0, framePixmap.height() - area.height(),
-                            framePixmap.width(), area.height());
-        QVector<QRect> newBorders {left, top, right, bottom};
-        cropBorders.swap(newBorders);
+    Q_UNUSED(frameNum);
+
+    original = QPixmap::fromImage(frame);
+    if(!frameSize.isValid()) {
+        frameSize = original.size();
     }
 
+    scaledFrames.clear();
+    idleTimer.start();
+    updateFrame();
+}
+
+void vfg::ui::VideoPreviewWidget::setCrop(const QRect& area)
+{
+    cropArea = area;
+
     updateFrame();
 
     // Prevent widget from disappearing
@@ -110,31 +142,81 @@ void vfg::ui::VideoPreviewWidget::updateFrame()
         }
     }
     else {
-        if(framePixmap.isNull()) {
-            return;
-        }
+        frameView->update();
+    }
+}
 
-        if(!cropBorders.isEmpty()) {
-            drawCropArea();
-        }
+void vfg::ui::VideoPreviewWidget::paintFrame()
+{
+    if(original.isNull()) {
+        return;
+    }
+
+    QElapsedTimer renderTime;
+    renderTime.start();
+
+    const QSize size = frameSize.scaled(calculateSize().size(),
+                                        Qt::KeepAspectRatio);
+    if(size.isEmpty()) {
+        return;
+    }
 
-        frameLabel->setPixmap(framePixmap.scaled(calculateSize().size(),
-                                                 Qt::KeepAspectRatio,
-                                                 Qt::SmoothTransformation));
+    // Centered horizontally and aligned to the top
+    const QRect target(QPoint((frameView->width() - size.width()) / 2, 0), size);
+
+    QPainter painter(frameView.get());
+    const char *path = "unscaled";
+    if(size == original.size()) {
+        painter.drawPixmap(target.topLeft(), original);
+    }
+    else if(scaledFrames.value(zoomMode).size() == size) {
+        painter.drawPixmap(target.topLeft(), scaledFrames.value(zoomMode));
+        path = "cached";
+    }
+    else if(idleTimer.isActive()) {
+        // Scaling while painting is bilinear and doesn't allocate
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawPixmap(target, original);
+        path = "fast";
+    }
+    else {
+        const QPixmap scaled = original.scaled(size, Qt::IgnoreAspectRatio,
+                                               Qt::SmoothTransformation);
+        scaledFrames.insert(zoomMode, scaled);
+        painter.drawPixmap(target.topLeft(), scaled);
+        path = "smooth";
     }
+
+    if(cropArea != QRect{}) {
+        drawCropArea(painter, target);
+    }
+
+    qCDebug(PREVIEW) << "Rendered" << original.size() << "frame at" << size
+                     << "in" << renderTime.nsecsElapsed() / 1000 << "us," << path;
 }
 
-void vfg::ui::VideoPreviewWidget::drawCropArea()
+void vfg::ui::VideoPreviewWidget::drawCropArea(QPainter& painter, const QRect& target) const
 {
-    QPixmap copiedFrame = original.copy();
-    QPainter painter(&copiedFrame);
+    const int width = frameSize.width();
+    const int height = frameSize.height();
+    const QVector<QRect> borders {
+        {0, 0, cropArea.left(), height},
+        {0, 0, width, cropArea.top()},
+        {width - cropArea.width(), 0, cropArea.width(), height},
+        {0, height - cropArea.height(), width, cropArea.height()}
+    };
+
+    // Borders are in frame coordinates
+    painter.translate(target.topLeft());
+    painter.scale(static_cast<double>(target.width()) / width,
+                  static_cast<double>(target.height()) / height);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
     painter.setBrush(Qt::cyan);
     // Performs an inverse operation which works well with cyan
     painter.setCompositionMode(QPainter::RasterOp_SourceXorDestination);
     painter.setOpacity(0.6);
     painter.setPen(Qt::NoPen);
-    painter.drawRects(cropBorders);
-    framePixmap.swap(copiedFrame);
+    painter.drawRects(borders);
 }
 
 QRect vfg::ui::VideoPreviewWidget::calculateSize() const
@@ -151,13 +233,15 @@ QRect vfg::ui::VideoPreviewWidget::calculateSize() const
 
     const auto zoomfactor = factors.value(zoomMode);
     return {geometry.x(), geometry.y(),
-                static_cast<int>(original.width() * zoomfactor),
-            static_cast<int>(original.height() * zoomfactor)};
+                static_cast<int>(frameSize.width() * zoomfactor),
+            static_cast<int>(frameSize.height() * zoomfactor)};
 }
 
 void vfg::ui::VideoPreviewWidget::setZoom(const ZoomMode mode)
 {
     zoomMode = mode;
 
+    // Cached copies are used as is, others are scaled smoothly at once
+    idleTimer.stop();
     updateFrame();
 }
@@ -1,18 +1,20 @@
 #ifndef VIDEOFRAMEWIDGET_H
 #define VIDEOFRAMEWIDGET_H
 
+#include <QMap>
 #include <QPixmap>
-#include <QVector>
+#include <QRect>
+#include <QSize>
+#include <QTimer>
 #include <QWidget>
 #include "ptrutil.hpp"
 
 // Forward declarations
+class QEvent;
 class QImage;
-class QLabel;
 class QMouseEvent;
-class QRect;
+class QPainter;
 class QResizeEvent;
-class QSize;
 class QVBoxLayout;
 class QVideoWidget;
 
@@ -34,27 +36,41 @@ namespace ui {
 
 /**
  * @brief The VideoPreviewWidget class
+ *
+ * Frames are painted directly instead of through a label. While frames
+ * keep arriving or the widget is being resized, the frame is scaled
+ * bilinearly as it is painted. Once idle, a smoothly scaled copy is made
+ * and cached per zoom level until the frame changes. Crop borders are
+ * painted over the frame without copying it.
  */
 class VideoPreviewWidget : public QWidget
 {
     Q_OBJECT
 
 private:
-    //! Areas to crop are drawn on the current frame
-    QVector<QRect> cropBorders {};
+    //! Area to crop, drawn on the current frame
+    QRect cropArea {};
 
     //! Layout to hold the preview frame
     vfg::observer_ptr<QVBoxLayout> layout;
 
-    //! The label contains the frame
-    vfg::observer_ptr<QLabel> frameLabel;
-
-    //! Modifiable copy of the frame that is displayed in the widget
-    QPixmap framePixmap {};
+    //! The frame is painted on this widget
+    vfg::observer_ptr<QWidget> frameView;
 
     //! The original frame that is never modified
     QPixmap original {};
 
+    //! Size of the last full resolution frame, scrub frames are
+    //! displayed at this size
+    QSize frameSize {};
+
+    //! Smoothly scaled copies of the current frame per zoom mode
+    QMap<ZoomMode, QPixmap> scaledFrames {};
+
+    //! Running while frames arrive or the widget is resized,
+    //! the frame is scaled smoothly when it times out
+    QTimer idleTimer {};
+
     //! Specifies the current zoom mode
     ZoomMode zoomMode {ZoomMode::Zoom_Scale};
 
@@ -72,10 +88,17 @@ private:
      */
     void updateFrame();
 
+    /**
+     * @brief Paints the current frame on the frame view
+     */
+    void paintFrame();
+
     /**
      * @brief Paints area to crop on current frame
+     * @param painter Painter of the frame view
+     * @param target Area the frame is painted to
      */
-    void drawCropArea();
+    void drawCropArea(QPainter& painter, const QRect& target) const;
 
     /**
      * @brief Calculates new size based on zoom mode
@@ -110,6 +133,14 @@ protected:
      */
     void resizeEvent(QResizeEvent *event);
 
+    /**
+     * @brief Paints the frame when the frame view is painted
+     * @param watched Watched object
+     * @param event Event
+     * @return True if the event was handled, otherwise false
+     */
+    bool eventFilter(QObject *watched, QEvent *event);
+
 public slots:
     /**
      * @brief Changes the zoom mode
@@ -130,6 +161,17 @@ public slots:
      */
     void setFrame(int frameNum, const QImage& frame);
 
+    /**
+     * @brief Sets a low resolution frame while scrubbing
+     *
+     * The frame is displayed at the size of the last full
+     * resolution frame
+     *
+     * @param frameNum frame number
+     * @param frame Low resolution preview frame
+     */
+    void setScrubFrame(int frameNum, const QImage& frame);
+
     /**
      * @brief Sets an area to crop
      * @param area Area to crop
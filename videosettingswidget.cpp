@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <QCloseEvent>
 #include <QMap>
@@ -7,6 +8,7 @@
 #include <QSize>
 #include <QString>
 #include <QVariant>
+#include "framefilter.h"
 #include "ptrutil.hpp"
 #include "videosettingswidget.h"
 
@@ -38,6 +40,15 @@ VideoSettingsWidget::VideoSettingsWidget(QWidget *parent) :
     ui.cboxDvdResolution->insertItem(PAL_16_9, tr("PAL 16:9"));
     ui.cboxDvdResolution->insertItem(PAL_4_3, tr("PAL 4:3"));
 
+    using Kernel = vfg::core::FrameFilter::Kernel;
+    ui.cboxResizeKernel->addItem(tr("Spline36"), vfg::core::FrameFilter::kernelName(Kernel::Spline36));
+    ui.cboxResizeKernel->addItem(tr("Lanczos"), vfg::core::FrameFilter::kernelName(Kernel::Lanczos3));
+    ui.cboxResizeKernel->addItem(tr("Bicubic"), vfg::core::FrameFilter::kernelName(Kernel::Bicubic));
+    ui.cboxResizeKernel->addItem(tr("Bilinear"), vfg::core::FrameFilter::kernelName(Kernel::Bilinear));
+    ui.cboxResizeKernel->addItem(tr("Point"), vfg::core::FrameFilter::kernelName(Kernel::Point));
+    ui.cboxResizeKernel->setCurrentIndex(std::max(0, ui.cboxResizeKernel->findData(
+                                                      config.value("video/resizekernel", "Spline36"))));
+
     connect(ui.sboxCropBottom,  static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
             this,               &VideoSettingsWidget::handleCropChange);
 
@@ -50,6 +61,16 @@ VideoSettingsWidget::VideoSettingsWidget(QWidget *parent) :
     connect(ui.sboxCropRight,   static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
             this,               &VideoSettingsWidget::handleCropChange);
 
+    // Preview the settings on the current frame while they're being changed
+    connect(ui.cbLivePreview,   &QCheckBox::toggled,
+            this,               &VideoSettingsWidget::updatePreview);
+
+    connect(ui.radioDeinterlace, &QRadioButton::toggled,
+            this,               &VideoSettingsWidget::updatePreview);
+
+    connect(ui.cboxResizeKernel, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this,               &VideoSettingsWidget::updatePreview);
+
     resetSettings();
 }
 
@@ -69,6 +90,11 @@ void VideoSettingsWidget::on_cboxDvdResolution_activated(const int index)
 }
 
 void VideoSettingsWidget::on_pushButton_clicked()
+{
+    apply();
+}
+
+void VideoSettingsWidget::apply()
 {
     // Override previous settings when applying new settings
     prevSettings = getSettings();
@@ -95,6 +121,7 @@ void VideoSettingsWidget::on_pushButton_clicked()
                                           ui.sboxResizeHeight->value()));
     config.setValue("video/deinterlace", ui.radioDeinterlace->isChecked());
     config.setValue("video/ivtc", ui.radioInverseTelecine->isChecked());
+    config.setValue("video/resizekernel", ui.cboxResizeKernel->currentData());
 
     emit settingsChanged();
 }
@@ -106,7 +133,46 @@ void VideoSettingsWidget::handleCropChange(int)
                      noneg(ui.sboxCropRight->value()),
                      noneg(ui.sboxCropBottom->value()));
 
-    emit cropChanged(area);
+    // Live preview crops the frame instead of drawing the area
+    emit cropChanged(ui.cbLivePreview->isChecked() ? QRect{} : area);
+
+    updatePreview();
+}
+
+void VideoSettingsWidget::updatePreview()
+{
+    emit previewChanged(previewSettings());
+}
+
+vfg::core::FrameFilter::Settings VideoSettingsWidget::previewSettings() const
+{
+    vfg::core::FrameFilter::Settings settings;
+    if(!ui.cbLivePreview->isChecked()) {
+        return settings;
+    }
+
+    // Displayed frames already have the applied settings,
+    // so only the changes on top of them are previewed
+    settings.crop = QRect(noneg(ui.sboxCropLeft->value()),
+                          noneg(ui.sboxCropTop->value()),
+                          noneg(ui.sboxCropRight->value()),
+                          noneg(ui.sboxCropBottom->value()));
+
+    const QSize size(ui.sboxResizeWidth->value(), ui.sboxResizeHeight->value());
+    if(size != QSize(sourceWidth, sourceHeight)) {
+        settings.resize = size;
+    }
+
+    settings.kernel = vfg::core::FrameFilter::kernelFromName(ui.cboxResizeKernel->currentData().toString());
+    settings.deinterlace = ui.radioDeinterlace->isChecked()
+            && !config.value("video/deinterlace").toBool();
+
+    return settings;
+}
+
+bool VideoSettingsWidget::hasPendingPreview() const
+{
+    return !vfg::core::FrameFilter(previewSettings()).isIdentity();
 }
 
 void VideoSettingsWidget::showEvent(QShowEvent *event)
@@ -131,8 +197,10 @@ void VideoSettingsWidget::closeEvent(QCloseEvent *event)
     ui.radioDeinterlace->setChecked(prevSettings.value("deinterlace").toBool());
     ui.radioInverseTelecine->setChecked(prevSettings.value("ivtc").toBool());
     ui.cboxDvdResolution->setCurrentIndex(prevSettings.value("dvdresolutionidx").toInt());
+    ui.cboxResizeKernel->setCurrentIndex(prevSettings.value("resizekernelidx").toInt());
 
     emit cropChanged({});
+    emit previewChanged({});
 
     event->accept();
 }
@@ -149,6 +217,7 @@ QMap<QString, QVariant> VideoSettingsWidget::getSettings() const
     settings.insert("ivtc", ui.radioInverseTelecine->isChecked());
     settings.insert("deinterlace", ui.radioDeinterlace->isChecked());
     settings.insert("dvdresolutionidx", ui.cboxDvdResolution->currentIndex());
+    settings.insert("resizekernelidx", ui.cboxResizeKernel->currentIndex());
     return settings;
 }
 
@@ -196,6 +265,7 @@ void VideoSettingsWidget::on_btnRevertCrop_clicked()
                                           ui.sboxResizeHeight->value()));
     config.setValue("video/deinterlace", ui.radioDeinterlace->isChecked());
     config.setValue("video/ivtc", ui.radioInverseTelecine->isChecked());
+    config.setValue("video/resizekernel", ui.cboxResizeKernel->currentData());
 
     emit settingsChanged();
 }
@@ -234,6 +304,8 @@ void VideoSettingsWidget::on_sboxResizeWidth_valueChanged(const int width)
         const int newHeight = std::ceil(ratio * width);
         ui.sboxResizeHeight->setValue(newHeight);
     }
+
+    updatePreview();
 }
 
 void VideoSettingsWidget::on_sboxResizeHeight_valueChanged(const int height)
@@ -243,6 +315,8 @@ void VideoSettingsWidget::on_sboxResizeHeight_valueChanged(const int height)
         const int newWidth = std::ceil(height / ratio);
         ui.sboxResizeWidth->setValue(newWidth);
     }
+
+    updatePreview();
 }
 
 } // namespace ui
@@ -5,6 +5,7 @@
 #include <QMap>
 #include <QSettings>
 #include <QWidget>
+#include "framefilter.h"
 #include "ui_videosettingswidget.h"
 
 class QCloseEvent;
@@ -45,7 +46,19 @@ public:
      * @brief Refresh values
      */
     void refresh();
-    
+
+    /**
+     * @brief Check if live preview shows settings that are not applied
+     * @return True if there are previewed settings, otherwise false
+     */
+    bool hasPendingPreview() const;
+
+public slots:
+    /**
+     * @brief Apply changes and emit \link settingsChanged() \endlink
+     */
+    void apply();
+
 private slots:
     /**
      * @brief Handle DVD resolution dropdown change
@@ -57,7 +70,7 @@ private slots:
     void on_cboxDvdResolution_activated(int index);
 
     /**
-     * @brief Apply changes and emit \link settingsChanged() \endlink
+     * @brief Apply changes
      */
     void on_pushButton_clicked();
 
@@ -66,6 +79,11 @@ private slots:
      */
     void handleCropChange(int);
 
+    /**
+     * @brief Emit \link previewChanged() \endlink with current settings
+     */
+    void updatePreview();
+
     /**
      * @brief Revert previously applied crop
      */
@@ -125,6 +143,12 @@ private:
      */
     QMap<QString, QVariant> getSettings() const;
 
+    /**
+     * @brief Get filter that previews the settings that are not applied
+     * @return Filter settings, nothing to apply if live preview is off
+     */
+    vfg::core::FrameFilter::Settings previewSettings() const;
+
 protected:
     void showEvent(QShowEvent *event);
     void closeEvent(QCloseEvent *event);
@@ -140,6 +164,12 @@ signals:
      * @param area Area to crop
      */
     void cropChanged(const QRect& area);
+
+    /**
+     * @brief Signal changed live preview
+     * @param settings Filter to apply to displayed frames
+     */
+    void previewChanged(const vfg::core::FrameFilter::Settings& settings);
 };
 
 } // namespace ui
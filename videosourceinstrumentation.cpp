@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cstdlib>
+#include <QFile>
+#include <QMutexLocker>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include "videosourceinstrumentation.h"
+
+namespace vfg {
+namespace core {
+
+void TimingHistogram::add(qint64 value)
+{
+    value = std::max<qint64>(0, value);
+
+    std::size_t bucket = 0;
+    for(qint64 v = value; v > 0 && bucket < buckets.size() - 1; v >>= 1) {
+        ++bucket;
+    }
+
+    ++buckets[bucket];
+    minValue = total == 0 ? value : std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+    sum += value;
+    ++total;
+}
+
+qint64 TimingHistogram::count() const
+{
+    return total;
+}
+
+double TimingHistogram::mean() const
+{
+    return total == 0 ? 0.0 : static_cast<double>(sum) / total;
+}
+
+qint64 TimingHistogram::min() const
+{
+    return minValue;
+}
+
+qint64 TimingHistogram::max() const
+{
+    return maxValue;
+}
+
+qint64 TimingHistogram::percentile(const double percent) const
+{
+    if(total == 0) {
+        return 0;
+    }
+
+    const qint64 rank = std::max<qint64>(1, static_cast<qint64>(total * percent / 100.0 + 0.5));
+    qint64 seen = 0;
+    for(std::size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        seen += buckets[bucket];
+        if(seen >= rank) {
+            const qint64 upper = bucket == 0 ? 0 : (qint64(1) << bucket) - 1;
+            return std::min(upper, maxValue);
+        }
+    }
+
+    return maxValue;
+}
+
+QString TimingHistogram::toString(const QString& unit) const
+{
+    QString out;
+    QTextStream ts(&out);
+    ts << "count=" << total << " mean=" << QString::number(mean(), 'f', 1) << unit
+       << " min=" << minValue << unit << " p50=" << percentile(50) << unit
+       << " p90=" << percentile(90) << unit << " p99=" << percentile(99) << unit
+       << " max=" << maxValue << unit << "\n";
+
+    for(std::size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        if(buckets[bucket] == 0) {
+            continue;
+        }
+
+        const qint64 lower = bucket == 0 ? 0 : qint64(1) << (bucket - 1);
+        const qint64 upper = bucket == 0 ? 0 : (qint64(1) << bucket) - 1;
+        ts << "  [" << lower << ", " << upper << "] " << buckets[bucket] << "\n";
+    }
+
+    return out;
+}
+
+HistogramInstrumentation::SeekClass HistogramInstrumentation::classify(const int seekDistance)
+{
+    if(seekDistance == 0) {
+        return Repeat;
+    }
+    else if(seekDistance == 1) {
+        return Next;
+    }
+    else if(seekDistance < 0) {
+        return Backward;
+    }
+    else if(seekDistance <= 25) {
+        return Short;
+    }
+    else if(seekDistance <= 250) {
+        return Medium;
+    }
+
+    return Long;
+}
+
+void HistogramInstrumentation::recordFrame(const FrameTiming& timing)
+{
+    QMutexLocker lock(&mutex);
+
+    decode.add(timing.decodeTime);
+    conversion.add(timing.conversionTime);
+    seekDistance.add(std::abs(timing.seekDistance));
+    decodeBySeek[classify(timing.seekDistance)].add(timing.decodeTime);
+}
+
+void HistogramInstrumentation::recordRequest(const int frameNumber, const qint64 totalTime)
+{
+    Q_UNUSED(frameNumber);
+
+    QMutexLocker lock(&mutex);
+
+    requests.add(totalTime);
+}
+
+QString HistogramInstrumentation::report() const
+{
+    static const QStringList seekClassNames {
+        "repeat", "next frame", "forward <= 25", "forward <= 250",
+        "forward > 250", "backward"
+    };
+
+    QMutexLocker lock(&mutex);
+
+    QString out;
+    QTextStream ts(&out);
+    ts << "Request time (grabber):\n" << requests.toString("us")
+       << "Decode time:\n" << decode.toString("us")
+       << "Conversion time:\n" << conversion.toString("us")
+       << "Seek distance:\n" << seekDistance.toString(" frames");
+
+    for(int seekClass = 0; seekClass < NumSeekClasses; ++seekClass) {
+        const TimingHistogram& histogram = decodeBySeek[seekClass];
+        if(histogram.count() > 0) {
+            ts << "Decode time, " << seekClassNames.at(seekClass) << ":\n"
+               << histogram.toString("us");
+        }
+    }
+
+    return out;
+}
+
+bool HistogramInstrumentation::dump(const QString& path) const
+{
+    QFile outFile(path);
+    if(!outFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QTextStream ts(&outFile);
+    ts << report();
+    return true;
+}
+
+void HistogramInstrumentation::clear()
+{
+    QMutexLocker lock(&mutex);
+
+    decode = {};
+    conversion = {};
+    seekDistance = {};
+    requests = {};
+    decodeBySeek = {};
+}
+
+} // namespace core
+} // namespace vfg
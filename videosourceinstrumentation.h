@@ -0,0 +1,185 @@
+#ifndef VFG_VIDEOSOURCEINSTRUMENTATION_H
+#define VFG_VIDEOSOURCEINSTRUMENTATION_H
+
+#include <array>
+#include <QMutex>
+#include <QtGlobal>
+
+class QString;
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The TimingHistogram class
+ *
+ * Fixed size histogram with power of two buckets. Recording
+ * a value is constant time and does not allocate, which keeps it
+ * cheap enough to be used on every frame request
+ */
+class TimingHistogram
+{
+public:
+    /**
+     * @brief Add a value to the histogram
+     * @param value Value to add (negative values are treated as 0)
+     */
+    void add(qint64 value);
+
+    /**
+     * @brief Get number of recorded values
+     * @return Number of recorded values
+     */
+    qint64 count() const;
+
+    /**
+     * @brief Get mean of the recorded values
+     * @return Mean value, 0 if empty
+     */
+    double mean() const;
+
+    /**
+     * @brief Get smallest recorded value
+     * @return Smallest value, 0 if empty
+     */
+    qint64 min() const;
+
+    /**
+     * @brief Get largest recorded value
+     * @return Largest value, 0 if empty
+     */
+    qint64 max() const;
+
+    /**
+     * @brief Get approximate percentile
+     *
+     * The result is the upper bound of the bucket the percentile
+     * falls into, clamped to the largest recorded value
+     *
+     * @param percent Percentile in range [0, 100]
+     * @return Approximate percentile value, 0 if empty
+     */
+    qint64 percentile(double percent) const;
+
+    /**
+     * @brief Format the histogram as text
+     * @param unit Unit name appended to the values
+     * @return Histogram as a multi-line string
+     */
+    QString toString(const QString& unit) const;
+
+private:
+    //! Bucket i counts values in range [2^(i-1), 2^i), bucket 0 counts zeros
+    std::array<qint64, 48> buckets {};
+    qint64 total {0};
+    qint64 sum {0};
+    qint64 minValue {0};
+    qint64 maxValue {0};
+};
+
+/**
+ * @brief Timing data for a single frame decoded by a video source
+ */
+struct FrameTiming
+{
+    //! Requested frame number
+    int frameNumber {-1};
+
+    //! Distance in frames from the previously requested frame (may be negative)
+    int seekDistance {0};
+
+    //! Time spent decoding the frame in microseconds
+    qint64 decodeTime {0};
+
+    //! Time spent converting the decoded frame to a QImage in microseconds
+    qint64 conversionTime {0};
+};
+
+/**
+ * @brief The SourceInstrumentation class
+ *
+ * Lightweight interface for collecting per-call timings from
+ * \link vfg::core::AbstractVideoSource video sources \endlink and
+ * \link vfg::core::VideoFrameGrabber frame grabbers \endlink
+ *
+ * Implementations must be thread-safe as frames are requested
+ * from multiple threads
+ */
+class SourceInstrumentation
+{
+public:
+    virtual ~SourceInstrumentation() = default;
+
+    /**
+     * @brief Record timings of a decoded frame
+     * @param timing Frame timings
+     */
+    virtual void recordFrame(const FrameTiming& timing) = 0;
+
+    /**
+     * @brief Record total time of a frame request, including locking
+     * @param frameNumber Requested frame number
+     * @param totalTime Request duration in microseconds
+     */
+    virtual void recordRequest(int frameNumber, qint64 totalTime) = 0;
+};
+
+/**
+ * @brief The HistogramInstrumentation class
+ *
+ * Records frame timings into histograms grouped by seek distance
+ * which can be dumped to a file
+ */
+class HistogramInstrumentation : public SourceInstrumentation
+{
+public:
+    void recordFrame(const FrameTiming& timing) override;
+
+    void recordRequest(int frameNumber, qint64 totalTime) override;
+
+    /**
+     * @brief Format all histograms as a text report
+     * @return Report
+     */
+    QString report() const;
+
+    /**
+     * @brief Write the report to a file
+     * @param path Path to the output file
+     * @return True on success, otherwise false
+     */
+    bool dump(const QString& path) const;
+
+    /**
+     * @brief Discard all recorded data
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Seek distance classes used to group decode times
+     */
+    enum SeekClass : int {
+        Repeat = 0,   //!< Same frame as the previous request
+        Next,         //!< The next frame
+        Short,        //!< Forward by at most 25 frames
+        Medium,       //!< Forward by at most 250 frames
+        Long,         //!< Forward by more than 250 frames
+        Backward,     //!< Any backward seek
+        NumSeekClasses
+    };
+
+    static SeekClass classify(int seekDistance);
+
+    mutable QMutex mutex {};
+    TimingHistogram decode {};
+    TimingHistogram conversion {};
+    TimingHistogram seekDistance {};
+    TimingHistogram requests {};
+    std::array<TimingHistogram, NumSeekClasses> decodeBySeek {};
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_VIDEOSOURCEINSTRUMENTATION_H
@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QList>
+#include <QLoggingCategory>
+#include "scriptparser.h"
+#include "y4mvideosource.h"
+
+Q_LOGGING_CATEGORY(Y4MSOURCE, "y4mvideosource")
+
+namespace {
+
+//! Maximum length of a stream or frame header line
+constexpr int MaxHeaderLength = 1024;
+
+const char StreamMagic[] = "YUV4MPEG2";
+const char FrameMagic[] = "FRAME";
+
+inline std::uint8_t clampByte(const int value) {
+    return static_cast<std::uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+/**
+ * @brief Find end of a header line
+ * @param data Start of the line
+ * @param available Bytes available after data
+ * @return Length of the line without the newline, -1 if not found
+ */
+qint64 lineLength(const uchar *data, const qint64 available) {
+    const qint64 maxLength = std::min<qint64>(available, MaxHeaderLength);
+    const void *newline = std::memchr(data, '\n', static_cast<std::size_t>(maxLength));
+    return newline ? static_cast<const uchar*>(newline) - data : -1;
+}
+
+/**
+ * @brief Convert planar YUV to 32-bit ARGB using BT.601 limited range
+ * @param luma Luma plane
+ * @param cb Cb plane (nullptr for monochrome)
+ * @param cr Cr plane (nullptr for monochrome)
+ * @param size Frame resolution
+ * @param shiftX Horizontal chroma subsampling as a power of two
+ * @param shiftY Vertical chroma subsampling as a power of two
+ * @return Frame as QImage
+ */
+QImage yuvToImage(const uchar *luma, const uchar *cb, const uchar *cr,
+                  const QSize& size, const int shiftX, const int shiftY) {
+    const int width = size.width();
+    const int height = size.height();
+    const int chromaWidth = (width + (1 << shiftX) - 1) >> shiftX;
+
+    QImage image(size, QImage::Format_ARGB32);
+    for(int y = 0; y < height; ++y) {
+        auto row = reinterpret_cast<std::uint32_t*>(image.scanLine(y));
+        const uchar *lumaRow = luma + static_cast<qint64>(y) * width;
+
+        if(!cb || !cr) {
+            for(int x = 0; x < width; ++x) {
+                const std::uint32_t level = clampByte((298 * (lumaRow[x] - 16) + 128) >> 8);
+                row[x] = 0xff000000 | (level << 16) | (level << 8) | level;
+            }
+            continue;
+        }
+
+        const qint64 chromaRowOffset = static_cast<qint64>(y >> shiftY) * chromaWidth;
+        const uchar *cbRow = cb + chromaRowOffset;
+        const uchar *crRow = cr + chromaRowOffset;
+        for(int x = 0; x < width; ++x) {
+            const int c = 298 * (lumaRow[x] - 16) + 128;
+            const int d = cbRow[x >> shiftX] - 128;
+            const int e = crRow[x >> shiftX] - 128;
+            const std::uint32_t r = clampByte((c + 409 * e) >> 8);
+            const std::uint32_t g = clampByte((c - 100 * d - 208 * e) >> 8);
+            const std::uint32_t b = clampByte((c + 516 * d) >> 8);
+            row[x] = 0xff000000 | (r << 16) | (g << 8) | b;
+        }
+    }
+
+    return image;
+}
+
+} // namespace
+
+namespace vfg {
+namespace core {
+
+Y4mVideoSource::Y4mVideoSource() :
+    AbstractVideoSource()
+{
+}
+
+void Y4mVideoSource::setRawFormat(const QSize& resolution, const Chroma rawFormat)
+{
+    rawSize = resolution;
+    rawChroma = rawFormat;
+}
+
+void Y4mVideoSource::load(const QString& fileName)
+{
+    unload();
+
+    file.setFileName(fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        throw VideoSourceError(QString("Unable to open %1: %2")
+                               .arg(fileName).arg(file.errorString()).toStdString());
+    }
+
+    dataSize = file.size();
+    data = dataSize > 0 ? file.map(0, dataSize) : nullptr;
+    if(!data) {
+        unload();
+        throw VideoSourceError("Unable to map video file into memory");
+    }
+
+    try {
+        const auto magicLength = static_cast<qint64>(sizeof(StreamMagic) - 1);
+        if(dataSize >= magicLength && std::memcmp(data, StreamMagic, magicLength) == 0) {
+            parseY4m();
+        }
+        else if(rawSize.isValid() && !rawSize.isEmpty()) {
+            frameSize = rawSize;
+            chroma = rawChroma;
+            firstFrame = 0;
+            frameStride = frameDataSize();
+            frameCount = static_cast<int>(dataSize / frameStride);
+        }
+        else {
+            throw VideoSourceError("File is not a YUV4MPEG2 video");
+        }
+
+        if(frameCount < 1) {
+            throw VideoSourceError("Video has no frames");
+        }
+    }
+    catch(const VideoSourceError&) {
+        unload();
+        throw;
+    }
+
+    qCDebug(Y4MSOURCE) << "Loaded" << fileName << frameSize << frameCount << "frames"
+                       << (frameOffsets.empty() ? "(fixed stride)" : "(indexed)");
+
+    emit videoLoaded();
+}
+
+void Y4mVideoSource::parseY4m()
+{
+    const qint64 headerLength = lineLength(data, dataSize);
+    if(headerLength < 0) {
+        throw VideoSourceError("Invalid YUV4MPEG2 header");
+    }
+
+    const QByteArray header = QByteArray::fromRawData(reinterpret_cast<const char*>(data),
+                                                      static_cast<int>(headerLength));
+    int width = 0;
+    int height = 0;
+    chroma = Chroma::C420;
+    for(const QByteArray& token : header.split(' ')) {
+        if(token.isEmpty()) {
+            continue;
+        }
+
+        const char tag = token.at(0);
+        const QByteArray value = token.mid(1);
+        if(tag == 'W') {
+            width = value.toInt();
+        }
+        else if(tag == 'H') {
+            height = value.toInt();
+        }
+        else if(tag == 'C') {
+            if(value == "420" || value == "420jpeg" || value == "420paldv" || value == "420mpeg2") {
+                chroma = Chroma::C420;
+            }
+            else if(value == "422") {
+                chroma = Chroma::C422;
+            }
+            else if(value == "444") {
+                chroma = Chroma::C444;
+            }
+            else if(value == "mono") {
+                chroma = Chroma::Mono;
+            }
+            else {
+                throw VideoSourceError("Unsupported YUV4MPEG2 colorspace: " + value.toStdString());
+            }
+        }
+    }
+
+    if(width <= 0 || height <= 0) {
+        throw VideoSourceError("Invalid YUV4MPEG2 resolution");
+    }
+    frameSize = QSize(width, height);
+
+    const qint64 frameBytes = frameDataSize();
+    const auto frameMagicLength = static_cast<qint64>(sizeof(FrameMagic) - 1);
+    firstFrame = headerLength + 1;
+
+    // Frame headers are normally plain "FRAME" lines, in which case every
+    // frame is the same size and can be located without reading the file
+    const qint64 available = dataSize - firstFrame;
+    const qint64 firstHeaderLength = lineLength(data + firstFrame, available);
+    if(firstHeaderLength == frameMagicLength
+            && std::memcmp(data + firstFrame, FrameMagic, frameMagicLength) == 0) {
+        frameStride = firstHeaderLength + 1 + frameBytes;
+        frameCount = static_cast<int>(available / frameStride);
+        firstFrame += firstHeaderLength + 1;
+        return;
+    }
+
+    // Frame headers with parameters may vary in size, so index every frame
+    frameStride = 0;
+    qint64 pos = firstFrame;
+    while(pos < dataSize) {
+        const qint64 length = lineLength(data + pos, dataSize - pos);
+        if(length < frameMagicLength || std::memcmp(data + pos, FrameMagic, frameMagicLength) != 0) {
+            break;
+        }
+
+        const qint64 offset = pos + length + 1;
+        if(offset + frameBytes > dataSize) {
+            break;
+        }
+
+        frameOffsets.push_back(offset);
+        pos = offset + frameBytes;
+    }
+
+    frameCount = static_cast<int>(frameOffsets.size());
+}
+
+void Y4mVideoSource::unload()
+{
+    if(data) {
+        file.unmap(const_cast<uchar*>(data));
+    }
+    file.close();
+
+    data = nullptr;
+    dataSize = 0;
+    frameSize = QSize();
+    frameCount = 0;
+    firstFrame = 0;
+    frameStride = 0;
+    frameOffsets.clear();
+}
+
+qint64 Y4mVideoSource::frameDataSize() const
+{
+    const qint64 lumaSize = static_cast<qint64>(frameSize.width()) * frameSize.height();
+    const qint64 halfWidth = (frameSize.width() + 1) / 2;
+    const qint64 halfHeight = (frameSize.height() + 1) / 2;
+    switch(chroma) {
+    case Chroma::C420:
+        return lumaSize + 2 * halfWidth * halfHeight;
+    case Chroma::C422:
+        return lumaSize + 2 * halfWidth * frameSize.height();
+    case Chroma::C444:
+        return lumaSize * 3;
+    case Chroma::Mono:
+        return lumaSize;
+    }
+
+    return lumaSize;
+}
+
+qint64 Y4mVideoSource::frameOffset(const int frameNumber) const
+{
+    if(frameOffsets.empty()) {
+        return firstFrame + frameNumber * frameStride;
+    }
+
+    return frameOffsets[static_cast<std::size_t>(frameNumber)];
+}
+
+bool Y4mVideoSource::hasVideo() const
+{
+    return data != nullptr && frameCount > 0;
+}
+
+int Y4mVideoSource::getNumFrames() const
+{
+    return frameCount;
+}
+
+QImage Y4mVideoSource::getFrame(const int frameNumber)
+{
+    if(!isValidFrame(frameNumber)) {
+        return {};
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const uchar *luma = data + frameOffset(frameNumber);
+    const qint64 lumaSize = static_cast<qint64>(frameSize.width()) * frameSize.height();
+    const uchar *cb = nullptr;
+    const uchar *cr = nullptr;
+    int shiftX = 0;
+    int shiftY = 0;
+    if(chroma != Chroma::Mono) {
+        shiftX = chroma == Chroma::C444 ? 0 : 1;
+        shiftY = chroma == Chroma::C420 ? 1 : 0;
+        cb = luma + lumaSize;
+        cr = cb + (frameDataSize() - lumaSize) / 2;
+    }
+
+    QImage frame = yuvToImage(luma, cb, cr, frameSize, shiftX, shiftY);
+    recordFrameTiming(frameNumber, 0, timer.nsecsElapsed() / 1000);
+
+    return frame;
+}
+
+QString Y4mVideoSource::getSupportedFormats()
+{
+    static const QString formats = "YUV4MPEG2 video (*.y4m);;Raw YUV video (*.yuv)";
+    return formats;
+}
+
+bool Y4mVideoSource::isValidFrame(const int frameNum) const
+{
+    return frameNum >= 0 && frameNum < frameCount;
+}
+
+vfg::ScriptParser Y4mVideoSource::getParser(const QFileInfo& info) const
+{
+    return vfg::ScriptParser(info.absoluteFilePath());
+}
+
+QSize Y4mVideoSource::resolution() const
+{
+    return frameSize;
+}
+
+QString Y4mVideoSource::fileName() const
+{
+    return data ? QFileInfo(file).absoluteFilePath() : QString();
+}
+
+std::pair<qint64, qint64> Y4mVideoSource::frameByteRange(const int frameNumber) const
+{
+    if(!isValidFrame(frameNumber)) {
+        return {-1, -1};
+    }
+
+    const qint64 offset = frameOffset(frameNumber);
+    return {offset, offset + frameDataSize() - 1};
+}
+
+} // namespace core
+} // namespace vfg
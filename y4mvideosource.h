@@ -0,0 +1,132 @@
+#ifndef VFG_Y4MVIDEOSOURCE_H
+#define VFG_Y4MVIDEOSOURCE_H
+
+#include <vector>
+#include <QFile>
+#include <QSize>
+#include <QString>
+#include "abstractvideosource.h"
+
+namespace vfg {
+namespace core {
+
+/**
+ * @brief The Y4mVideoSource class
+ *
+ * Reads uncompressed YUV4MPEG2 (.y4m) files or headerless planar YUV
+ * files. The file is memory-mapped and frames are located by offset,
+ * so any frame is accessed in constant time without decoding.
+ *
+ * Supports 8-bit 4:2:0, 4:2:2, 4:4:4 and monochrome video. Frames are
+ * converted to 32-bit ARGB using BT.601 limited range coefficients.
+ */
+class Y4mVideoSource : public vfg::core::AbstractVideoSource
+{
+public:
+    /**
+     * @brief Chroma subsampling of the planar YUV data
+     */
+    enum class Chroma {
+        C420,
+        C422,
+        C444,
+        Mono
+    };
+
+private:
+    //! Mapped file
+    QFile file {};
+
+    //! Start of the mapped file, nullptr if nothing is loaded
+    const uchar *data {nullptr};
+
+    //! Size of the mapped file
+    qint64 dataSize {0};
+
+    //! Resolution of the loaded video
+    QSize frameSize {};
+
+    //! Chroma subsampling of the loaded video
+    Chroma chroma {Chroma::C420};
+
+    //! Resolution of headerless files
+    QSize rawSize {};
+
+    //! Chroma subsampling of headerless files
+    Chroma rawChroma {Chroma::C420};
+
+    //! Number of frames in the loaded video
+    int frameCount {0};
+
+    //! Offset of the first frame's pixel data
+    qint64 firstFrame {0};
+
+    //! Distance between frames when all frames have the same header size
+    qint64 frameStride {0};
+
+    //! Pixel data offset of every frame when frame headers vary in size,
+    //! empty when frames are located using frameStride
+    std::vector<qint64> frameOffsets {};
+
+    /**
+     * @brief Get size of the pixel data of a single frame
+     * @return Size in bytes
+     */
+    qint64 frameDataSize() const;
+
+    /**
+     * @brief Get offset of a frame's pixel data
+     * @pre frameNumber must be valid
+     * @param frameNumber Frame number
+     * @return Offset from the start of the file
+     */
+    qint64 frameOffset(int frameNumber) const;
+
+    /**
+     * @brief Parse YUV4MPEG2 stream header and locate frames
+     * @exception vfg::core::VideoSourceError If the header is invalid or unsupported
+     */
+    void parseY4m();
+
+    /**
+     * @brief Unmap and close the current file
+     */
+    void unload();
+
+public:
+    Y4mVideoSource();
+    ~Y4mVideoSource() override = default;
+
+    /**
+     * @brief Set format of headerless files
+     *
+     * Files that do not start with a YUV4MPEG2 header are read as
+     * consecutive planar YUV frames with this format
+     *
+     * @param resolution Resolution of the video
+     * @param rawFormat Chroma subsampling of the video
+     */
+    void setRawFormat(const QSize& resolution, Chroma rawFormat);
+
+    /**
+     * @brief Load file
+     * @param fileName File to load
+     * @throws vfg::core::VideoSourceError If the file can't be opened or mapped
+     * @throws vfg::core::VideoSourceError If the format is invalid or unsupported
+     */
+    void load(const QString& fileName) override;
+    bool hasVideo() const override;
+    int getNumFrames() const override;
+    QImage getFrame(int frameNumber) override;
+    QString getSupportedFormats() override;
+    bool isValidFrame(int frameNum) const override;
+    vfg::ScriptParser getParser(const QFileInfo& info) const override;
+    QSize resolution() const override;
+    QString fileName() const override;
+    std::pair<qint64, qint64> frameByteRange(int frameNumber) const override;
+};
+
+} // namespace core
+} // namespace vfg
+
+#endif // VFG_Y4MVIDEOSOURCE_H